@@ -0,0 +1,292 @@
+/// ===========================================================================
+/*! \file   BenchmarkCalibrationInference.cxx
+ *  \author Derek Anderson
+ *  \date   10.17.2026
+ *
+ *  A ROOT macro to benchmark the cost of evaluating
+ *  each of the BHCal+BIC calibration methods listed
+ *  in 'TMVAClusterParameters.hxx'. Each method is
+ *  loaded through TMVAHelper::Reader (and, where
+ *  supported, through QuantizedModelHelper) and
+ *  evaluated on a fixed table of features read from
+ *  the TNtuple produced by 'FillBHCalClusterCalibrationTuple.cxx'.
+ */
+/// ===========================================================================
+
+#define BenchmarkCalibrationInference_cxx
+
+// c++ utilities
+#include <string>
+#include <vector>
+#include <cassert>
+#include <utility>
+#include <iostream>
+// root libraries
+#include <TFile.h>
+#include <TNtuple.h>
+#include <TSystem.h>
+// tmva components
+#include <TMVA/Reader.h>
+// analysis utilities
+#include "TMVAClusterParameters.hxx"
+#include "../../utility/TMVAHelper.hxx"
+#include "../../utility/NTupleHelper.hxx"
+#include "../../utility/BenchmarkHelper.hxx"
+#include "../../utility/QuantizedModelHelper.hxx"
+
+
+
+// ============================================================================
+//! Struct to consolidate user options
+// ============================================================================
+struct Options {
+  std::string in_file;      // input file
+  std::string in_tuple;     // input ntuple
+  std::string in_tmva;      // input tmva directory
+  std::string name_tmva;    // name of TMVA process
+  std::string out_json;     // output json file
+  std::size_t num_events;   // no. of events in feature table
+  std::size_t batch_size;   // batch size for batched backends
+  bool        do_quantize;  // also benchmark quantized backends
+}  DefaultOptions = {
+  "./input/forNewTrainingMacro_noNonzeroEvts_andDefinitePrimary.evt5Ke210pim_central.d14m9y2024.root",
+  "ntForCalib",
+  "tmva_test",
+  "TMVARegression",
+  "benchmarkCalibrationInference.json",
+  10000,
+  256,
+  true
+};
+
+
+
+// ============================================================================
+//! Benchmark per-event inference of BHCal cluster calibrations
+// ============================================================================
+void BenchmarkCalibrationInference(const Options& opt = DefaultOptions) {
+
+  // --------------------------------------------------------------------------
+  // Grab calculation parameters
+  // --------------------------------------------------------------------------
+  TMVAHelper::Parameters param = TMVAClusterParameters::GetParameters(false);
+
+  // precisions to benchmark for quantized backend
+  const std::vector<QuantizedModelHelper::Precision> vecPrecisions = {
+    QuantizedModelHelper::Precision::Float32,
+    QuantizedModelHelper::Precision::Float16,
+    QuantizedModelHelper::Precision::Int8
+  };
+
+  // lower verbosity & announce start
+  gErrorIgnoreLevel = kError;
+  std::cout << "\n  Beginning calibration inference benchmark..." << std::endl;
+
+  // --------------------------------------------------------------------------
+  // Load fixed feature table
+  // --------------------------------------------------------------------------
+
+  // open input
+  TFile* input = new TFile(opt.in_file.data(), "read");
+  if (!input) {
+    std::cerr << "PANIC: couldn't open input file!\n"
+              << "       input  = " << input
+              << std::endl;
+    assert(input);
+  }
+
+  // grab input tuple
+  TNtuple* ntInput = (TNtuple*) input -> Get(opt.in_tuple.data());
+  if (!ntInput) {
+    std::cerr << "PANIC: couldn't grab input tuple!\n"
+              << "       name  = " << opt.in_tuple
+              << std::endl;
+    assert(ntInput);
+  }
+
+  // collect input leaves into a single vector
+  std::vector<std::string> inputs;
+  for (const auto& useAndVar : param.variables) {
+    inputs.push_back(useAndVar.second);
+  }
+
+  // create input helper
+  NTupleHelper in_helper( inputs );
+  in_helper.SetBranches(ntInput);
+
+  // read table into memory so i/o doesn't enter the timing
+  const uint64_t nEntries = std::min((uint64_t) opt.num_events, (uint64_t) ntInput -> GetEntries());
+  std::vector<std::vector<float>> table(nEntries);
+  for (uint64_t iEntry = 0; iEntry < nEntries; ++iEntry) {
+    ntInput -> GetEntry(iEntry);
+    table[iEntry] = in_helper.GetValues();
+  }
+  std::cout << "    Loaded feature table: " << nEntries << " events." << std::endl;
+
+  // --------------------------------------------------------------------------
+  // Benchmark each method
+  // --------------------------------------------------------------------------
+
+  // timer & list of results
+  BenchmarkHelper::Timer               timer;
+  std::vector<BenchmarkHelper::Result> results;
+
+  for (const auto& methodAndOpt : param.methods) {
+
+    const std::string method = methodAndOpt.first;
+    const std::string path   = opt.in_tmva + "/weights/" + opt.name_tmva + "_" + method + ".weights.xml";
+    if (!TMVAHelper::DoesFileExist(path)) {
+      std::cerr << "WARNING: file '" << path << "' doesn't exist! Not benchmarking method '" << method << "'!" << std::endl;
+      continue;
+    }
+
+    // ------------------------------------------------------------------------
+    // TMVA reader backend
+    // ------------------------------------------------------------------------
+    {
+      BenchmarkHelper::Result result;
+      result.name              = method + "/tmva";
+      result.labels["method"]  = method;
+      result.labels["backend"] = "tmva";
+
+      // load model
+      const double memBefore = BenchmarkHelper::GetResidentMemory();
+      timer.Start();
+
+      TMVAHelper::Reader read_helper( param.variables, {methodAndOpt} );
+      read_helper.SetOptions(param.opts_reading);
+
+      TMVA::Reader* reader = new TMVA::Reader(read_helper.CompressOptions().data());
+      read_helper.ReadVariables(reader, in_helper);
+      read_helper.BookMethodsToRead(reader, std::vector<std::string>({path}));
+
+      result.metrics["load_ms"]   = timer.GetElapsed() * 1e-6;
+      result.metrics["memory_kB"] = BenchmarkHelper::GetResidentMemory() - memBefore;
+
+      // evaluate each event, timing only the evaluation
+      std::vector<double> timings(nEntries);
+      for (uint64_t iEntry = 0; iEntry < nEntries; ++iEntry) {
+        for (std::size_t iVar = 0; iVar < inputs.size(); ++iVar) {
+          in_helper.SetVariable(inputs[iVar], table[iEntry][iVar]);
+        }
+        timer.Start();
+        read_helper.EvaluateMethod(reader, method);
+        timings[iEntry] = timer.GetElapsed();
+      }
+      BenchmarkHelper::AddTimingMetrics(result, timings);
+      results.push_back(result);
+
+      delete reader;
+      std::cout << "    Benchmarked method '" << method << "' with TMVA reader." << std::endl;
+    }
+
+    // ------------------------------------------------------------------------
+    // Quantized backend
+    // ------------------------------------------------------------------------
+    const auto type = TMVAHelper::MapNameToType()[method];
+    const bool isSupported = (type == TMVA::Types::EMVA::kLD)  ||
+                             (type == TMVA::Types::EMVA::kMLP) ||
+                             (type == TMVA::Types::EMVA::kBDT);
+    if (!opt.do_quantize || !isSupported) continue;
+
+    for (const auto precision : vecPrecisions) {
+
+      const std::string backend = "quantized_" + QuantizedModelHelper::GetPrecisionName(precision);
+
+      BenchmarkHelper::Result result;
+      result.name              = method + "/" + backend;
+      result.labels["method"]  = method;
+      result.labels["backend"] = backend;
+
+      // load model
+      const double memBefore = BenchmarkHelper::GetResidentMemory();
+      timer.Start();
+
+      QuantizedModelHelper::Model model(path, precision);
+
+      result.metrics["load_ms"]     = timer.GetElapsed() * 1e-6;
+      result.metrics["memory_kB"]   = BenchmarkHelper::GetResidentMemory() - memBefore;
+      result.metrics["model_bytes"] = model.GetNBytes();
+
+      // map model variables onto table columns
+      std::vector<std::size_t> columns;
+      for (const std::string& var : model.GetVariables()) {
+        auto column = std::find(inputs.begin(), inputs.end(), var);
+        if (column == inputs.end()) {
+          std::cerr << "PANIC: variable '" << var << "' of model '" << path << "' isn't in the input table!" << std::endl;
+          assert(column != inputs.end());
+        }
+        columns.push_back( column - inputs.begin() );
+      }
+
+      // single-event latency
+      std::vector<float>  row(columns.size());
+      std::vector<double> timings(nEntries);
+      for (uint64_t iEntry = 0; iEntry < nEntries; ++iEntry) {
+        for (std::size_t iVar = 0; iVar < columns.size(); ++iVar) {
+          row[iVar] = table[iEntry][columns[iVar]];
+        }
+        timer.Start();
+        const float value = model.Evaluate(row);
+        timings[iEntry] = timer.GetElapsed();
+        (void) value;
+      }
+      BenchmarkHelper::AddTimingMetrics(result, timings);
+
+      // batched throughput
+      std::vector<double> batchTimings;
+      std::vector<float>  soa;
+      std::vector<float>  outputs;
+      for (uint64_t iStart = 0; iStart < nEntries; iStart += opt.batch_size) {
+
+        const std::size_t nEvts = std::min((uint64_t) opt.batch_size, nEntries - iStart);
+        soa.resize(columns.size() * nEvts);
+        for (std::size_t iEvt = 0; iEvt < nEvts; ++iEvt) {
+          for (std::size_t iVar = 0; iVar < columns.size(); ++iVar) {
+            soa[(iVar * nEvts) + iEvt] = table[iStart + iEvt][columns[iVar]];
+          }
+        }
+
+        timer.Start();
+        model.EvaluateBatch(soa, nEvts, outputs);
+        const double elapsed = timer.GetElapsed();
+
+        // record per-event cost of batch
+        for (std::size_t iEvt = 0; iEvt < nEvts; ++iEvt) {
+          batchTimings.push_back(elapsed / nEvts);
+        }
+      }
+      BenchmarkHelper::AddTimingMetrics(result, batchTimings, "batch_");
+      result.metrics["batch_size"] = opt.batch_size;
+      results.push_back(result);
+
+      std::cout << "    Benchmarked method '" << method << "' with " << backend << " backend." << std::endl;
+    }  // end precision loop
+  }  // end method loop
+
+  // --------------------------------------------------------------------------
+  // Report and exit
+  // --------------------------------------------------------------------------
+
+  // print summary
+  std::cout << "\n    Results:" << std::endl;
+  BenchmarkHelper::PrintResults(
+    results,
+    {"ns_per_event", "p50_ns", "p99_ns", "batch_ns_per_event", "load_ms", "memory_kB"}
+  );
+
+  // write json
+  BenchmarkHelper::WriteJSON(opt.out_json, "BenchmarkCalibrationInference", results);
+  std::cout << "\n    Wrote results to: " << opt.out_json << std::endl;
+
+  // close input
+  input -> cd();
+  input -> Close();
+
+  // announce end & exit
+  std::cout << "  Finished calibration inference benchmark!\n" << std::endl;
+  return;
+
+}
+
+// end ========================================================================
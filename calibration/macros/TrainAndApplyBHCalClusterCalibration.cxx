@@ -33,6 +33,7 @@
 #include "TMVAClusterParameters.hxx"
 #include "../../utility/TMVAHelper.hxx"
 #include "../../utility/NTupleHelper.hxx"
+#include "../../utility/CompressionProfiles.hxx"
 
 
 
@@ -45,6 +46,7 @@ struct Options {
   std::string out_file;     // output file
   std::string out_tmva;     // output tmva directory
   std::string name_tmva;    // name of TMVA process
+  std::string comp_profile; // output compression profile
   bool        do_progress;  // print progress through entry loop
   bool        do_read_cut;  // apply cuts while reading ntuple
 }  DefaultOptions = {
@@ -53,6 +55,7 @@ struct Options {
   "test.root",
   "tmva_test",
   "TMVARegression",
+  "tmva",
   true,
   false
 };
@@ -89,6 +92,10 @@ void TrainAndApplyBHCalClusterCalibration(const Options& opt = DefaultOptions) {
     assert(output && inToTrain && inToApply);
   }
 
+  // set compression of output
+  const CompressionProfiles::Profile profile = CompressionProfiles::Get(opt.comp_profile);
+  CompressionProfiles::Apply(output, profile);
+
   // print input/output files
   std::cout << "    Opened input/output files:\n"
             << "      input file  = " << opt.in_file << "\n"
@@ -136,6 +143,7 @@ void TrainAndApplyBHCalClusterCalibration(const Options& opt = DefaultOptions) {
 
   // set input/output tuple branches
   TNtuple* ntOutput = new TNtuple("ntTmvaOutput", "Output of TMVA regression", out_helper.CompressVariables().data());
+  CompressionProfiles::Apply(ntOutput, profile);
   in_helper.SetBranches(ntToApply);
   std::cout << "    Set input/output tuple branches." << std::endl;
 
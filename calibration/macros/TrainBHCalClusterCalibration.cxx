@@ -30,6 +30,7 @@
 // analysis utilities
 #include "TMVAClusterParameters.hxx"
 #include "../../utility/TMVAHelper.hxx"
+#include "../../utility/CompressionProfiles.hxx"
 
 
 
@@ -42,6 +43,7 @@ struct Options {
   std::string out_file;     // output file
   std::string out_tmva;     // output tmva directory
   std::string name_tmva;    // name of TMVA process
+  std::string comp_profile; // output compression profile
   bool        do_progress;  // print progress through entry loop
 }  DefaultOptions = {
   "./input/forNewTrainingMacro_noNonzeroEvts_andDefinitePrimary.evt5Ke210pim_central.d14m9y2024.root",
@@ -49,6 +51,7 @@ struct Options {
   "testA.root",
   "tmva_test",
   "TMVARegression",
+  "tmva",
   true
 };
 
@@ -83,6 +86,9 @@ void TrainBHCalClusterCalibration(const Options& opt = DefaultOptions) {
     assert(output && input);
   }
 
+  // set compression of output
+  CompressionProfiles::Apply(output, CompressionProfiles::Get(opt.comp_profile));
+
   // print input/output files
   std::cout << "    Opened input/output files:\n"
             << "      input file  = " << opt.in_file << "\n"
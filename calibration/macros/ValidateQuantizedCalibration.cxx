@@ -0,0 +1,430 @@
+/// ===========================================================================
+/*! \file   ValidateQuantizedCalibration.cxx
+ *  \author Derek Anderson
+ *  \date   10.17.2026
+ *
+ *  A ROOT macro to validate reduced-precision (fp16/int8)
+ *  evaluation of the BHCal+BIC calibration models against
+ *  full-precision evaluation via TMVA::Reader. Ingests the
+ *  TNtuple produced by 'FillBHCalClusterCalibrationTuple.cxx'
+ *  and reports the change in resolution and linearity in
+ *  bins of particle energy.
+ */
+/// ===========================================================================
+
+#define ValidateQuantizedCalibration_cxx
+
+// c++ utilities
+#include <cmath>
+#include <string>
+#include <vector>
+#include <cassert>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <utility>
+#include <iostream>
+// root libraries
+#include <TFile.h>
+#include <TNtuple.h>
+#include <TSystem.h>
+#include <TGraphErrors.h>
+#include <TTreeFormula.h>
+// tmva components
+#include <TMVA/Reader.h>
+// analysis utilities
+#include "TMVAClusterParameters.hxx"
+#include "../../utility/TMVAHelper.hxx"
+#include "../../utility/GraphHelper.hxx"
+#include "../../utility/NTupleHelper.hxx"
+#include "../../utility/QuantizedModelHelper.hxx"
+
+
+
+// ============================================================================
+//! Struct to consolidate user options
+// ============================================================================
+struct Options {
+  std::string              in_file;      // input file
+  std::string              in_tuple;     // input ntuple
+  std::string              in_tmva;      // input tmva directory
+  std::string              name_tmva;    // name of TMVA process
+  std::string              out_file;     // output file
+  std::string              out_report;   // output report (text)
+  std::vector<std::string> methods;      // methods to validate
+  std::size_t              batch_size;   // no. of events per batch
+  bool                     do_progress;  // print progress through entry loop
+  bool                     do_read_cut;  // apply cuts while reading ntuple
+}  DefaultOptions = {
+  "./input/forNewTrainingMacro_noNonzeroEvts_andDefinitePrimary.evt5Ke210pim_central.d14m9y2024.root",
+  "ntForCalib",
+  "tmva_test",
+  "TMVARegression",
+  "validateQuantized.root",
+  "validateQuantized.txt",
+  {"LD", "MLP", "BDTG"},
+  1024,
+  true,
+  false
+};
+
+
+
+// ============================================================================
+//! Struct to accumulate moments of calibrated energy in a bin
+// ============================================================================
+struct Moments {
+  double n    = 0.;
+  double sum  = 0.;
+  double sum2 = 0.;
+
+  void Add(const double value) {
+    n    += 1.;
+    sum  += value;
+    sum2 += value * value;
+  }
+  double Mean()     const {return (n > 0.) ? sum / n : 0.;}
+  double RMS()      const {return (n > 0.) ? std::sqrt(std::max(0., (sum2 / n) - (Mean() * Mean()))) : 0.;}
+  double MeanErr()  const {return (n > 0.) ? RMS() / std::sqrt(n) : 0.;}
+  double RMSErr()   const {return (n > 0.) ? RMS() / std::sqrt(2. * n) : 0.;}
+  double Reso()     const {return (Mean() != 0.) ? RMS() / Mean() : 0.;}
+  double ResoErr()  const {return (Mean() != 0.) ? std::hypot(MeanErr() / Mean(), RMSErr() / RMS()) : 0.;}
+};
+
+
+
+// ============================================================================
+//! Validate reduced-precision evaluation of BHCal cluster calibrations
+// ============================================================================
+void ValidateQuantizedCalibration(const Options& opt = DefaultOptions) {
+
+  // particle energy, binning & histogram tags
+  //   <0> = tag
+  //   <1> = particle energy
+  //   <2> = bin low edge
+  //   <3> = bin high edge
+  const std::vector<std::tuple<std::string, float, float, float>> vecParBins = {
+    std::make_tuple("Ene2",  2., 0., 4.),
+    std::make_tuple("Ene5",  5., 4., 6.),
+    std::make_tuple("Ene7",  7., 6., 9.),
+    std::make_tuple("Ene10", 10., 9., 100.)
+  };
+
+  // precisions to compare against full tmva evaluation
+  const std::vector<QuantizedModelHelper::Precision> vecPrecisions = {
+    QuantizedModelHelper::Precision::Float32,
+    QuantizedModelHelper::Precision::Float16,
+    QuantizedModelHelper::Precision::Int8
+  };
+
+  // --------------------------------------------------------------------------
+  // Grab calculation parameters
+  // --------------------------------------------------------------------------
+  TMVAHelper::Parameters param = TMVAClusterParameters::GetParameters(opt.do_progress);
+
+  // only keep methods which are being validated
+  std::vector<std::pair<std::string, std::string>> methods;
+  for (const auto& methodAndOpt : param.methods) {
+    if (std::find(opt.methods.begin(), opt.methods.end(), methodAndOpt.first) != opt.methods.end()) {
+      methods.push_back(methodAndOpt);
+    }
+  }
+
+  // lower verbosity & announce start
+  gErrorIgnoreLevel = kError;
+  std::cout << "\n  Beginning quantized calibration validation macro..." << std::endl;
+
+  // --------------------------------------------------------------------------
+  // Open input/outputs
+  // --------------------------------------------------------------------------
+
+  // open files
+  TFile* input  = new TFile(opt.in_file.data(),  "read");
+  TFile* output = new TFile(opt.out_file.data(), "recreate");
+  if (!input || !output) {
+    std::cerr << "PANIC: couldn't open a file!\n"
+              << "       input  = " << input << "\n"
+              << "       output = " << output
+              << std::endl;
+    assert(output && input);
+  }
+
+  // grab input tuple
+  TNtuple* ntInput = (TNtuple*) input -> Get(opt.in_tuple.data());
+  if (!ntInput) {
+    std::cerr << "PANIC: couldn't grab input tuple!\n"
+              << "       name  = " << opt.in_tuple << "\n"
+              << "       input = " << input
+              << std::endl;
+    assert(ntInput);
+  }
+  std::cout << "    Opened inputs/outputs:\n"
+            << "      input file  = " << opt.in_file << "\n"
+            << "      input tuple = " << opt.in_tuple << "\n"
+            << "      output file = " << opt.out_file
+            << std::endl;
+
+  // --------------------------------------------------------------------------
+  // Set up full-precision reader & reduced-precision models
+  // --------------------------------------------------------------------------
+
+  // create tmva helper
+  TMVAHelper::Reader read_helper( param.variables, methods );
+  read_helper.SetOptions(param.opts_reading);
+
+  // collect input leaves into a single vector
+  std::vector<std::string> inputs;
+  for (const auto& useAndVar : param.variables) {
+    inputs.push_back(useAndVar.second);
+  }
+
+  // create input helper
+  NTupleHelper in_helper( inputs );
+  in_helper.SetBranches(ntInput);
+
+  // instantiate reader, add input variables & book methods
+  TMVA::Reader* reader = new TMVA::Reader(read_helper.CompressOptions().data());
+  read_helper.ReadVariables(reader, in_helper);
+  read_helper.BookMethodsToRead(reader, opt.in_tmva, opt.name_tmva);
+
+  // load reduced-precision models
+  //   - models[iMethod][iPrec]
+  std::vector<std::string>                                    vecMethods;
+  std::vector<std::vector<QuantizedModelHelper::Model>>       vecModels;
+  for (const auto& methodAndOpt : methods) {
+
+    const std::string path = opt.in_tmva + "/weights/" + opt.name_tmva + "_" + methodAndOpt.first + ".weights.xml";
+    if (!TMVAHelper::DoesFileExist(path)) {
+      std::cerr << "WARNING: file '" << path << "' doesn't exist! Not validating method '" << methodAndOpt.first << "'!" << std::endl;
+      continue;
+    }
+
+    vecMethods.push_back( methodAndOpt.first );
+    vecModels.emplace_back();
+    for (const auto precision : vecPrecisions) {
+      vecModels.back().push_back( QuantizedModelHelper::Model(path, precision) );
+    }
+  }
+  std::cout << "    Loaded " << vecMethods.size() << " methods in " << vecPrecisions.size() << " precisions." << std::endl;
+
+  // --------------------------------------------------------------------------
+  // Evaluate models
+  // --------------------------------------------------------------------------
+
+  // accumulators: [iMethod][iPrec][iBin], where iPrec = 0 is tmva
+  const std::size_t nPrec = vecPrecisions.size() + 1;
+  std::vector<std::vector<std::vector<Moments>>> moments(
+    vecMethods.size(),
+    std::vector<std::vector<Moments>>(nPrec, std::vector<Moments>(vecParBins.size()))
+  );
+
+  // largest relative deviation from tmva: [iMethod][iPrec]
+  std::vector<std::vector<double>> maxDev(vecMethods.size(), std::vector<double>(nPrec, 0.));
+
+  // batch buffers
+  std::vector<float>              batchPar;
+  std::vector<std::vector<float>> batchRef(vecMethods.size());
+  std::vector<std::vector<float>> batchIn(vecMethods.size());
+  std::vector<float>              batchOut;
+
+  // helper lambda to find particle energy bin
+  auto findParBin = [&vecParBins](const float energy) {
+    for (std::size_t iBin = 0; iBin < vecParBins.size(); ++iBin) {
+      if ((energy >= get<2>(vecParBins[iBin])) && (energy < get<3>(vecParBins[iBin]))) {
+        return (int) iBin;
+      }
+    }
+    return -1;
+  };
+
+  // helper lambda to evaluate & clear a batch
+  auto processBatch = [&]() {
+
+    const std::size_t nEvts = batchPar.size();
+    if (nEvts == 0) return;
+
+    for (std::size_t iMethod = 0; iMethod < vecMethods.size(); ++iMethod) {
+
+      // re-arrange inputs into structure-of-arrays
+      const std::vector<std::string> vars = vecModels[iMethod].front().GetVariables();
+      std::vector<float>             soa(vars.size() * nEvts);
+      for (std::size_t iEvt = 0; iEvt < nEvts; ++iEvt) {
+        for (std::size_t iVar = 0; iVar < vars.size(); ++iVar) {
+          soa[(iVar * nEvts) + iEvt] = batchIn[iMethod][(iEvt * vars.size()) + iVar];
+        }
+      }
+
+      // full precision reference
+      for (std::size_t iEvt = 0; iEvt < nEvts; ++iEvt) {
+        const int iBin = findParBin(batchPar[iEvt]);
+        if (iBin >= 0) moments[iMethod][0][iBin].Add( batchRef[iMethod][iEvt] );
+      }
+
+      // reduced precision
+      for (std::size_t iPrec = 0; iPrec < vecPrecisions.size(); ++iPrec) {
+        vecModels[iMethod][iPrec].EvaluateBatch(soa, nEvts, batchOut);
+        for (std::size_t iEvt = 0; iEvt < nEvts; ++iEvt) {
+
+          const int iBin = findParBin(batchPar[iEvt]);
+          if (iBin >= 0) moments[iMethod][iPrec + 1][iBin].Add( batchOut[iEvt] );
+
+          const double ref = batchRef[iMethod][iEvt];
+          if (ref != 0.) {
+            maxDev[iMethod][iPrec + 1] = std::max(maxDev[iMethod][iPrec + 1], std::abs((batchOut[iEvt] - ref) / ref));
+          }
+        }
+      }
+      batchRef[iMethod].clear();
+      batchIn[iMethod].clear();
+    }
+    batchPar.clear();
+    return;
+
+  };  // end 'processBatch()'
+
+  // instantiate formula object for applying ntuple cuts
+  TTreeFormula* selector = new TTreeFormula("selector", param.reading_cuts, ntInput);
+
+  // get number of entries
+  const uint64_t nEntries = ntInput -> GetEntries();
+  cout << "    Processing: " << nEntries << " events" << endl;
+
+  // loop over entries in input tuple
+  uint64_t nBytes = 0;
+  for (uint64_t iEntry = 0; iEntry < nEntries; iEntry++) {
+
+    // announce progress
+    if (opt.do_progress) {
+      std::cout << "      Processing entry " << iEntry + 1 << "/" << nEntries << "...";
+      if (iEntry + 1 < nEntries) {
+        std::cout << "\r" << std::flush;
+      } else {
+        std::cout << std::endl;
+      }
+    }
+
+    // grab entry
+    const uint64_t bytes = ntInput -> GetEntry(iEntry);
+    if (bytes < 0.) {
+      std::cerr << "WARNING error in entry #" << iEntry << "! Aborting loop!" << std::endl;
+      break;
+    } else {
+      nBytes += bytes;
+    }
+
+    // apply cuts if need be
+    const bool isInCut = selector -> EvalInstance();
+    if (opt.do_read_cut && !isInCut) continue;
+
+    // evaluate full-precision reference
+    read_helper.ResetValues();
+    read_helper.EvaluateMethods(reader, in_helper);
+
+    // add event to batch
+    batchPar.push_back( in_helper.GetVariable("ePar") );
+    for (std::size_t iMethod = 0; iMethod < vecMethods.size(); ++iMethod) {
+      batchRef[iMethod].push_back( read_helper.GetVariable("ePar_" + vecMethods[iMethod]) );
+      for (const std::string& var : vecModels[iMethod].front().GetVariables()) {
+        batchIn[iMethod].push_back( in_helper.GetVariable(var) );
+      }
+    }
+
+    // evaluate batch when full
+    if (batchPar.size() >= opt.batch_size) {
+      processBatch();
+    }
+  }  // end entry loop
+  processBatch();
+  std::cout << "    Evaluation loop finished." << std::endl;
+
+  // --------------------------------------------------------------------------
+  // Make graphs & report
+  // --------------------------------------------------------------------------
+
+  // names of each evaluation
+  std::vector<std::string> vecPrecNames = {"tmva"};
+  for (const auto precision : vecPrecisions) {
+    vecPrecNames.push_back( QuantizedModelHelper::GetPrecisionName(precision) );
+  }
+
+  std::ostringstream report;
+  report << "Quantized calibration validation\n"
+         << "  input = " << opt.in_file << "\n"
+         << "  tmva  = " << opt.in_tmva << "/weights/" << opt.name_tmva << "_<method>.weights.xml\n"
+         << std::endl;
+
+  output -> cd();
+  for (std::size_t iMethod = 0; iMethod < vecMethods.size(); ++iMethod) {
+
+    report << "Method: " << vecMethods[iMethod] << "\n";
+    for (std::size_t iPrec = 0; iPrec < vecPrecisions.size(); ++iPrec) {
+      report << "  " << std::setw(4) << vecPrecNames[iPrec + 1]
+             << ": model size = " << vecModels[iMethod][iPrec].GetNBytes() << " B"
+             << ", max |dE/E| vs. tmva = " << maxDev[iMethod][iPrec + 1]
+             << "\n";
+    }
+    report << "  " << std::setw(6) << "bin"
+           << std::setw(8)  << "prec"
+           << std::setw(14) << "reso"
+           << std::setw(14) << "d(reso)"
+           << std::setw(14) << "lin"
+           << std::setw(14) << "d(lin)"
+           << "\n";
+
+    for (std::size_t iPrec = 0; iPrec < nPrec; ++iPrec) {
+
+      // resolution & linearity graphs
+      GraphHelper::Definition grRes("grCalibResHist_ePar_" + vecMethods[iMethod] + "_" + vecPrecNames[iPrec]);
+      GraphHelper::Definition grLin("grCalibLinHist_ePar_" + vecMethods[iMethod] + "_" + vecPrecNames[iPrec]);
+      for (std::size_t iBin = 0; iBin < vecParBins.size(); ++iBin) {
+        const Moments& mom = moments[iMethod][iPrec][iBin];
+        grRes.AddPoint( {get<1>(vecParBins[iBin]), mom.Reso(), 0., mom.ResoErr()} );
+        grLin.AddPoint( {get<1>(vecParBins[iBin]), mom.Mean(), 0., mom.MeanErr()} );
+      }
+      grRes.MakeTGraphErrors() -> Write();
+      grLin.MakeTGraphErrors() -> Write();
+    }
+
+    for (std::size_t iBin = 0; iBin < vecParBins.size(); ++iBin) {
+      const Moments& ref = moments[iMethod][0][iBin];
+      for (std::size_t iPrec = 0; iPrec < nPrec; ++iPrec) {
+        const Moments& mom = moments[iMethod][iPrec][iBin];
+        report << "  " << std::setw(6) << get<0>(vecParBins[iBin])
+               << std::setw(8)  << vecPrecNames[iPrec]
+               << std::setw(14) << mom.Reso()
+               << std::setw(14) << mom.Reso() - ref.Reso()
+               << std::setw(14) << mom.Mean()
+               << std::setw(14) << mom.Mean() - ref.Mean()
+               << "\n";
+      }
+    }
+    report << std::endl;
+  }  // end method loop
+
+  // print & save report
+  std::cout << "\n" << report.str() << std::endl;
+  std::ofstream reportFile(opt.out_report);
+  reportFile << report.str();
+  reportFile.close();
+  std::cout << "    Wrote report to: " << opt.out_report << std::endl;
+
+  // --------------------------------------------------------------------------
+  // Save output and exit
+  // --------------------------------------------------------------------------
+
+  // close files
+  output -> cd();
+  output -> Close();
+  input  -> cd();
+  input  -> Close();
+
+  // delete tmva object
+  delete reader;
+
+  // announce end & exit
+  std::cout << "  Finished quantized calibration validation macro!\n" << std::endl;
+  return;
+
+}
+
+// end ========================================================================
@@ -0,0 +1,41 @@
+#!/usr/bin/env ruby
+# =============================================================================
+# @file   BuildGeometryCache.rb
+# @author Derek Anderson
+# @date   10.17.2026
+#
+# Builds the geometry for a compact file once and caches it (see
+# GeometryCache.rb), so that later simulation jobs launched by
+# `RunNPSim.rb`, `RunNPSimOnHepMC.rb` and `RunDD4hepInSerial.rb` can skip
+# rebuilding it from XML. Needs to be run in an environment with DD4hep
+# (e.g. eic-shell). The cache is keyed by a hash of the compact and
+# everything it includes, so editing any of them means rerunning this.
+#
+# Usage:
+#   ./BuildGeometryCache.rb [compact file(s)...]
+# =============================================================================
+
+require_relative 'GeometryCache'
+
+
+
+# main body of script =========================================================
+
+END {
+
+  # compact files to cache
+  compacts = if ARGV.empty? then ["../compact/epic_bhcal_ONLY.xml"] else ARGV end
+
+  compacts.each do |compact|
+    puts "    Building geometry for #{compact}..."
+    path = GeometryCache.build(compact)
+    if path.nil?
+      warn "WARNING: #{compact} wasn't cached."
+    else
+      puts "    Cached geometry: #{path}"
+    end
+  end
+
+}  # end main body of script
+
+# end =========================================================================
@@ -0,0 +1,224 @@
+# =============================================================================
+# @file   ContinuousGun.rb
+# @author Derek Anderson
+# @date   10.17.2026
+#
+# Helper functions to generate single-particle events with continuously
+# sampled energies (flat, flat in log, or a user-specified spectrum) and
+# a cycle of species, written as HepMC3 (ASCII) so that one DD4hep job
+# can cover what would otherwise take a steering file per energy and
+# species. Meant to be pulled into other scripts via `require_relative`.
+# =============================================================================
+
+require 'json'
+
+
+
+module ContinuousGun
+
+  # species known to the gun: name => [pdg code, mass (GeV)]
+  # n.b. names follow the ddsim gun (i.e. Geant4 names)
+  SPECIES = {
+    "e-"          => [11,    0.000511],
+    "e+"          => [-11,   0.000511],
+    "mu-"         => [13,    0.105658],
+    "mu+"         => [-13,   0.105658],
+    "gamma"       => [22,    0.0],
+    "pi-"         => [-211,  0.139570],
+    "pi+"         => [211,   0.139570],
+    "pi0"         => [111,   0.134977],
+    "kaon-"       => [-321,  0.493677],
+    "kaon+"       => [321,   0.493677],
+    "kaon0L"      => [130,   0.497611],
+    "proton"      => [2212,  0.938272],
+    "anti_proton" => [-2212, 0.938272],
+    "neutron"     => [2112,  0.939565]
+  }
+
+  # default configuration: mirrors the central single-particle
+  # steering files (cos(theta) between 33.5 and 146 degrees)
+  DEFAULT_CONFIG = {
+    species:   ["pi-"],
+    sampling:  :log,
+    e_min:     1.0,
+    e_max:     20.0,
+    spectrum:  nil,
+    theta_min: 33.5,
+    theta_max: 146.0,
+    seed:      1
+  }
+
+
+
+  # ===========================================================================
+  # Read spectrum
+  # ---------------------------------------------------------------------------
+  # @brief reads a spectrum from a text file with two columns (energy in
+  #   GeV and relative weight); each weight applies from its energy up
+  #   to the next one, so the last row only sets the upper edge. Lines
+  #   starting with '#' are ignored.
+  #
+  # @param[in] path spectrum file
+  # ===========================================================================
+  def self.read_spectrum(path)
+
+    points = []
+    File.foreach(path) do |line|
+      next if line.strip.empty? or line.start_with?("#")
+      energy, weight = line.split.map(&:to_f)
+      points.push([energy, weight])
+    end
+    points.sort_by!(&:first)
+
+    if points.size < 2
+      abort "PANIC: spectrum '#{path}' needs at least 2 rows!"
+    end
+    return points
+
+  end  # end :read_spectrum
+
+
+
+  # ===========================================================================
+  # Make energy sampler
+  # ---------------------------------------------------------------------------
+  # @brief returns a lambda which samples a kinetic energy (GeV) from
+  #   the provided random generator according to the configuration:
+  #     :flat     -- uniform between e_min and e_max
+  #     :log      -- uniform in log(E) between e_min and e_max
+  #     :spectrum -- piecewise-constant spectrum read from a file
+  #
+  # @param[in] config gun configuration
+  # ===========================================================================
+  def self.make_sampler(config)
+
+    case config[:sampling]
+    when :flat
+      return lambda { |rng| config[:e_min] + (rng.rand * (config[:e_max] - config[:e_min])) }
+    when :log
+      log_min = Math.log(config[:e_min])
+      log_max = Math.log(config[:e_max])
+      return lambda { |rng| Math.exp(log_min + (rng.rand * (log_max - log_min))) }
+    when :spectrum
+      points = read_spectrum(config[:spectrum])
+
+      # cumulative weight of each bin
+      cumul = [0.0]
+      points.each_cons(2) do |(e_lo, weight), (e_hi, _)|
+        cumul.push(cumul.last + (weight * (e_hi - e_lo)))
+      end
+      if cumul.last <= 0.0
+        abort "PANIC: spectrum '#{config[:spectrum]}' has no weight!"
+      end
+
+      return lambda do |rng|
+        target = rng.rand * cumul.last
+        bin    = cumul.bsearch_index { |sum| sum > target } - 1
+        bin    = [[bin, 0].max, points.size - 2].min
+        e_lo   = points[bin][0]
+        e_hi   = points[bin + 1][0]
+        e_lo + (rng.rand * (e_hi - e_lo))
+      end
+    else
+      abort "PANIC: unknown sampling '#{config[:sampling]}'! Use :flat, :log, or :spectrum."
+    end
+
+  end  # end :make_sampler
+
+
+
+  # ===========================================================================
+  # Generate events
+  # ---------------------------------------------------------------------------
+  # @brief writes the requested no. of single-particle events to a HepMC3
+  #   file. Species are cycled event by event, energies are sampled from
+  #   the configured distribution, and directions are uniform in
+  #   cos(theta) and phi. Returns a summary of what was generated.
+  #
+  # @param[in] output  output HepMC3 file
+  # @param[in] nevents no. of events to generate
+  # @param[in] config  gun configuration (merged with the defaults)
+  # ===========================================================================
+  def self.generate(output, nevents, config = {})
+
+    config = DEFAULT_CONFIG.merge(config)
+    config[:species].each do |name|
+      abort "PANIC: unknown species '#{name}'!" if not SPECIES.key?(name)
+    end
+
+    rng     = Random.new(config[:seed])
+    sampler = make_sampler(config)
+    cos_min = Math.cos(config[:theta_max] * Math::PI / 180.0)
+    cos_max = Math.cos(config[:theta_min] * Math::PI / 180.0)
+
+    counts = Hash.new(0)
+    File.open(output, "w") do |file|
+      file.puts("HepMC::Version 3.02.00")
+      file.puts("HepMC::Asciiv3-START_EVENT_LISTING")
+
+      nevents.times do |ievt|
+
+        # pick species and kinematics
+        name       = config[:species][ievt % config[:species].size]
+        pdg, mass  = SPECIES[name]
+        kinetic    = sampler.call(rng)
+        energy     = kinetic + mass
+        momentum   = Math.sqrt((energy * energy) - (mass * mass))
+        cos_theta  = cos_min + (rng.rand * (cos_max - cos_min))
+        sin_theta  = Math.sqrt(1.0 - (cos_theta * cos_theta))
+        phi        = 2.0 * Math::PI * rng.rand
+        counts[name] += 1
+
+        # n.b. the particle is attached to an explicit
+        # vertex at the origin, as in standard HepMC3
+        # ASCII output
+        px = momentum * sin_theta * Math.cos(phi)
+        py = momentum * sin_theta * Math.sin(phi)
+        pz = momentum * cos_theta
+        file.puts("E #{ievt} 1 1")
+        file.puts("U GEV MM")
+        file.puts(format("P 1 0 %d %.9e %.9e %.9e %.9e %.9e 1", pdg, px, py, pz, energy, mass))
+        file.puts("V -1 0 [1] @ 0 0 0 0")
+      end
+
+      file.puts("HepMC::Asciiv3-END_EVENT_LISTING")
+    end
+
+    return {output: output, nevents: nevents, config: config, counts: counts}
+
+  end  # end :generate
+
+
+
+  # ===========================================================================
+  # Write steering file
+  # ---------------------------------------------------------------------------
+  # @brief writes a ddsim steering file which reads the generated events
+  #   in place of the particle gun, with the configuration noted at the
+  #   top for reference
+  #
+  # @param[in] path    output steering file
+  # @param[in] summary summary returned by `generate`
+  # ===========================================================================
+  def self.write_steering(path, summary)
+
+    config = summary[:config]
+    File.write(path, <<~EOS)
+      # Continuous single-particle sample generated by ContinuousGun.rb
+      #   species  = #{config[:species].join(', ')}
+      #   sampling = #{config[:sampling]} (#{config[:sampling] == :spectrum ? config[:spectrum] : "#{config[:e_min]} - #{config[:e_max]} GeV"})
+      #   theta    = #{config[:theta_min]} - #{config[:theta_max]} degree
+      #   seed     = #{config[:seed]}
+      from DDSim.DD4hepSimulation import DD4hepSimulation
+
+      SIM = DD4hepSimulation()
+      SIM.inputFiles     = ["#{File.expand_path(summary[:output])}"]
+      SIM.numberOfEvents = #{summary[:nevents]}
+    EOS
+    return path
+
+  end  # end :write_steering
+
+end  # end ContinuousGun
+
+# end =========================================================================
@@ -0,0 +1,54 @@
+#!/usr/bin/env ruby
+# =============================================================================
+# @file   FilterHepMC.rb
+# @author Derek Anderson
+# @date   10.17.2026
+#
+# Filters a HepMC3 (ASCII) file down to the events with final-state
+# particles inside the BHCal acceptance before it's run through DD4hep,
+# so that no Geant4 time is spent on events that would be discarded
+# afterwards. The no. of rejected events is recorded in
+# `<output>.filter.json` for normalization.
+#
+# Usage:
+#   ./FilterHepMC.rb <input> <output> [eta min] [eta max] [min energy sum (GeV)]
+# =============================================================================
+
+require_relative 'HepMCFilter'
+
+
+
+# main body of script =========================================================
+
+END {
+
+  # i/o parameters
+  in_hepmc  = if ARGV[0] then ARGV[0] else "forBHCalMultiPartSim.e10h11pipXpim.hepmc" end
+  out_hepmc = if ARGV[1] then ARGV[1] else in_hepmc.sub(/(\.hepmc)?\z/, ".filtered.hepmc") end
+
+  # acceptance & energy cuts
+  cuts = {}
+  cuts[:eta_min]   = ARGV[2].to_f if ARGV[2]
+  cuts[:eta_max]   = ARGV[3].to_f if ARGV[3]
+  cuts[:e_sum_min] = ARGV[4].to_f if ARGV[4]
+
+  if not File.exist?(in_hepmc)
+    abort "PANIC: input '#{in_hepmc}' doesn't exist!"
+  end
+  if in_hepmc == out_hepmc
+    abort "PANIC: output would overwrite input '#{in_hepmc}'!"
+  end
+
+  # filter and record
+  record = HepMCFilter.filter(in_hepmc, out_hepmc, cuts)
+  log    = HepMCFilter.write_record("#{out_hepmc}.filter.json", record)
+
+  puts "    Kept #{record[:events_accepted]} of #{record[:events_read]} events " \
+       "(#{record[:rejected][:no_particles]} with nothing in acceptance, " \
+       "#{record[:rejected][:low_energy]} below energy sum)."
+  puts "    Wrote filtered events to: #{out_hepmc}"
+  puts "    Wrote record to: #{log}"
+
+}  # end main body of script
+
+# end =========================================================================
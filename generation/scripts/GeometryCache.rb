@@ -0,0 +1,208 @@
+# =============================================================================
+# @file   GeometryCache.rb
+# @author Derek Anderson
+# @date   10.17.2026
+#
+# Helper functions to build, look up, and use cached geometries for
+# DD4hep simulation. A compact file and everything it includes is built
+# once (via DD4hep_Geometry2ROOT) into a ROOT file keyed by a hash of
+# all of those files, and later ddsim/npsim jobs load that file instead
+# of rebuilding the detector from XML (see RunWithCachedGeometry.py).
+# Meant to be pulled into other scripts via `require_relative`.
+# =============================================================================
+
+require 'json'
+require 'digest'
+require 'fileutils'
+
+
+
+module GeometryCache
+
+  # attributes in the compact which point to other files that
+  # go into the geometry (includes, field maps, etc.)
+  FILE_REFERENCE = /<(?:include|gdmlFile|fieldmap|file)\b[^>]*?\b(?:ref|url|file)\s*=\s*"([^"]+)"/
+
+  # python runner which loads the cached geometry
+  RUNNER = File.join(__dir__, "RunWithCachedGeometry.py")
+
+
+
+  # ===========================================================================
+  # Expand environment variables in a path
+  # ---------------------------------------------------------------------------
+  # @brief replaces $VAR and ${VAR} with their values (left as-is if
+  #   the variable isn't set)
+  #
+  # @param[in] path path to expand
+  # ===========================================================================
+  def self.expand(path)
+
+    return path.gsub(/\$\{(\w+)\}|\$(\w+)/) { ENV.fetch($1 || $2, $&) }
+
+  end  # end :expand
+
+
+
+  # ===========================================================================
+  # Collect files making up a geometry
+  # ---------------------------------------------------------------------------
+  # @brief returns the compact file and every file it references
+  #   (recursively), in the order they're found; references which
+  #   can't be found are returned separately
+  #
+  # @param[in] compact path to compact file
+  # ===========================================================================
+  def self.collect_files(compact)
+
+    files   = []
+    missing = []
+    queue   = [File.expand_path(expand(compact))]
+    until queue.empty?
+      path = queue.shift
+      next if files.include?(path)
+
+      if not File.exist?(path)
+        missing.push(path)
+        next
+      end
+      files.push(path)
+
+      # n.b. only XML is scanned for further references
+      next if File.extname(path) != ".xml"
+      File.binread(path).scan(FILE_REFERENCE) do |(ref)|
+        ref = expand(ref).sub(/\Afile:/, "")
+        queue.push(File.expand_path(ref, File.dirname(path)))
+      end
+    end
+    return files, missing
+
+  end  # end :collect_files
+
+
+
+  # ===========================================================================
+  # Get cache key
+  # ---------------------------------------------------------------------------
+  # @brief returns a SHA-256 hash of the contents of every file making up
+  #   the geometry, along with the DD4hep and detector installations, or
+  #   nil if any referenced file couldn't be found
+  #
+  # @param[in] compact path to compact file
+  # ===========================================================================
+  def self.key(compact)
+
+    files, missing = collect_files(compact)
+    if not missing.empty?
+      warn "WARNING: couldn't find #{missing.size} file(s) in geometry (e.g. '#{missing.first}')! Not caching."
+      return nil
+    end
+
+    digest = Digest::SHA256.new
+    files.each do |file|
+      digest.update(file)
+      digest.update(Digest::SHA256.file(file).hexdigest)
+    end
+    ["DD4hepINSTALL", "DETECTOR_VERSION"].each do |var|
+      digest.update("#{var}=#{ENV.fetch(var, '')}")
+    end
+    return digest.hexdigest
+
+  end  # end :key
+
+
+
+  # ===========================================================================
+  # Get path to cached geometry
+  # ---------------------------------------------------------------------------
+  # @brief returns where the cached geometry of a compact file lives
+  #   ($BHCAL_GEOMETRY_CACHE if set, ~/.cache/bhcal/geometry if not), or
+  #   nil if there's no key
+  #
+  # @param[in] compact path to compact file
+  # ===========================================================================
+  def self.cache_path(compact)
+
+    hash = key(compact)
+    return nil if hash.nil?
+
+    dir = ENV.fetch("BHCAL_GEOMETRY_CACHE", File.join(Dir.home, ".cache", "bhcal", "geometry"))
+    return File.join(dir, "#{File.basename(expand(compact), '.xml')}.#{hash[0, 16]}.root")
+
+  end  # end :cache_path
+
+
+
+  # ===========================================================================
+  # Build cached geometry
+  # ---------------------------------------------------------------------------
+  # @brief builds the geometry from the compact file and saves it (plus a
+  #   JSON record of the files hashed) to the cache; returns the path to
+  #   the cached geometry, or nil if it couldn't be built
+  #
+  # @param[in] compact path to compact file
+  # ===========================================================================
+  def self.build(compact)
+
+    path = cache_path(compact)
+    return nil if path.nil?
+    return path if File.exist?(path)
+
+    FileUtils.mkdir_p(File.dirname(path))
+    command = [
+      "geoPluginRun",
+      "-volmgr",
+      "-destroy",
+      "-input", File.expand_path(expand(compact)),
+      "-plugin", "DD4hep_Geometry2ROOT",
+      "-output", path
+    ]
+    if not system(*command) or not File.exist?(path)
+      warn "WARNING: couldn't build cached geometry for '#{compact}'!"
+      FileUtils.rm_f(path)
+      return nil
+    end
+
+    files, _ = collect_files(compact)
+    File.write(path.sub(/\.root\z/, ".json"), JSON.pretty_generate({
+      compact: File.expand_path(expand(compact)),
+      date:    Time.now.strftime("%Y-%m-%d %H:%M:%S"),
+      files:   files
+    }))
+    return path
+
+  end  # end :build
+
+
+
+  # ===========================================================================
+  # Get simulation command
+  # ---------------------------------------------------------------------------
+  # @brief returns the command to launch ddsim/npsim with: if a cached
+  #   geometry exists for the compact file (i.e. nothing in it changed
+  #   since it was built), the executable is wrapped so that the cache
+  #   is loaded instead of the XML; otherwise the executable is
+  #   returned as-is
+  #
+  # @param[in] exec    simulation executable (e.g. "ddsim")
+  # @param[in] compact path to compact file
+  # ===========================================================================
+  def self.command(exec, compact)
+
+    path = cache_path(compact)
+    if path.nil? or not File.exist?(path)
+      return exec
+    end
+
+    puts "    Using cached geometry '#{path}' for '#{compact}'."
+    return [
+      "BHCAL_GEOMETRY_COMPACT=#{File.expand_path(expand(compact))}",
+      "BHCAL_GEOMETRY_CACHE_FILE=#{path}",
+      "python3", RUNNER, exec
+    ].join(' ')
+
+  end  # end :command
+
+end  # end GeometryCache
+
+# end =========================================================================
@@ -0,0 +1,203 @@
+# =============================================================================
+# @file   HepMCFilter.rb
+# @author Derek Anderson
+# @date   10.17.2026
+#
+# Helper functions to stream a HepMC3 (ASCII) file, keep only the events
+# with final-state particles inside a given acceptance, and record how
+# many were rejected (and why) for normalization. Meant to be pulled into
+# other scripts via `require_relative`.
+# =============================================================================
+
+require 'json'
+
+
+
+module HepMCFilter
+
+  # default cuts: barrel acceptance, no energy requirements, and
+  # neutrinos never count as being in the acceptance
+  DEFAULT_CUTS = {
+    eta_min:   -1.1,
+    eta_max:   1.1,
+    e_min:     0.0,
+    e_sum_min: 0.0,
+    n_min:     1,
+    skip_pdg:  [12, -12, 14, -14, 16, -16]
+  }
+
+
+
+  # ===========================================================================
+  # Get pseudorapidity
+  # ---------------------------------------------------------------------------
+  # @brief returns the pseudorapidity of a momentum (+-infinity if it's
+  #   along the beam)
+  #
+  # @param[in] px, py, pz components of momentum
+  # ===========================================================================
+  def self.eta(px, py, pz)
+
+    pt = Math.sqrt((px * px) + (py * py))
+    return (pz >= 0 ? Float::INFINITY : -Float::INFINITY) if pt == 0.0
+    return Math.asinh(pz / pt)
+
+  end  # end :eta
+
+
+
+  # ===========================================================================
+  # Check event
+  # ---------------------------------------------------------------------------
+  # @brief returns nil if an event passes the cuts, or the reason it
+  #   was rejected if not (:no_particles or :low_energy)
+  #
+  # @param[in] lines lines of the event
+  # @param[in] cuts  cuts to apply
+  # ===========================================================================
+  def self.check_event(lines, cuts)
+
+    # n.b. units are set per event, and may be in MeV
+    scale  = 1.0
+    n_acc  = 0
+    e_acc  = 0.0
+    lines.each do |line|
+      if line.start_with?("U ")
+        scale = 0.001 if line.split[1] == "MEV"
+        next
+      end
+      next if not line.start_with?("P ")
+
+      # particle lines are: P id vertex pdg px py pz e m status
+      fields = line.split
+      next if fields[9].to_i != 1
+      next if cuts[:skip_pdg].include?(fields[3].to_i)
+
+      energy = fields[7].to_f * scale
+      next if energy < cuts[:e_min]
+
+      pseudo = eta(fields[4].to_f, fields[5].to_f, fields[6].to_f)
+      next if (pseudo < cuts[:eta_min]) or (pseudo > cuts[:eta_max])
+
+      n_acc += 1
+      e_acc += energy
+    end
+
+    return :no_particles if n_acc < cuts[:n_min]
+    return :low_energy   if e_acc < cuts[:e_sum_min]
+    return nil
+
+  end  # end :check_event
+
+
+
+  # ===========================================================================
+  # Get event weight
+  # ---------------------------------------------------------------------------
+  # @brief returns the first weight of an event (1 if there are none)
+  #
+  # @param[in] lines lines of the event
+  # ===========================================================================
+  def self.event_weight(lines)
+
+    weights = lines.find { |line| line.start_with?("W ") }
+    return 1.0 if weights.nil?
+    return weights.split[1].to_f
+
+  end  # end :event_weight
+
+
+
+  # ===========================================================================
+  # Filter a file
+  # ---------------------------------------------------------------------------
+  # @brief streams the input one event at a time, writes the accepted
+  #   events (and the file header/footer) to the output unchanged, and
+  #   returns a record of what was kept and rejected
+  #
+  # @param[in] input  input HepMC3 file
+  # @param[in] output output HepMC3 file
+  # @param[in] cuts   cuts to apply (merged with the defaults)
+  # ===========================================================================
+  def self.filter(input, output, cuts = {})
+
+    cuts   = DEFAULT_CUTS.merge(cuts)
+    record = {
+      input:           input,
+      output:          output,
+      cuts:            cuts,
+      events_read:     0,
+      events_accepted: 0,
+      events_rejected: 0,
+      rejected:        {no_particles: 0, low_energy: 0},
+      weight_read:     0.0,
+      weight_accepted: 0.0,
+      accept_fraction: 0.0
+    }
+
+    # helper lambda to check and write out an event
+    event  = []
+    finish = lambda do |file|
+      return if event.empty?
+
+      weight = event_weight(event)
+      reason = check_event(event, cuts)
+      record[:events_read] += 1
+      record[:weight_read] += weight
+      if reason.nil?
+        file.write(event.join)
+        record[:events_accepted] += 1
+        record[:weight_accepted] += weight
+      else
+        record[:events_rejected]  += 1
+        record[:rejected][reason] += 1
+      end
+      event.clear
+    end
+
+    # n.b. anything outside of an event (version, run info,
+    # end of listing) is copied as-is
+    File.open(output, "w") do |file|
+      File.foreach(input) do |line|
+        if line.start_with?("E ")
+          finish.call(file)
+          event.push(line)
+        elsif line.start_with?("HepMC::")
+          finish.call(file)
+          file.write(line)
+        elsif event.empty?
+          file.write(line)
+        else
+          event.push(line)
+        end
+      end
+      finish.call(file)
+    end
+
+    if record[:events_read] > 0
+      record[:accept_fraction] = record[:events_accepted].to_f / record[:events_read]
+    end
+    return record
+
+  end  # end :filter
+
+
+
+  # ===========================================================================
+  # Write filter record
+  # ---------------------------------------------------------------------------
+  # @brief writes the record returned by `filter` to a JSON file
+  #
+  # @param[in] path   output file
+  # @param[in] record record to write
+  # ===========================================================================
+  def self.write_record(path, record)
+
+    File.write(path, JSON.pretty_generate(record))
+    return path
+
+  end  # end :write_record
+
+end  # end HepMCFilter
+
+# end =========================================================================
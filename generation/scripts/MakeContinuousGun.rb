@@ -0,0 +1,58 @@
+#!/usr/bin/env ruby
+# =============================================================================
+# @file   MakeContinuousGun.rb
+# @author Derek Anderson
+# @date   10.17.2026
+#
+# Generates a single-particle sample with energies sampled continuously
+# (flat, flat in log, or from a spectrum file) and species cycled event
+# by event, along with a ddsim steering file which reads it. One long
+# ddsim job can then replace the per-energy, per-species steering files
+# in `steering/SingleParticle`, e.g.
+#
+#   ddsim --steeringFile <label>.py --compactFile $DETECTOR_PATH/epic.xml \
+#     --outputFile <label>.edm4hep.root
+#
+# Usage:
+#   ./MakeContinuousGun.rb [no. of events] [output label] [seed]
+# =============================================================================
+
+require_relative 'ContinuousGun'
+
+
+
+# main body of script =========================================================
+
+END {
+
+  # i/o parameters
+  nevents = if ARGV[0] then ARGV[0].to_i else 100000 end
+  label   = if ARGV[1] then ARGV[1] else "central.log1to20.pimpip" end
+  seed    = if ARGV[2] then ARGV[2].to_i else 1 end
+
+  # gun parameters
+  #   sampling = :flat, :log, or :spectrum (with spectrum set to a file
+  #              of energies in GeV and relative weights)
+  gun = {
+    species:   ["pi-", "pi+"],
+    sampling:  :log,
+    e_min:     1.0,
+    e_max:     20.0,
+    spectrum:  nil,
+    theta_min: 33.5,
+    theta_max: 146.0,
+    seed:      seed
+  }
+
+  # generate events and steering file
+  summary = ContinuousGun.generate("#{label}.hepmc", nevents, gun)
+  steerer = ContinuousGun.write_steering("#{label}.py", summary)
+
+  counts = summary[:counts].map { |name, count| "#{count} #{name}" }.join(', ')
+  puts "    Generated #{nevents} events (#{counts})."
+  puts "    Wrote events to: #{summary[:output]}"
+  puts "    Wrote steering file to: #{steerer}"
+
+}  # end main body of script
+
+# end =========================================================================
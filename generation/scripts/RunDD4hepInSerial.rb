@@ -8,6 +8,15 @@
 #   type = :gun   -- run particle gun with parameters specified in
 #                    provided steering file
 #   type = :hepmc -- run specified hepmc file through DD4hep
+#   type = :continuous -- generate single-particle events with
+#                    continuously sampled energies and cycled
+#                    species (see ContinuousGun.rb), then run
+#                    them through DD4hep like :hepmc
+#
+# In :hepmc mode, the input can be prefiltered so that only events with
+# final-state particles in the acceptance are simulated (see
+# HepMCFilter.rb); the no. of rejected events is saved alongside the
+# output in `<output>.filter.json`.
 #
 # When providing command-line options (either via condor or locally), the
 # order of arguments is:
@@ -17,6 +26,10 @@
 # -----------------------------------------------------------------------------
 
 require 'fileutils'
+require 'zlib'
+require_relative 'HepMCFilter'
+require_relative 'ContinuousGun'
+require_relative 'GeometryCache'
 
 
 
@@ -33,6 +46,12 @@ END {
   output  = "testOutOnLocal.d22m3y2024.edm4hep.root"
   steerer = "steering.forTowerVsTileCalibCheck_e10th45pim.py"
 
+  # acceptance prefilter for hepmc input (set cuts to nil to turn off)
+  cuts = {eta_min: -1.1, eta_max: 1.1, e_sum_min: 0.0}
+
+  # continuous gun parameters (for type = :continuous)
+  gun = {species: ["pi-", "pi+"], sampling: :log, e_min: 1.0, e_max: 20.0}
+
   # input, output, and runnning directories
   in_dir  = "/sphenix/user/danderson/"
   out_dir = "/sphenix/user/danderson/"
@@ -51,7 +70,9 @@ END {
   compact = "/opt/detector/epic-nightly/share/epic/epic.xml"
 
   # environment parameters
-  exec  = "ddsim"
+  # n.b. ddsim is wrapped to load a cached geometry if one was
+  # built for the current compact (see BuildGeometryCache.rb)
+  exec  = GeometryCache.command("ddsim", compact)
   shell = "/sphenix/u/danderson/scripts/eic-shell"
   setup = "/sphenix/u/danderson/scripts/initialize-eic-detectors"
 
@@ -80,17 +101,35 @@ END {
     )
     parser.parse()
 
+    # generate events for continuous gun (if needed)
+    # n.b. the seed is derived from the label so that
+    # each iteration/condor job gets different events
+    in_type = type
+    in_file = input
+    in_cuts = cuts
+    if type == :continuous
+      in_type = :hepmc
+      in_file = parser.out_name.sub(/(\.edm4hep\.root)?\z/, ".hepmc")
+      in_cuts = nil
+      ContinuousGun.generate(
+        File.join(in_dir, in_file),
+        numevts,
+        gun.merge(seed: Zlib.crc32(parser.out_label))
+      )
+    end
+
     # run simulation
     handler = SimHandler.new
     handler.configure(
       outname:  parser.out_name,
       outdir:   out_dir,
-      intype:   type,
-      infile:   input,
+      intype:   in_type,
+      infile:   in_file,
       indir:    in_dir,
       optnum:   numevts,
       optdet:   compact,
       optsteer: parser.out_steer,
+      optcuts:  in_cuts,
       sysexec:  exec,
       syssim:   parser.out_sim,
       sysrun:   parser.out_run,
@@ -100,6 +139,9 @@ END {
     )
     handler.run()
 
+    # remove generated events
+    FileUtils.rm(File.join(in_dir, in_file)) if type == :continuous
+
     # increment counter
     iter = iter + 1
 
@@ -272,6 +314,7 @@ class SimHandler
   attr_reader :opt_nevt
   attr_reader :opt_det
   attr_reader :opt_steer
+  attr_reader :opt_cuts
   attr_reader :sys_exec
   attr_reader :sys_sim
   attr_reader :sys_run
@@ -296,6 +339,7 @@ class SimHandler
       optnum:   1,
       optdet:   "epic.xml",
       optsteer: "./steer.py",
+      optcuts:  nil,
       sysexec:  "ddsim",
       syssim:   "DoSim.sh",
       sysrun:   "RunShell.sh",
@@ -312,6 +356,7 @@ class SimHandler
       @opt_nevt  = optnum
       @opt_det   = optdet
       @opt_steer = optsteer
+      @opt_cuts  = optcuts
       @sys_exec  = sysexec
       @sys_sim   = syssim
       @sys_run   = sysrun
@@ -371,9 +416,14 @@ class SimHandler
         @in_orig.gsub!("//", "/")
         @in_path.gsub!("..", ".")
 
-        # copy to run dir
+        # copy to run dir, filtering if needed
         if not File.exists?(@in_path)
-          FileUtils.cp(@in_orig, @in_path)
+          if @opt_cuts.nil?
+            FileUtils.cp(@in_orig, @in_path)
+          else
+            record = HepMCFilter.filter(@in_orig, @in_path, @opt_cuts)
+            HepMCFilter.write_record(@out_path + ".filter.json", record)
+          end
         end
       end
       return
@@ -441,8 +491,9 @@ class SimHandler
 
     def clean_up()
 
-      # move output to output directory
+      # move output (and filter record) to output directory
       FileUtils.mv(@out_path, @out_dir)
+      FileUtils.mv(@out_path + ".filter.json", @out_dir) if File.exists?(@out_path + ".filter.json")
 
       # remove sim/run scripts
       FileUtils.rm @sim_path
@@ -8,6 +8,8 @@
 # specified steering and compact files.
 # -----------------------------------------------------------------------------
 
+require_relative 'GeometryCache'
+
 # output file
 out_file = "test_ruby_script.edm4hep.root"
 
@@ -16,7 +18,10 @@ numevts = 1000
 steerer = "../steering/steering.forTowerVsTileCalibCheck_e10th45pim.py"
 compact = "$DETECTOR_PATH/epic_imaging.xml"
 
+# use cached geometry if compact is unchanged (see BuildGeometryCache.rb)
+sim = GeometryCache.command("npsim", compact)
+
 # run ddsim
-exec("npsim --steeringFile #{steerer} --compactFile #{compact} -G -N #{numevts} --outputFile #{out_file}")
+exec("#{sim} --steeringFile #{steerer} --compactFile #{compact} -G -N #{numevts} --outputFile #{out_file}")
 
 # end -------------------------------------------------------------------------
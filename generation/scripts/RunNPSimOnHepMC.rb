@@ -8,6 +8,9 @@
 # in npsim with a specific compact file.
 # -----------------------------------------------------------------------------
 
+require_relative 'HepMCFilter'
+require_relative 'GeometryCache'
+
 # output file
 out_file = "forBHCalMultiPartSim.e10h11pipXpim.edm4hep.root"
 
@@ -16,7 +19,25 @@ numevts = 10000
 compact = "$DETECTOR_PATH/epic_bhcal.xml"
 hepmc   = "forBHCalMultiPartSim.e10h11pipXpim.hepmc"
 
+# acceptance prefilter: only events with a final-state particle
+# in the barrel are simulated (n.b. numevts then counts events
+# passing the filter, see <hepmc>.filter.json for normalization)
+prefilter = true
+cuts      = {eta_min: -1.1, eta_max: 1.1, e_sum_min: 0.0}
+
+# filter input (if needed)
+if prefilter
+  filtered = hepmc.sub(/(\.hepmc)?\z/, ".filtered.hepmc")
+  record   = HepMCFilter.filter(hepmc, filtered, cuts)
+  HepMCFilter.write_record("#{filtered}.filter.json", record)
+  puts "Prefilter kept #{record[:events_accepted]} of #{record[:events_read]} events."
+  hepmc = filtered
+end
+
+# use cached geometry if compact is unchanged (see BuildGeometryCache.rb)
+sim = GeometryCache.command("npsim", compact)
+
 # run npsim
-exec("npsim -I #{hepmc} -N #{numevts} --compactFile #{compact} --outputFile #{out_file}")
+exec("#{sim} -I #{hepmc} -N #{numevts} --compactFile #{compact} --outputFile #{out_file}")
 
 # end -------------------------------------------------------------------------
@@ -0,0 +1,92 @@
+#!/usr/bin/env python3
+# =============================================================================
+# @file   RunWithCachedGeometry.py
+# @author Derek Anderson
+# @date   10.17.2026
+#
+# Runs ddsim (or npsim) with the detector loaded from a cached geometry
+# (built by GeometryCache.rb with DD4hep_Geometry2ROOT) rather than from
+# the compact XML. The cache is only used for the compact file it was
+# built from, which are set via
+#
+#   BHCAL_GEOMETRY_COMPACT    -- path to compact file
+#   BHCAL_GEOMETRY_CACHE_FILE -- path to cached geometry
+#
+# If loading the cache fails for any reason, the XML is used as usual.
+#
+# Usage:
+#   python3 RunWithCachedGeometry.py <ddsim|npsim> [options...]
+# =============================================================================
+
+import os
+import sys
+import runpy
+import shutil
+
+
+
+# =============================================================================
+# Patch geometry loading
+# -----------------------------------------------------------------------------
+# @brief wraps DDG4.Kernel.loadGeometry so that loading the cached compact
+#   file restores the persisted detector description instead
+# =============================================================================
+def patch_geometry_loading(compact, cache):
+
+    import DDG4
+    from ROOT import dd4hep
+
+    load_from_xml = DDG4.Kernel.loadGeometry
+
+    def load_geometry(kernel, fname):
+
+        # n.b. ddsim passes compact files as "file:<path>"
+        path = fname[len("file:"):] if fname.startswith("file:") else fname
+        if os.path.realpath(path) != os.path.realpath(compact):
+            return load_from_xml(kernel, fname)
+
+        try:
+            status = dd4hep.DD4hepRootPersistency.load(kernel.detectorDescription(), cache, "Geometry")
+        except Exception as error:
+            print(f"WARNING: couldn't load cached geometry '{cache}' ({error})! Using XML.")
+            return load_from_xml(kernel, fname)
+
+        if status != 1:
+            print(f"WARNING: couldn't load cached geometry '{cache}'! Using XML.")
+            return load_from_xml(kernel, fname)
+
+        print(f"    Loaded cached geometry '{cache}' for '{compact}'.")
+        return status
+
+    DDG4.Kernel.loadGeometry = load_geometry
+    return
+
+# end 'patch_geometry_loading(str, str)'
+
+
+
+# main body of script =========================================================
+
+if __name__ == "__main__":
+
+    if len(sys.argv) < 2:
+        sys.exit("PANIC: please provide the simulation executable (e.g. ddsim)!")
+
+    # find the simulation script
+    executable = shutil.which(sys.argv[1])
+    if executable is None:
+        sys.exit(f"PANIC: couldn't find '{sys.argv[1]}'!")
+
+    # patch in cache (if it exists)
+    compact = os.environ.get("BHCAL_GEOMETRY_COMPACT", "")
+    cache   = os.environ.get("BHCAL_GEOMETRY_CACHE_FILE", "")
+    if compact and cache and os.path.exists(cache):
+        patch_geometry_loading(compact, cache)
+    else:
+        print("WARNING: no cached geometry provided! Using XML.")
+
+    # run simulation as if it was called directly
+    sys.argv = [executable] + sys.argv[2:]
+    runpy.run_path(executable, run_name="__main__")
+
+# end =========================================================================
@@ -0,0 +1,216 @@
+/// ===========================================================================
+/*! \file   MakeGraphsFromMoments.cxx
+ *  \author Derek Anderson
+ *  \date   10.17.2026
+ *
+ *  A ROOT macro to merge the moment trees written
+ *  by the histogram filling routines (e.g. in
+ *  'UncalibratedClusterHistograms.hxx') across any
+ *  number of files, and to build resolution and
+ *  linearity graphs from the merged moments.
+ *
+ *  Quantile sketch trees (if present) are merged
+ *  in the same way, and robust resolution and
+ *  linearity graphs are built from them.
+ */
+/// ===========================================================================
+
+#define MakeGraphsFromMoments_cxx
+
+// c++ utilities
+#include <string>
+#include <vector>
+#include <cassert>
+#include <iostream>
+#include <algorithm>
+// root libraries
+#include <TFile.h>
+#include <TChain.h>
+#include <TSystem.h>
+// analysis utilities
+#include "../utility/GraphHelper.hxx"
+#include "../utility/MomentHelper.hxx"
+#include "../utility/SketchHelper.hxx"
+
+
+
+// ============================================================================
+//! Struct to consolidate user options
+// ============================================================================
+/*! Input files can be a single (e.g. hadd'd)
+ *  file, or a wildcard pattern matching many
+ *  job outputs (e.g. all ".hists.root" files
+ *  in a directory).
+ */
+struct Options {
+  std::string in_files;   // input file(s)
+  std::string in_tree;    // input moment tree
+  std::string out_file;   // output file
+  std::string out_tree;   // output (merged) moment tree
+  std::string res_name;   // prefix of resolution graphs
+  std::string lin_name;   // prefix of linearity graphs
+  std::string in_sk;      // input sketch tree
+  std::string out_sk;     // output (merged) sketch tree
+  std::string res_sk;     // prefix of robust resolution graphs
+  std::string lin_sk;     // prefix of robust linearity graphs
+}  DefaultOptions = {
+  "./input/*.hists.root",
+  "tUncalibMoments",
+  "mergedMoments.root",
+  "tUncalibMoments",
+  "grUncalibResMoments",
+  "grUncalibLinMoments",
+  "tUncalibSketches",
+  "tUncalibSketches",
+  "grUncalibResSketch",
+  "grUncalibLinSketch"
+};
+
+
+
+// ============================================================================
+//! Merge moments and make resolution/linearity graphs
+// ============================================================================
+void MakeGraphsFromMoments(const Options& opt = DefaultOptions) {
+
+  // lower verbosity & announce start
+  gErrorIgnoreLevel = kError;
+  std::cout << "\n  Beginning moment merging macro..." << std::endl;
+
+  // --------------------------------------------------------------------------
+  // Read in and merge moments
+  // --------------------------------------------------------------------------
+  TChain* chInput = new TChain(opt.in_tree.data());
+  const int nFiles = chInput -> Add(opt.in_files.data());
+  if (nFiles == 0) {
+    std::cerr << "PANIC: no input files matched!\n"
+              << "       pattern = " << opt.in_files
+              << std::endl;
+    assert(nFiles > 0);
+  }
+  std::cout << "    Found " << nFiles << " file(s) with " << chInput -> GetEntries() << " rows." << std::endl;
+
+  // n.b. rows with the same variable, slice & edges are merged
+  MomentHelper::Table moments;
+  moments.ReadTree(chInput);
+  std::cout << "    Merged moments: " << moments.GetSlices().size() << " slices." << std::endl;
+
+  // n.b. older outputs won't have sketches
+  TChain* chSketch = new TChain(opt.in_sk.data());
+  chSketch -> Add(opt.in_files.data());
+
+  SketchHelper::Table sketches;
+  if (chSketch -> GetEntries() > 0) {
+    sketches.ReadTree(chSketch);
+    std::cout << "    Merged sketches: " << sketches.GetSlices().size() << " slices." << std::endl;
+  } else {
+    std::cerr << "WARNING: no sketch tree '" << opt.in_sk << "' found! Skipping sketches." << std::endl;
+  }
+
+  // warn if inputs were sliced differently: those slices
+  // share a tag but have different edges, so aren't merged
+  auto warnOnSplitTags = [](const std::string& what, const std::string& variable, std::vector<std::string> tags) {
+    std::sort(tags.begin(), tags.end());
+    for (std::size_t iTag = 1; iTag < tags.size(); ++iTag) {
+      if ((tags[iTag] == tags[iTag - 1]) && ((iTag == 1) || (tags[iTag] != tags[iTag - 2]))) {
+        std::cerr << "WARNING: " << what << " of '" << variable << "' in slice '" << tags[iTag]
+                  << "' have different edges across inputs! Keeping them as separate slices."
+                  << std::endl;
+      }
+    }
+  };
+  for (const std::string& variable : moments.GetVariables()) {
+    std::vector<std::string> tags;
+    for (const MomentHelper::Slice& slice : moments.GetSlices(variable)) {
+      tags.push_back(slice.tag);
+    }
+    warnOnSplitTags("moments", variable, tags);
+  }
+  for (const std::string& variable : sketches.GetVariables()) {
+    std::vector<std::string> tags;
+    for (SketchHelper::Slice* slice : sketches.GetSlices(variable)) {
+      tags.push_back(slice -> tag);
+    }
+    warnOnSplitTags("sketches", variable, tags);
+  }
+
+  // --------------------------------------------------------------------------
+  // Make graphs
+  // --------------------------------------------------------------------------
+  std::vector<GraphHelper::Definition> vecRes;
+  std::vector<GraphHelper::Definition> vecLin;
+  for (const std::string& variable : moments.GetVariables()) {
+
+    vecRes.push_back( GraphHelper::Definition(opt.res_name + "_" + variable) );
+    vecLin.push_back( GraphHelper::Definition(opt.lin_name + "_" + variable) );
+    for (const MomentHelper::Slice& slice : moments.GetSlices(variable)) {
+      if (slice.moments.GetCount() < 2) continue;
+      vecRes.back().AddPoint( {slice.center, slice.moments.GetResolution(), 0., slice.moments.GetResolutionError()} );
+      vecLin.back().AddPoint( {slice.center, slice.moments.GetMean(),       0., slice.moments.GetMeanError()}       );
+    }
+
+    std::cout << "      Variable '" << variable << "':" << std::endl;
+    for (const MomentHelper::Slice& slice : moments.GetSlices(variable)) {
+      std::cout << "        [" << slice.low << ", " << slice.high << ") "
+                << "n = " << slice.moments.GetCount() << ", "
+                << "mean = " << slice.moments.GetMean() << ", "
+                << "sigma/mean = " << slice.moments.GetResolution() << " +- " << slice.moments.GetResolutionError()
+                << std::endl;
+    }
+  }  // end variable loop
+
+  std::vector<GraphHelper::Definition> vecResSketch;
+  std::vector<GraphHelper::Definition> vecLinSketch;
+  for (const std::string& variable : sketches.GetVariables()) {
+
+    vecResSketch.push_back( GraphHelper::Definition(opt.res_sk + "_" + variable) );
+    vecLinSketch.push_back( GraphHelper::Definition(opt.lin_sk + "_" + variable) );
+    for (SketchHelper::Slice* slice : sketches.GetSlices(variable)) {
+      if (slice -> sketch.GetTotal() < 2.) continue;
+      vecResSketch.back().AddPoint( {slice -> center, slice -> sketch.GetResolution(), 0., slice -> sketch.GetResolutionError()} );
+      vecLinSketch.back().AddPoint( {slice -> center, slice -> sketch.GetMedian(),     0., slice -> sketch.GetMedianError()}     );
+    }
+
+    std::cout << "      Variable '" << variable << "' (sketch):" << std::endl;
+    for (SketchHelper::Slice* slice : sketches.GetSlices(variable)) {
+      std::cout << "        [" << slice -> low << ", " << slice -> high << ") "
+                << "n = " << slice -> sketch.GetTotal() << ", "
+                << "median = " << slice -> sketch.GetMedian() << ", "
+                << "sigma_eff/median = " << slice -> sketch.GetResolution() << " +- " << slice -> sketch.GetResolutionError()
+                << std::endl;
+    }
+  }  // end variable loop
+
+  // --------------------------------------------------------------------------
+  // Save and exit
+  // --------------------------------------------------------------------------
+  TFile* output = new TFile(opt.out_file.data(), "recreate");
+  if (!output) {
+    std::cerr << "PANIC: couldn't open output file!" << std::endl;
+    assert(output);
+  }
+
+  // save graphs & merged tree
+  output -> cd();
+  for (std::size_t iGraph = 0; iGraph < vecRes.size(); ++iGraph) {
+    vecRes[iGraph].MakeTGraphErrors() -> Write();
+    vecLin[iGraph].MakeTGraphErrors() -> Write();
+  }
+  for (std::size_t iGraph = 0; iGraph < vecResSketch.size(); ++iGraph) {
+    vecResSketch[iGraph].MakeTGraphErrors() -> Write();
+    vecLinSketch[iGraph].MakeTGraphErrors() -> Write();
+  }
+  moments.MakeTree(opt.out_tree) -> Write();
+  if (!sketches.GetSlices().empty()) {
+    sketches.MakeTree(opt.out_sk) -> Write();
+  }
+  output -> Close();
+  std::cout << "    Wrote graphs and merged moments/sketches to: " << opt.out_file << std::endl;
+
+  // announce end & exit
+  std::cout << "  Finished moment merging macro!\n" << std::endl;
+  return;
+
+}
+
+// end ========================================================================
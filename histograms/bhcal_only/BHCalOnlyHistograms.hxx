@@ -31,7 +31,9 @@
 // analysis utilities
 #include "../../utility/HistHelper.hxx"
 #include "../../utility/GraphHelper.hxx"
+#include "../../utility/MomentHelper.hxx"
 #include "../../utility/NTupleHelper.hxx"
+#include "../../utility/SketchHelper.hxx"
 
 
 
@@ -156,6 +158,31 @@ namespace BHCalOnlyHistograms {
   const std::pair<std::string, std::string> grResName = {"grBHCalOnlyResHist", "grBHCalOnlyResFit"};
   const std::pair<std::string, std::string> grLinName = {"grBHCalOnlyLinHist", "grBHCalOnlyLinFit"};
 
+  // --------------------------------------------------------------------------
+  //! Option for moments
+  // --------------------------------------------------------------------------
+  /*! Resolution and linearity are also calculated
+   *  from exact (unbinned) moments, which are saved
+   *  to a tree so they can be merged across files
+   *  (see 'histograms/MakeGraphsFromMoments.cxx').
+   */
+  const std::string grResMomName = "grBHCalOnlyResMoments";
+  const std::string grLinMomName = "grBHCalOnlyLinMoments";
+  const std::string momTreeName  = "tBHCalOnlyMoments";
+
+  // --------------------------------------------------------------------------
+  //! Option for sketches
+  // --------------------------------------------------------------------------
+  /*! Robust resolution (sigma_eff / median) and
+   *  linearity (median) are calculated from
+   *  streaming quantile sketches, which are
+   *  likewise saved to a tree for merging.
+   */
+  const double      skCompression = 200.;
+  const std::string grResSkName   = "grBHCalOnlyResSketch";
+  const std::string grLinSkName   = "grBHCalOnlyLinSketch";
+  const std::string skTreeName    = "tBHCalOnlySketches";
+
 
 
   // --------------------------------------------------------------------------
@@ -254,6 +281,40 @@ namespace BHCalOnlyHistograms {
       }  // end 2d hist loop
 
     }  // end particle bin loop
+
+    // create moment accumulators for each 1d variable
+    MomentHelper::Table                                  moments;
+    std::vector<std::vector<MomentHelper::Accumulator*>> vecMoments( par_bins.size() );
+    for (std::size_t iBin = 0; iBin < par_bins.size(); ++iBin) {
+      for (const auto& def : vecVarDef1D) {
+        vecMoments[iBin].push_back(
+          &moments.Get(
+            def.first,
+            get<0>(par_bins[iBin]),
+            get<1>(par_bins[iBin]),
+            get<2>(par_bins[iBin]),
+            get<3>(par_bins[iBin])
+          )
+        );
+      }
+    }  // end particle bin loop
+
+    // create quantile sketches for each 1d variable
+    SketchHelper::Table                             sketches(skCompression);
+    std::vector<std::vector<SketchHelper::TDigest*>> vecSketches( par_bins.size() );
+    for (std::size_t iBin = 0; iBin < par_bins.size(); ++iBin) {
+      for (const auto& def : vecVarDef1D) {
+        vecSketches[iBin].push_back(
+          &sketches.Get(
+            def.first,
+            get<0>(par_bins[iBin]),
+            get<1>(par_bins[iBin]),
+            get<2>(par_bins[iBin]),
+            get<3>(par_bins[iBin])
+          )
+        );
+      }
+    }  // end particle bin loop
     std::cout << "    Generated histograms." << std::endl;
 
     // ------------------------------------------------------------------------
@@ -300,11 +361,17 @@ namespace BHCalOnlyHistograms {
         if ( isInParBin(helper.GetVariable("ePar"), bin) ) {
 
 
-          // fill 1d variable histograms
+          // fill 1d variable histograms, moments, & sketches
           for (std::size_t iVar = 0; iVar < vecVarDef1D.size(); ++iVar) {
             vecVar1D[iBin][iVar].first -> Fill( 
               helper.GetVariable(vecVarDef1D[iVar].first) 
             );
+            vecMoments[iBin][iVar] -> Add(
+              helper.GetVariable(vecVarDef1D[iVar].first)
+            );
+            vecSketches[iBin][iVar] -> Add(
+              helper.GetVariable(vecVarDef1D[iVar].first)
+            );
           }  // end variable loop
 
           // fill 1d formula histograms
@@ -357,6 +424,10 @@ namespace BHCalOnlyHistograms {
     std::vector<GraphHelper::Definition> vecResFit;
     std::vector<GraphHelper::Definition> vecLinHist;
     std::vector<GraphHelper::Definition> vecLinFit;
+    std::vector<GraphHelper::Definition> vecResMoments;
+    std::vector<GraphHelper::Definition> vecLinMoments;
+    std::vector<GraphHelper::Definition> vecResSketch;
+    std::vector<GraphHelper::Definition> vecLinSketch;
 
     // loop over histograms
     std::vector<std::vector<TF1*>> vecFit1D( vecVar1D.front().size() );
@@ -379,6 +450,18 @@ namespace BHCalOnlyHistograms {
       vecLinFit.push_back(
         GraphHelper::Definition(grLinName.second + "_" + vecVarDef1D[iVar].first)
       );
+      vecResMoments.push_back(
+        GraphHelper::Definition(grResMomName + "_" + vecVarDef1D[iVar].first)
+      );
+      vecLinMoments.push_back(
+        GraphHelper::Definition(grLinMomName + "_" + vecVarDef1D[iVar].first)
+      );
+      vecResSketch.push_back(
+        GraphHelper::Definition(grResSkName + "_" + vecVarDef1D[iVar].first)
+      );
+      vecLinSketch.push_back(
+        GraphHelper::Definition(grLinSkName + "_" + vecVarDef1D[iVar].first)
+      );
   
       // loop over particle bins
       for (std::size_t iBin = 0; iBin < par_bins.size(); ++iBin) {
@@ -396,6 +479,16 @@ namespace BHCalOnlyHistograms {
         vecResHist.back().AddPoint( {get<1>(par_bins[iBin]), resValHist, 0., resErrHist} );
         vecLinHist.back().AddPoint( {get<1>(par_bins[iBin]), muValHist,  0., muErrHist}  );
 
+        // add points to moment graphs
+        const MomentHelper::Accumulator& mom = *vecMoments[iBin][iVar];
+        vecResMoments.back().AddPoint( {get<1>(par_bins[iBin]), mom.GetResolution(), 0., mom.GetResolutionError()} );
+        vecLinMoments.back().AddPoint( {get<1>(par_bins[iBin]), mom.GetMean(),       0., mom.GetMeanError()}       );
+
+        // add points to sketch graphs
+        SketchHelper::TDigest& sketch = *vecSketches[iBin][iVar];
+        vecResSketch.back().AddPoint( {get<1>(par_bins[iBin]), sketch.GetResolution(), 0., sketch.GetResolutionError()} );
+        vecLinSketch.back().AddPoint( {get<1>(par_bins[iBin]), sketch.GetMedian(),     0., sketch.GetMedianError()}     );
+
         // create fit name
         std::string fitName( vecVar1D[iBin][iVar].first -> GetName() );
         fitName[0] = 'f';
@@ -455,7 +548,13 @@ namespace BHCalOnlyHistograms {
       vecLinHist[iGraph].MakeTGraphErrors() -> Write();
       vecResFit[iGraph].MakeTGraphErrors()  -> Write();
       vecLinFit[iGraph].MakeTGraphErrors()  -> Write();
+      vecResMoments[iGraph].MakeTGraphErrors() -> Write();
+      vecLinMoments[iGraph].MakeTGraphErrors() -> Write();
+      vecResSketch[iGraph].MakeTGraphErrors() -> Write();
+      vecLinSketch[iGraph].MakeTGraphErrors() -> Write();
     }
+    moments.MakeTree(momTreeName) -> Write();
+    sketches.MakeTree(skTreeName) -> Write();
 
     // announce end
     std::cout << "  Finished filling BHCal-only histograms!\n"
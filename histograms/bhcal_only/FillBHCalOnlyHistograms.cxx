@@ -17,21 +17,42 @@
 #include <iostream>
 // analysis utilities
 #include "BHCalOnlyHistograms.hxx"
+#include "../../utility/SliceHelper.hxx"
+#include "../../utility/CompressionProfiles.hxx"
 
 
 
 // ============================================================================
 //! Struct to consolidate user options
 // ============================================================================
+/*! By default, particles are sliced with the
+ *  hard-coded bins below. For continuous-energy
+ *  samples, slicing can instead be set to:
+ *    "equal" = 'n_slices' slices with the same
+ *              no. of entries
+ *    "count" = as many slices as needed to get
+ *              ~'n_per_slice' entries in each
+ *  where the edges are derived from a quick
+ *  first pass over 'ePar'. The edges and centers
+ *  of the slices are saved to the output file.
+ */
 struct Options {
-  std::string in_file;     // input file
-  std::string in_tuple;    // input ntuple
-  std::string out_file;    // output file
-  bool        do_progress; // print progress through entry loop
+  std::string in_file;      // input file
+  std::string in_tuple;     // input ntuple
+  std::string out_file;     // output file
+  std::string slicing;      // particle slicing: "fixed", "equal", or "count"
+  std::size_t n_slices;     // no. of slices for "equal"
+  double      n_per_slice;  // target no. of entries per slice for "count"
+  std::string comp_profile; // output compression profile
+  bool        do_progress;  // print progress through entry loop
 }  DefaultOptions = {
   "./reco/forBHCalOnlyCheck.evt5Ke120pim_central.d31m10y2024.tuple.root",
   "ntBHCalOnly",
   "forBHCalOnlyCheck.evt5Ke120pim_central.d31m10y2024.hists.root",
+  "fixed",
+  8,
+  5000.,
+  "histograms",
   true
 };
 
@@ -47,7 +68,7 @@ void FillBHCalOnlyHistograms(const Options& opt = DefaultOptions) {
   //   <1> = particle energy
   //   <2> = bin low edge
   //   <3> = bin high edge
-  const std::vector<std::tuple<std::string, float, float, float>> vecParBins = {
+  std::vector<std::tuple<std::string, float, float, float>> vecParBins = {
     std::make_tuple("Ene1",  1.,  0.5, 1.5),
     std::make_tuple("Ene2",  2.,  1.5, 4.),
     std::make_tuple("Ene5",  5.,  4.,  6.),
@@ -67,12 +88,43 @@ void FillBHCalOnlyHistograms(const Options& opt = DefaultOptions) {
     std::cerr << "PANIC: couldn't open output file!" << std::endl;
     assert(output);
   }
+
+  // set compression of output
+  CompressionProfiles::Apply(output, CompressionProfiles::Get(opt.comp_profile));
   std::cout << "    Opened output file: " << opt.out_file << std::endl;
 
+  // derive slices from data if needed
+  if (opt.slicing != "fixed") {
+
+    TFile* fSlice = new TFile(opt.in_file.data(), "read");
+    TTree* tSlice = (TTree*) fSlice -> Get(opt.in_tuple.data());
+    if (!tSlice) {
+      std::cerr << "PANIC: couldn't grab tuple for slicing!\n"
+                << "       name = " << opt.in_tuple
+                << std::endl;
+      assert(tSlice);
+    }
+
+    vecParBins = SliceHelper::MakeBins(tSlice, "ePar", opt.slicing, opt.n_slices, opt.n_per_slice);
+    std::cout << "    Derived " << vecParBins.size() << " particle slices (" << opt.slicing << "):" << std::endl;
+    SliceHelper::PrintBins(vecParBins);
+    fSlice -> Close();
+    output -> cd();
+  }
+
   // fill uncalibrated histograms
   BHCalOnlyHistograms::Fill(output, opt.in_file, opt.in_tuple, vecParBins, opt.do_progress);
   std::cout << "    Filled BHCal-only histograms." << std::endl;
 
+  // save slicing so downstream plotting can use the same edges
+  output -> cd();
+  std::vector<double> vecParCenters;
+  for (const auto& bin : vecParBins) {
+    vecParCenters.push_back( get<1>(bin) );
+  }
+  SliceHelper::MakeVector( SliceHelper::GetEdges(vecParBins) ).Write("vecParEdges");
+  SliceHelper::MakeVector( vecParCenters ).Write("vecParCenters");
+
   // close output file
   output -> cd();
   output -> Close();
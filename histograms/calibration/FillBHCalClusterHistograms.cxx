@@ -21,18 +21,35 @@
 // analysis utilities
 #include "CalibratedClusterHistograms.hxx"
 #include "UncalibratedClusterHistograms.hxx"
+#include "../../utility/SliceHelper.hxx"
+#include "../../utility/CompressionProfiles.hxx"
 
 
 
 // ============================================================================
 //! Struct to consolidate user options
 // ============================================================================
+/*! By default, particles are sliced with the
+ *  hard-coded bins below. For continuous-energy
+ *  samples, slicing can instead be set to:
+ *    "equal" = 'n_slices' slices with the same
+ *              no. of entries
+ *    "count" = as many slices as needed to get
+ *              ~'n_per_slice' entries in each
+ *  where the edges are derived from a quick
+ *  first pass over 'ePar'. The edges and centers
+ *  of the slices are saved to the output file.
+ */
 struct Options {
   std::string in_uncalib_file;   // input uncalibrated file
   std::string in_uncalib_tuple;  // input uncalibrated ntuple
   std::string in_calib_file;     // input calibrated file
   std::string in_calib_tuple;    // input calibrated ntuple
   std::string out_file;          // output file
+  std::string slicing;           // particle slicing: "fixed", "equal", or "count"
+  std::size_t n_slices;          // no. of slices for "equal"
+  double      n_per_slice;       // target no. of entries per slice for "count"
+  std::string comp_profile;      // output compression profile
   bool        do_progress;       // print progress through entry loop
 }  DefaultOptions = {
   "./input/forNewTrainingMacro_noNonzeroEvts_andDefinitePrimary.evt5Ke210pim_central.d14m9y2024.root",
@@ -40,6 +57,10 @@ struct Options {
   "./input/forNewHistogrammingMacro_noNonzeroEvts_andDefinitePrimary.evt5Ke210pim_central.d21m9y2024.root",
   "ntTmvaOutput",
   "test.root",
+  "fixed",
+  8,
+  5000.,
+  "histograms",
   true
 };
 
@@ -55,7 +76,7 @@ void FillBHCalClusterHistograms(const Options& opt = DefaultOptions) {
   //   <1> = particle energy
   //   <2> = bin low edge
   //   <3> = bin high edge
-  const std::vector<std::tuple<std::string, float, float, float>> vecParBins = {
+  std::vector<std::tuple<std::string, float, float, float>> vecParBins = {
     std::make_tuple("Ene2",  2., 0., 4.),
     std::make_tuple("Ene5",  5., 4., 6.),
     std::make_tuple("Ene7",  7., 6., 9.),
@@ -72,8 +93,30 @@ void FillBHCalClusterHistograms(const Options& opt = DefaultOptions) {
     std::cerr << "PANIC: couldn't open output file!" << std::endl;
     assert(output);
   }
+
+  // set compression of output
+  CompressionProfiles::Apply(output, CompressionProfiles::Get(opt.comp_profile));
   std::cout << "    Opened output file: " << opt.out_file << std::endl;
 
+  // derive slices from data if needed
+  if (opt.slicing != "fixed") {
+
+    TFile* fSlice = new TFile(opt.in_uncalib_file.data(), "read");
+    TTree* tSlice = (TTree*) fSlice -> Get(opt.in_uncalib_tuple.data());
+    if (!tSlice) {
+      std::cerr << "PANIC: couldn't grab tuple for slicing!\n"
+                << "       name = " << opt.in_uncalib_tuple
+                << std::endl;
+      assert(tSlice);
+    }
+
+    vecParBins = SliceHelper::MakeBins(tSlice, "ePar", opt.slicing, opt.n_slices, opt.n_per_slice);
+    std::cout << "    Derived " << vecParBins.size() << " particle slices (" << opt.slicing << "):" << std::endl;
+    SliceHelper::PrintBins(vecParBins);
+    fSlice -> Close();
+    output -> cd();
+  }
+
   // fill uncalibrated histograms
   UncalibratedClusterHistograms::Fill(output, opt.in_uncalib_file, opt.in_uncalib_tuple, vecParBins, opt.do_progress);
   std::cout << "    Filled uncalibrated histograms." << std::endl;
@@ -82,6 +125,15 @@ void FillBHCalClusterHistograms(const Options& opt = DefaultOptions) {
   CalibratedClusterHistograms::Fill(output, opt.in_calib_file, opt.in_calib_tuple, vecParBins, opt.do_progress);
   std::cout << "    Filled calibrated histograms." << std::endl;
 
+  // save slicing so downstream plotting can use the same edges
+  output -> cd();
+  std::vector<double> vecParCenters;
+  for (const auto& bin : vecParBins) {
+    vecParCenters.push_back( get<1>(bin) );
+  }
+  SliceHelper::MakeVector( SliceHelper::GetEdges(vecParBins) ).Write("vecParEdges");
+  SliceHelper::MakeVector( vecParCenters ).Write("vecParCenters");
+
   // close output file
   output -> cd();
   output -> Close();
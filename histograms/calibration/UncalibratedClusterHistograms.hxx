@@ -31,7 +31,9 @@
 // analysis utilities
 #include "../../utility/HistHelper.hxx"
 #include "../../utility/GraphHelper.hxx"
+#include "../../utility/MomentHelper.hxx"
 #include "../../utility/NTupleHelper.hxx"
+#include "../../utility/SketchHelper.hxx"
 
 
 
@@ -182,6 +184,31 @@ namespace UncalibratedClusterHistograms {
   const std::string grResName = "grUncalibResHist";
   const std::string grLinName = "grUncalibLinHist";
 
+  // --------------------------------------------------------------------------
+  //! Option for moments
+  // --------------------------------------------------------------------------
+  /*! Resolution and linearity are also calculated
+   *  from exact (unbinned) moments, which are saved
+   *  to a tree so they can be merged across files
+   *  (see 'histograms/MakeGraphsFromMoments.cxx').
+   */
+  const std::string grResMomName = "grUncalibResMoments";
+  const std::string grLinMomName = "grUncalibLinMoments";
+  const std::string momTreeName  = "tUncalibMoments";
+
+  // --------------------------------------------------------------------------
+  //! Option for sketches
+  // --------------------------------------------------------------------------
+  /*! Robust resolution (sigma_eff / median) and
+   *  linearity (median) are calculated from
+   *  streaming quantile sketches, which are
+   *  likewise saved to a tree for merging.
+   */
+  const double      skCompression = 200.;
+  const std::string grResSkName   = "grUncalibResSketch";
+  const std::string grLinSkName   = "grUncalibLinSketch";
+  const std::string skTreeName    = "tUncalibSketches";
+
 
 
   // --------------------------------------------------------------------------
@@ -280,6 +307,40 @@ namespace UncalibratedClusterHistograms {
       }  // end 2d hist loop
 
     }  // end particle bin loop
+
+    // create moment accumulators for each 1d variable
+    MomentHelper::Table                                  moments;
+    std::vector<std::vector<MomentHelper::Accumulator*>> vecMoments( par_bins.size() );
+    for (std::size_t iBin = 0; iBin < par_bins.size(); ++iBin) {
+      for (const auto& def : vecVarDef1D) {
+        vecMoments[iBin].push_back(
+          &moments.Get(
+            def.first,
+            get<0>(par_bins[iBin]),
+            get<1>(par_bins[iBin]),
+            get<2>(par_bins[iBin]),
+            get<3>(par_bins[iBin])
+          )
+        );
+      }
+    }  // end particle bin loop
+
+    // create quantile sketches for each 1d variable
+    SketchHelper::Table                             sketches(skCompression);
+    std::vector<std::vector<SketchHelper::TDigest*>> vecSketches( par_bins.size() );
+    for (std::size_t iBin = 0; iBin < par_bins.size(); ++iBin) {
+      for (const auto& def : vecVarDef1D) {
+        vecSketches[iBin].push_back(
+          &sketches.Get(
+            def.first,
+            get<0>(par_bins[iBin]),
+            get<1>(par_bins[iBin]),
+            get<2>(par_bins[iBin]),
+            get<3>(par_bins[iBin])
+          )
+        );
+      }
+    }  // end particle bin loop
     std::cout << "    Generated histograms." << std::endl;
 
     // ------------------------------------------------------------------------
@@ -326,11 +387,17 @@ namespace UncalibratedClusterHistograms {
         if ( isInParBin(helper.GetVariable("ePar"), bin) ) {
 
 
-          // fill 1d variable histograms
+          // fill 1d variable histograms, moments, & sketches
           for (std::size_t iVar = 0; iVar < vecVarDef1D.size(); ++iVar) {
             vecVar1D[iBin][iVar].first -> Fill( 
               helper.GetVariable(vecVarDef1D[iVar].first) 
             );
+            vecMoments[iBin][iVar] -> Add(
+              helper.GetVariable(vecVarDef1D[iVar].first)
+            );
+            vecSketches[iBin][iVar] -> Add(
+              helper.GetVariable(vecVarDef1D[iVar].first)
+            );
           }  // end variable loop
 
           // fill 1d formula histograms
@@ -381,6 +448,10 @@ namespace UncalibratedClusterHistograms {
     // for resolution graphs
     std::vector<GraphHelper::Definition> vecResHist;
     std::vector<GraphHelper::Definition> vecLinHist;
+    std::vector<GraphHelper::Definition> vecResMoments;
+    std::vector<GraphHelper::Definition> vecLinMoments;
+    std::vector<GraphHelper::Definition> vecResSketch;
+    std::vector<GraphHelper::Definition> vecLinSketch;
 
     // loop over histograms
     for (std::size_t iVar = 0; iVar < vecVar1D.front().size(); ++iVar) {
@@ -396,6 +467,18 @@ namespace UncalibratedClusterHistograms {
       vecLinHist.push_back(
         GraphHelper::Definition(grLinName + "_" + vecVarDef1D[iVar].first)
       );
+      vecResMoments.push_back(
+        GraphHelper::Definition(grResMomName + "_" + vecVarDef1D[iVar].first)
+      );
+      vecLinMoments.push_back(
+        GraphHelper::Definition(grLinMomName + "_" + vecVarDef1D[iVar].first)
+      );
+      vecResSketch.push_back(
+        GraphHelper::Definition(grResSkName + "_" + vecVarDef1D[iVar].first)
+      );
+      vecLinSketch.push_back(
+        GraphHelper::Definition(grLinSkName + "_" + vecVarDef1D[iVar].first)
+      );
 
       // loop over particle bins
       for (std::size_t iBin = 0; iBin < par_bins.size(); ++iBin) {
@@ -413,6 +496,16 @@ namespace UncalibratedClusterHistograms {
         vecResHist.back().AddPoint( {get<1>(par_bins[iBin]), resValHist, 0., resErrHist} );
         vecLinHist.back().AddPoint( {get<1>(par_bins[iBin]), muValHist,  0., muErrHist}  );
 
+        // add points to moment graphs
+        const MomentHelper::Accumulator& mom = *vecMoments[iBin][iVar];
+        vecResMoments.back().AddPoint( {get<1>(par_bins[iBin]), mom.GetResolution(), 0., mom.GetResolutionError()} );
+        vecLinMoments.back().AddPoint( {get<1>(par_bins[iBin]), mom.GetMean(),       0., mom.GetMeanError()}       );
+
+        // add points to sketch graphs
+        SketchHelper::TDigest& sketch = *vecSketches[iBin][iVar];
+        vecResSketch.back().AddPoint( {get<1>(par_bins[iBin]), sketch.GetResolution(), 0., sketch.GetResolutionError()} );
+        vecLinSketch.back().AddPoint( {get<1>(par_bins[iBin]), sketch.GetMedian(),     0., sketch.GetMedianError()}     );
+
       }  // end bin loop
     }  // end hist loop
 
@@ -440,7 +533,13 @@ namespace UncalibratedClusterHistograms {
     for (std::size_t iGraph = 0; iGraph < vecResHist.size(); ++iGraph) {
       vecResHist[iGraph].MakeTGraphErrors() -> Write();
       vecLinHist[iGraph].MakeTGraphErrors() -> Write();
+      vecResMoments[iGraph].MakeTGraphErrors() -> Write();
+      vecLinMoments[iGraph].MakeTGraphErrors() -> Write();
+      vecResSketch[iGraph].MakeTGraphErrors() -> Write();
+      vecLinSketch[iGraph].MakeTGraphErrors() -> Write();
     }
+    moments.MakeTree(momTreeName) -> Write();
+    sketches.MakeTree(skTreeName) -> Write();
 
     // announce end
     std::cout << "  Finished filling uncalibrated cluster histograms!\n"
@@ -13,6 +13,7 @@
 
 // c++ utilities
 #include <map>
+#include <array>
 #include <string>
 #include <utility>
 // root libraries
@@ -30,23 +31,41 @@
 // edm4hep types
 #include <edm4hep/Vector3f.h>
 #include <edm4hep/utils/vector_utils.h>
+// analysis utilities
+#include "../../utility/HitSkimHelper.hxx"
+#include "../../utility/CompressionProfiles.hxx"
 
 
 
 // ============================================================================
 //! Struct to consolidate user options
 // ============================================================================
+/*! With 'do_skim' on, the input is read as a
+ *  hit skim (see 'SkimBHCalHitsInROI.cxx')
+ *  rather than podio output, and the hits are
+ *  taken from the skim collection tagged
+ *  'skim_tag'. n.b. skims keep only events
+ *  with a primary, and only hits near it, so
+ *  the no. of hits is saved as 'hHitNumInROI'
+ *  instead of 'hHitNum'.
+ */
 struct Options {
   std::string in_file;      // input file
   std::string out_file;     // output file
   std::string gen_par;      // particle collection
   std::string hcal_hit;     // hcal cluster collection
+  bool        do_skim;      // read input as a hit skim
+  std::string skim_tag;     // skim collection to use
+  std::string comp_profile; // output compression profile
   bool        do_progress;  // print progress through frame loop
 } DefaultOptions = {
   "../output/forTileMerger.change0_test_mergeBHCalHitsInEta.d11m5y2024.podio.root",
   "forTileMerger.change0_test_mergeBHCalHitsInEta.d6m5y2024.hist.root",
   "GeneratedParticles",
   "HcalBarrelMergedHits",
+  false,
+  "BHCal",
+  "histograms",
   true
 };
 
@@ -64,9 +83,25 @@ void FillBHCalHitHistograms(const Options& opt = DefaultOptions) {
   // Open input/outputs
   // --------------------------------------------------------------------------
 
-  // open file w/ frame reader
+  // open file w/ frame reader or skim reader
   podio::ROOTFrameReader reader = podio::ROOTFrameReader();
-  reader.openFile( opt.in_file );
+  HitSkimHelper::Reader  skim;
+  TFile*                 input = nullptr;
+  int                    iSkim = -1;
+  if (opt.do_skim) {
+    input = new TFile(opt.in_file.data(), "read");
+    if (!input || !skim.Attach(input)) {
+      std::cerr << "PANIC: couldn't open hit skim!" << std::endl;
+      assert(input && (skim.GetEntries() > 0));
+    }
+    iSkim = skim.GetIndex(opt.skim_tag);
+    if (iSkim < 0) {
+      std::cerr << "PANIC: collection '" << opt.skim_tag << "' not in hit skim!" << std::endl;
+      assert(iSkim >= 0);
+    }
+  } else {
+    reader.openFile( opt.in_file );
+  }
 
   // open output file
   TFile* output = new TFile(opt.out_file.data(), "recreate");
@@ -75,6 +110,9 @@ void FillBHCalHitHistograms(const Options& opt = DefaultOptions) {
     assert(output);
   }
 
+  // set compression of output
+  CompressionProfiles::Apply(output, CompressionProfiles::Get(opt.comp_profile));
+
   // print input/output
   std::cout << "    Opened input/output files:\n"
             << "      input file  = " << opt.in_file << "\n"
@@ -101,6 +139,14 @@ void FillBHCalHitHistograms(const Options& opt = DefaultOptions) {
   TH1D* hHitPhi = new TH1D("hHitPhi", "", get<0>(bins["phi"]), get<1>(bins["phi"]), get<2>(bins["phi"]));
   TH1D* hHitNum = new TH1D("hHitNum", "", get<0>(bins["num"]), get<1>(bins["num"]), get<2>(bins["num"]));
 
+  // n.b. a skim only keeps hits near the primary, so
+  // label its no. of hits to keep it from being mixed
+  // up with the no. of hits over the whole BHCal
+  if (opt.do_skim) {
+    hHitNum -> SetName("hHitNumInROI");
+    hHitNum -> SetTitle("No. of hits in ROI around primary");
+  }
+
   // make 2d histograms
   TH2D* hHitPhiVsEta = new TH2D(
     "hHitPhiVsEta",
@@ -109,11 +155,18 @@ void FillBHCalHitHistograms(const Options& opt = DefaultOptions) {
     get<0>(bins["phi"]), get<1>(bins["phi"]), get<2>(bins["phi"])
   );
 
+  // fill hit histograms
+  auto fillHit = [&](const double hHit, const double fHit) {
+    hHitEta      -> Fill(hHit);
+    hHitPhi      -> Fill(fHit);
+    hHitPhiVsEta -> Fill(hHit, fHit);
+  };
+
   // --------------------------------------------------------------------------
   // Loop over input frames
   // --------------------------------------------------------------------------
-  const uint64_t nFrames = reader.getEntries(podio::Category::Event);
-  std::cout << "    Starting frame loop: " << reader.getEntries(podio::Category::Event) << " frames to process." << std::endl;
+  const uint64_t nFrames = opt.do_skim ? skim.GetEntries() : reader.getEntries(podio::Category::Event);
+  std::cout << "    Starting frame loop: " << nFrames << " frames to process." << std::endl;
 
   // iterate through frames
   for (uint64_t iFrame = 0; iFrame < nFrames; ++iFrame) {
@@ -128,6 +181,30 @@ void FillBHCalHitHistograms(const Options& opt = DefaultOptions) {
       }
     }
 
+    // ------------------------------------------------------------------------
+    // skimmed hit loop
+    // ------------------------------------------------------------------------
+    if (opt.do_skim) {
+
+      skim.GetEntry(iFrame);
+
+      std::array<Float_t, 3> position;
+      for (const ULong64_t cellID : skim.GetCellIDs(iSkim)) {
+
+        // look up position and get eta/phi
+        if (!skim.GetPosition(iSkim, cellID, position)) continue;
+        const edm4hep::Vector3f vHit(position[0], position[1], position[2]);
+
+        // fill hit histograms
+        fillHit(edm4hep::utils::eta(vHit), edm4hep::utils::angleAzimuthal(vHit));
+
+      }  // end skimmed hit loop
+
+      // fill event histograms
+      hHitNum -> Fill( skim.GetCellIDs(iSkim).size() );
+      continue;
+    }
+
     // grab frame
     auto frame = podio::Frame( reader.readNextEntry(podio::Category::Event) );
 
@@ -145,9 +222,7 @@ void FillBHCalHitHistograms(const Options& opt = DefaultOptions) {
       const double fHit = edm4hep::utils::angleAzimuthal( hit.getPosition() );
 
       // fill hit histograms
-      hHitEta      -> Fill(hHit);
-      hHitPhi      -> Fill(fHit);
-      hHitPhiVsEta -> Fill(hHit, fHit);
+      fillHit(hHit, fHit);
 
     }  // end hcal cluster loop
 
@@ -164,6 +239,7 @@ void FillBHCalHitHistograms(const Options& opt = DefaultOptions) {
   hHitNum      -> Write();
   hHitPhiVsEta -> Write();
   output       -> Close();
+  if (input) input -> Close();
 
   // announce end & exit
   std::cout << "  End of macro!\n" << std::endl;
@@ -11,12 +11,15 @@
 #define FillBHCalClusterCalibrationTuple_cxx
 
 // c++ utilities
+#include <cmath>
 #include <limits>
 #include <string>
+#include <optional>
 #include <vector>
 #include <cassert>
 #include <iostream>
-#include <optional>
+#include <algorithm>
+#include <utility>
 // root libraries
 #include <TFile.h>
 #include <TNtuple.h>
@@ -34,23 +37,72 @@
 #include <edm4hep/utils/vector_utils.h>
 // analysis utilities
 #include "../../utility/NTupleHelper.hxx"
+#include "../../utility/TimingHelper.hxx"
+#include "../../utility/CheckpointHelper.hxx"
+#include "../../utility/CompressionProfiles.hxx"
+#include "../../utility/SpatialIndexHelper.hxx"
+#include "../../utility/TowerGridHelper.hxx"
+#include "../../utility/ClusterShapeHelper.hxx"
 
 
 
 // ============================================================================
 //! Struct to consolidate user options
 // ============================================================================
+/*! The output tuple is checkpointed every
+ *  'ckpt_every' frames (0 turns this off). If a
+ *  job dies, rerunning with 'do_resume' on will
+ *  reopen the output and pick up after the last
+ *  checkpoint.
+ *
+ *  By default, only the first primary of each
+ *  event is used and all clusters are attributed
+ *  to it. With 'do_multi' on, a row is filled
+ *  for every primary instead, and each cluster
+ *  (and hit) is attributed to the nearest
+ *  primary within 'match_cone' in eta-phi.
+ *
+ *  With 'do_link' on, BEMC clusters within
+ *  'link_cone' of a BHCal cluster are linked
+ *  to it, and the most energetic linked system
+ *  is saved alongside the leading clusters.
+ *
+ *  With 'do_cones' on, BHCal and imaging hits
+ *  are summed onto an eta-phi tower grid, and
+ *  the energy within each of 'cone_radii' of
+ *  the lead BHCal cluster is added to the tuple
+ *  along with an isolation fraction.
+ *
+ *  With 'do_shapes' on, the energy-weighted
+ *  widths in eta, phi, and depth, dispersion,
+ *  and lead hit fraction of the lead BHCal and
+ *  BEMC clusters are added to the tuple.
+ */
 struct Options {
-  std::string in_file;      // input file
-  std::string out_file;     // output file
-  std::string gen_par;      // generated particles
-  std::string hcal_clust;   // hcal cluster collection
-  std::string ecal_clust;   // ecal (scfi + imaging) cluster collection
-  std::string scfi_clust;   // ecal (scfi) cluster collection
-  std::string scfi_hits;    // ecal (scfi) hit collection
-  std::string image_clust;  // ecal (imaging) cluster/layer collection
-  std::string image_hits;   // ecal (imaging) hit collection
-  bool        do_progress;  // print progress through frame loop
+  std::string               in_file;      // input file
+  std::string               out_file;     // output file
+  std::string               gen_par;      // generated particles
+  std::string               hcal_clust;   // hcal cluster collection
+  std::string               ecal_clust;   // ecal (scfi + imaging) cluster collection
+  std::string               scfi_clust;   // ecal (scfi) cluster collection
+  std::string               scfi_hits;    // ecal (scfi) hit collection
+  std::string               image_clust;  // ecal (imaging) cluster/layer collection
+  std::string               image_hits;   // ecal (imaging) hit collection
+  std::string               hcal_hits;    // hcal hit collection
+  bool                      do_multi;     // fill a row per primary (multi-particle events)
+  double                    match_cone;   // eta-phi cone for matching clusters/hits to primaries
+  bool                      do_link;      // add most energetic linked bhcal-bemc system
+  double                    link_cone;    // eta-phi cone for linking bemc clusters to bhcal clusters
+  bool                      do_cones;     // add cone energies around lead bhcal cluster
+  std::vector<double>       cone_radii;   // radii of cones (ascending)
+  std::pair<double, double> tower_eta;    // eta range of tower grid
+  double                    tower_deta;   // tower size in eta
+  std::size_t               tower_nphi;   // no. of towers in phi
+  bool                      do_shapes;    // add shape moments of lead bhcal/bemc clusters
+  std::string               comp_profile; // output compression profile
+  uint64_t                  ckpt_every;   // no. of frames between checkpoints
+  bool                      do_resume;    // resume from last checkpoint (if any)
+  bool                      do_progress;  // print progress through frame loop
 } DefaultOptions = {
   "./forNewCalibWorkflow.evt5Ke10pim_central.d14m9y2024.podio.root",
   "forNewTrainingMacro_noNonzeroEvts_andDefinitePrimary.evt5Ke10pim_central.d14m9y2024.root",
@@ -61,6 +113,20 @@ struct Options {
   "EcalBarrelScFiRecHits",
   "EcalBarrelImagingLayers",
   "EcalBarrelImagingRecHits",
+  "HcalBarrelRecHits",
+  false,
+  0.4,
+  true,
+  0.3,
+  false,
+  {0.1, 0.2, 0.3, 0.5},
+  {-1.6, 1.6},
+  0.05,
+  320,
+  false,
+  "tuple",
+  10000,
+  false,
   true
 };
 
@@ -130,9 +196,60 @@ void FillBHCalClusterCalibrationTuple(const Options& opt = DefaultOptions) {
     "eSumImageLayer6"
   });
 
+  // add optional linked system variables
+  if (opt.do_link) {
+    for (const std::string variable : {"eLinkBHCal", "eLinkBEMC", "eLinkSum", "nLinkBEMC", "hLinkSys", "fLinkSys"}) {
+      helper.AddVariable( variable );
+    }
+  }
+
+  // add optional cone variables
+  if (opt.do_cones) {
+    for (const double radius : opt.cone_radii) {
+      helper.AddVariable( "eConeBHCal" + TowerGridHelper::MakeRadiusTag(radius) );
+      helper.AddVariable( "eConeImage" + TowerGridHelper::MakeRadiusTag(radius) );
+    }
+    helper.AddVariable( "isoBHCal" );
+    helper.AddVariable( "isoImage" );
+  }
+
+  // add optional cluster shape variables
+  if (opt.do_shapes) {
+    for (const std::string& variable : ClusterShapeHelper::Variables) {
+      helper.AddVariable( variable + "LeadBHCal" );
+      helper.AddVariable( variable + "LeadBEMC" );
+    }
+  }
+
   // announce start of macro
   std::cout << "\n  Beginning calibration tuple-filling macro!" << std::endl;
 
+  // make sure matching cone is sensible
+  if (opt.do_multi && (opt.match_cone <= 0.)) {
+    std::cerr << "PANIC: matching cone must be positive! (match_cone = " << opt.match_cone << ")" << std::endl;
+    assert(opt.match_cone > 0.);
+  }
+
+  // make sure linking cone is sensible
+  if (opt.do_link && (opt.link_cone <= 0.)) {
+    std::cerr << "PANIC: linking cone must be positive! (link_cone = " << opt.link_cone << ")" << std::endl;
+    assert(opt.link_cone > 0.);
+  }
+
+  // n.b. isolation assumes cone radii are strictly ascending
+  if (opt.do_cones) {
+    const bool isAscending = std::adjacent_find(
+      opt.cone_radii.begin(),
+      opt.cone_radii.end(),
+      [](const double lhs, const double rhs) {return lhs >= rhs;}
+    ) == opt.cone_radii.end();
+    const bool isPositive = opt.cone_radii.empty() || (opt.cone_radii.front() > 0.);
+    if (!isAscending || !isPositive) {
+      std::cerr << "PANIC: cone radii must be positive and strictly ascending!" << std::endl;
+      assert(isAscending && isPositive);
+    }
+  }
+
   // --------------------------------------------------------------------------
   // Open input/outputs
   // --------------------------------------------------------------------------
@@ -141,21 +258,46 @@ void FillBHCalClusterCalibrationTuple(const Options& opt = DefaultOptions) {
   podio::ROOTFrameReader reader = podio::ROOTFrameReader();
   reader.openFile( opt.in_file );
 
+  // check for checkpoint if resuming
+  CheckpointHelper::State state;
+  bool doResume = false;
+  if (opt.do_resume) {
+    doResume = CheckpointHelper::ReadState(CheckpointHelper::GetStateFile(opt.out_file), state);
+    if (!doResume) {
+      std::cerr << "WARNING: no checkpoint found for " << opt.out_file << "! Starting from first frame." << std::endl;
+    }
+  }
+
   // open output file
-  TFile* output = new TFile(opt.out_file.data(), "recreate");
+  TFile* output = new TFile(opt.out_file.data(), doResume ? "update" : "recreate");
   if (!output) {
     std::cerr << "PANIC: couldn't open output file!" << std::endl;
     assert(output);
   }
 
+  // set compression of output
+  const CompressionProfiles::Profile profile = CompressionProfiles::Get(opt.comp_profile);
+  CompressionProfiles::Apply(output, profile);
+
   // print input/output
   std::cout << "    Opened input/output files:\n"
             << "      input file  = " << opt.in_file << "\n"
             << "      output file = " << opt.out_file
             << std::endl;
 
-  // create output ntuple
-  TNtuple* ntForCalib = new TNtuple("ntForCalib", "NTuple for calibration", helper.CompressVariables().c_str());
+  // create output ntuple (or grab it if resuming)
+  TNtuple* ntForCalib = nullptr;
+  if (doResume) {
+    ntForCalib = (TNtuple*) output -> Get("ntForCalib");
+    if (!CheckpointHelper::IsConsistent(ntForCalib, state, opt.in_file, helper.CompressVariables())) {
+      std::cerr << "PANIC: can't resume from checkpoint! Please rerun without resuming." << std::endl;
+      assert(CheckpointHelper::IsConsistent(ntForCalib, state, opt.in_file, helper.CompressVariables()));
+    }
+    std::cout << "    Resuming from frame " << state.next_frame << " (" << state.n_entries << " entries)." << std::endl;
+  } else {
+    ntForCalib = new TNtuple("ntForCalib", "NTuple for calibration", helper.CompressVariables().c_str());
+    CompressionProfiles::Apply(ntForCalib, profile);
+  }
 
   // --------------------------------------------------------------------------
   // Loop over input frames
@@ -163,8 +305,51 @@ void FillBHCalClusterCalibrationTuple(const Options& opt = DefaultOptions) {
   const uint64_t nFrames = reader.getEntries(podio::Category::Event);
   std::cout << "    Starting frame loop: " << reader.getEntries(podio::Category::Event) << " frames to process." << std::endl;
 
+  // reset stage timers (if enabled)
+  if (TimingHelper::IsEnabled()) {
+    TimingHelper::Registry::Get().Reset();
+  }
+
+  // tower grids for cone sums
+  TowerGridHelper::TowerGrid hcalTowers(opt.tower_eta.first, opt.tower_eta.second, opt.tower_deta, opt.tower_nphi);
+  TowerGridHelper::TowerGrid imageTowers(opt.tower_eta.first, opt.tower_eta.second, opt.tower_deta, opt.tower_nphi);
+
+  // hit arrays & shapes of lead clusters
+  ClusterShapeHelper::HitArrays          shapeHits;
+  std::vector<ClusterShapeHelper::Shape> shapes;
+
+  // lambda to split objects (clusters or hits) between primaries: in
+  // single-particle mode everything goes to the primary, otherwise each
+  // object goes to the nearest primary within the matching cone
+  auto splitByParticle = [&opt](
+    const auto& objects,
+    const std::vector<double>& parEtas,
+    const std::vector<double>& parPhis,
+    auto& byParticle
+  ) {
+    if (opt.do_multi) {
+      SpatialIndexHelper::SplitByNearest(objects, parEtas, parPhis, opt.match_cone, byParticle);
+      return;
+    }
+
+    byParticle.assign(parEtas.size(), {});
+    for (const auto& object : objects) {
+      byParticle.front().push_back(object);
+    }
+  };
+
+  // checkpoint output periodically
+  const uint64_t firstFrame = doResume ? state.next_frame : 0;
+  CheckpointHelper::Checkpointer checkpointer(ntForCalib, opt.in_file, opt.out_file, opt.ckpt_every, firstFrame);
+
   // iterate through frames
-  for (uint64_t iFrame = 0; iFrame < nFrames; ++iFrame) {
+  for (uint64_t iFrame = firstFrame; iFrame < nFrames; ++iFrame) {
+
+    // checkpoint all previous frames (if due)
+    checkpointer.Update(iFrame);
+
+    // time stages of frame (if enabled)
+    BHCAL_TIME_STAGES();
 
     // announce progress
     if (opt.do_progress) {
@@ -177,208 +362,444 @@ void FillBHCalClusterCalibrationTuple(const Options& opt = DefaultOptions) {
     }
 
     // grab frame
-    auto frame = podio::Frame( reader.readNextEntry(podio::Category::Event) );
+    BHCAL_TIME_STAGE("read frame");
+    auto frame = podio::Frame( reader.readEntry(podio::Category::Event, iFrame) );
 
     // grab needed collections
-    auto& genParticles  = frame.get<edm4eic::ReconstructedParticleCollection>( opt.gen_par );
-    auto& hcalClusters  = frame.get<edm4eic::ClusterCollection>( opt.hcal_clust );
-    auto& ecalClusters  = frame.get<edm4eic::ClusterCollection>( opt.ecal_clust );
-    auto& scfiClusters  = frame.get<edm4eic::ClusterCollection>( opt.scfi_clust );
-    auto& scfiHits      = frame.get<edm4eic::CalorimeterHitCollection>( opt.scfi_hits );
-    auto& imageClusters = frame.get<edm4eic::ClusterCollection>( opt.image_clust );
-    auto& imageHits     = frame.get<edm4eic::CalorimeterHitCollection>( opt.image_hits );
+    BHCAL_TIME_STAGE("get collections");
+    auto& genParticles     = frame.get<edm4eic::ReconstructedParticleCollection>( opt.gen_par );
+    auto& allHCalClusters  = frame.get<edm4eic::ClusterCollection>( opt.hcal_clust );
+    auto& allECalClusters  = frame.get<edm4eic::ClusterCollection>( opt.ecal_clust );
+    auto& allScFiClusters  = frame.get<edm4eic::ClusterCollection>( opt.scfi_clust );
+    auto& allScFiHits      = frame.get<edm4eic::CalorimeterHitCollection>( opt.scfi_hits );
+    auto& allImageClusters = frame.get<edm4eic::ClusterCollection>( opt.image_clust );
+    auto& allImageHits     = frame.get<edm4eic::CalorimeterHitCollection>( opt.image_hits );
 
-    // reset output values
-    helper.ResetValues();
+    // ------------------------------------------------------------------------
+    // fill tower grids (if needed)
+    // ------------------------------------------------------------------------
+    // n.b. cones include all hits in the event, not just those
+    // matched to a given primary, so that isolation is meaningful
+    if (opt.do_cones) {
+
+      BHCAL_TIME_STAGE("tower grids");
+      auto& allHCalHits = frame.get<edm4eic::CalorimeterHitCollection>( opt.hcal_hits );
+      BHCAL_COUNT_ITEMS("tower grids", allHCalHits.size() + allImageHits.size());
+
+      hcalTowers.Reset();
+      imageTowers.Reset();
+      for (edm4eic::CalorimeterHit hHit : allHCalHits) {
+        hcalTowers.Add(
+          edm4hep::utils::eta(hHit.getPosition()),
+          edm4hep::utils::angleAzimuthal(hHit.getPosition()),
+          hHit.getEnergy()
+        );
+      }
+      for (edm4eic::CalorimeterHit iHit : allImageHits) {
+        imageTowers.Add(
+          edm4hep::utils::eta(iHit.getPosition()),
+          edm4hep::utils::angleAzimuthal(iHit.getPosition()),
+          iHit.getEnergy()
+        );
+      }
+      hcalTowers.Build();
+      imageTowers.Build();
+    }
 
     // ------------------------------------------------------------------------
     // particle loop
     // ------------------------------------------------------------------------
-    std::optional<edm4eic::ReconstructedParticle> optPrimary = std::nullopt;
+    BHCAL_TIME_STAGE("particle loop");
+    BHCAL_COUNT_ITEMS("particle loop", genParticles.size());
+
+    // n.b. in single-particle mode, only the first primary is kept
+    std::vector<edm4eic::ReconstructedParticle> primaries;
+    std::vector<double>                         parEtas;
+    std::vector<double>                         parPhis;
     for (edm4eic::ReconstructedParticle particle : genParticles) {
       if (particle.getType() == 1) {
-        optPrimary = particle;
-        break;
+        primaries.push_back( particle );
+        parEtas.push_back( edm4hep::utils::eta(particle.getMomentum()) );
+        parPhis.push_back( edm4hep::utils::angleAzimuthal(particle.getMomentum()) );
+        if (!opt.do_multi) break;
       }
     }  // end particle loop
 
     // skip event if no primary found
-    if (!optPrimary.has_value()) {
+    if (primaries.empty()) {
       continue;
     }
-    edm4eic::ReconstructedParticle primary = optPrimary.value();
-
-    // set particle output variables
-    helper.SetVariable( "ePar", primary.getEnergy() );
-
-    // ------------------------------------------------------------------------
-    // hcal cluster loop
-    // ------------------------------------------------------------------------
-    edm4eic::Cluster hLeadClust;
-
-    // find leading cluster, sum energies
-    float eSumHCal  = 0.;
-    float eLeadHCal = 0.;
-    for (edm4eic::Cluster hClust : hcalClusters) {
-
-      if (hClust.getEnergy() > eLeadHCal) {
-        hLeadClust = hClust;
-        eLeadHCal  = hClust.getEnergy();
-      }
-      eSumHCal += hClust.getEnergy();
-
-    }  // end hcal cluster loop
-
-    // fill lead hcal cluster variables
-    helper.SetVariable( "eLeadBHCal", hLeadClust.getEnergy() );
-    helper.SetVariable( "nHitsLeadBHCal", (float) hLeadClust.getHits().size() );
-    helper.SetVariable( "hLeadBHCal", edm4hep::utils::eta(hLeadClust.getPosition()) );
-    helper.SetVariable( "fLeadBHCal", edm4hep::utils::angleAzimuthal(hLeadClust.getPosition()) );
-
-    // fill event-level output variables
-    helper.SetVariable( "eSumBHCal", eSumHCal);
-    helper.SetVariable( "nClustBHCal", (float) hcalClusters.size());
-    helper.SetVariable( "fracParVsSumBHCal", eSumHCal / primary.getEnergy());
-    helper.SetVariable( "fracParVsLeadBHCal", hLeadClust.getEnergy() / primary.getEnergy());
-    helper.SetVariable( "diffSumBHCal", (eSumHCal - primary.getEnergy()) / primary.getEnergy());
-    helper.SetVariable( "diffLeadBHCal", (hLeadClust.getEnergy() - primary.getEnergy()) / primary.getEnergy());
 
     // ------------------------------------------------------------------------
-    // ecal (scfi + imaging) cluster loop
+    // match clusters & hits to primaries
     // ------------------------------------------------------------------------
-    edm4eic::Cluster eLeadClust;
-
-    // loop over combined ecal clusters
-    float eSumECal  = 0.;
-    float eLeadECal = 0.;
-    for (edm4eic::Cluster eClust : ecalClusters) {
-
-      if (eClust.getEnergy() > eLeadECal) {
-        eLeadClust = eClust;
-        eLeadECal  = eClust.getEnergy();
+    BHCAL_TIME_STAGE("particle matching");
+    BHCAL_COUNT_ITEMS(
+      "particle matching",
+      allHCalClusters.size() + allECalClusters.size() + allScFiClusters.size() +
+      allScFiHits.size() + allImageClusters.size() + allImageHits.size()
+    );
+
+    std::vector<std::vector<edm4eic::Cluster>>        hcalByPar;
+    std::vector<std::vector<edm4eic::Cluster>>        ecalByPar;
+    std::vector<std::vector<edm4eic::Cluster>>        scfiByPar;
+    std::vector<std::vector<edm4eic::CalorimeterHit>> scfiHitsByPar;
+    std::vector<std::vector<edm4eic::Cluster>>        imageByPar;
+    std::vector<std::vector<edm4eic::CalorimeterHit>> imageHitsByPar;
+    splitByParticle(allHCalClusters, parEtas, parPhis, hcalByPar);
+    splitByParticle(allECalClusters, parEtas, parPhis, ecalByPar);
+    splitByParticle(allScFiClusters, parEtas, parPhis, scfiByPar);
+    splitByParticle(allScFiHits, parEtas, parPhis, scfiHitsByPar);
+    splitByParticle(allImageClusters, parEtas, parPhis, imageByPar);
+    splitByParticle(allImageHits, parEtas, parPhis, imageHitsByPar);
+
+    // fill a row for each primary
+    for (std::size_t iPar = 0; iPar < primaries.size(); ++iPar) {
+
+      // reset output values
+      helper.ResetValues();
+
+      // grab primary and what's matched to it
+      const edm4eic::ReconstructedParticle&       primary       = primaries[iPar];
+      const std::vector<edm4eic::Cluster>&        hcalClusters  = hcalByPar[iPar];
+      const std::vector<edm4eic::Cluster>&        ecalClusters  = ecalByPar[iPar];
+      const std::vector<edm4eic::Cluster>&        scfiClusters  = scfiByPar[iPar];
+      const std::vector<edm4eic::CalorimeterHit>& scfiHits      = scfiHitsByPar[iPar];
+      const std::vector<edm4eic::Cluster>&        imageClusters = imageByPar[iPar];
+      const std::vector<edm4eic::CalorimeterHit>& imageHits     = imageHitsByPar[iPar];
+
+      // set particle output variables
+      helper.SetVariable( "ePar", primary.getEnergy() );
+
+      // -----------------------------------------------------------------------
+      // hcal cluster loop
+      // -----------------------------------------------------------------------
+      BHCAL_TIME_STAGE("hcal cluster loop");
+      BHCAL_COUNT_ITEMS("hcal cluster loop", hcalClusters.size());
+
+      edm4eic::Cluster hLeadClust;
+
+      // find leading cluster, sum energies
+      float eSumHCal  = 0.;
+      float eLeadHCal = 0.;
+      for (edm4eic::Cluster hClust : hcalClusters) {
+
+        if (hClust.getEnergy() > eLeadHCal) {
+          hLeadClust = hClust;
+          eLeadHCal  = hClust.getEnergy();
+        }
+        eSumHCal += hClust.getEnergy();
+
+      }  // end hcal cluster loop
+
+      // fill lead hcal cluster variables
+      helper.SetVariable( "eLeadBHCal", hLeadClust.getEnergy() );
+      helper.SetVariable( "nHitsLeadBHCal", (float) hLeadClust.getHits().size() );
+      helper.SetVariable( "hLeadBHCal", edm4hep::utils::eta(hLeadClust.getPosition()) );
+      helper.SetVariable( "fLeadBHCal", edm4hep::utils::angleAzimuthal(hLeadClust.getPosition()) );
+
+      // fill event-level output variables
+      helper.SetVariable( "eSumBHCal", eSumHCal);
+      helper.SetVariable( "nClustBHCal", (float) hcalClusters.size());
+      helper.SetVariable( "fracParVsSumBHCal", eSumHCal / primary.getEnergy());
+      helper.SetVariable( "fracParVsLeadBHCal", hLeadClust.getEnergy() / primary.getEnergy());
+      helper.SetVariable( "diffSumBHCal", (eSumHCal - primary.getEnergy()) / primary.getEnergy());
+      helper.SetVariable( "diffLeadBHCal", (hLeadClust.getEnergy() - primary.getEnergy()) / primary.getEnergy());
+
+      // -----------------------------------------------------------------------
+      // ecal (scfi + imaging) cluster loop
+      // -----------------------------------------------------------------------
+      BHCAL_TIME_STAGE("ecal cluster loop");
+      BHCAL_COUNT_ITEMS("ecal cluster loop", ecalClusters.size());
+
+      edm4eic::Cluster eLeadClust;
+
+      // loop over combined ecal clusters
+      float eSumECal  = 0.;
+      float eLeadECal = 0.;
+      for (edm4eic::Cluster eClust : ecalClusters) {
+
+        if (eClust.getEnergy() > eLeadECal) {
+          eLeadClust = eClust;
+          eLeadECal  = eClust.getEnergy();
+        }
+        eSumECal += eClust.getEnergy();
+
+      }  // end combined ecal cluster loop
+
+      // fill lead ecal cluster variables
+      helper.SetVariable( "eLeadBEMC", eLeadClust.getEnergy() );
+      helper.SetVariable( "nHitsLeadBEMC", (float) eLeadClust.getHits().size() );
+      helper.SetVariable( "hLeadBEMC", edm4hep::utils::eta(eLeadClust.getPosition()) );
+      helper.SetVariable( "fLeadBEMC", edm4hep::utils::angleAzimuthal(eLeadClust.getPosition()) );
+
+      // fill event-level output variables
+      helper.SetVariable( "eSumBEMC", eSumECal );
+      helper.SetVariable( "nClustBEMC", (float) ecalClusters.size() );
+      helper.SetVariable( "fracParVsSumBEMC", eSumECal / primary.getEnergy() );
+      helper.SetVariable( "fracParVsLeadBEMC", eLeadClust.getEnergy() / primary.getEnergy() );
+      helper.SetVariable( "fracSumBHCalVsBEMC", eSumECal / (eSumECal + eSumHCal) );
+      helper.SetVariable( "fracLeadBHCalVsBEMC", eLeadClust.getEnergy() / (eLeadClust.getEnergy() + hLeadClust.getEnergy()) );
+      helper.SetVariable( "diffSumBEMC", (eSumECal - primary.getEnergy()) / primary.getEnergy() );
+      helper.SetVariable( "diffLeadBEMC", (eLeadClust.getEnergy() - primary.getEnergy()) / primary.getEnergy() );
+
+      // -----------------------------------------------------------------------
+      // link bemc clusters to bhcal clusters (if needed)
+      // -----------------------------------------------------------------------
+      if (opt.do_link) {
+
+        BHCAL_TIME_STAGE("bhcal-bemc linking");
+        BHCAL_COUNT_ITEMS("bhcal-bemc linking", hcalClusters.size() + ecalClusters.size());
+
+        // index bemc clusters in eta-phi (only if there are any)
+        std::vector<double> ecalEtas;
+        std::vector<double> ecalPhis;
+        for (edm4eic::Cluster eClust : ecalClusters) {
+          ecalEtas.push_back( edm4hep::utils::eta(eClust.getPosition()) );
+          ecalPhis.push_back( edm4hep::utils::angleAzimuthal(eClust.getPosition()) );
+        }
+        std::optional<SpatialIndexHelper::EtaPhiGrid> ecalGrid;
+        if (!ecalClusters.empty()) {
+          ecalGrid.emplace(ecalEtas, ecalPhis, opt.link_cone);
+        }
+
+        // find most energetic linked system, i.e. a bhcal
+        // cluster plus all bemc clusters in its cone
+        float eLinkBHCal = 0.;
+        float eLinkBEMC  = 0.;
+        float nLinkBEMC  = 0.;
+        float hLinkSys   = 0.;
+        float fLinkSys   = 0.;
+        for (edm4eic::Cluster hClust : hcalClusters) {
+
+          const double hEta = edm4hep::utils::eta(hClust.getPosition());
+          const double hPhi = edm4hep::utils::angleAzimuthal(hClust.getPosition());
+
+          // n.b. centroid phi is calculated w.r.t. the bhcal cluster to handle wraparound
+          double eLinked = 0.;
+          double nLinked = 0.;
+          double hWeight = hClust.getEnergy() * hEta;
+          double fWeight = 0.;
+          if (ecalGrid) {
+            ecalGrid -> ForEachInCone(
+              hEta,
+              hPhi,
+              opt.link_cone,
+              [&](const std::size_t iECal, const double) {
+                const double energy = ecalClusters[iECal].getEnergy();
+                eLinked += energy;
+                nLinked += 1.;
+                hWeight += energy * ecalEtas[iECal];
+                fWeight += energy * SpatialIndexHelper::WrapPhi(ecalPhis[iECal] - hPhi);
+              }
+            );
+          }
+
+          const double eSystem = hClust.getEnergy() + eLinked;
+          if ((eSystem > 0.) && (eSystem > (eLinkBHCal + eLinkBEMC))) {
+            eLinkBHCal = hClust.getEnergy();
+            eLinkBEMC  = eLinked;
+            nLinkBEMC  = nLinked;
+            hLinkSys   = hWeight / eSystem;
+            fLinkSys   = SpatialIndexHelper::WrapPhi(hPhi + (fWeight / eSystem));
+          }
+        }  // end hcal cluster loop
+
+        // fill linked system variables
+        helper.SetVariable( "eLinkBHCal", eLinkBHCal );
+        helper.SetVariable( "eLinkBEMC", eLinkBEMC );
+        helper.SetVariable( "eLinkSum", eLinkBHCal + eLinkBEMC );
+        helper.SetVariable( "nLinkBEMC", nLinkBEMC );
+        helper.SetVariable( "hLinkSys", hLinkSys );
+        helper.SetVariable( "fLinkSys", fLinkSys );
       }
-      eSumECal += eClust.getEnergy();
-
-    }  // end combined ecal cluster loop
-
-    // fill lead ecal cluster variables
-    helper.SetVariable( "eLeadBEMC", eLeadClust.getEnergy() );
-    helper.SetVariable( "nHitsLeadBEMC", (float) eLeadClust.getHits().size() );
-    helper.SetVariable( "hLeadBEMC", edm4hep::utils::eta(eLeadClust.getPosition()) );
-    helper.SetVariable( "fLeadBEMC", edm4hep::utils::angleAzimuthal(eLeadClust.getPosition()) );
-
-    // fill event-level output variables
-    helper.SetVariable( "eSumBEMC", eSumECal );
-    helper.SetVariable( "nClustBEMC", (float) ecalClusters.size() );
-    helper.SetVariable( "fracParVsSumBEMC", eSumECal / primary.getEnergy() );
-    helper.SetVariable( "fracParVsLeadBEMC", eLeadClust.getEnergy() / primary.getEnergy() );
-    helper.SetVariable( "fracSumBHCalVsBEMC", eSumECal / (eSumECal + eSumHCal) );
-    helper.SetVariable( "fracLeadBHCalVsBEMC", eLeadClust.getEnergy() / (eLeadClust.getEnergy() + hLeadClust.getEnergy()) );
-    helper.SetVariable( "diffSumBEMC", (eSumECal - primary.getEnergy()) / primary.getEnergy() );
-    helper.SetVariable( "diffLeadBEMC", (eLeadClust.getEnergy() - primary.getEnergy()) / primary.getEnergy() );
-
-    // if no energy in BHCal or BIC, skip event
-    const bool isHCalNonzero = (eSumHCal > 0.);
-    const bool isECalNonzero = (eSumECal > 0.);
-    if (!isHCalNonzero && !isECalNonzero) continue;
-
-    // ------------------------------------------------------------------------
-    // scfi cluster/hit loops
-    // ------------------------------------------------------------------------
-    edm4eic::Cluster sLeadClust;
-
-    // loop over scfi ecal clusters
-    float eSumScFi  = 0.;
-    float eLeadScFi = 0.;
-    for (edm4eic::Cluster sClust : scfiClusters) {
 
-      if (sClust.getEnergy() > eLeadScFi) {
-        sLeadClust = sClust;
-        eLeadScFi  = sClust.getEnergy();
+      // -----------------------------------------------------------------------
+      // cone energies around lead bhcal cluster (if needed)
+      // -----------------------------------------------------------------------
+      if (opt.do_cones && !hcalClusters.empty()) {
+
+        BHCAL_TIME_STAGE("cone sums");
+        BHCAL_COUNT_ITEMS("cone sums", opt.cone_radii.size());
+
+        const double hLead = edm4hep::utils::eta(hLeadClust.getPosition());
+        const double fLead = edm4hep::utils::angleAzimuthal(hLeadClust.getPosition());
+
+        // n.b. isolation = fraction of energy in widest cone outside of narrowest
+        std::vector<double> eConeHCal;
+        std::vector<double> eConeImage;
+        for (const double radius : opt.cone_radii) {
+          eConeHCal.push_back( hcalTowers.GetConeSum(hLead, fLead, radius) );
+          eConeImage.push_back( imageTowers.GetConeSum(hLead, fLead, radius) );
+          helper.SetVariable( "eConeBHCal" + TowerGridHelper::MakeRadiusTag(radius), eConeHCal.back() );
+          helper.SetVariable( "eConeImage" + TowerGridHelper::MakeRadiusTag(radius), eConeImage.back() );
+        }
+        if (!opt.cone_radii.empty()) {
+          helper.SetVariable( "isoBHCal", (eConeHCal.back() > 0.) ? 1. - (eConeHCal.front() / eConeHCal.back()) : 0. );
+          helper.SetVariable( "isoImage", (eConeImage.back() > 0.) ? 1. - (eConeImage.front() / eConeImage.back()) : 0. );
+        }
       }
-      eSumScFi += sClust.getEnergy();
-
-    }  // end scfi cluster loop
-
-    // fill scfi cluster variables
-    helper.SetVariable( "nClustScFi", (float) scfiClusters.size() );
-    helper.SetVariable( "eSumScFi", eSumScFi );
-    helper.SetVariable( "eLeadScFi", sLeadClust.getEnergy() );
-    helper.SetVariable( "hLeadScFi", edm4hep::utils::eta(sLeadClust.getPosition()) );
-    helper.SetVariable( "fLeadScFi", edm4hep::utils::angleAzimuthal(sLeadClust.getPosition()) );
-
-    // loop over scfi hits
-    std::map<int32_t, float> mapScFiSumToLayer;
-    for (edm4eic::CalorimeterHit sRecHit : scfiHits) {
-      mapScFiSumToLayer[ sRecHit.getLayer() ] += sRecHit.getEnergy();
-    }  // end scfi hit loop
-
-    // fill scfi layer variables
-    helper.SetVariable( "eSumScFiLayer1", mapScFiSumToLayer[1] );
-    helper.SetVariable( "eSumScFiLayer2", mapScFiSumToLayer[2] );
-    helper.SetVariable( "eSumScFiLayer3", mapScFiSumToLayer[3] );
-    helper.SetVariable( "eSumScFiLayer4", mapScFiSumToLayer[4] );
-    helper.SetVariable( "eSumScFiLayer5", mapScFiSumToLayer[5] );
-    helper.SetVariable( "eSumScFiLayer6", mapScFiSumToLayer[6] );
-    helper.SetVariable( "eSumScFiLayer7", mapScFiSumToLayer[7] );
-    helper.SetVariable( "eSumScFiLayer8", mapScFiSumToLayer[8] );
-    helper.SetVariable( "eSumScFiLayer9", mapScFiSumToLayer[9] );
-    helper.SetVariable( "eSumScFiLayer10", mapScFiSumToLayer[10] );
-    helper.SetVariable( "eSumScFiLayer11", mapScFiSumToLayer[11] );
-    helper.SetVariable( "eSumScFiLayer12", mapScFiSumToLayer[12] );
 
-    // ------------------------------------------------------------------------
-    // imaging cluster loop
-    // ------------------------------------------------------------------------
-    edm4eic::Cluster iLeadClust;
-
-    // loop over imaging ecal clusters (layers)
-    float eSumImage  = 0.;
-    float eLeadImage = 0.;
-    for (edm4eic::Cluster iClust : imageClusters) {
-
-      if (iClust.getEnergy() > eLeadImage) {
-        iLeadClust = iClust;
-        eLeadImage = iClust.getEnergy();
+      // -----------------------------------------------------------------------
+      // shapes of lead bhcal & bemc clusters (if needed)
+      // -----------------------------------------------------------------------
+      if (opt.do_shapes) {
+
+        BHCAL_TIME_STAGE("cluster shapes");
+        BHCAL_COUNT_ITEMS("cluster shapes", hLeadClust.getHits().size() + eLeadClust.getHits().size());
+
+        // pack hits of lead clusters: bhcal is cluster 0, bemc is cluster 1
+        shapeHits.Clear();
+        for (const edm4eic::Cluster& lead : {hLeadClust, eLeadClust}) {
+          shapeHits.AddCluster( edm4hep::utils::angleAzimuthal(lead.getPosition()) );
+          for (edm4eic::CalorimeterHit hit : lead.getHits()) {
+            shapeHits.AddHit(
+              hit.getEnergy(),
+              edm4hep::utils::eta(hit.getPosition()),
+              edm4hep::utils::angleAzimuthal(hit.getPosition()),
+              std::hypot(hit.getPosition().x, hit.getPosition().y)
+            );
+          }
+        }
+        ClusterShapeHelper::ComputeShapes(shapeHits, shapes);
+
+        // n.b. leave columns at their reset value if there's no cluster
+        const std::vector<float> hShape = shapes[0].GetValues();
+        const std::vector<float> eShape = shapes[1].GetValues();
+        for (std::size_t iVar = 0; iVar < ClusterShapeHelper::Variables.size(); ++iVar) {
+          if (!hcalClusters.empty()) {
+            helper.SetVariable( ClusterShapeHelper::Variables[iVar] + "LeadBHCal", hShape[iVar] );
+          }
+          if (!ecalClusters.empty()) {
+            helper.SetVariable( ClusterShapeHelper::Variables[iVar] + "LeadBEMC", eShape[iVar] );
+          }
+        }
       }
-      eSumImage += iClust.getEnergy();
-
-    }  // end imaging cluster loop
-
-    // fill imaging cluster variables
-    helper.SetVariable( "nClustImage", (float) imageClusters.size() );
-    helper.SetVariable( "eSumImage", eSumImage );
-    helper.SetVariable( "eLeadImage", iLeadClust.getEnergy() );
-    helper.SetVariable( "hLeadImage", edm4hep::utils::eta(iLeadClust.getPosition()) );
-    helper.SetVariable( "fLeadImage", edm4hep::utils::angleAzimuthal(iLeadClust.getPosition()) );
-
-    // loop over scfi hits
-    std::map<int32_t, float> mapImageSumToLayer;
-    for (edm4eic::CalorimeterHit iRecHit : imageHits) {
-      mapImageSumToLayer[ iRecHit.getLayer() ] += iRecHit.getEnergy();
-    }  // end scfi hit loop
-
-    // fill image layer variables
-    helper.SetVariable( "eSumImageLayer1", mapImageSumToLayer[1] );
-    helper.SetVariable( "eSumImageLayer2", mapImageSumToLayer[2] );
-    helper.SetVariable( "eSumImageLayer3", mapImageSumToLayer[3] );
-    helper.SetVariable( "eSumImageLayer4", mapImageSumToLayer[4] );
-    helper.SetVariable( "eSumImageLayer5", mapImageSumToLayer[5] );
-    helper.SetVariable( "eSumImageLayer6", mapImageSumToLayer[6] );
 
-    // ------------------------------------------------------------------------
-    // fill ntuple
-    //  -----------------------------------------------------------------------
-    ntForCalib -> Fill( helper.GetValues().data() );
+      // if no energy in BHCal or BIC, skip event
+      const bool isHCalNonzero = (eSumHCal > 0.);
+      const bool isECalNonzero = (eSumECal > 0.);
+      if (!isHCalNonzero && !isECalNonzero) continue;
+
+      // -----------------------------------------------------------------------
+      // scfi cluster/hit loops
+      // -----------------------------------------------------------------------
+      BHCAL_TIME_STAGE("scfi cluster/hit loops");
+      BHCAL_COUNT_ITEMS("scfi cluster/hit loops", scfiClusters.size() + scfiHits.size());
+
+      edm4eic::Cluster sLeadClust;
+
+      // loop over scfi ecal clusters
+      float eSumScFi  = 0.;
+      float eLeadScFi = 0.;
+      for (edm4eic::Cluster sClust : scfiClusters) {
+
+        if (sClust.getEnergy() > eLeadScFi) {
+          sLeadClust = sClust;
+          eLeadScFi  = sClust.getEnergy();
+        }
+        eSumScFi += sClust.getEnergy();
+
+      }  // end scfi cluster loop
+
+      // fill scfi cluster variables
+      helper.SetVariable( "nClustScFi", (float) scfiClusters.size() );
+      helper.SetVariable( "eSumScFi", eSumScFi );
+      helper.SetVariable( "eLeadScFi", sLeadClust.getEnergy() );
+      helper.SetVariable( "hLeadScFi", edm4hep::utils::eta(sLeadClust.getPosition()) );
+      helper.SetVariable( "fLeadScFi", edm4hep::utils::angleAzimuthal(sLeadClust.getPosition()) );
+
+      // loop over scfi hits
+      std::map<int32_t, float> mapScFiSumToLayer;
+      for (edm4eic::CalorimeterHit sRecHit : scfiHits) {
+        mapScFiSumToLayer[ sRecHit.getLayer() ] += sRecHit.getEnergy();
+      }  // end scfi hit loop
+
+      // fill scfi layer variables
+      helper.SetVariable( "eSumScFiLayer1", mapScFiSumToLayer[1] );
+      helper.SetVariable( "eSumScFiLayer2", mapScFiSumToLayer[2] );
+      helper.SetVariable( "eSumScFiLayer3", mapScFiSumToLayer[3] );
+      helper.SetVariable( "eSumScFiLayer4", mapScFiSumToLayer[4] );
+      helper.SetVariable( "eSumScFiLayer5", mapScFiSumToLayer[5] );
+      helper.SetVariable( "eSumScFiLayer6", mapScFiSumToLayer[6] );
+      helper.SetVariable( "eSumScFiLayer7", mapScFiSumToLayer[7] );
+      helper.SetVariable( "eSumScFiLayer8", mapScFiSumToLayer[8] );
+      helper.SetVariable( "eSumScFiLayer9", mapScFiSumToLayer[9] );
+      helper.SetVariable( "eSumScFiLayer10", mapScFiSumToLayer[10] );
+      helper.SetVariable( "eSumScFiLayer11", mapScFiSumToLayer[11] );
+      helper.SetVariable( "eSumScFiLayer12", mapScFiSumToLayer[12] );
+
+      // -----------------------------------------------------------------------
+      // imaging cluster loop
+      // -----------------------------------------------------------------------
+      BHCAL_TIME_STAGE("imaging cluster/hit loops");
+      BHCAL_COUNT_ITEMS("imaging cluster/hit loops", imageClusters.size() + imageHits.size());
+
+      edm4eic::Cluster iLeadClust;
+
+      // loop over imaging ecal clusters (layers)
+      float eSumImage  = 0.;
+      float eLeadImage = 0.;
+      for (edm4eic::Cluster iClust : imageClusters) {
+
+        if (iClust.getEnergy() > eLeadImage) {
+          iLeadClust = iClust;
+          eLeadImage = iClust.getEnergy();
+        }
+        eSumImage += iClust.getEnergy();
+
+      }  // end imaging cluster loop
+
+      // fill imaging cluster variables
+      helper.SetVariable( "nClustImage", (float) imageClusters.size() );
+      helper.SetVariable( "eSumImage", eSumImage );
+      helper.SetVariable( "eLeadImage", iLeadClust.getEnergy() );
+      helper.SetVariable( "hLeadImage", edm4hep::utils::eta(iLeadClust.getPosition()) );
+      helper.SetVariable( "fLeadImage", edm4hep::utils::angleAzimuthal(iLeadClust.getPosition()) );
+
+      // loop over scfi hits
+      std::map<int32_t, float> mapImageSumToLayer;
+      for (edm4eic::CalorimeterHit iRecHit : imageHits) {
+        mapImageSumToLayer[ iRecHit.getLayer() ] += iRecHit.getEnergy();
+      }  // end scfi hit loop
+
+      // fill image layer variables
+      helper.SetVariable( "eSumImageLayer1", mapImageSumToLayer[1] );
+      helper.SetVariable( "eSumImageLayer2", mapImageSumToLayer[2] );
+      helper.SetVariable( "eSumImageLayer3", mapImageSumToLayer[3] );
+      helper.SetVariable( "eSumImageLayer4", mapImageSumToLayer[4] );
+      helper.SetVariable( "eSumImageLayer5", mapImageSumToLayer[5] );
+      helper.SetVariable( "eSumImageLayer6", mapImageSumToLayer[6] );
+
+      // -----------------------------------------------------------------------
+      // fill ntuple
+      //  ----------------------------------------------------------------------
+      BHCAL_TIME_STAGE("ntuple fill");
+
+      ntForCalib -> Fill( helper.GetValues().data() );
+
+    }  // end primary loop
 
   }  // end frame loop
   std::cout << "    Finished frame loop" << std::endl;
 
   // save output & close files
   output     -> cd();
-  ntForCalib -> Write();
+  ntForCalib -> Write("", TObject::kOverwrite);
+
+  // write timing summary (if enabled)
+  if (TimingHelper::IsEnabled()) {
+    const auto summary = TimingHelper::Registry::Get().GetSummary();
+    TimingHelper::PrintSummary(summary);
+    TimingHelper::WriteJSON(opt.out_file + ".timing.json", "FillBHCalClusterCalibrationTuple", summary);
+    TimingHelper::MakeTree("StageTiming", summary) -> Write();
+  }
+
   output     -> Close();
 
+  // n.b. only clear checkpoint once output is safely closed
+  checkpointer.Finish();
+
   // announce end & exit
   std::cout << "  End of macro!\n" << std::endl;
   return;
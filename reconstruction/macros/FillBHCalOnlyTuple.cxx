@@ -28,23 +28,50 @@
 #include <edm4hep/utils/vector_utils.h>
 // analysis utilities
 #include "../../utility/NTupleHelper.hxx"
+#include "../../utility/TimingHelper.hxx"
+#include "../../utility/CheckpointHelper.hxx"
+#include "../../utility/CompressionProfiles.hxx"
+#include "../../utility/SpatialIndexHelper.hxx"
 
 
 
 // ============================================================================
 //! Struct to consolidate user options
 // ============================================================================
+/*! The output tuple is checkpointed every
+ *  'ckpt_every' frames (0 turns this off). If a
+ *  job dies, rerunning with 'do_resume' on will
+ *  reopen the output and pick up after the last
+ *  checkpoint.
+ *
+ *  By default, only the first primary of each
+ *  event is used and all clusters are attributed
+ *  to it. With 'do_multi' on, a row is filled
+ *  for every primary instead, and each cluster
+ *  is attributed to the nearest primary within
+ *  'match_cone' in eta-phi.
+ */
 struct Options {
   std::string in_file;      // input file
   std::string out_file;     // output file
   std::string gen_par;      // generated particles
   std::string hcal_clust;   // hcal cluster collection
+  bool        do_multi;     // fill a row per primary (multi-particle events)
+  double      match_cone;   // eta-phi cone for matching clusters to primaries
+  std::string comp_profile; // output compression profile
+  uint64_t    ckpt_every;   // no. of frames between checkpoints
+  bool        do_resume;    // resume from last checkpoint (if any)
   bool        do_progress;  // print progress through frame loop
 } DefaultOptions = {
   "./reco/forBHCalOnlyCheck.evt5Ke1pim_central.d31m10y2024.podio.root",
   "forBHCalOnlyCheck.evt5ke1pim_central.d31m10y2024.tuple.root",
   "GeneratedParticles",
   "HcalBarrelClusters",
+  false,
+  0.4,
+  "tuple",
+  10000,
+  false,
   true
 };
 
@@ -77,6 +104,12 @@ void FillBHCalOnlyTuple(const Options& opt = DefaultOptions) {
   // announce start of macro
   std::cout << "\n  Beginning BHCal only tuple-filling macro!" << std::endl;
 
+  // make sure matching cone is sensible
+  if (opt.do_multi && (opt.match_cone <= 0.)) {
+    std::cerr << "PANIC: matching cone must be positive! (match_cone = " << opt.match_cone << ")" << std::endl;
+    assert(opt.match_cone > 0.);
+  }
+
   // --------------------------------------------------------------------------
   // Open input/outputs
   // --------------------------------------------------------------------------
@@ -85,21 +118,46 @@ void FillBHCalOnlyTuple(const Options& opt = DefaultOptions) {
   podio::ROOTFrameReader reader = podio::ROOTFrameReader();
   reader.openFile( opt.in_file );
 
+  // check for checkpoint if resuming
+  CheckpointHelper::State state;
+  bool doResume = false;
+  if (opt.do_resume) {
+    doResume = CheckpointHelper::ReadState(CheckpointHelper::GetStateFile(opt.out_file), state);
+    if (!doResume) {
+      std::cerr << "WARNING: no checkpoint found for " << opt.out_file << "! Starting from first frame." << std::endl;
+    }
+  }
+
   // open output file
-  TFile* output = new TFile(opt.out_file.data(), "recreate");
+  TFile* output = new TFile(opt.out_file.data(), doResume ? "update" : "recreate");
   if (!output) {
     std::cerr << "PANIC: couldn't open output file!" << std::endl;
     assert(output);
   }
 
+  // set compression of output
+  const CompressionProfiles::Profile profile = CompressionProfiles::Get(opt.comp_profile);
+  CompressionProfiles::Apply(output, profile);
+
   // print input/output
   std::cout << "    Opened input/output files:\n"
             << "      input file  = " << opt.in_file << "\n"
             << "      output file = " << opt.out_file
             << std::endl;
 
-  // create output ntuple
-  TNtuple* ntOutput = new TNtuple("ntBHCalOnly", "NTuple for BHCal only plots", helper.CompressVariables().c_str());
+  // create output ntuple (or grab it if resuming)
+  TNtuple* ntOutput = nullptr;
+  if (doResume) {
+    ntOutput = (TNtuple*) output -> Get("ntBHCalOnly");
+    if (!CheckpointHelper::IsConsistent(ntOutput, state, opt.in_file, helper.CompressVariables())) {
+      std::cerr << "PANIC: can't resume from checkpoint! Please rerun without resuming." << std::endl;
+      assert(CheckpointHelper::IsConsistent(ntOutput, state, opt.in_file, helper.CompressVariables()));
+    }
+    std::cout << "    Resuming from frame " << state.next_frame << " (" << state.n_entries << " entries)." << std::endl;
+  } else {
+    ntOutput = new TNtuple("ntBHCalOnly", "NTuple for BHCal only plots", helper.CompressVariables().c_str());
+    CompressionProfiles::Apply(ntOutput, profile);
+  }
 
   // --------------------------------------------------------------------------
   // Loop over input frames
@@ -107,8 +165,23 @@ void FillBHCalOnlyTuple(const Options& opt = DefaultOptions) {
   const uint64_t nFrames = reader.getEntries(podio::Category::Event);
   std::cout << "    Starting frame loop: " << reader.getEntries(podio::Category::Event) << " frames to process." << std::endl;
 
+  // reset stage timers (if enabled)
+  if (TimingHelper::IsEnabled()) {
+    TimingHelper::Registry::Get().Reset();
+  }
+
+  // checkpoint output periodically
+  const uint64_t firstFrame = doResume ? state.next_frame : 0;
+  CheckpointHelper::Checkpointer checkpointer(ntOutput, opt.in_file, opt.out_file, opt.ckpt_every, firstFrame);
+
   // iterate through frames
-  for (uint64_t iFrame = 0; iFrame < nFrames; ++iFrame) {
+  for (uint64_t iFrame = firstFrame; iFrame < nFrames; ++iFrame) {
+
+    // checkpoint all previous frames (if due)
+    checkpointer.Update(iFrame);
+
+    // time stages of frame (if enabled)
+    BHCAL_TIME_STAGES();
 
     // announce progress
     if (opt.do_progress) {
@@ -121,80 +194,131 @@ void FillBHCalOnlyTuple(const Options& opt = DefaultOptions) {
     }
 
     // grab frame
-    auto frame = podio::Frame( reader.readNextEntry(podio::Category::Event) );
+    BHCAL_TIME_STAGE("read frame");
+    auto frame = podio::Frame( reader.readEntry(podio::Category::Event, iFrame) );
 
     // grab needed collections
-    auto& genParticles  = frame.get<edm4eic::ReconstructedParticleCollection>( opt.gen_par );
-    auto& hcalClusters  = frame.get<edm4eic::ClusterCollection>( opt.hcal_clust );
-
-    // reset output values
-    helper.ResetValues();
+    BHCAL_TIME_STAGE("get collections");
+    auto& genParticles    = frame.get<edm4eic::ReconstructedParticleCollection>( opt.gen_par );
+    auto& allHCalClusters = frame.get<edm4eic::ClusterCollection>( opt.hcal_clust );
 
     // ------------------------------------------------------------------------
     // particle loop
     // ------------------------------------------------------------------------
-    std::optional<edm4eic::ReconstructedParticle> optPrimary = std::nullopt;
+    BHCAL_TIME_STAGE("particle loop");
+    BHCAL_COUNT_ITEMS("particle loop", genParticles.size());
+
+    // n.b. in single-particle mode, only the first primary is kept
+    std::vector<edm4eic::ReconstructedParticle> primaries;
+    std::vector<double>                         parEtas;
+    std::vector<double>                         parPhis;
     for (edm4eic::ReconstructedParticle particle : genParticles) {
       if (particle.getType() == 1) {
-        optPrimary = particle;
-        break;
+        primaries.push_back( particle );
+        parEtas.push_back( edm4hep::utils::eta(particle.getMomentum()) );
+        parPhis.push_back( edm4hep::utils::angleAzimuthal(particle.getMomentum()) );
+        if (!opt.do_multi) break;
       }
     }  // end particle loop
 
     // skip event if no primary found
-    if (!optPrimary.has_value()) {
+    if (primaries.empty()) {
       continue;
     }
-    edm4eic::ReconstructedParticle primary = optPrimary.value();
-
-    // set particle output variables
-    helper.SetVariable( "ePar", primary.getEnergy() );
 
     // ------------------------------------------------------------------------
-    // hcal cluster loop
+    // match clusters to primaries
     // ------------------------------------------------------------------------
-    edm4eic::Cluster hLeadClust;
+    BHCAL_TIME_STAGE("particle matching");
+    BHCAL_COUNT_ITEMS("particle matching", allHCalClusters.size());
+
+    // n.b. in single-particle mode, everything goes to the primary
+    std::vector<std::vector<edm4eic::Cluster>> hcalByPar(primaries.size());
+    if (opt.do_multi) {
+      SpatialIndexHelper::SplitByNearest(allHCalClusters, parEtas, parPhis, opt.match_cone, hcalByPar);
+    } else {
+      for (edm4eic::Cluster hClust : allHCalClusters) {
+        hcalByPar.front().push_back( hClust );
+      }
+    }
 
-    // find leading cluster, sum energies
-    float eSumHCal  = 0.;
-    float eLeadHCal = 0.;
-    for (edm4eic::Cluster hClust : hcalClusters) {
+    // fill a row for each primary
+    for (std::size_t iPar = 0; iPar < primaries.size(); ++iPar) {
 
-      if (hClust.getEnergy() > eLeadHCal) {
-        hLeadClust = hClust;
-        eLeadHCal  = hClust.getEnergy();
-      }
-      eSumHCal += hClust.getEnergy();
+      // reset output values
+      helper.ResetValues();
 
-    }  // end hcal cluster loop
+      // grab primary and what's matched to it
+      const edm4eic::ReconstructedParticle& primary      = primaries[iPar];
+      const std::vector<edm4eic::Cluster>&  hcalClusters = hcalByPar[iPar];
 
-    // fill lead hcal cluster variables
-    helper.SetVariable( "eLeadBHCal", hLeadClust.getEnergy() );
-    helper.SetVariable( "nHitsLeadBHCal", (float) hLeadClust.getHits().size() );
-    helper.SetVariable( "hLeadBHCal", edm4hep::utils::eta(hLeadClust.getPosition()) );
-    helper.SetVariable( "fLeadBHCal", edm4hep::utils::angleAzimuthal(hLeadClust.getPosition()) );
+      // set particle output variables
+      helper.SetVariable( "ePar", primary.getEnergy() );
 
-    // fill event-level output variables
-    helper.SetVariable( "eSumBHCal", eSumHCal);
-    helper.SetVariable( "nClustBHCal", (float) hcalClusters.size());
-    helper.SetVariable( "fracParVsSumBHCal", eSumHCal / primary.getEnergy());
-    helper.SetVariable( "fracParVsLeadBHCal", hLeadClust.getEnergy() / primary.getEnergy());
-    helper.SetVariable( "diffSumBHCal", (eSumHCal - primary.getEnergy()) / primary.getEnergy());
-    helper.SetVariable( "diffLeadBHCal", (hLeadClust.getEnergy() - primary.getEnergy()) / primary.getEnergy());
+      // -----------------------------------------------------------------------
+      // hcal cluster loop
+      // -----------------------------------------------------------------------
+      BHCAL_TIME_STAGE("hcal cluster loop");
+      BHCAL_COUNT_ITEMS("hcal cluster loop", hcalClusters.size());
 
-    // ------------------------------------------------------------------------
-    // fill ntuple
-    //  -----------------------------------------------------------------------
-    ntOutput -> Fill( helper.GetValues().data() );
+      edm4eic::Cluster hLeadClust;
+
+      // find leading cluster, sum energies
+      float eSumHCal  = 0.;
+      float eLeadHCal = 0.;
+      for (edm4eic::Cluster hClust : hcalClusters) {
+
+        if (hClust.getEnergy() > eLeadHCal) {
+          hLeadClust = hClust;
+          eLeadHCal  = hClust.getEnergy();
+        }
+        eSumHCal += hClust.getEnergy();
+
+      }  // end hcal cluster loop
+
+      // fill lead hcal cluster variables
+      helper.SetVariable( "eLeadBHCal", hLeadClust.getEnergy() );
+      helper.SetVariable( "nHitsLeadBHCal", (float) hLeadClust.getHits().size() );
+      helper.SetVariable( "hLeadBHCal", edm4hep::utils::eta(hLeadClust.getPosition()) );
+      helper.SetVariable( "fLeadBHCal", edm4hep::utils::angleAzimuthal(hLeadClust.getPosition()) );
+
+      // fill event-level output variables
+      helper.SetVariable( "eSumBHCal", eSumHCal);
+      helper.SetVariable( "nClustBHCal", (float) hcalClusters.size());
+      helper.SetVariable( "fracParVsSumBHCal", eSumHCal / primary.getEnergy());
+      helper.SetVariable( "fracParVsLeadBHCal", hLeadClust.getEnergy() / primary.getEnergy());
+      helper.SetVariable( "diffSumBHCal", (eSumHCal - primary.getEnergy()) / primary.getEnergy());
+      helper.SetVariable( "diffLeadBHCal", (hLeadClust.getEnergy() - primary.getEnergy()) / primary.getEnergy());
+
+      // -----------------------------------------------------------------------
+      // fill ntuple
+      //  ----------------------------------------------------------------------
+      BHCAL_TIME_STAGE("ntuple fill");
+
+      ntOutput -> Fill( helper.GetValues().data() );
+
+    }  // end primary loop
 
   }  // end frame loop
   std::cout << "    Finished frame loop" << std::endl;
 
   // save output & close files
   output   -> cd();
-  ntOutput -> Write();
+  ntOutput -> Write("", TObject::kOverwrite);
+
+  // write timing summary (if enabled)
+  if (TimingHelper::IsEnabled()) {
+    const auto summary = TimingHelper::Registry::Get().GetSummary();
+    TimingHelper::PrintSummary(summary);
+    TimingHelper::WriteJSON(opt.out_file + ".timing.json", "FillBHCalOnlyTuple", summary);
+    TimingHelper::MakeTree("StageTiming", summary) -> Write();
+  }
+
   output   -> Close();
 
+  // n.b. only clear checkpoint once output is safely closed
+  checkpointer.Finish();
+
   // announce end & exit
   std::cout << "  End of macro!\n" << std::endl;
   return;
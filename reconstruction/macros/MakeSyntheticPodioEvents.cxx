@@ -0,0 +1,486 @@
+/// ===========================================================================
+/*! \file   MakeSyntheticPodioEvents.cxx
+ *  \author Derek Anderson
+ *  \date   10.17.2026
+ *
+ *  A ROOT macro to write synthetic `*.podio.root` frames
+ *  which mimic EICrecon output for single particles in
+ *  the BHCal + BIC. Intended to produce arbitrarily large
+ *  local inputs for testing and benchmarking the podio
+ *  macros (e.g. 'FillBHCalClusterCalibrationTuple.cxx',
+ *  'FillBHCalOnlyTuple.cxx', 'FillBHCalHitHistograms.cxx').
+ *
+ *  NOTE: the detector response here is a toy model! It
+ *  only aims to produce plausible multiplicities, energy
+ *  sharing and layer profiles -- not physics results.
+ */
+/// ===========================================================================
+
+#define MakeSyntheticPodioEvents_cxx
+
+// c++ utilities
+#include <map>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <cassert>
+#include <cstdint>
+#include <utility>
+#include <iostream>
+#include <algorithm>
+// root libraries
+#include <TMath.h>
+#include <TSystem.h>
+#include <TRandom3.h>
+#include <TDatabasePDG.h>
+#include <TParticlePDG.h>
+// podio libraries
+#include <podio/Frame.h>
+#include <podio/ROOTFrameWriter.h>
+// edm4eic types
+#include <edm4eic/ClusterCollection.h>
+#include <edm4eic/CalorimeterHitCollection.h>
+#include <edm4eic/ReconstructedParticleCollection.h>
+// edm4hep types
+#include <edm4hep/Vector3f.h>
+
+
+
+// ============================================================================
+//! Struct to consolidate user options
+// ============================================================================
+struct Options {
+  std::string out_file;       // output file
+  uint64_t    num_events;     // no. of events to generate
+  uint32_t    seed;           // rng seed
+  std::string ene_dist;       // particle energy distribution: "flat", "log", or "fixed"
+  float       ene_min;        // min particle energy [GeV] (or fixed energy)
+  float       ene_max;        // max particle energy [GeV]
+  float       eta_min;        // min particle eta
+  float       eta_max;        // max particle eta
+  int32_t     pdg;            // pdg code of primary
+  double      mean_n_other;   // mean no. of additional (non-primary) generated particles
+  double      mean_n_hclust;  // mean no. of additional hcal clusters
+  double      mean_n_eclust;  // mean no. of additional ecal clusters
+  double      hits_per_gev;   // mean no. of hcal hits per GeV deposited
+  double      frac_in_ecal;   // mean fraction of energy deposited in ecal
+  std::string gen_par;        // generated particles
+  std::string hcal_hits;      // hcal hit collection
+  std::string hcal_merged;    // hcal (merged) hit collection
+  std::string hcal_clust;     // hcal cluster collection
+  std::string ecal_clust;     // ecal (scfi + imaging) cluster collection
+  std::string scfi_clust;     // ecal (scfi) cluster collection
+  std::string scfi_hits;      // ecal (scfi) hit collection
+  std::string image_clust;    // ecal (imaging) cluster/layer collection
+  std::string image_hits;     // ecal (imaging) hit collection
+  bool        do_progress;    // print progress through event loop
+} DefaultOptions = {
+  "synthetic.evt1Ke1to20pim_central.podio.root",
+  1000,
+  12345,
+  "flat",
+  1.,
+  20.,
+  -1.1,
+  1.1,
+  -211,
+  0.,
+  1.5,
+  1.5,
+  8.,
+  0.35,
+  "GeneratedParticles",
+  "HcalBarrelRecHits",
+  "HcalBarrelMergedHits",
+  "HcalBarrelClusters",
+  "EcalBarrelClusters",
+  "EcalBarrelScFiClusters",
+  "EcalBarrelScFiRecHits",
+  "EcalBarrelImagingLayers",
+  "EcalBarrelImagingRecHits",
+  true
+};
+
+
+
+// ============================================================================
+//! Toy detector parameters
+// ============================================================================
+namespace SyntheticDetector {
+
+  // radii [mm]
+  const float rHCal  = 1950.;
+  const float rScFi  = 900.;
+  const float rImage = 800.;
+
+  // segmentation
+  const float    dEtaHCal  = 0.1;
+  const float    dEtaECal  = 0.01;
+  const uint32_t nPhiHCal  = 320;
+  const uint32_t nPhiECal  = 1024;
+  const int32_t  nScFiLay  = 12;
+  const int32_t  nImageLay = 6;
+
+  // stochastic terms & transverse spreads
+  const float stochHCal   = 0.50;
+  const float stochECal   = 0.10;
+  const float spreadHCal  = 0.08;
+  const float spreadECal  = 0.02;
+  const float fracInImage = 0.3;
+
+}  // end SyntheticDetector namespace
+
+
+
+// ============================================================================
+//! Write synthetic podio frames
+// ============================================================================
+void MakeSyntheticPodioEvents(const Options& opt = DefaultOptions) {
+
+  // announce start of macro
+  std::cout << "\n  Beginning synthetic podio event generation!" << std::endl;
+
+  // --------------------------------------------------------------------------
+  // Set up rng & output
+  // --------------------------------------------------------------------------
+  TRandom3 rng(opt.seed);
+
+  podio::ROOTFrameWriter writer(opt.out_file);
+  std::cout << "    Opened output file: " << opt.out_file << "\n"
+            << "      seed = " << opt.seed << "\n"
+            << "      energy = " << opt.ene_dist << " in [" << opt.ene_min << ", " << opt.ene_max << "] GeV"
+            << std::endl;
+
+  // --------------------------------------------------------------------------
+  // Look up particle properties
+  // --------------------------------------------------------------------------
+
+  // mass [GeV] & charge [e] of a pdg code
+  //   - n.b. TDatabasePDG stores charge in units of |e|/3
+  auto getMassAndCharge = [](const int32_t pdg) {
+    TParticlePDG* particle = TDatabasePDG::Instance() -> GetParticle(pdg);
+    if (!particle) {
+      std::cerr << "PANIC: pdg code " << pdg << " not found in TDatabasePDG!" << std::endl;
+      assert(particle);
+    }
+    return std::make_pair((float) particle -> Mass(), (float) (particle -> Charge() / 3.));
+  };
+
+  // primary is as set by user, others are always photons
+  const int32_t pdgOther = 22;
+  const auto    mqPar    = getMassAndCharge(opt.pdg);
+  const auto    mqOther  = getMassAndCharge(pdgOther);
+
+  // --------------------------------------------------------------------------
+  // Helper lambdas
+  // --------------------------------------------------------------------------
+
+  // draw particle energy
+  auto drawEnergy = [&]() {
+    float energy = opt.ene_min;
+    if (opt.ene_dist == "flat") {
+      energy = rng.Uniform(opt.ene_min, opt.ene_max);
+    } else if (opt.ene_dist == "log") {
+      energy = std::exp(rng.Uniform(std::log(opt.ene_min), std::log(opt.ene_max)));
+    }
+    return energy;
+  };
+
+  // smear an energy with a stochastic term
+  auto smear = [&](const float energy, const float stoch) {
+    if (energy <= 0.) return 0.f;
+    return std::max(0.f, (float) rng.Gaus(energy, stoch * std::sqrt(energy)));
+  };
+
+  // position on a cylinder of radius r
+  auto getPosition = [](const float eta, const float phi, const float r) {
+    return edm4hep::Vector3f(r * std::cos(phi), r * std::sin(phi), r * std::sinh(eta));
+  };
+
+  // wrap phi into (-pi, pi]
+  auto wrapPhi = [](float phi) {
+    while (phi >  TMath::Pi()) phi -= TMath::TwoPi();
+    while (phi <= -TMath::Pi()) phi += TMath::TwoPi();
+    return phi;
+  };
+
+  // toy cell id: eta index (16 bits), phi index (16 bits), layer (8 bits)
+  auto getCellID = [](const float eta, const float phi, const float dEta, const uint32_t nPhi, const int32_t layer) {
+    const uint64_t iEta = (uint64_t) std::clamp((int) std::floor((eta + 2.) / dEta), 0, 0xffff);
+    const uint64_t iPhi = (uint64_t) std::clamp((int) std::floor((phi + TMath::Pi()) / TMath::TwoPi() * nPhi), 0, (int) nPhi - 1);
+    return (iEta) | (iPhi << 16) | ((uint64_t) layer << 32);
+  };
+
+  // split energy into n random pieces
+  auto split = [&](const float energy, const std::size_t nPieces) {
+    std::vector<float> pieces(nPieces, 0.);
+    float sum = 0.;
+    for (auto& piece : pieces) {
+      piece = rng.Exp(1.);
+      sum  += piece;
+    }
+    for (auto& piece : pieces) {
+      piece *= (sum > 0.) ? (energy / sum) : 0.;
+    }
+    return pieces;
+  };
+
+  // make hits around (eta, phi) & add them to a cluster
+  auto makeHits = [&](
+    edm4eic::CalorimeterHitCollection& hits,
+    edm4eic::MutableCluster& cluster,
+    const float energy,
+    const std::size_t nHits,
+    const float eta,
+    const float phi,
+    const float r,
+    const float spread,
+    const float dEta,
+    const uint32_t nPhi,
+    const int32_t layer
+  ) {
+    for (const float eHit : split(energy, std::max((std::size_t) 1, nHits))) {
+      const float hEta = rng.Gaus(eta, spread);
+      const float hPhi = wrapPhi(rng.Gaus(phi, spread));
+      auto hit = hits.create();
+      hit.setCellID( getCellID(hEta, hPhi, dEta, nPhi, layer) );
+      hit.setEnergy( eHit );
+      hit.setTime( rng.Gaus(10., 1.) );
+      hit.setPosition( getPosition(hEta, hPhi, r) );
+      hit.setLayer( layer );
+      cluster.addToHits( hit );
+    }
+    return;
+  };
+
+  // set cluster kinematics
+  auto setCluster = [&](edm4eic::MutableCluster& cluster, const float energy, const float eta, const float phi, const float r) {
+    cluster.setType( 0 );
+    cluster.setEnergy( energy );
+    cluster.setTime( 10. );
+    cluster.setPosition( getPosition(eta, phi, r) );
+    cluster.setIntrinsicTheta( 2. * std::atan(std::exp(-eta)) );
+    cluster.setIntrinsicPhi( phi );
+    cluster.setNhits( cluster.hits_size() );
+    return;
+  };
+
+  // --------------------------------------------------------------------------
+  // Event loop
+  // --------------------------------------------------------------------------
+  std::cout << "    Starting event loop: " << opt.num_events << " events to generate." << std::endl;
+
+  for (uint64_t iEvent = 0; iEvent < opt.num_events; ++iEvent) {
+
+    // announce progress
+    if (opt.do_progress) {
+      std::cout << "      Generating event " << iEvent + 1 << "/" << opt.num_events << "...";
+      if (iEvent + 1 < opt.num_events) {
+        std::cout << "\r" << std::flush;
+      } else {
+        std::cout << std::endl;
+      }
+    }
+
+    // create collections
+    edm4eic::ReconstructedParticleCollection genParticles;
+    edm4eic::CalorimeterHitCollection        hcalHits;
+    edm4eic::CalorimeterHitCollection        hcalMerged;
+    edm4eic::ClusterCollection               hcalClusters;
+    edm4eic::ClusterCollection               ecalClusters;
+    edm4eic::ClusterCollection               scfiClusters;
+    edm4eic::CalorimeterHitCollection        scfiHits;
+    edm4eic::ClusterCollection               imageClusters;
+    edm4eic::CalorimeterHitCollection        imageHits;
+
+    // ------------------------------------------------------------------------
+    // generated particles
+    // ------------------------------------------------------------------------
+    const float ePar = drawEnergy();
+    const float hPar = rng.Uniform(opt.eta_min, opt.eta_max);
+    const float fPar = rng.Uniform(-TMath::Pi(), TMath::Pi());
+    const float mPar = mqPar.first;
+    const float pPar = std::sqrt(std::max(0.f, (ePar * ePar) - (mPar * mPar)));
+
+    auto primary = genParticles.create();
+    primary.setType( 1 );
+    primary.setPDG( opt.pdg );
+    primary.setCharge( mqPar.second );
+    primary.setMass( mPar );
+    primary.setEnergy( ePar );
+    primary.setMomentum({
+      (float) (pPar * std::cos(fPar) / std::cosh(hPar)),
+      (float) (pPar * std::sin(fPar) / std::cosh(hPar)),
+      (float) (pPar * std::tanh(hPar))
+    });
+
+    const int nOther = rng.Poisson(opt.mean_n_other);
+    for (int iOther = 0; iOther < nOther; ++iOther) {
+      const float eOther = rng.Exp(1.);
+      const float hOther = rng.Uniform(opt.eta_min, opt.eta_max);
+      const float fOther = rng.Uniform(-TMath::Pi(), TMath::Pi());
+      auto other = genParticles.create();
+      other.setType( 0 );
+      other.setPDG( pdgOther );
+      other.setCharge( mqOther.second );
+      other.setMass( mqOther.first );
+      other.setEnergy( eOther );
+      other.setMomentum({
+        (float) (eOther * std::cos(fOther) / std::cosh(hOther)),
+        (float) (eOther * std::sin(fOther) / std::cosh(hOther)),
+        (float) (eOther * std::tanh(hOther))
+      });
+    }
+
+    // ------------------------------------------------------------------------
+    // share energy between ecal & hcal
+    // ------------------------------------------------------------------------
+    const float fracECal = std::clamp((float) rng.Gaus(opt.frac_in_ecal, 0.2), 0.f, 1.f);
+    const float eECal    = smear(ePar * fracECal, SyntheticDetector::stochECal);
+    const float eHCal    = smear(ePar * (1. - fracECal), SyntheticDetector::stochHCal);
+    const float eImage   = eECal * SyntheticDetector::fracInImage;
+    const float eScFi    = eECal - eImage;
+
+    // ------------------------------------------------------------------------
+    // ecal: scfi hits & cluster
+    // ------------------------------------------------------------------------
+    auto sClust = scfiClusters.create();
+    {
+      // longitudinal profile peaks a few layers in
+      std::vector<float> profile(SyntheticDetector::nScFiLay, 0.);
+      float norm = 0.;
+      for (int32_t iLay = 0; iLay < SyntheticDetector::nScFiLay; ++iLay) {
+        profile[iLay] = TMath::GammaDist(iLay + 0.5, 2.5, 0., 2.) * rng.Uniform(0.7, 1.3);
+        norm         += profile[iLay];
+      }
+      for (int32_t iLay = 0; iLay < SyntheticDetector::nScFiLay; ++iLay) {
+        const float eLay = (norm > 0.) ? eScFi * profile[iLay] / norm : 0.;
+        if (eLay <= 0.) continue;
+        makeHits(
+          scfiHits, sClust, eLay,
+          1 + rng.Poisson(3. * eLay),
+          hPar, fPar, SyntheticDetector::rScFi + (10. * iLay),
+          SyntheticDetector::spreadECal, SyntheticDetector::dEtaECal, SyntheticDetector::nPhiECal,
+          iLay + 1
+        );
+      }
+    }
+    setCluster(sClust, eScFi, hPar, fPar, SyntheticDetector::rScFi);
+
+    // ------------------------------------------------------------------------
+    // ecal: imaging hits & layers
+    // ------------------------------------------------------------------------
+    const std::vector<float> eImageLay = split(eImage, SyntheticDetector::nImageLay);
+    for (int32_t iLay = 0; iLay < SyntheticDetector::nImageLay; ++iLay) {
+      const float eLay = eImageLay[iLay];
+      auto iClust = imageClusters.create();
+      makeHits(
+        imageHits, iClust, eLay,
+        1 + rng.Poisson(5. * eLay),
+        hPar, fPar, SyntheticDetector::rImage + (15. * iLay),
+        SyntheticDetector::spreadECal, SyntheticDetector::dEtaECal, SyntheticDetector::nPhiECal,
+        iLay + 1
+      );
+      setCluster(iClust, eLay, hPar, fPar, SyntheticDetector::rImage + (15. * iLay));
+    }
+
+    // ------------------------------------------------------------------------
+    // ecal: combined clusters
+    // ------------------------------------------------------------------------
+    auto eClust = ecalClusters.create();
+    for (auto sHit : scfiHits) {
+      eClust.addToHits(sHit);
+    }
+    setCluster(eClust, eECal, hPar, fPar, SyntheticDetector::rScFi);
+    eClust.addToClusters(sClust);
+
+    const int nExtraECal = rng.Poisson(opt.mean_n_eclust);
+    for (int iExtra = 0; iExtra < nExtraECal; ++iExtra) {
+      const float eExtra = rng.Exp(0.2);
+      const float hExtra = rng.Gaus(hPar, 0.3);
+      const float fExtra = wrapPhi(rng.Gaus(fPar, 0.3));
+      auto extra = ecalClusters.create();
+      makeHits(
+        scfiHits, extra, eExtra,
+        1 + rng.Poisson(2.),
+        hExtra, fExtra, SyntheticDetector::rScFi,
+        SyntheticDetector::spreadECal, SyntheticDetector::dEtaECal, SyntheticDetector::nPhiECal,
+        1 + (int32_t) rng.Integer(SyntheticDetector::nScFiLay)
+      );
+      setCluster(extra, eExtra, hExtra, fExtra, SyntheticDetector::rScFi);
+    }
+
+    // ------------------------------------------------------------------------
+    // hcal: hits & clusters
+    // ------------------------------------------------------------------------
+    auto hClust = hcalClusters.create();
+    makeHits(
+      hcalHits, hClust, eHCal,
+      1 + rng.Poisson(opt.hits_per_gev * eHCal),
+      hPar, fPar, SyntheticDetector::rHCal,
+      SyntheticDetector::spreadHCal, SyntheticDetector::dEtaHCal, SyntheticDetector::nPhiHCal,
+      1
+    );
+    setCluster(hClust, eHCal, hPar, fPar, SyntheticDetector::rHCal);
+
+    const int nExtraHCal = rng.Poisson(opt.mean_n_hclust);
+    for (int iExtra = 0; iExtra < nExtraHCal; ++iExtra) {
+      const float eExtra = rng.Exp(0.3);
+      const float hExtra = rng.Gaus(hPar, 0.4);
+      const float fExtra = wrapPhi(rng.Gaus(fPar, 0.4));
+      auto extra = hcalClusters.create();
+      makeHits(
+        hcalHits, extra, eExtra,
+        1 + rng.Poisson(opt.hits_per_gev * eExtra),
+        hExtra, fExtra, SyntheticDetector::rHCal,
+        SyntheticDetector::spreadHCal, SyntheticDetector::dEtaHCal, SyntheticDetector::nPhiHCal,
+        1
+      );
+      setCluster(extra, eExtra, hExtra, fExtra, SyntheticDetector::rHCal);
+    }
+
+    // merged hits: combine hcal hits sharing a (toy) tower
+    std::map<uint64_t, std::size_t> mapCellToMerged;
+    for (auto hHit : hcalHits) {
+      if (mapCellToMerged.count(hHit.getCellID())) {
+        auto mHit = hcalMerged[ mapCellToMerged[hHit.getCellID()] ];
+        mHit.setEnergy( mHit.getEnergy() + hHit.getEnergy() );
+      } else {
+        mapCellToMerged[hHit.getCellID()] = hcalMerged.size();
+        auto mHit = hcalMerged.create();
+        mHit.setCellID( hHit.getCellID() );
+        mHit.setEnergy( hHit.getEnergy() );
+        mHit.setTime( hHit.getTime() );
+        mHit.setPosition( hHit.getPosition() );
+        mHit.setLayer( hHit.getLayer() );
+      }
+    }
+
+    // ------------------------------------------------------------------------
+    // write frame
+    // ------------------------------------------------------------------------
+    podio::Frame frame;
+    frame.put(std::move(genParticles),  opt.gen_par);
+    frame.put(std::move(hcalHits),      opt.hcal_hits);
+    frame.put(std::move(hcalMerged),    opt.hcal_merged);
+    frame.put(std::move(hcalClusters),  opt.hcal_clust);
+    frame.put(std::move(ecalClusters),  opt.ecal_clust);
+    frame.put(std::move(scfiClusters),  opt.scfi_clust);
+    frame.put(std::move(scfiHits),      opt.scfi_hits);
+    frame.put(std::move(imageClusters), opt.image_clust);
+    frame.put(std::move(imageHits),     opt.image_hits);
+    writer.writeFrame(frame, "events");
+
+  }  // end event loop
+  std::cout << "    Finished event loop." << std::endl;
+
+  // close output
+  writer.finish();
+
+  // announce end & exit
+  std::cout << "  End of macro!\n" << std::endl;
+  return;
+
+}
+
+// end ========================================================================
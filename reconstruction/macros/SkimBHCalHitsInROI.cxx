@@ -0,0 +1,242 @@
+/// ===========================================================================
+/*! \file   SkimBHCalHitsInROI.cxx
+ *  \author Derek Anderson
+ *  \date   10.17.2026
+ *
+ *  A ROOT macro to read EICrecon output (either `*.podio.root` or
+ *  `*.tree.edm4eic.root`) and skim the BHCal, BIC ScFi and BIC
+ *  imaging hits within an eta-phi window around the primary
+ *  particle into a compact hit skim (see 'HitSkimHelper.hxx').
+ */
+/// ===========================================================================
+
+#define SkimBHCalHitsInROI_cxx
+
+// c++ utilities
+#include <string>
+#include <vector>
+#include <cassert>
+#include <cstdint>
+#include <iostream>
+// root libraries
+#include <TFile.h>
+#include <TSystem.h>
+// podio libraries
+#include <podio/Frame.h>
+#include <podio/CollectionBase.h>
+#include <podio/ROOTFrameReader.h>
+// edm4eic types
+#include <edm4eic/CalorimeterHitCollection.h>
+#include <edm4eic/ReconstructedParticleCollection.h>
+// edm4hep types
+#include <edm4hep/Vector3f.h>
+#include <edm4hep/utils/vector_utils.h>
+// analysis utilities
+#include "../../utility/HitSkimHelper.hxx"
+#include "../../utility/CompressionProfiles.hxx"
+
+
+
+// ============================================================================
+//! Struct to consolidate user options
+// ============================================================================
+/*! Hits are kept if they're within 'd_eta' and
+ *  'd_phi' of the first primary of each event;
+ *  events without a primary are dropped. Setting
+ *  a hit collection to "" leaves it out of the
+ *  skim.
+ */
+struct Options {
+  std::string in_file;      // input file
+  std::string out_file;     // output file
+  std::string gen_par;      // generated particles
+  std::string hcal_hits;    // hcal hit collection
+  std::string scfi_hits;    // scfi hit collection
+  std::string image_hits;   // imaging hit collection
+  double      d_eta;        // half-width of window in eta
+  double      d_phi;        // half-width of window in phi
+  std::string comp_profile; // output compression profile
+  bool        do_progress;  // print progress through frame loop
+} DefaultOptions = {
+  "./reco/forBHCalOnlyCheck.evt5Ke1pim_central.d31m10y2024.podio.root",
+  "forBHCalOnlyCheck.evt5Ke1pim_central.d31m10y2024.skim.root",
+  "GeneratedParticles",
+  "HcalBarrelMergedHits",
+  "EcalBarrelScFiRecHits",
+  "EcalBarrelImagingRecHits",
+  0.5,
+  0.5,
+  "tuple",
+  true
+};
+
+
+
+// ============================================================================
+//! Skim BHCal + BIC hits around primary
+// ============================================================================
+void SkimBHCalHitsInROI(const Options& opt = DefaultOptions) {
+
+  // announce start of macro
+  std::cout << "\n  Beginning BHCal hit-skimming macro!" << std::endl;
+
+  // --------------------------------------------------------------------------
+  // Open input/outputs
+  // --------------------------------------------------------------------------
+
+  // open file w/ frame reader
+  podio::ROOTFrameReader reader = podio::ROOTFrameReader();
+  reader.openFile( opt.in_file );
+
+  // open output file
+  TFile* output = new TFile(opt.out_file.data(), "recreate");
+  if (!output) {
+    std::cerr << "PANIC: couldn't open output file!" << std::endl;
+    assert(output);
+  }
+
+  // set compression of output
+  const CompressionProfiles::Profile profile = CompressionProfiles::Get(opt.comp_profile);
+  CompressionProfiles::Apply(output, profile);
+
+  // print input/output
+  std::cout << "    Opened input/output files:\n"
+            << "      input file  = " << opt.in_file << "\n"
+            << "      output file = " << opt.out_file
+            << std::endl;
+
+  // --------------------------------------------------------------------------
+  // Set up skim
+  // --------------------------------------------------------------------------
+
+  // collections to skim (skipping any left empty)
+  std::vector<std::string> tags;
+  std::vector<std::string> collections;
+  if (!opt.hcal_hits.empty()) {
+    tags.push_back("BHCal");
+    collections.push_back(opt.hcal_hits);
+  }
+  if (!opt.scfi_hits.empty()) {
+    tags.push_back("SciFi");
+    collections.push_back(opt.scfi_hits);
+  }
+  if (!opt.image_hits.empty()) {
+    tags.push_back("Image");
+    collections.push_back(opt.image_hits);
+  }
+
+  // create skim tree
+  output -> cd();
+  HitSkimHelper::Writer writer(tags);
+  CompressionProfiles::Apply(writer.GetTree(), profile);
+
+  // for counting hits kept
+  std::vector<uint64_t> nHitsAll(tags.size(), 0);
+  std::vector<uint64_t> nHitsKept(tags.size(), 0);
+
+  // --------------------------------------------------------------------------
+  // Loop over input frames
+  // --------------------------------------------------------------------------
+  const uint64_t nFrames = reader.getEntries(podio::Category::Event);
+  std::cout << "    Starting frame loop: " << reader.getEntries(podio::Category::Event) << " frames to process." << std::endl;
+
+  // iterate through frames
+  uint64_t nSkimmed = 0;
+  for (uint64_t iFrame = 0; iFrame < nFrames; ++iFrame) {
+
+    // announce progress
+    if (opt.do_progress) {
+      std::cout << "      Processing frame " << iFrame + 1 << "/" << nFrames << "...";
+      if (iFrame + 1 < nFrames) {
+        std::cout << "\r" << std::flush;
+      } else {
+        std::cout << std::endl;
+      }
+    }
+
+    // grab frame
+    auto frame = podio::Frame( reader.readNextEntry(podio::Category::Event) );
+
+    // ------------------------------------------------------------------------
+    // particle loop
+    // ------------------------------------------------------------------------
+    auto& genParticles = frame.get<edm4eic::ReconstructedParticleCollection>( opt.gen_par );
+
+    bool   foundPrimary = false;
+    double parEta       = 0.;
+    double parPhi       = 0.;
+    for (edm4eic::ReconstructedParticle particle : genParticles) {
+      if (particle.getType() == 1) {
+        parEta = edm4hep::utils::eta(particle.getMomentum());
+        parPhi = edm4hep::utils::angleAzimuthal(particle.getMomentum());
+        writer.SetParticle(iFrame, particle.getPDG(), particle.getEnergy(), parEta, parPhi);
+        foundPrimary = true;
+        break;
+      }
+    }  // end particle loop
+
+    // skip event if no primary found
+    if (!foundPrimary) {
+      continue;
+    }
+
+    // ------------------------------------------------------------------------
+    // hit loops
+    // ------------------------------------------------------------------------
+    for (std::size_t iColl = 0; iColl < collections.size(); ++iColl) {
+
+      auto& hits = frame.get<edm4eic::CalorimeterHitCollection>( collections[iColl] );
+      for (edm4eic::CalorimeterHit hit : hits) {
+
+        // check if hit is in window
+        const bool inWindow = HitSkimHelper::IsInWindow(
+          edm4hep::utils::eta( hit.getPosition() ),
+          edm4hep::utils::angleAzimuthal( hit.getPosition() ),
+          parEta,
+          parPhi,
+          opt.d_eta,
+          opt.d_phi
+        );
+        if (!inWindow) continue;
+
+        writer.AddHit(
+          iColl,
+          hit.getCellID(),
+          hit.getEnergy(),
+          hit.getPosition().x,
+          hit.getPosition().y,
+          hit.getPosition().z
+        );
+        ++nHitsKept[iColl];
+
+      }  // end hit loop
+      nHitsAll[iColl] += hits.size();
+
+    }  // end collection loop
+
+    // fill skim
+    writer.Fill();
+    ++nSkimmed;
+
+  }  // end frame loop
+  std::cout << "    Finished frame loop: skimmed " << nSkimmed << " events." << std::endl;
+
+  // print no. of hits kept
+  for (std::size_t iColl = 0; iColl < collections.size(); ++iColl) {
+    std::cout << "      " << collections[iColl] << ": kept "
+              << nHitsKept[iColl] << "/" << nHitsAll[iColl] << " hits"
+              << std::endl;
+  }
+
+  // save output & close files
+  output -> cd();
+  writer.Write();
+  output -> Close();
+
+  // announce end & exit
+  std::cout << "  End of macro!\n" << std::endl;
+  return;
+
+}
+
+// end ========================================================================
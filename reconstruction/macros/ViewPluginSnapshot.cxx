@@ -0,0 +1,159 @@
+/// ===========================================================================
+/*! \file   ViewPluginSnapshot.cxx
+ *  \author Derek Anderson
+ *  \date   10.17.2026
+ *
+ *  A ROOT macro to attach to the live snapshots
+ *  published by 'FillBHCalClusterCalibrationTupleProcessor'
+ *  (see 'utility/SnapshotHelper.hxx') and draw them,
+ *  so a running job can be checked without waiting
+ *  for it to finish.
+ */
+/// ===========================================================================
+
+#define ViewPluginSnapshot_cxx
+
+// c++ utilities
+#include <cmath>
+#include <ctime>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <iostream>
+#include <algorithm>
+// root libraries
+#include <TH1D.h>
+#include <TFile.h>
+#include <TCanvas.h>
+#include <TSystem.h>
+// analysis utilities
+#include "../../utility/SnapshotHelper.hxx"
+
+
+
+// ============================================================================
+//! Struct to consolidate user options
+// ============================================================================
+/*! Every 'refresh' seconds, the latest snapshot
+ *  is redrawn, up to 'n_updates' times (0 runs
+ *  until the macro is interrupted). If 'out_file'
+ *  is set, the last snapshot drawn is also saved
+ *  there, and if 'out_image' is set the canvas is
+ *  saved as an image after every update (e.g. for
+ *  viewing on a remote node).
+ */
+struct Options {
+  std::string snap_file;  // snapshot file published by plugin
+  double      refresh;    // seconds between updates
+  uint64_t    n_updates;  // no. of updates (0 = forever)
+  std::string out_file;   // output file for last snapshot (optional)
+  std::string out_image;  // image of canvas (optional)
+  bool        do_log;     // draw histograms with log y-axis
+} DefaultOptions = {
+  "bhcal_calib.snapshot",
+  10.,
+  0,
+  "",
+  "",
+  false
+};
+
+
+
+// ============================================================================
+//! View snapshots published by plugin
+// ============================================================================
+void ViewPluginSnapshot(const Options& opt = DefaultOptions) {
+
+  // announce start of macro
+  std::cout << "\n  Beginning snapshot viewer macro!" << std::endl;
+
+  // --------------------------------------------------------------------------
+  // Attach to snapshot file
+  // --------------------------------------------------------------------------
+
+  // n.b. the plugin may not have started yet, so keep trying
+  SnapshotHelper::Reader reader;
+  while (!reader.Attach(opt.snap_file)) {
+    std::cout << "    Waiting for " << opt.snap_file << "..." << std::endl;
+    gSystem -> Sleep((UInt_t) (1000. * opt.refresh));
+    if (gSystem -> ProcessEvents()) return;
+  }
+  std::cout << "    Attached to " << opt.snap_file << "." << std::endl;
+
+  // --------------------------------------------------------------------------
+  // Update loop
+  // --------------------------------------------------------------------------
+  TCanvas* canvas = nullptr;
+
+  std::vector<TH1D*>                vecHists;
+  std::vector<SnapshotHelper::Item> vecItems;
+  uint64_t                          nLastSeen = 0;
+  for (uint64_t iUpdate = 0; (opt.n_updates == 0) || (iUpdate < opt.n_updates); ++iUpdate) {
+
+    // grab latest snapshot, skip if nothing new
+    uint64_t nPublished = 0;
+    double   tPublished = 0.;
+    const bool isRead = reader.Read(vecItems, nPublished, tPublished);
+    if (isRead && (nPublished != nLastSeen)) {
+      nLastSeen = nPublished;
+
+      // rebuild histograms and print counters
+      for (TH1D* hist : vecHists) delete hist;
+      vecHists.clear();
+
+      char              tString[32];
+      const std::time_t tStamp = (std::time_t) tPublished;
+      std::strftime(tString, sizeof(tString), "%Y-%m-%d %H:%M:%S", std::localtime(&tStamp));
+      std::cout << "    Snapshot " << nPublished << " (published " << tString << "):" << std::endl;
+      for (const SnapshotHelper::Item& item : vecItems) {
+        if (item.kind == SnapshotHelper::Kind::Histogram) {
+          vecHists.push_back( item.MakeHistogram("_snapshot") );
+        } else {
+          std::cout << "      " << item.name << " = " << item.values.front() << std::endl;
+        }
+      }
+
+      // create canvas on first snapshot
+      if (!canvas) {
+        const int nColumns = (int) std::ceil(std::sqrt((double) vecHists.size()));
+        const int nRows    = (nColumns > 0) ? (int) std::ceil((double) vecHists.size() / nColumns) : 1;
+        canvas = new TCanvas("cSnapshot", "Plugin snapshot", 400 * std::max(nColumns, 1), 300 * nRows);
+        canvas -> Divide(std::max(nColumns, 1), nRows);
+      }
+
+      // draw histograms
+      for (std::size_t iHist = 0; iHist < vecHists.size(); ++iHist) {
+        canvas -> cd(iHist + 1);
+        gPad   -> SetLogy(opt.do_log);
+        vecHists[iHist] -> Draw("hist");
+      }
+      canvas -> Update();
+      if (!opt.out_image.empty()) {
+        canvas -> SaveAs(opt.out_image.data());
+      }
+    }
+
+    // wait for next update
+    if ((opt.n_updates == 0) || ((iUpdate + 1) < opt.n_updates)) {
+      gSystem -> Sleep((UInt_t) (1000. * opt.refresh));
+    }
+    if (gSystem -> ProcessEvents()) break;
+
+  }  // end update loop
+
+  // save last snapshot (if needed)
+  if (!opt.out_file.empty() && !vecHists.empty()) {
+    TFile* output = new TFile(opt.out_file.data(), "recreate");
+    for (TH1D* hist : vecHists) hist -> Write();
+    output -> Close();
+    std::cout << "    Saved last snapshot to " << opt.out_file << "." << std::endl;
+  }
+
+  // announce end & exit
+  std::cout << "  End of macro!\n" << std::endl;
+  return;
+
+}
+
+// end ========================================================================
@@ -0,0 +1,276 @@
+// ----------------------------------------------------------------------------
+// 'CalibratedBHCalClusterFactory.cc'
+// Derek Anderson
+// 10.17.2026
+//
+// A JANA factory which applies a pre-trained TMVA
+// calibration to the combined BHCal+BIC response
+// during reconstruction and emits a collection of
+// calibrated clusters.
+// ----------------------------------------------------------------------------
+
+// c++ utilities
+#include <cmath>
+#include <string>
+#include <algorithm>
+#include <stdexcept>
+// root libraries
+#include <TXMLEngine.h>
+// jana includes
+#include <JANA/JApplication.h>
+#include <JANA/JFactoryGenerator.h>
+// user includes
+#include "CalibratedBHCalClusterFactory.h"
+
+// The following just makes this a JANA plugin
+extern "C" {
+  void InitPlugin(JApplication *app) {
+    InitJANAPlugin(app);
+    app -> Add(new JFactoryGeneratorT<CalibratedBHCalClusterFactory>());
+  }
+}
+
+
+
+//-------------------------------------------
+// Init
+//-------------------------------------------
+void CalibratedBHCalClusterFactory::Init() {
+
+  // grab parameters
+  auto app = GetApplication();
+  app -> SetDefaultParameter("BHCALCALIB:method",      m_method,      "TMVA method to evaluate (e.g. LD, MLP, BDTG)");
+  app -> SetDefaultParameter("BHCALCALIB:weights",     m_weights,     "Path to the TMVA weights file of the method");
+  app -> SetDefaultParameter("BHCALCALIB:hcalClust",   m_hcal_clust,  "BHCal cluster collection");
+  app -> SetDefaultParameter("BHCALCALIB:ecalClust",   m_ecal_clust,  "BIC (scfi + imaging) cluster collection");
+  app -> SetDefaultParameter("BHCALCALIB:scfiHits",    m_scfi_hits,   "BIC (scfi) hit collection");
+  app -> SetDefaultParameter("BHCALCALIB:imageHits",   m_image_hits,  "BIC (imaging) hit collection");
+
+  // make sure a weights file was provided
+  if (m_weights.empty()) {
+    throw std::runtime_error("CalibratedBHCalClusterFactory: no weights file provided! Set -PBHCALCALIB:weights=<file>");
+  }
+
+  // read training variables & spectators off of the weights file
+  ReadWeightsVariables();
+
+  // create map between feature name and position in vector
+  m_values.resize( m_features.size(), 0. );
+  m_specValues.resize( m_spectators.size(), 0. );
+  for (std::size_t iFeature = 0; iFeature < m_features.size(); ++iFeature) {
+    m_index[ m_features[iFeature] ] = iFeature;
+  }
+
+  // create reader once and keep it around: the weights file is
+  // only parsed here rather than on every event
+  m_reader = std::make_unique<TMVA::Reader>("!Color:Silent");
+  for (std::size_t iFeature = 0; iFeature < m_features.size(); ++iFeature) {
+    m_reader -> AddVariable(m_features[iFeature].data(), &m_values[iFeature]);
+  }
+
+  // spectators aren't used in evaluation, but the reader
+  // needs them declared if the model was trained with them
+  for (std::size_t iSpec = 0; iSpec < m_spectators.size(); ++iSpec) {
+    m_reader -> AddSpectator(m_spectators[iSpec].data(), &m_specValues[iSpec]);
+  }
+  m_reader -> BookMVA(m_method + " method", m_weights);
+  return;
+
+}  // end 'Init()'
+
+
+
+//-------------------------------------------
+// Process
+//-------------------------------------------
+void CalibratedBHCalClusterFactory::Process(const std::shared_ptr<const JEvent>& event) {
+
+  // grab input collections
+  auto hcalClusters = event -> Get<edm4eic::Cluster>(m_hcal_clust);
+  auto ecalClusters = event -> Get<edm4eic::Cluster>(m_ecal_clust);
+  auto scfiHits     = event -> Get<edm4eic::CalorimeterHit>(m_scfi_hits);
+  auto imageHits    = event -> Get<edm4eic::CalorimeterHit>(m_image_hits);
+
+  // output collection
+  edm4eic::ClusterCollection calibClusters;
+
+  // find leading clusters
+  const edm4eic::Cluster* hLeadClust = nullptr;
+  const edm4eic::Cluster* eLeadClust = nullptr;
+  for (const auto* hClust : hcalClusters) {
+    if (!hLeadClust || (hClust -> getEnergy() > hLeadClust -> getEnergy())) {
+      hLeadClust = hClust;
+    }
+  }
+  for (const auto* eClust : ecalClusters) {
+    if (!eLeadClust || (eClust -> getEnergy() > eLeadClust -> getEnergy())) {
+      eLeadClust = eClust;
+    }
+  }
+
+  // if no energy in BHCal or BIC, emit an empty collection
+  if (!hLeadClust && !eLeadClust) {
+    SetCollection(std::move(calibClusters));
+    return;
+  }
+
+  // calculate features & evaluate model
+  CalculateFeatures(hLeadClust, eLeadClust, scfiHits, imageHits);
+  const float eCalib = m_reader -> EvaluateRegression(0, m_method + " method");
+
+  // create calibrated cluster: position & shape taken
+  // from the leading cluster of the dominant calorimeter
+  const edm4eic::Cluster* seed = hLeadClust;
+  if (!seed || (eLeadClust && (eLeadClust -> getEnergy() > seed -> getEnergy()))) {
+    seed = eLeadClust;
+  }
+
+  // carry the relative uncertainty on the raw lead
+  // energies over to the calibrated energy
+  const float eRaw    = (hLeadClust ? hLeadClust -> getEnergy() : 0.) + (eLeadClust ? eLeadClust -> getEnergy() : 0.);
+  const float varRaw  = (hLeadClust ? std::pow(hLeadClust -> getEnergyError(), 2) : 0.) + (eLeadClust ? std::pow(eLeadClust -> getEnergyError(), 2) : 0.);
+  const float eCalErr = (eRaw > 0.) ? std::abs(eCalib) * (std::sqrt(varRaw) / eRaw) : 0.;
+
+  auto calib = calibClusters.create();
+  calib.setType( seed -> getType() );
+  calib.setEnergy( eCalib );
+  calib.setEnergyError( eCalErr );
+  calib.setTime( seed -> getTime() );
+  calib.setTimeError( seed -> getTimeError() );
+  calib.setPosition( seed -> getPosition() );
+  calib.setPositionError( seed -> getPositionError() );
+  calib.setIntrinsicTheta( seed -> getIntrinsicTheta() );
+  calib.setIntrinsicPhi( seed -> getIntrinsicPhi() );
+  calib.setIntrinsicDirectionError( seed -> getIntrinsicDirectionError() );
+
+  // link back to the clusters that went into the calibration
+  unsigned int nHits = 0;
+  if (hLeadClust) {
+    calib.addToClusters( *hLeadClust );
+    nHits += hLeadClust -> getNhits();
+  }
+  if (eLeadClust) {
+    calib.addToClusters( *eLeadClust );
+    nHits += eLeadClust -> getNhits();
+  }
+  calib.setNhits( nHits );
+
+  SetCollection(std::move(calibClusters));
+  return;
+
+}  // end 'Process(std::shared_ptr<JEvent>&)'
+
+
+
+//-------------------------------------------
+// ReadWeightsVariables
+//-------------------------------------------
+/*! Pulls the list of training variables (in
+ *  training order) and spectators out of the
+ *  TMVA weights file, and checks that every
+ *  training variable can be calculated here.
+ */
+void CalibratedBHCalClusterFactory::ReadWeightsVariables() {
+
+  TXMLEngine xml;
+  XMLDocPointer_t doc = xml.ParseFile(m_weights.data());
+  if (!doc) {
+    throw std::runtime_error("CalibratedBHCalClusterFactory: couldn't parse weights file '" + m_weights + "'!");
+  }
+
+  // collect 'Expression' attribute of each child of
+  // the <Variables> and <Spectators> nodes
+  XMLNodePointer_t top = xml.DocGetRootElement(doc);
+  for (XMLNodePointer_t node = xml.GetChild(top); node; node = xml.GetNext(node)) {
+    const std::string name = xml.GetNodeName(node);
+    if ((name != "Variables") && (name != "Spectators")) continue;
+
+    std::vector<std::string>& list = (name == "Variables") ? m_features : m_spectators;
+    for (XMLNodePointer_t var = xml.GetChild(node); var; var = xml.GetNext(var)) {
+      list.push_back( xml.GetAttr(var, "Expression") );
+    }
+  }
+  xml.FreeDoc(doc);
+
+  if (m_features.empty()) {
+    throw std::runtime_error("CalibratedBHCalClusterFactory: no training variables found in '" + m_weights + "'!");
+  }
+
+  // make sure each training variable is something we know how to calculate
+  for (const std::string& feature : m_features) {
+    const bool isLead  = (feature == "eLeadBHCal") || (feature == "eLeadBEMC");
+    const bool isScFi  = (feature.rfind("eSumScFiLayer", 0) == 0);
+    const bool isImage = (feature.rfind("eSumImageLayer", 0) == 0);
+    if (!isLead && !isScFi && !isImage) {
+      throw std::runtime_error("CalibratedBHCalClusterFactory: training variable '" + feature + "' can't be calculated in-line!");
+    }
+  }
+  return;
+
+}  // end 'ReadWeightsVariables()'
+
+
+
+//-------------------------------------------
+// SetFeature
+//-------------------------------------------
+void CalibratedBHCalClusterFactory::SetFeature(const std::string& feature, const float value) {
+
+  // features not used in training are silently dropped
+  if (m_index.count(feature)) {
+    m_values[ m_index[feature] ] = value;
+  }
+  return;
+
+}  // end 'SetFeature(std::string&, float)'
+
+
+
+//-------------------------------------------
+// CalculateFeatures
+//-------------------------------------------
+/*! Mirrors the definitions used in
+ *  'FillBHCalClusterCalibrationTuple.cxx'
+ *  so that the model sees the same inputs
+ *  it was trained on.
+ */
+void CalibratedBHCalClusterFactory::CalculateFeatures(
+  const edm4eic::Cluster* hLeadClust,
+  const edm4eic::Cluster* eLeadClust,
+  const std::vector<const edm4eic::CalorimeterHit*>& scfiHits,
+  const std::vector<const edm4eic::CalorimeterHit*>& imageHits
+) {
+
+  // reset features
+  std::fill(m_values.begin(), m_values.end(), 0.);
+
+  // leading bhcal & bic cluster energies (found in 'Process()')
+  SetFeature("eLeadBHCal", hLeadClust ? hLeadClust -> getEnergy() : 0.);
+  SetFeature("eLeadBEMC",  eLeadClust ? eLeadClust -> getEnergy() : 0.);
+
+  // scfi & imaging layer sums
+  float eSumScFiLayer[CONST::NSciFiLayer]  = {0.};
+  float eSumImageLayer[CONST::NImageLayer] = {0.};
+  for (const auto* sHit : scfiHits) {
+    const int iLayer = sHit -> getLayer() - 1;
+    if ((iLayer >= 0) && (iLayer < CONST::NSciFiLayer)) {
+      eSumScFiLayer[iLayer] += sHit -> getEnergy();
+    }
+  }
+  for (const auto* iHit : imageHits) {
+    const int iLayer = iHit -> getLayer() - 1;
+    if ((iLayer >= 0) && (iLayer < CONST::NImageLayer)) {
+      eSumImageLayer[iLayer] += iHit -> getEnergy();
+    }
+  }
+  for (std::size_t iLayer = 0; iLayer < CONST::NSciFiLayer; ++iLayer) {
+    SetFeature("eSumScFiLayer" + std::to_string(iLayer + 1), eSumScFiLayer[iLayer]);
+  }
+  for (std::size_t iLayer = 0; iLayer < CONST::NImageLayer; ++iLayer) {
+    SetFeature("eSumImageLayer" + std::to_string(iLayer + 1), eSumImageLayer[iLayer]);
+  }
+  return;
+
+}  // end 'CalculateFeatures(...)'
+
+// end ------------------------------------------------------------------------
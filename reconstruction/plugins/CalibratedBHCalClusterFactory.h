@@ -0,0 +1,91 @@
+// ----------------------------------------------------------------------------
+// 'CalibratedBHCalClusterFactory.h'
+// Derek Anderson
+// 10.17.2026
+//
+// A JANA factory which applies a pre-trained TMVA
+// calibration to the combined BHCal+BIC response
+// during reconstruction and emits a collection of
+// calibrated clusters.
+// ----------------------------------------------------------------------------
+
+#ifndef CalibratedBHCalClusterFactory_h
+#define CalibratedBHCalClusterFactory_h
+
+// c++ utilities
+#include <map>
+#include <string>
+#include <vector>
+#include <memory>
+// tmva components
+#include <TMVA/Reader.h>
+// jana includes
+#include <JANA/JEvent.h>
+#include <JANA/Podio/JFactoryPodioT.h>
+// edm includes
+#include <edm4eic/Cluster.h>
+#include <edm4eic/ClusterCollection.h>
+#include <edm4eic/CalorimeterHit.h>
+
+
+
+// CalibratedBHCalClusterFactory definition -----------------------------------
+
+class CalibratedBHCalClusterFactory : public JFactoryPodioT<edm4eic::Cluster> {
+
+  // global constants
+  enum CONST {
+    NSciFiLayer = 12,
+    NImageLayer = 6
+  };
+
+  private:
+
+    // input collections (same as the tuple filler)
+    std::string m_hcal_clust  = "HcalBarrelClusters";
+    std::string m_ecal_clust  = "EcalBarrelClusters";
+    std::string m_scfi_hits   = "EcalBarrelScFiRecHits";
+    std::string m_image_hits  = "EcalBarrelImagingRecHits";
+
+    // model parameters
+    std::string m_method  = "LD";
+    std::string m_weights = "";
+
+    // training variables & spectators, read from the
+    // weights file so they always match the trained model
+    std::vector<std::string> m_features;
+    std::vector<std::string> m_spectators;
+
+    // cached model & feature vector
+    std::vector<float>                 m_values;
+    std::vector<float>                 m_specValues;
+    std::map<std::string, std::size_t> m_index;
+    std::unique_ptr<TMVA::Reader>      m_reader;
+
+    // helper methods
+    void ReadWeightsVariables();
+    void SetFeature(const std::string& feature, const float value);
+    void CalculateFeatures(
+      const edm4eic::Cluster* hLeadClust,
+      const edm4eic::Cluster* eLeadClust,
+      const std::vector<const edm4eic::CalorimeterHit*>& scfiHits,
+      const std::vector<const edm4eic::CalorimeterHit*>& imageHits
+    );
+
+  public:
+
+    // ctor
+    CalibratedBHCalClusterFactory() {
+      SetTag("HcalBarrelCalibratedClusters");
+      SetTypeName(NAME_OF_THIS);
+    }
+
+    // inherited methods
+    void Init() override;
+    void Process(const std::shared_ptr<const JEvent>& event) override;
+
+};  // end CalibratedBHCalClusterFactory definition
+
+#endif
+
+// end ------------------------------------------------------------------------
@@ -11,10 +11,15 @@
 // C includes
 #include <vector>
 #include <string>
+#include <iostream>
+#include <algorithm>
 #include <boost/math/special_functions/sign.hpp>
 // eicrecon includes 
 #include <services/rootfile/RootFile_service.h>
 // user includes
+#include "GraphHelper.hxx"
+#include "TimingHelper.hxx"
+#include "CompressionProfiles.hxx"
 #include "FillBHCalClusterCalibrationTupleProcessor.h"
 
 // The following just makes this a JANA plugin
@@ -27,6 +32,98 @@ extern "C" {
 
 
 
+//-------------------------------------------
+// Init
+//-------------------------------------------
+void FillBHCalClusterCalibrationTupleProcessor::Init() {
+
+  rootLock = GetApplication() -> GetService<JGlobalRootLock>();
+  rootLock -> acquire_write_lock();
+  try {
+    InitWithGlobalRootLock();
+  } catch (...) {
+    rootLock -> release_lock();
+    throw;
+  }
+  rootLock -> release_lock();
+  return;
+
+}  // end 'Init()'
+
+
+
+//-------------------------------------------
+// Process
+//-------------------------------------------
+void FillBHCalClusterCalibrationTupleProcessor::Process(const std::shared_ptr<const JEvent>& event) {
+
+  // calculate tuple row and moments without the lock: collections
+  // are made here, and the row only goes to this thread's buffer
+  TupleRow      row;
+  ThreadBuffer& buffer = GetThreadBuffer();
+  const bool    hasRow = CalculateTupleRow(event, row);
+  if (hasRow) {
+    buffer.events.push_back( event -> GetEventNumber() );
+    buffer.rows.insert(buffer.rows.end(), row.begin(), row.end());
+    if (doMoments) {
+      FillMoments(
+        buffer,
+        row[0],
+        {
+          row[7],
+          row[8],
+          row[9],
+          row[10],
+          row[7] + row[8],
+          row[9] + row[10]
+        }
+      );
+    }
+  }
+
+  // histograms and the ntuple are shared, so
+  // only touch them with the global root lock held
+  rootLock -> acquire_write_lock();
+  const auto tLock = std::chrono::steady_clock::now();
+  try {
+    ProcessSequential(event);
+    if (hasRow) {
+      ++nTupleRows;
+    }
+    if ((tupleBufferRows > 0) && (buffer.events.size() >= tupleBufferRows)) {
+      SpillTuple(buffer);
+    }
+  } catch (...) {
+    rootLock -> release_lock();
+    throw;
+  }
+  RecordLockHeld(tLock);
+  rootLock -> release_lock();
+  return;
+
+}  // end 'Process(std::shared_ptr<JEvent>&)'
+
+
+
+//-------------------------------------------
+// Finish
+//-------------------------------------------
+void FillBHCalClusterCalibrationTupleProcessor::Finish() {
+
+  rootLock -> acquire_write_lock();
+  try {
+    FinishWithGlobalRootLock();
+  } catch (...) {
+    rootLock -> release_lock();
+    throw;
+  }
+  rootLock -> release_lock();
+  return;
+
+}  // end 'Finish()'
+
+
+
 //-------------------------------------------
 // InitWithGlobalRootLock
 //-------------------------------------------
@@ -37,6 +134,26 @@ void FillBHCalClusterCalibrationTupleProcessor::InitWithGlobalRootLock(){
   auto rootfile     = rootfile_svc     -> GetHistFile();
   rootfile -> mkdir("FillBHCalCalibrationTuple") -> cd();
 
+  // get parameters
+  auto app = GetApplication();
+  app -> SetDefaultParameter("FillBHCalCalibrationTuple:doMoments",  doMoments,  "Accumulate resolution/linearity moments in bins of particle energy");
+  app -> SetDefaultParameter("FillBHCalCalibrationTuple:momentBins", momentBins, "Edges of particle energy bins for moments [GeV]");
+  app -> SetDefaultParameter("FillBHCalCalibrationTuple:doMatching", doMatching, "Match reco to truth clusters by shared cells");
+  app -> SetDefaultParameter("FillBHCalCalibrationTuple:matchFrac",  matchFrac,  "Min. fraction of truth cluster energy for a reco cluster to match it");
+  app -> SetDefaultParameter("FillBHCalCalibrationTuple:splitFrac",  splitFrac,  "Min. fraction of energy shared for a cluster to count as split/merged");
+  app -> SetDefaultParameter("FillBHCalCalibrationTuple:sortTuple",       sortTuple,       "Fill tuple in order of event number at finish (set tupleBufferRows = 0 to sort the whole tuple)");
+  app -> SetDefaultParameter("FillBHCalCalibrationTuple:tupleBufferRows", tupleBufferRows, "Max. no. of tuple rows buffered per thread before spilling to tuple (0 = no limit)");
+  app -> SetDefaultParameter("FillBHCalCalibrationTuple:compProfile",     compProfile,     "Compression profile of tuple (see CompressionProfiles.hxx)");
+  app -> SetDefaultParameter("FillBHCalCalibrationTuple:snapshotFile",    snapshotFile,    "File to publish live snapshots of histograms to (off if empty)");
+  app -> SetDefaultParameter("FillBHCalCalibrationTuple:snapshotPeriod",  snapshotPeriod,  "Seconds between live snapshots");
+
+  // make sure moment bins are sensible
+  const bool areBinsSorted = std::is_sorted(momentBins.begin(), momentBins.end());
+  if (doMoments && ((momentBins.size() < 2) || !areBinsSorted)) {
+    std::cerr << "WARNING: need at least 2 increasing bin edges for moments! Not accumulating moments." << std::endl;
+    doMoments = false;
+  }
+
   // initialize bhcal histograms
   const unsigned long nNumBin(200);
   const unsigned long nChrgBin(6);
@@ -48,6 +165,7 @@ void FillBHCalClusterCalibrationTupleProcessor::InitWithGlobalRootLock(){
   const unsigned long nPosTrBin(800);
   const unsigned long nPosLoBin(30);
   const unsigned long nDiffBin(200);
+  const unsigned long nFracBin(110);
   const unsigned long rNumBin[CONST::NRange]   = {0,      200};
   const double        rChrgBin[CONST::NRange]  = {-3.,    3.};
   const double        rMassBin[CONST::NRange]  = {0.,     5.};
@@ -58,6 +176,7 @@ void FillBHCalClusterCalibrationTupleProcessor::InitWithGlobalRootLock(){
   const double        rPosTrBin[CONST::NRange] = {-4000., 4000.};
   const double        rPosLoBin[CONST::NRange] = {-3000., 3000.};
   const double        rDiffBin[CONST::NRange]  = {-5.,    5.};
+  const double        rFracBin[CONST::NRange]  = {-0.05,  1.05};
   // particle histograms
   hParChrg                   = new TH1D("hParChrg",     "Gen. Particles", nChrgBin, rChrgBin[0], rChrgBin[1]);
   hParMass                   = new TH1D("hParMass",     "Gen. Particles", nMassBin, rMassBin[0], rMassBin[1]);
@@ -145,6 +264,14 @@ void FillBHCalClusterCalibrationTupleProcessor::InitWithGlobalRootLock(){
   hEvtHCalLeadTruClustEne    = new TH1D("hEvtHCalLeadTruClustEne",    "Barrel HCal", nEneBin,  rEneBin[0],  rEneBin[1]);
   hEvtHCalLeadTruClustDiff   = new TH1D("hEvtHCalLeadTruClustDiff",   "Barrel HCal", nDiffBin, rDiffBin[0], rDiffBin[1]);
   hEvtHCalLeadTruClustVsPar  = new TH2D("hEvtHCalLeadTruClustVsPar",  "Barrel HCal", nEneBin,  rEneBin[0],  rEneBin[1], nEneBin, rEneBin[0], rEneBin[1]);
+  // bhcal reco-truth matching histograms
+  hHCalTruClustBestFrac      = new TH1D("hHCalTruClustBestFrac",      "Barrel HCal", nFracBin, rFracBin[0], rFracBin[1]);
+  hEvtHCalMatchEff           = new TH1D("hEvtHCalMatchEff",           "Barrel HCal", nFracBin, rFracBin[0], rFracBin[1]);
+  hEvtHCalMatchPur           = new TH1D("hEvtHCalMatchPur",           "Barrel HCal", nFracBin, rFracBin[0], rFracBin[1]);
+  hEvtHCalSplitRate          = new TH1D("hEvtHCalSplitRate",          "Barrel HCal", nFracBin, rFracBin[0], rFracBin[1]);
+  hEvtHCalMergeRate          = new TH1D("hEvtHCalMergeRate",          "Barrel HCal", nFracBin, rFracBin[0], rFracBin[1]);
+  hEvtHCalMatchEffVsPar      = new TH2D("hEvtHCalMatchEffVsPar",      "Barrel HCal", nEneBin,  rEneBin[0],  rEneBin[1], nFracBin, rFracBin[0], rFracBin[1]);
+  hEvtHCalMatchPurVsPar      = new TH2D("hEvtHCalMatchPurVsPar",      "Barrel HCal", nEneBin,  rEneBin[0],  rEneBin[1], nFracBin, rFracBin[0], rFracBin[1]);
   // bhcal particle errors
   hParChrg                   -> Sumw2();
   hParMass                   -> Sumw2();
@@ -231,6 +358,14 @@ void FillBHCalClusterCalibrationTupleProcessor::InitWithGlobalRootLock(){
   hEvtHCalLeadTruClustEne    -> Sumw2();
   hEvtHCalLeadTruClustDiff   -> Sumw2();
   hEvtHCalLeadTruClustVsPar  -> Sumw2();
+  // bhcal reco-truth matching errors
+  hHCalTruClustBestFrac      -> Sumw2();
+  hEvtHCalMatchEff           -> Sumw2();
+  hEvtHCalMatchPur           -> Sumw2();
+  hEvtHCalSplitRate          -> Sumw2();
+  hEvtHCalMergeRate          -> Sumw2();
+  hEvtHCalMatchEffVsPar      -> Sumw2();
+  hEvtHCalMatchPurVsPar      -> Sumw2();
 
   // initialize becal histograms
   const unsigned long nLayerBin(50);
@@ -406,6 +541,12 @@ void FillBHCalClusterCalibrationTupleProcessor::InitWithGlobalRootLock(){
 
   // ntuple for calibration
   ntForCalibration = new TNtuple("ntForCalibration", "For Calibration", argCalibVars.c_str());
+  CompressionProfiles::Apply(ntForCalibration, CompressionProfiles::Get(compProfile));
+
+  // start publishing live snapshots (if needed)
+  if (!snapshotFile.empty()) {
+    StartSnapshots();
+  }
   return;
 
 }  // end 'InitWithGlobalRootLock()'
@@ -418,29 +559,46 @@ void FillBHCalClusterCalibrationTupleProcessor::InitWithGlobalRootLock(){
 //-------------------------------------------
 void FillBHCalClusterCalibrationTupleProcessor::ProcessSequential(const std::shared_ptr<const JEvent>& event) {
 
-  // clear array for ntuple
-  for (size_t iCalibVar = 0; iCalibVar < NCalibVars; iCalibVar++) {
-    varsForCalibration[iCalibVar] = 0.;
+  // time stages of event (if enabled)
+  BHCAL_TIME_STAGES();
+
+  // publish snapshot of previous events (if due)
+  if (snapshots.IsDue()) {
+    BHCAL_TIME_STAGE("snapshot");
+    PublishSnapshot();
   }
 
+  BHCAL_TIME_STAGE("get collections");
+
+  // grab collections (n.b. already made in Process)
+  const auto genParticles       = event -> Get<edm4eic::ReconstructedParticle>("GeneratedParticles");
+  const auto bhcalRecHits       = event -> Get<edm4eic::CalorimeterHit>("HcalBarrelRecHits");
+  const auto bhcalClusters      = event -> Get<edm4eic::Cluster>("HcalBarrelClusters");
+  const auto bhcalTruthClusters = event -> Get<edm4eic::Cluster>("HcalBarrelTruthClusters");
+  const auto scifiRecHits       = event -> Get<edm4eic::CalorimeterHit>("EcalBarrelScFiRecHits");
+  const auto imageRecHits       = event -> Get<edm4eic::CalorimeterHit>("EcalBarrelImagingRecHits");
+  const auto bemcClusters       = event -> Get<edm4eic::Cluster>("EcalBarrelImagingMergedClusters");
+
   // hit and cluster sums
   double eHCalHitSum(0.);
   double eHCalClustSum(0.);
   double eECalClustSum(0.);
-  double eImageClustSum(0.);
-  double eSciFiClustSum(0.);
   double eTruHCalClustSum(0.);
 
+  BHCAL_TIME_STAGE("bhcal hit sum");
+  BHCAL_COUNT_ITEMS("bhcal hit sum", bhcalRecHits.size());
+
   // sum bhcal hit energy
-  for (auto bhCalHit : bhcalRecHits()) {
+  for (auto bhCalHit : bhcalRecHits) {
     eHCalHitSum += bhCalHit -> getEnergy();
   }  // end 1st bhcal hit loop
 
   // if hit sum is 0, skip event
   const bool isHCalHitSumNonzero = (eHCalHitSum > 0.);
-  if (!isHCalHitSumNonzero) {
-    return;
-  }
+  if (!isHCalHitSumNonzero) return;
+
+  BHCAL_TIME_STAGE("particle loop");
+  BHCAL_COUNT_ITEMS("particle loop", genParticles.size());
 
   // MC particle properties
   float  cMcPar(0.);
@@ -453,7 +611,7 @@ void FillBHCalClusterCalibrationTupleProcessor::ProcessSequential(const std::sha
 
   // particle loop
   unsigned long nPar(0);
-  for (auto par : genParticles()) {
+  for (auto par : genParticles) {
 
     // grab particle properties
     const auto typePar = par -> getType();
@@ -495,9 +653,12 @@ void FillBHCalClusterCalibrationTupleProcessor::ProcessSequential(const std::sha
   hParMomZ     -> Fill(pMcPar[2]);
   hParEtaVsPhi -> Fill(fMcPar, hMcPar);
 
+  BHCAL_TIME_STAGE("bhcal hit loop");
+  BHCAL_COUNT_ITEMS("bhcal hit loop", bhcalRecHits.size());
+
   // reco. bhcal hit loop
   unsigned long nHCalHit(0);
-  for (auto bhCalHit : bhcalRecHits()) {
+  for (auto bhCalHit : bhcalRecHits) {
 
     // grab hit properties
     const auto rHCalHitX   = bhCalHit -> getPosition().x;
@@ -523,13 +684,14 @@ void FillBHCalClusterCalibrationTupleProcessor::ProcessSequential(const std::sha
     ++nHCalHit;
   }  // end 2nd bhcal hit loop
 
+  BHCAL_TIME_STAGE("bhcal cluster loop");
+  BHCAL_COUNT_ITEMS("bhcal cluster loop", bhcalClusters.size());
+
   // for highest energy bhcal clusters
   int    iLeadHCalClust(-1);
   int    iLeadTruHCalClust(-1);
   int    nHitLeadHCalClust(-1);
   int    nHitLeadTruHCalClust(-1);
-  double hLeadHCalClust(-999.);
-  double fLeadHCalClust(-999.);
   double eLeadHCalClust(-999.);
   double eLeadTruHCalClust(-999.);
   double diffLeadHCalClust(-999.);
@@ -542,7 +704,7 @@ void FillBHCalClusterCalibrationTupleProcessor::ProcessSequential(const std::sha
   unsigned long iHCalClust(0);
   unsigned long nHCalProto(0);
   unsigned long nHCalClust(0);
-  for (auto bhCalClust : bhcalClusters()) {
+  for (auto bhCalClust : bhcalClusters) {
 
     // grab cluster properties
     const auto rHCalClustX   = bhCalClust -> getPosition().x;
@@ -620,13 +782,14 @@ void FillBHCalClusterCalibrationTupleProcessor::ProcessSequential(const std::sha
     if (isBiggerEne) {
       iLeadHCalClust    = iHCalClust;
       nHitLeadHCalClust = nHitHCalClust;
-      hLeadHCalClust    = hHCalClust;
-      fLeadHCalClust    = fHCalClust;
       eLeadHCalClust    = eHCalClust;
       diffLeadHCalClust = diffHCalClust;
     }
   }  // end reco. bhcal cluster loop
 
+  BHCAL_TIME_STAGE("bhcal truth cluster loop");
+  BHCAL_COUNT_ITEMS("bhcal truth cluster loop", bhcalTruthClusters.size());
+
   // get truth protoclusters
   auto bhCalTruProtoClusters = event -> Get<edm4eic::ProtoCluster>("HcalBarrelTruthProtoClusters");
 
@@ -634,7 +797,7 @@ void FillBHCalClusterCalibrationTupleProcessor::ProcessSequential(const std::sha
   unsigned long iTruHCalClust(0);
   unsigned long nTruHCalProto(0);
   unsigned long nTruHCalClust(0);
-  for (auto truthHCalClust : bhcalTruthClusters()) {
+  for (auto truthHCalClust : bhcalTruthClusters) {
 
     // grab cluster properties
     const auto rTruHCalClustX   = truthHCalClust -> getPosition().x;
@@ -713,6 +876,16 @@ void FillBHCalClusterCalibrationTupleProcessor::ProcessSequential(const std::sha
     ++iTruHCalClust;
   }  // end true bhcal cluster loop
 
+  // match reco to truth clusters (if needed)
+  if (doMatching) {
+    BHCAL_TIME_STAGE("bhcal cluster matching");
+    BHCAL_COUNT_ITEMS("bhcal cluster matching", bhcalClusters.size() + bhcalTruthClusters.size());
+    FillMatching(bhcalClusters, bhcalTruthClusters, eMcPar);
+  }
+
+  BHCAL_TIME_STAGE("bemc hit loops");
+  BHCAL_COUNT_ITEMS("bemc hit loops", scifiRecHits.size() + imageRecHits.size());
+
   // for scifi/image hit sums
   double eSciFiHitSum(0.);
   double eImageHitSum(0.);
@@ -728,7 +901,7 @@ void FillBHCalClusterCalibrationTupleProcessor::ProcessSequential(const std::sha
 
   // reco. scifi hit loop
   unsigned long nSciFiHit(0);
-  for (auto scifiHit : scifiRecHits()) {
+  for (auto scifiHit : scifiRecHits) {
 
     // grab hit properties
     const auto nLayerSciFi  = scifiHit -> getLayer();
@@ -764,7 +937,7 @@ void FillBHCalClusterCalibrationTupleProcessor::ProcessSequential(const std::sha
 
   // reco. image hit loop
   unsigned long nImageHit(0);
-  for (auto imageHit : imageRecHits()) {
+  for (auto imageHit : imageRecHits) {
 
     // grab hit properties
     const auto nLayerImage  = imageHit -> getLayer();
@@ -798,34 +971,19 @@ void FillBHCalClusterCalibrationTupleProcessor::ProcessSequential(const std::sha
     ++nImageHit;
   }  // end scifi hit loop
 
+  BHCAL_TIME_STAGE("bemc cluster loops");
+  BHCAL_COUNT_ITEMS("bemc cluster loops", bemcClusters.size());
+
   // for highest energy bemc clusters
   int    iLeadECalClust(-1);
-  int    iLeadSciFiClust(-1);
-  int    iLeadImageClust(-1);
   int    nHitLeadECalClust(-1);
-  int    nHitLeadImageClust(-1);
-  int    nHitLeadSciFiClust(-1);
-  double hLeadECalClust(-999.);
-  double hLeadImageClust(-999.);
-  double hLeadSciFiClust(-999.);
-  double fLeadECalClust(-999.);
-  double fLeadImageClust(-999.);
-  double fLeadSciFiClust(-999.);
   double eLeadECalClust(-999.);
-  double eLeadImageClust(0.);
-  double eLeadSciFiClust(0.);
   double diffLeadECalClust(-999.);
-  double diffLeadImageClust(-999.);
-  double diffLeadSciFiClust(-999.);
 
   // reco. bemc cluster loop
   unsigned long iECalClust(0);
-  unsigned long iImageClust(0);
-  unsigned long iSciFiClust(0);
   unsigned long nECalClust(0);
-  unsigned long nImageClust(0);
-  unsigned long nSciFiClust(0);
-  for (auto bemcClust : bemcClusters()) {
+  for (auto bemcClust : bemcClusters) {
 
     // grab cluster properties
     const auto rECalClustX   = bemcClust -> getPosition().x;
@@ -861,90 +1019,14 @@ void FillBHCalClusterCalibrationTupleProcessor::ProcessSequential(const std::sha
     if (isBiggerEne) {
       iLeadECalClust    = iECalClust;
       nHitLeadECalClust = nHitECalClust;
-      hLeadECalClust    = hECalClust;
-      fLeadECalClust    = fECalClust;
       eLeadECalClust    = eECalClust;
       diffLeadECalClust = diffECalClust;
     }
   }  // end reco. bemc cluster loop
 
-  // loop over scifi clusters
-  for (auto scifiClust : scifiClusters()) {
-
-    // grab cluster properties
-    const auto rSciFiClustX   = scifiClust -> getPosition().x;
-    const auto rSciFiClustY   = scifiClust -> getPosition().y;
-    const auto rSciFiClustZ   = scifiClust -> getPosition().z;
-    const auto eSciFiClust    = scifiClust -> getEnergy();
-    const auto nHitSciFiClust = scifiClust -> getNhits();
-    const auto tSciFiClust    = scifiClust -> getIntrinsicTheta();
-    const auto diffSciFiClust = (eSciFiClust - eMcPar) / eMcPar;
-
-    // calculate cluster eta, phi
-    // FIXME update to XYZvectors
-    const TVector3 vecPosition(rSciFiClustX, rSciFiClustY, rSciFiClustZ);
-    const auto     hSciFiClust = vecPosition.Eta();
-    const auto     fSciFiClust = vecPosition.Phi();
-
-    // increment counters
-    eSciFiClustSum += eSciFiClust;
-    ++nSciFiClust;
-    ++iSciFiClust;
-
-    // select leading cluster
-    const bool isBiggerEne = (eSciFiClust > eLeadSciFiClust);
-    if (isBiggerEne) {
-      iLeadSciFiClust    = iSciFiClust;
-      nHitLeadSciFiClust = nHitSciFiClust;
-      hLeadSciFiClust    = hSciFiClust;
-      fLeadSciFiClust    = fSciFiClust;
-      eLeadSciFiClust    = eSciFiClust;
-      diffLeadSciFiClust = diffSciFiClust;
-    }
-  }  // end scifi cluster loop
-
-  // loop over imaging clusters
-  for (auto imageClust : imageClusters()) {
-
-    // grab cluster properties
-    const auto rImageClustX   = imageClust -> getPosition().x;
-    const auto rImageClustY   = imageClust -> getPosition().y;
-    const auto rImageClustZ   = imageClust -> getPosition().z;
-    const auto eImageClust    = imageClust -> getEnergy();
-    const auto nHitImageClust = imageClust -> getNhits();
-    const auto tImageClust    = imageClust -> getIntrinsicTheta();
-    const auto diffImageClust = (eImageClust - eMcPar) / eMcPar;
-
-    // calculate cluster eta, phi
-    // FIXME update to XYZvectors
-    const TVector3 vecPosition(rImageClustX, rImageClustY, rImageClustZ);
-    const auto     hImageClust = vecPosition.Eta();
-    const auto     fImageClust = vecPosition.Phi();
-
-    // increment counters
-    eImageClustSum += eImageClust;
-    ++nImageClust;
-    ++iImageClust;
-
-    // select leading cluster
-    const bool isBiggerEne = (eImageClust > eLeadImageClust);
-    if (isBiggerEne) {
-      iLeadImageClust    = iImageClust;
-      nHitLeadImageClust = nHitImageClust;
-      hLeadImageClust    = hImageClust;
-      fLeadImageClust    = fImageClust;
-      eLeadImageClust    = eImageClust;
-      diffLeadImageClust = diffImageClust;
-    }
-  }  // end imaging cluster loop
+  BHCAL_TIME_STAGE("event histograms");
 
   // do event-wise calculations
-  const auto fracParVsLeadHCal   = eLeadHCalClust / eMcPar;
-  const auto fracParVsLeadECal   = eLeadECalClust / eMcPar;
-  const auto fracParVsSumHCal    = eHCalClustSum / eMcPar;
-  const auto fracParVsSumECal    = eECalClustSum / eMcPar;
-  const auto fracLeadHCalVsECal  = eLeadECalClust / (eLeadHCalClust + eLeadECalClust);
-  const auto fracSumHCalVsECal   = eECalClustSum / (eHCalClustSum + eECalClustSum);
   const auto diffHCalHitSum      = (eHCalHitSum - eMcPar) / eMcPar;
   const auto diffHCalClustSum    = (eHCalClustSum - eMcPar) / eMcPar;
   const auto diffECalClustSum    = (eECalClustSum - eMcPar) / eMcPar;
@@ -1007,61 +1089,6 @@ void FillBHCalClusterCalibrationTupleProcessor::ProcessSequential(const std::sha
   hEvtECalLeadClustVsPar     -> Fill(eMcPar,         eLeadECalClust);
   hEvtECalVsHCalLeadClustEne -> Fill(eLeadHCalClust, eLeadECalClust);
 
-  // set variables for calibration tuple
-  varsForCalibration[0]  = (Float_t) eMcPar;
-  varsForCalibration[1]  = (Float_t) fracParVsLeadHCal;
-  varsForCalibration[2]  = (Float_t) fracParVsLeadECal;
-  varsForCalibration[3]  = (Float_t) fracParVsSumHCal;
-  varsForCalibration[4]  = (Float_t) fracParVsSumECal;
-  varsForCalibration[5]  = (Float_t) fracLeadHCalVsECal;
-  varsForCalibration[6]  = (Float_t) fracSumHCalVsECal;
-  varsForCalibration[7]  = (Float_t) eLeadHCalClust;
-  varsForCalibration[8]  = (Float_t) eLeadECalClust;
-  varsForCalibration[9]  = (Float_t) eHCalClustSum;
-  varsForCalibration[10] = (Float_t) eECalClustSum;
-  varsForCalibration[11] = (Float_t) diffLeadHCalClust;
-  varsForCalibration[12] = (Float_t) diffLeadECalClust;
-  varsForCalibration[13] = (Float_t) diffHCalClustSum;
-  varsForCalibration[14] = (Float_t) diffECalClustSum;
-  varsForCalibration[15] = (Float_t) nHitLeadHCalClust;
-  varsForCalibration[16] = (Float_t) nHitLeadECalClust;
-  varsForCalibration[17] = (Float_t) nHCalClust;
-  varsForCalibration[18] = (Float_t) nECalClust;
-  varsForCalibration[19] = (Float_t) hLeadHCalClust;
-  varsForCalibration[20] = (Float_t) hLeadECalClust;
-  varsForCalibration[21] = (Float_t) fLeadHCalClust;
-  varsForCalibration[22] = (Float_t) fLeadECalClust;
-  varsForCalibration[23] = (Float_t) eLeadImageClust;
-  varsForCalibration[24] = (Float_t) eImageClustSum;
-  varsForCalibration[25] = (Float_t) eLeadSciFiClust;
-  varsForCalibration[26] = (Float_t) eSciFiClustSum;
-  varsForCalibration[27] = (Float_t) nSciFiClust;
-  varsForCalibration[28] = (Float_t) nImageClust;
-  varsForCalibration[29] = (Float_t) hLeadImageClust;
-  varsForCalibration[30] = (Float_t) hLeadSciFiClust;
-  varsForCalibration[31] = (Float_t) fLeadImageClust;
-  varsForCalibration[32] = (Float_t) fLeadSciFiClust;
-  varsForCalibration[33] = (Float_t) eSciFiHitSumVsNLayer[0];
-  varsForCalibration[34] = (Float_t) eSciFiHitSumVsNLayer[1];
-  varsForCalibration[35] = (Float_t) eSciFiHitSumVsNLayer[2];
-  varsForCalibration[36] = (Float_t) eSciFiHitSumVsNLayer[3];
-  varsForCalibration[37] = (Float_t) eSciFiHitSumVsNLayer[4];
-  varsForCalibration[38] = (Float_t) eSciFiHitSumVsNLayer[5];
-  varsForCalibration[39] = (Float_t) eSciFiHitSumVsNLayer[6];
-  varsForCalibration[40] = (Float_t) eSciFiHitSumVsNLayer[7];
-  varsForCalibration[41] = (Float_t) eSciFiHitSumVsNLayer[8];
-  varsForCalibration[42] = (Float_t) eSciFiHitSumVsNLayer[9];
-  varsForCalibration[43] = (Float_t) eSciFiHitSumVsNLayer[10];
-  varsForCalibration[44] = (Float_t) eSciFiHitSumVsNLayer[11];
-  varsForCalibration[45] = (Float_t) eImageHitSumVsNLayer[0];
-  varsForCalibration[46] = (Float_t) eImageHitSumVsNLayer[1];
-  varsForCalibration[47] = (Float_t) eImageHitSumVsNLayer[2];
-  varsForCalibration[48] = (Float_t) eImageHitSumVsNLayer[3];
-  varsForCalibration[49] = (Float_t) eImageHitSumVsNLayer[4];
-  varsForCalibration[50] = (Float_t) eImageHitSumVsNLayer[5];
-
-  // fill tuple
-  ntForCalibration -> Fill(varsForCalibration);
   return;
 
 }  // end 'ProcessSequential(std::shared_ptr<JEvent>&)'
@@ -1129,6 +1156,12 @@ void FillBHCalClusterCalibrationTupleProcessor::FinishWithGlobalRootLock() {
   const TString sEneTruClustLeadDiff("#DeltaE^{lead/truth}_{clust} / E^{lead/truth}_{clust} = (E^{lead/truth} _{clust} - E_{par}) / E^{lead/truth}_{clust} [GeV]");
   const TString sNumHitTruClust("N_{hit} per truth cluster");
   const TString sNumTruClustEvt("N_{truth clust} per event");
+  // matching titles
+  const TString sBestFrac("max_{reco} e^{shared}_{clust} / e^{truth}_{clust}");
+  const TString sMatchEff("#varepsilon_{match} = N^{matched}_{truth clust} / N_{truth clust}");
+  const TString sMatchPur("purity = #Sigmamax_{truth} e^{shared}_{clust} / #Sigmae_{clust}");
+  const TString sSplitRate("N^{split}_{truth clust} / N_{truth clust}");
+  const TString sMergeRate("N^{merged}_{clust} / N_{clust}");
 
   // set particle axis titles
   hParChrg                   -> GetXaxis() -> SetTitle(sCharge.Data());
@@ -1295,6 +1328,23 @@ void FillBHCalClusterCalibrationTupleProcessor::FinishWithGlobalRootLock() {
   hEvtHCalLeadTruClustVsPar  -> GetXaxis() -> SetTitle(sEnePar.Data());
   hEvtHCalLeadTruClustVsPar  -> GetYaxis() -> SetTitle(sEneTruClustLead.Data());
   hEvtHCalLeadTruClustVsPar  -> GetZaxis() -> SetTitle(sCount.Data());
+  // set reco-truth matching axis titles
+  hHCalTruClustBestFrac      -> GetXaxis() -> SetTitle(sBestFrac.Data());
+  hHCalTruClustBestFrac      -> GetYaxis() -> SetTitle(sCount.Data());
+  hEvtHCalMatchEff           -> GetXaxis() -> SetTitle(sMatchEff.Data());
+  hEvtHCalMatchEff           -> GetYaxis() -> SetTitle(sCount.Data());
+  hEvtHCalMatchPur           -> GetXaxis() -> SetTitle(sMatchPur.Data());
+  hEvtHCalMatchPur           -> GetYaxis() -> SetTitle(sCount.Data());
+  hEvtHCalSplitRate          -> GetXaxis() -> SetTitle(sSplitRate.Data());
+  hEvtHCalSplitRate          -> GetYaxis() -> SetTitle(sCount.Data());
+  hEvtHCalMergeRate          -> GetXaxis() -> SetTitle(sMergeRate.Data());
+  hEvtHCalMergeRate          -> GetYaxis() -> SetTitle(sCount.Data());
+  hEvtHCalMatchEffVsPar      -> GetXaxis() -> SetTitle(sEnePar.Data());
+  hEvtHCalMatchEffVsPar      -> GetYaxis() -> SetTitle(sMatchEff.Data());
+  hEvtHCalMatchEffVsPar      -> GetZaxis() -> SetTitle(sCount.Data());
+  hEvtHCalMatchPurVsPar      -> GetXaxis() -> SetTitle(sEnePar.Data());
+  hEvtHCalMatchPurVsPar      -> GetYaxis() -> SetTitle(sMatchPur.Data());
+  hEvtHCalMatchPurVsPar      -> GetZaxis() -> SetTitle(sCount.Data());
 
   // TODO add hit histogram axis titles
   // set reco. cluster bemc axis titles
@@ -1339,8 +1389,486 @@ void FillBHCalClusterCalibrationTupleProcessor::FinishWithGlobalRootLock() {
   hEvtECalLeadClustVsPar  -> GetXaxis() -> SetTitle(sEnePar.Data());
   hEvtECalLeadClustVsPar  -> GetYaxis() -> SetTitle(sEneClustLead.Data());
   hEvtECalLeadClustVsPar  -> GetZaxis() -> SetTitle(sCount.Data());
+
+  // merge buffered rows into tuple
+  WriteTuple();
+
+  // publish final snapshot and stop writer
+  if (snapshots.IsStarted()) {
+    PublishSnapshot();
+    snapshots.Stop();
+  }
+
+  // write resolution/linearity graphs
+  if (doMoments) {
+    WriteMoments();
+  }
+
+  // write timing summary (if enabled)
+  if (TimingHelper::IsEnabled()) {
+    auto rootfile = GetApplication() -> GetService<RootFile_service>() -> GetHistFile();
+    rootfile -> cd("FillBHCalCalibrationTuple");
+
+    const auto summary = TimingHelper::Registry::Get().GetSummary();
+    TimingHelper::PrintSummary(summary);
+    TimingHelper::WriteJSON(std::string(rootfile -> GetName()) + ".FillBHCalCalibrationTuple.timing.json", "FillBHCalCalibrationTuple", summary);
+    TimingHelper::MakeTree("StageTiming", summary) -> Write();
+  }
+
+  // report lock timing (parsed by scripts/RunPluginThreadScaling.rb)
+  const double tHeld = std::chrono::duration<double>(durLockHeld).count();
+  const double tSpan = std::chrono::duration<double>(tLastUnlock - tFirstLock).count();
+  std::cout << "LOCKTIMING plugin=FillBHCalCalibrationTuple"
+            << " events=" << nEvtsLocked
+            << " held_s=" << tHeld
+            << " span_s=" << tSpan
+            << std::endl;
   return;
 
 }  // end 'FinishWithGlobalRootLock()'
 
+
+
+//-------------------------------------------
+// RecordLockHeld
+//-------------------------------------------
+void FillBHCalClusterCalibrationTupleProcessor::RecordLockHeld(const std::chrono::steady_clock::time_point& tLock) {
+
+  // n.b. only time with the global root lock held is counted here;
+  // the held time vs. the span of the run shows how serialized we are
+  tLastUnlock = std::chrono::steady_clock::now();
+  if (nEvtsLocked == 0) {
+    tFirstLock = tLock;
+  }
+  durLockHeld += tLastUnlock - tLock;
+  ++nEvtsLocked;
+  return;
+
+}  // end 'RecordLockHeld(std::chrono::steady_clock::time_point&)'
+
+
+
+//-------------------------------------------
+// CalculateTupleRow
+//-------------------------------------------
+bool FillBHCalClusterCalibrationTupleProcessor::CalculateTupleRow(const std::shared_ptr<const JEvent>& event, TupleRow& row) {
+
+  // n.b. this runs outside of the global root lock, so
+  // it mustn't touch any histograms or shared members
+  BHCAL_TIME_SCOPE("tuple row");
+
+  // grab collections
+  const auto genParticles  = event -> Get<edm4eic::ReconstructedParticle>("GeneratedParticles");
+  const auto bhcalRecHits  = event -> Get<edm4eic::CalorimeterHit>("HcalBarrelRecHits");
+  const auto bhcalClusters = event -> Get<edm4eic::Cluster>("HcalBarrelClusters");
+  const auto scifiRecHits  = event -> Get<edm4eic::CalorimeterHit>("EcalBarrelScFiRecHits");
+  const auto imageRecHits  = event -> Get<edm4eic::CalorimeterHit>("EcalBarrelImagingRecHits");
+  const auto bemcClusters  = event -> Get<edm4eic::Cluster>("EcalBarrelImagingMergedClusters");
+  const auto scifiClusters = event -> Get<edm4eic::Cluster>("EcalBarrelScFiClusters");
+  const auto imageClusters = event -> Get<edm4eic::Cluster>("EcalBarrelImagingClusters");
+
+  // if bhcal hit sum is 0, skip event
+  double eHCalHitSum(0.);
+  for (auto bhCalHit : bhcalRecHits) {
+    eHCalHitSum += bhCalHit -> getEnergy();
+  }
+  if (eHCalHitSum <= 0.) return false;
+
+  // get MC particle energy
+  double eMcPar(0.);
+  for (auto par : genParticles) {
+    if (par -> getType() == 1) {
+      eMcPar = par -> getEnergy();
+    }
+  }
+
+  // sum clusters and find leading one
+  struct ClusterSums {
+    unsigned long n     = 0;
+    int           nHit  = -1;
+    double        eSum  = 0.;
+    double        eLead = 0.;
+    double        hLead = -999.;
+    double        fLead = -999.;
+    double        diff  = -999.;
+  };
+  auto sumClusters = [eMcPar](const std::vector<const edm4eic::Cluster*>& clusters, const double eLeadStart) {
+    ClusterSums sums;
+    sums.eLead = eLeadStart;
+    for (auto cluster : clusters) {
+      const auto eClust = cluster -> getEnergy();
+      sums.eSum += eClust;
+      ++sums.n;
+
+      // FIXME update to XYZvectors
+      if (eClust > sums.eLead) {
+        const TVector3 vecPosition(cluster -> getPosition().x, cluster -> getPosition().y, cluster -> getPosition().z);
+        sums.nHit  = cluster -> getNhits();
+        sums.eLead = eClust;
+        sums.hLead = vecPosition.Eta();
+        sums.fLead = vecPosition.Phi();
+        sums.diff  = (eClust - eMcPar) / eMcPar;
+      }
+    }
+    return sums;
+  };
+  const ClusterSums hcal  = sumClusters(bhcalClusters, -999.);
+  const ClusterSums ecal  = sumClusters(bemcClusters,  -999.);
+  const ClusterSums scifi = sumClusters(scifiClusters, 0.);
+  const ClusterSums image = sumClusters(imageClusters, 0.);
+
+  // sum scifi/image hits in each layer
+  std::array<double, CONST::NSciFiLayer> eSciFiHitSumVsNLayer;
+  std::array<double, CONST::NImageLayer> eImageHitSumVsNLayer;
+  eSciFiHitSumVsNLayer.fill(0.);
+  eImageHitSumVsNLayer.fill(0.);
+  for (auto scifiHit : scifiRecHits) {
+    eSciFiHitSumVsNLayer[scifiHit -> getLayer() - 1] += scifiHit -> getEnergy();
+  }
+  for (auto imageHit : imageRecHits) {
+    eImageHitSumVsNLayer[imageHit -> getLayer() - 1] += imageHit -> getEnergy();
+  }
+
+  // set variables for calibration tuple
+  row[0]  = (Float_t) eMcPar;
+  row[1]  = (Float_t) (hcal.eLead / eMcPar);
+  row[2]  = (Float_t) (ecal.eLead / eMcPar);
+  row[3]  = (Float_t) (hcal.eSum / eMcPar);
+  row[4]  = (Float_t) (ecal.eSum / eMcPar);
+  row[5]  = (Float_t) (ecal.eLead / (hcal.eLead + ecal.eLead));
+  row[6]  = (Float_t) (ecal.eSum / (hcal.eSum + ecal.eSum));
+  row[7]  = (Float_t) hcal.eLead;
+  row[8]  = (Float_t) ecal.eLead;
+  row[9]  = (Float_t) hcal.eSum;
+  row[10] = (Float_t) ecal.eSum;
+  row[11] = (Float_t) hcal.diff;
+  row[12] = (Float_t) ecal.diff;
+  row[13] = (Float_t) ((hcal.eSum - eMcPar) / eMcPar);
+  row[14] = (Float_t) ((ecal.eSum - eMcPar) / eMcPar);
+  row[15] = (Float_t) hcal.nHit;
+  row[16] = (Float_t) ecal.nHit;
+  row[17] = (Float_t) hcal.n;
+  row[18] = (Float_t) ecal.n;
+  row[19] = (Float_t) hcal.hLead;
+  row[20] = (Float_t) ecal.hLead;
+  row[21] = (Float_t) hcal.fLead;
+  row[22] = (Float_t) ecal.fLead;
+  row[23] = (Float_t) image.eLead;
+  row[24] = (Float_t) image.eSum;
+  row[25] = (Float_t) scifi.eLead;
+  row[26] = (Float_t) scifi.eSum;
+  row[27] = (Float_t) scifi.n;
+  row[28] = (Float_t) image.n;
+  row[29] = (Float_t) image.hLead;
+  row[30] = (Float_t) scifi.hLead;
+  row[31] = (Float_t) image.fLead;
+  row[32] = (Float_t) scifi.fLead;
+  for (size_t iSciFi = 0; iSciFi < CONST::NSciFiLayer; iSciFi++) {
+    row[33 + iSciFi] = (Float_t) eSciFiHitSumVsNLayer[iSciFi];
+  }
+  for (size_t iImage = 0; iImage < CONST::NImageLayer; iImage++) {
+    row[45 + iImage] = (Float_t) eImageHitSumVsNLayer[iImage];
+  }
+  return true;
+
+}  // end 'CalculateTupleRow(std::shared_ptr<JEvent>&, TupleRow&)'
+
+
+
+//-------------------------------------------
+// GetThreadBuffer
+//-------------------------------------------
+FillBHCalClusterCalibrationTupleProcessor::ThreadBuffer& FillBHCalClusterCalibrationTupleProcessor::GetThreadBuffer() {
+
+  // n.b. each thread registers its buffer once; after that it's only
+  // touched by that thread until finish, so no locking is needed
+  thread_local ThreadBuffer* buffer = nullptr;
+  if (!buffer) {
+    std::lock_guard<std::mutex> lock(bufferMutex);
+    threadBuffers.emplace_back( std::make_unique<ThreadBuffer>() );
+    buffer = threadBuffers.back().get();
+    if (doMoments) {
+      buffer -> moments.resize(momentBins.size() - 1);
+    }
+  }
+  return *buffer;
+
+}  // end 'GetThreadBuffer()'
+
+
+
+//-------------------------------------------
+// SpillTuple
+//-------------------------------------------
+void FillBHCalClusterCalibrationTupleProcessor::SpillTuple(ThreadBuffer& buffer) {
+
+  // n.b. called with the global root lock held; rows are still in
+  // event order within a spill, but the tuple as a whole won't be
+  // sorted anymore
+  BHCAL_TIME_SCOPE("ntuple spill");
+  if (sortTuple && !didSpillTuple) {
+    std::cerr << "WARNING: tuple buffer is full! Rows will only be sorted within each spill of " << tupleBufferRows << " rows." << std::endl;
+  }
+  didSpillTuple = true;
+
+  std::vector<size_t> order(buffer.events.size());
+  for (size_t iRow = 0; iRow < order.size(); iRow++) {
+    order[iRow] = iRow;
+  }
+  if (sortTuple) {
+    std::stable_sort(
+      order.begin(),
+      order.end(),
+      [&buffer](const size_t lhs, const size_t rhs) {return buffer.events[lhs] < buffer.events[rhs];}
+    );
+  }
+
+  for (const size_t iRow : order) {
+    ntForCalibration -> Fill(buffer.rows.data() + (iRow * CONST::NCalibVars));
+  }
+  buffer.events.clear();
+  buffer.rows.clear();
+  return;
+
+}  // end 'SpillTuple(ThreadBuffer&)'
+
+
+
+//-------------------------------------------
+// WriteTuple
+//-------------------------------------------
+void FillBHCalClusterCalibrationTupleProcessor::WriteTuple() {
+
+  // collect (event, buffer, row) for every buffered row
+  struct RowRef {
+    uint64_t            event;
+    const ThreadBuffer* buffer;
+    size_t              row;
+  };
+
+  std::vector<RowRef> refs;
+  for (const auto& buffer : threadBuffers) {
+    for (size_t iRow = 0; iRow < buffer -> events.size(); iRow++) {
+      refs.push_back( {buffer -> events[iRow], buffer.get(), iRow} );
+    }
+  }
+
+  // order by event no. so output doesn't depend on scheduling
+  if (sortTuple) {
+    std::stable_sort(
+      refs.begin(),
+      refs.end(),
+      [](const RowRef& lhs, const RowRef& rhs) {return lhs.event < rhs.event;}
+    );
+  }
+
+  // and fill tuple
+  for (const RowRef& ref : refs) {
+    ntForCalibration -> Fill(ref.buffer -> rows.data() + (ref.row * CONST::NCalibVars));
+  }
+  for (auto& buffer : threadBuffers) {
+    buffer -> events.clear();
+    buffer -> rows.clear();
+  }
+  return;
+
+}  // end 'WriteTuple()'
+
+
+
+//-------------------------------------------
+// FillMoments
+//-------------------------------------------
+void FillBHCalClusterCalibrationTupleProcessor::FillMoments(ThreadBuffer& buffer, const double ePar, const std::array<double, CONST::NMomentVars>& values) {
+
+  // find particle energy bin, skip if outside of bins
+  const auto itUpper = std::upper_bound(momentBins.begin(), momentBins.end(), ePar);
+  if ((itUpper == momentBins.begin()) || (itUpper == momentBins.end())) {
+    return;
+  }
+  const size_t iBin = (itUpper - momentBins.begin()) - 1;
+
+  // n.b. each thread fills its own accumulators, which are merged at finish
+  for (size_t iVar = 0; iVar < CONST::NMomentVars; iVar++) {
+    buffer.moments[iBin][iVar].Add(values[iVar]);
+  }
+  return;
+
+}  // end 'FillMoments(ThreadBuffer&, double, std::array<double, CONST::NMomentVars>&)'
+
+
+
+//-------------------------------------------
+// WriteMoments
+//-------------------------------------------
+void FillBHCalClusterCalibrationTupleProcessor::WriteMoments() {
+
+  // names of accumulated variables
+  const std::array<std::string, CONST::NMomentVars> vecMomentVars = {
+    "eLeadBHCal",
+    "eLeadBEMC",
+    "eSumBHCal",
+    "eSumBEMC",
+    "eLeadCombined",
+    "eSumCombined"
+  };
+
+  // merge accumulators across threads
+  std::vector<std::array<MomentHelper::Accumulator, CONST::NMomentVars>> merged(momentBins.size() - 1);
+  for (const auto& buffer : threadBuffers) {
+    for (size_t iBin = 0; iBin < buffer -> moments.size(); iBin++) {
+      for (size_t iVar = 0; iVar < CONST::NMomentVars; iVar++) {
+        merged[iBin][iVar].Merge(buffer -> moments[iBin][iVar]);
+      }
+    }
+  }
+
+  // make resolution and linearity graphs, and collect moments into a
+  // table so that outputs of many jobs can be merged afterwards
+  MomentHelper::Table table;
+
+  auto rootfile = GetApplication() -> GetService<RootFile_service>() -> GetHistFile();
+  rootfile -> cd("FillBHCalCalibrationTuple");
+  for (size_t iVar = 0; iVar < CONST::NMomentVars; iVar++) {
+
+    GraphHelper::Definition grRes("grStreamRes_" + vecMomentVars[iVar]);
+    GraphHelper::Definition grLin("grStreamLin_" + vecMomentVars[iVar]);
+    for (size_t iBin = 0; iBin < merged.size(); iBin++) {
+
+      // add bin to table
+      const MomentHelper::Accumulator& moments = merged[iBin][iVar];
+      const double                     eCenter = 0.5 * (momentBins[iBin] + momentBins[iBin + 1]);
+      table.Get(vecMomentVars[iVar], "Ene" + std::to_string(iBin), eCenter, momentBins[iBin], momentBins[iBin + 1]).Merge(moments);
+
+      // skip (nearly) empty bins in graphs
+      if (moments.GetCount() < 2) continue;
+
+      grRes.AddPoint( {eCenter, moments.GetResolution(), 0., moments.GetResolutionError()} );
+      grLin.AddPoint( {eCenter, moments.GetMean(),       0., moments.GetMeanError()} );
+    }
+    grRes.MakeTGraphErrors() -> Write();
+    grLin.MakeTGraphErrors() -> Write();
+  }
+  table.MakeTree("tStreamMoments") -> Write();
+  return;
+
+}  // end 'WriteMoments()'
+
+
+
+//-------------------------------------------
+// FillMatching
+//-------------------------------------------
+void FillBHCalClusterCalibrationTupleProcessor::FillMatching(const std::vector<const edm4eic::Cluster*>& recoClusters, const std::vector<const edm4eic::Cluster*>& truthClusters, const double ePar) {
+
+  // collect cells of reco clusters
+  recoCells.Clear();
+  for (auto bhCalClust : recoClusters) {
+    recoCells.AddCluster();
+    for (uint32_t iHit = 0; iHit < bhCalClust -> hits_size(); iHit++) {
+      const auto bhCalHit = bhCalClust -> getHits(iHit);
+      recoCells.AddHit(bhCalHit.getCellID(), bhCalHit.getEnergy());
+    }
+  }
+
+  // collect cells of truth clusters
+  truthCells.Clear();
+  for (auto truthHCalClust : truthClusters) {
+    truthCells.AddCluster();
+    for (uint32_t iHit = 0; iHit < truthHCalClust -> hits_size(); iHit++) {
+      const auto truthHCalHit = truthHCalClust -> getHits(iHit);
+      truthCells.AddHit(truthHCalHit.getCellID(), truthHCalHit.getEnergy());
+    }
+  }
+
+  // n.b. sorting makes the shared energies a single linear merge
+  recoCells.Sort();
+  truthCells.Sort();
+  sharedEne.Fill(recoCells, truthCells);
+
+  // calculate and fill metrics
+  std::vector<double> bestFracs;
+  const auto metrics = ClusterMatchHelper::GetMetrics(sharedEne, matchFrac, splitFrac, &bestFracs);
+  for (const double bestFrac : bestFracs) {
+    hHCalTruClustBestFrac -> Fill(bestFrac);
+  }
+  if (metrics.efficiency >= 0.) {
+    hEvtHCalMatchEff      -> Fill(metrics.efficiency);
+    hEvtHCalSplitRate     -> Fill(metrics.splitRate);
+    hEvtHCalMatchEffVsPar -> Fill(ePar, metrics.efficiency);
+  }
+  if (metrics.purity >= 0.) {
+    hEvtHCalMatchPur      -> Fill(metrics.purity);
+    hEvtHCalMatchPurVsPar -> Fill(ePar, metrics.purity);
+  }
+  if (metrics.mergeRate >= 0.) {
+    hEvtHCalMergeRate -> Fill(metrics.mergeRate);
+  }
+  return;
+
+}  // end 'FillMatching(std::vector<edm4eic::Cluster*>&, std::vector<edm4eic::Cluster*>&, double)'
+
+
+
+//-------------------------------------------
+// StartSnapshots
+//-------------------------------------------
+void FillBHCalClusterCalibrationTupleProcessor::StartSnapshots() {
+
+  // histograms to publish
+  std::vector<TH1*> vecToPublish = {
+    hParEne,
+    hEvtHCalNumClust,
+    hEvtHCalSumClustEne,
+    hEvtHCalSumClustDiff,
+    hEvtHCalLeadClustEne,
+    hEvtHCalLeadTruClustEne,
+    hEvtECalNumClust,
+    hEvtECalSumClustEne,
+    hEvtECalLeadClustEne
+  };
+  if (doMatching) {
+    vecToPublish.push_back(hEvtHCalMatchEff);
+    vecToPublish.push_back(hEvtHCalMatchPur);
+    vecToPublish.push_back(hEvtHCalSplitRate);
+    vecToPublish.push_back(hEvtHCalMergeRate);
+  }
+
+  // register histograms and counters
+  for (TH1* hist : vecToPublish) {
+    snapshotHists.push_back( {snapshots.AddHistogram(hist), hist} );
+  }
+  snapshotCounters[0] = snapshots.AddCounter("nEvents");
+  snapshotCounters[1] = snapshots.AddCounter("nTupleEntries");
+  snapshotCounters[2] = snapshots.AddCounter("lockHeldSeconds");
+
+  // n.b. the writer thread only ever sees copies, so
+  // event processing never waits on the file
+  if (snapshots.Start(snapshotFile, snapshotPeriod)) {
+    std::cout << "    Publishing snapshots to " << snapshotFile << " every " << snapshotPeriod << " s." << std::endl;
+  }
+  return;
+
+}  // end 'StartSnapshots()'
+
+
+
+//-------------------------------------------
+// PublishSnapshot
+//-------------------------------------------
+void FillBHCalClusterCalibrationTupleProcessor::PublishSnapshot() {
+
+  // n.b. this is called with the global root lock held,
+  // so histograms can't change while they're copied
+  for (const auto& indexAndHist : snapshotHists) {
+    snapshots.Stage(indexAndHist.first, indexAndHist.second);
+  }
+  snapshots.Stage(snapshotCounters[0], (double) nEvtsLocked);
+  snapshots.Stage(snapshotCounters[1], (double) nTupleRows);
+  snapshots.Stage(snapshotCounters[2], std::chrono::duration<double>(durLockHeld).count());
+  snapshots.Publish();
+  return;
+
+}  // end 'PublishSnapshot()'
+
 // end ------------------------------------------------------------------------
@@ -9,7 +9,15 @@
 // ----------------------------------------------------------------------------
 
 // C includes
+#include <map>
+#include <array>
 #include <cmath>
+#include <mutex>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+#include <utility>
 // ROOT includes
 #include <TH1.h>
 #include <TH2.h>
@@ -20,19 +28,24 @@
 #include <TVector3.h>  // FIXME update to XYZvectors
 #include <TProfile.h>
 // JANA includes
-#include <JANA/JEventProcessorSequentialRoot.h>
+#include <JANA/JEventProcessor.h>
 #include <JANA/JEvent.h>
+#include <JANA/Services/JGlobalRootLock.h>
 // EDM includes
 #include <edm4eic/CalorimeterHit.h>
 #include <edm4eic/ReconstructedParticle.h>
 #include <edm4eic/ProtoCluster.h>
 #include <edm4eic/Cluster.h>
+// user includes
+#include "MomentHelper.hxx"
+#include "ClusterMatchHelper.hxx"
+#include "SnapshotHelper.hxx"
 
 
 
 // JCalibrateWithImagingProcessor definition ----------------------------------
 
-class FillBHCalClusterCalibrationTupleProcessor : public JEventProcessorSequentialRoot {
+class FillBHCalClusterCalibrationTupleProcessor : public JEventProcessor {
 
   // global constants
   enum CONST {
@@ -40,21 +53,14 @@ class FillBHCalClusterCalibrationTupleProcessor : public JEventProcessorSequenti
     NSciFiLayer = 12,
     NImageLayer = 6,
     NRange      = 2,
-    NComp       = 3
+    NComp       = 3,
+    NMomentVars = 6
   };
 
   private:
 
-    // Data objects we will need from JANA
-    PrefetchT<edm4eic::ReconstructedParticle> genParticles       = {this, "GeneratedParticles"};
-    PrefetchT<edm4eic::CalorimeterHit>        bhcalRecHits       = {this, "HcalBarrelRecHits"};
-    PrefetchT<edm4eic::Cluster>               bhcalClusters      = {this, "HcalBarrelClusters"};
-    PrefetchT<edm4eic::Cluster>               bhcalTruthClusters = {this, "HcalBarrelTruthClusters"};
-    PrefetchT<edm4eic::CalorimeterHit>        scifiRecHits       = {this, "EcalBarrelScFiRecHits"};
-    PrefetchT<edm4eic::CalorimeterHit>        imageRecHits       = {this, "EcalBarrelImagingRecHits"};
-    PrefetchT<edm4eic::Cluster>               bemcClusters       = {this, "EcalBarrelImagingMergedClusters"};
-    PrefetchT<edm4eic::Cluster>               scifiClusters      = {this, "EcalBarrelScFiClusters"};
-    PrefetchT<edm4eic::Cluster>               imageClusters      = {this, "EcalBarrelImagingClusters"};
+    // global root lock: histograms and the ntuple are only touched while it's held
+    std::shared_ptr<JGlobalRootLock> rootLock;
 
     // particle histograms
     TH1D *hParChrg                   = nullptr;
@@ -143,6 +149,14 @@ class FillBHCalClusterCalibrationTupleProcessor : public JEventProcessorSequenti
     TH1D *hEvtHCalLeadTruClustEne    = nullptr;
     TH1D *hEvtHCalLeadTruClustDiff   = nullptr;
     TH2D *hEvtHCalLeadTruClustVsPar  = nullptr;
+    // bhcal reco-truth matching histograms
+    TH1D *hHCalTruClustBestFrac      = nullptr;
+    TH1D *hEvtHCalMatchEff           = nullptr;
+    TH1D *hEvtHCalMatchPur           = nullptr;
+    TH1D *hEvtHCalSplitRate          = nullptr;
+    TH1D *hEvtHCalMergeRate          = nullptr;
+    TH2D *hEvtHCalMatchEffVsPar      = nullptr;
+    TH2D *hEvtHCalMatchPurVsPar      = nullptr;
 
     // scifi reconstructed hit histograms
     TH1I *hSciFiRecHitNLayer         = nullptr;
@@ -198,18 +212,75 @@ class FillBHCalClusterCalibrationTupleProcessor : public JEventProcessorSequenti
     TH2D *hEvtECalVsHCalLeadClustEne = nullptr;
 
     // ntuple for calibration
-    Float_t  varsForCalibration[CONST::NCalibVars];
     TNtuple *ntForCalibration;
 
+    // per-thread buffers: tuple rows and moments are computed outside of
+    // the lock and added to the calling thread's buffer; rows are spilled
+    // to the ntuple once a buffer holds tupleBufferRows of them, and the
+    // rest are merged (optionally in event order) at finish
+    typedef std::array<Float_t, CONST::NCalibVars> TupleRow;
+    struct ThreadBuffer {
+      std::vector<uint64_t>                                                  events;
+      std::vector<Float_t>                                                   rows;
+      std::vector<std::array<MomentHelper::Accumulator, CONST::NMomentVars>> moments;
+    };
+    bool                                       sortTuple       = false;
+    size_t                                     tupleBufferRows = 10000;
+    std::string                                compProfile     = "tuple";
+    size_t                                     nTupleRows      = 0;
+    bool                                       didSpillTuple   = false;
+    std::mutex                                 bufferMutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> threadBuffers;
+
+    // streaming resolution/linearity accumulators: [energy bin][variable]
+    bool                doMoments  = false;
+    std::vector<double> momentBins = {1., 3., 5., 7., 10., 15., 20., 30., 50., 75., 100.};
+
+    // reco-truth cluster matching by shared cells
+    bool                             doMatching = false;
+    double                           matchFrac  = 0.5;
+    double                           splitFrac  = 0.1;
+    ClusterMatchHelper::CellList     recoCells;
+    ClusterMatchHelper::CellList     truthCells;
+    ClusterMatchHelper::SharedMatrix sharedEne;
+
+    // live snapshots of selected histograms/counters
+    std::string                          snapshotFile   = "";
+    double                               snapshotPeriod = 30.;
+    SnapshotHelper::Publisher            snapshots;
+    std::vector<std::pair<size_t, TH1*>> snapshotHists;
+    std::array<size_t, 3>                snapshotCounters;
+
+    // lock timing (ProcessSequential and spills run while the global root lock is held)
+    size_t                                nEvtsLocked = 0;
+    std::chrono::steady_clock::duration   durLockHeld = std::chrono::steady_clock::duration::zero();
+    std::chrono::steady_clock::time_point tFirstLock;
+    std::chrono::steady_clock::time_point tLastUnlock;
+
+    // private methods
+    void          InitWithGlobalRootLock();
+    void          ProcessSequential(const std::shared_ptr<const JEvent>& event);
+    void          FinishWithGlobalRootLock();
+    void          RecordLockHeld(const std::chrono::steady_clock::time_point& tLock);
+    bool          CalculateTupleRow(const std::shared_ptr<const JEvent>& event, TupleRow& row);
+    ThreadBuffer& GetThreadBuffer();
+    void          FillMoments(ThreadBuffer& buffer, const double ePar, const std::array<double, CONST::NMomentVars>& values);
+    void          WriteMoments();
+    void          FillMatching(const std::vector<const edm4eic::Cluster*>& recoClusters, const std::vector<const edm4eic::Cluster*>& truthClusters, const double ePar);
+    void          SpillTuple(ThreadBuffer& buffer);
+    void          WriteTuple();
+    void          StartSnapshots();
+    void          PublishSnapshot();
+
   public:
 
     // ctor
     FillBHCalClusterCalibrationTupleProcessor() { SetTypeName(NAME_OF_THIS); }
 
     // inherited methods
-    void InitWithGlobalRootLock() override;
-    void ProcessSequential(const std::shared_ptr<const JEvent>& event) override;
-    void FinishWithGlobalRootLock() override;
+    void Init() override;
+    void Process(const std::shared_ptr<const JEvent>& event) override;
+    void Finish() override;
 
 };  // end FillBHCalClusterCalibrationTupleProcessor definition
 
@@ -9,12 +9,14 @@
 
 // c includes
 #include <cmath>
+#include <iostream>
 // root includes
 #include <TString.h>
 #include <TVector3.h>
 // jana includes
 #include <services/rootfile/RootFile_service.h>
 // user include
+#include "TimingHelper.hxx"
 #include "GetRawEnergiesProcessor.h"
 
 // the following just makes this a JANA plugin
@@ -95,10 +97,19 @@ void GetRawEnergiesProcessor::InitWithGlobalRootLock(){
 
 void GetRawEnergiesProcessor::ProcessSequential(const std::shared_ptr<const JEvent>& event) {
 
+  // start timing held lock
+  const auto tLock = std::chrono::steady_clock::now();
+
+  // time stages of event (if enabled)
+  BHCAL_TIME_STAGES();
+
   // eta ranges
   const float etaMin[NEtaRanges] = {-10., -1.0, -0.5, 0.5};
   const float etaMax[NEtaRanges] = {10.,  -0.5, 0.5,  1.0};
 
+  BHCAL_TIME_STAGE("sim hit loop");
+  BHCAL_COUNT_ITEMS("sim hit loop", simHits().size());
+
   // fill sim hit histograms
   for (auto sim : simHits()) {
 
@@ -133,6 +144,9 @@ void GetRawEnergiesProcessor::ProcessSequential(const std::shared_ptr<const JEve
     }  // end eta range loop
   }  // end sim hit loop
 
+  BHCAL_TIME_STAGE("reco hit loop");
+  BHCAL_COUNT_ITEMS("reco hit loop", recHits().size());
+
   // fill reco hit histograms
   for (auto rec : recHits()) {
 
@@ -167,18 +181,59 @@ void GetRawEnergiesProcessor::ProcessSequential(const std::shared_ptr<const JEve
     }  // end eta range loop
   }  // end reco hit loop
 
+  BHCAL_TIME_STAGE("raw hit loop");
+  BHCAL_COUNT_ITEMS("raw hit loop", rawHits().size());
+
   // fill raw hit histogram
   for (auto raw : rawHits()) hAdcHitRaw -> Fill(raw -> getAmplitude());
 
+  // stop timing held lock
+  RecordLockHeld(tLock);
+
 }  // end 'ProcessSequential(shared_ptr<JEvent>&)'
 
 
 
 void GetRawEnergiesProcessor::FinishWithGlobalRootLock() {
 
-  /* nothing to do here */
+  // write timing summary (if enabled)
+  if (TimingHelper::IsEnabled()) {
+    auto rootfile = GetApplication() -> GetService<RootFile_service>() -> GetHistFile();
+    rootfile -> cd("GetRawEnergies");
+
+    const auto summary = TimingHelper::Registry::Get().GetSummary();
+    TimingHelper::PrintSummary(summary);
+    TimingHelper::WriteJSON(std::string(rootfile -> GetName()) + ".GetRawEnergies.timing.json", "GetRawEnergies", summary);
+    TimingHelper::MakeTree("StageTiming", summary) -> Write();
+  }
+
+  // report lock timing (parsed by scripts/RunPluginThreadScaling.rb)
+  const double tHeld = std::chrono::duration<double>(durLockHeld).count();
+  const double tSpan = std::chrono::duration<double>(tLastUnlock - tFirstLock).count();
+  std::cout << "LOCKTIMING plugin=GetRawEnergies"
+            << " events=" << nEvtsLocked
+            << " held_s=" << tHeld
+            << " span_s=" << tSpan
+            << std::endl;
   return;
 
 }  // end 'FinishWithGlobalRootLock()'
 
+
+
+void GetRawEnergiesProcessor::RecordLockHeld(const std::chrono::steady_clock::time_point& tLock) {
+
+  // n.b. the base class acquires the global root lock before calling
+  // ProcessSequential, so time spent waiting for it isn't visible here;
+  // the held time vs. the span of the run shows how serialized we are
+  tLastUnlock = std::chrono::steady_clock::now();
+  if (nEvtsLocked == 0) {
+    tFirstLock = tLock;
+  }
+  durLockHeld += tLastUnlock - tLock;
+  ++nEvtsLocked;
+  return;
+
+}  // end 'RecordLockHeld(std::chrono::steady_clock::time_point&)'
+
 // end ------------------------------------------------------------------------
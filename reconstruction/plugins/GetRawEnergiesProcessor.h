@@ -7,6 +7,8 @@
 // as a function of eta.
 // ----------------------------------------------------------------------------
 
+// c includes
+#include <chrono>
 // root includes
 #include <TH1D.h>
 #include <TFile.h>
@@ -45,6 +47,15 @@ class GetRawEnergiesProcessor : public JEventProcessorSequentialRoot {
     // raw hit histograms
     TH1D* hAdcHitRaw = nullptr;
 
+    // lock timing (ProcessSequential runs while the global root lock is held)
+    size_t                                nEvtsLocked = 0;
+    std::chrono::steady_clock::duration   durLockHeld = std::chrono::steady_clock::duration::zero();
+    std::chrono::steady_clock::time_point tFirstLock;
+    std::chrono::steady_clock::time_point tLastUnlock;
+
+    // private methods
+    void RecordLockHeld(const std::chrono::steady_clock::time_point& tLock);
+
   public:
 
     // ctor
@@ -0,0 +1,35 @@
+# =============================================================================
+# @file   EICReconJob.rb
+# @author Derek Anderson
+# @date   10.17.2026
+#
+# The plugins, options and output collections of the EICrecon job run by
+# `RunEICRecon.rb`. They're kept here so that `TuneEICRecon.rb` can time
+# exactly the same job. Meant to be pulled into other scripts via
+# `require_relative`.
+# =============================================================================
+
+module EICReconJob
+
+  # output collections from EICrecon
+  OUT_COLLECT = [
+    "GeneratedParticles",
+    "GeneratedJets",
+    "GeneratedChargedJets",
+    "ReconstructedJets",
+    "ReconstructedChargedJets"
+  ].compact.reject(&:empty?)
+
+  # plugins to run in EICrecon
+  PLUGINS = [
+    "dump_flags"
+  ].compact.reject(&:empty?)
+
+  # options
+  OPTIONS = [
+    "-Peicrecon:LogLevel=debug"
+  ].compact.reject(&:empty?)
+
+end  # end EICReconJob
+
+# end =========================================================================
@@ -0,0 +1,226 @@
+# =============================================================================
+# @file   EICReconMeasurement.rb
+# @author Derek Anderson
+# @date   10.17.2026
+#
+# Helper functions to run EICrecon under `/usr/bin/time -v` and pull
+# resource usage and plugin timing out of the resulting log, and to
+# read/write the per-host tuning profiles made by `TuneEICRecon.rb`.
+# Meant to be pulled into other scripts via `require_relative`.
+# =============================================================================
+
+require 'json'
+require 'open3'
+require 'socket'
+require 'fileutils'
+
+
+
+module EICReconMeasurement
+
+  # ===========================================================================
+  # Get thread counts to scan
+  # ---------------------------------------------------------------------------
+  # @brief returns 1, 2, 4, ... up to (and including) the maximum
+  #
+  # @param[in] nmax maximum number of threads
+  # ===========================================================================
+  def self.thread_counts(nmax)
+
+    counts = []
+    nthread = 1
+    while nthread < nmax
+      counts.push(nthread)
+      nthread *= 2
+    end
+    counts.push(nmax)
+    return counts
+
+  end  # end :thread_counts
+
+
+
+  # ===========================================================================
+  # Run a command with resource usage
+  # ---------------------------------------------------------------------------
+  # @brief runs the provided command under `/usr/bin/time -v`, writes
+  #   all output to a log, and returns the parsed resource usage
+  #
+  # @param[in] command command to run (as an array of arguments)
+  # @param[in] log     path to log file
+  # ===========================================================================
+  def self.run_measured(command, log)
+
+    output, status = Open3.capture2e("/usr/bin/time", "-v", *command)
+    File.write(log, output)
+
+    if not status.success?
+      warn "WARNING: command exited with status #{status.exitstatus}! See '#{log}'."
+    end
+
+    usage = parse_time_output(output)
+    usage[:nevents] = parse_event_count(output)
+    usage[:status]  = status.exitstatus
+    usage[:output] = output
+    return usage
+
+  end  # end :run_measured
+
+
+
+  # ===========================================================================
+  # Parse output of `/usr/bin/time -v`
+  # ---------------------------------------------------------------------------
+  # @brief extracts wall-clock time (s), CPU utilization (%) and
+  #   peak resident memory (kB) from the verbose output of GNU time
+  #
+  # @param[in] output text to parse
+  # ===========================================================================
+  def self.parse_time_output(output)
+
+    usage = {wall_s: nil, cpu_pct: nil, max_rss_kB: nil}
+
+    # wall time is formatted as [h:]m:ss.ss
+    if output =~ /Elapsed \(wall clock\) time.*:\s+([\d:.]+)\s*$/
+      usage[:wall_s] = $1.split(':').map(&:to_f).reduce(0.0) { |sum, part| (sum * 60.0) + part }
+    end
+    if output =~ /Percent of CPU this job got:\s+(\d+)%/
+      usage[:cpu_pct] = $1.to_f
+    end
+    if output =~ /Maximum resident set size \(kbytes\):\s+(\d+)/
+      usage[:max_rss_kB] = $1.to_f
+    end
+    return usage
+
+  end  # end :parse_time_output
+
+
+
+  # ===========================================================================
+  # Parse no. of events processed
+  # ---------------------------------------------------------------------------
+  # @brief extracts the no. of events JANA reports having processed,
+  #   taken from the final report if present and the last status line
+  #   otherwise; returns nil if neither is found
+  #
+  # @param[in] output text to parse
+  # ===========================================================================
+  def self.parse_event_count(output)
+
+    if output =~ /Total events processed:\s+(\d+)/
+      return $1.to_i
+    end
+    counts = output.scan(/(\d+) events processed/).flatten
+    return (if counts.empty? then nil else counts.last.to_i end)
+
+  end  # end :parse_event_count
+
+
+
+  # ===========================================================================
+  # Parse plugin lock timing
+  # ---------------------------------------------------------------------------
+  # @brief extracts the `LOCKTIMING` lines printed by the plugins in
+  #   FinishWithGlobalRootLock, returned as a hash keyed by plugin
+  #
+  # @param[in] output text to parse
+  # ===========================================================================
+  def self.parse_lock_timing(output)
+
+    timing = {}
+    output.scan(/^LOCKTIMING plugin=(\S+) events=(\d+) held_s=(\S+) span_s=(\S+)/) do |plugin, events, held, span|
+      timing[plugin] = {events: events.to_i, held_s: held.to_f, span_s: span.to_f}
+    end
+    return timing
+
+  end  # end :parse_lock_timing
+
+
+
+  # ===========================================================================
+  # Get path to tuning profile
+  # ---------------------------------------------------------------------------
+  # @brief returns the path to the tuning profile of a host; profiles
+  #   live in $BHCAL_TUNING_DIR if set, or next to this script if not
+  #
+  # @param[in] host name of host (defaults to this one)
+  # ===========================================================================
+  def self.profile_path(host = Socket.gethostname)
+
+    dir = ENV.fetch("BHCAL_TUNING_DIR", File.join(__dir__, "tuning"))
+    return File.join(dir, "#{host}.json")
+
+  end  # end :profile_path
+
+
+
+  # ===========================================================================
+  # Write tuning profile
+  # ---------------------------------------------------------------------------
+  # @brief writes the provided profile (a hash) to the profile path
+  #   of this host
+  #
+  # @param[in] profile profile to write
+  # ===========================================================================
+  def self.write_profile(profile)
+
+    path = profile_path
+    FileUtils.mkdir_p(File.dirname(path))
+    File.write(path, JSON.pretty_generate(profile))
+    return path
+
+  end  # end :write_profile
+
+
+
+  # ===========================================================================
+  # Read tuning profile
+  # ---------------------------------------------------------------------------
+  # @brief returns the tuning profile of this host as a hash (with
+  #   symbol keys), or nil if there isn't one
+  # ===========================================================================
+  def self.read_profile
+
+    path = profile_path
+    return nil if not File.exist?(path)
+
+    begin
+      return JSON.parse(File.read(path), symbolize_names: true)
+    rescue JSON::ParserError
+      warn "WARNING: couldn't parse tuning profile '#{path}'! Ignoring it."
+      return nil
+    end
+
+  end  # end :read_profile
+
+
+
+  # ===========================================================================
+  # Get options from tuning profile
+  # ---------------------------------------------------------------------------
+  # @brief returns the EICrecon options (as a string) set by the tuning
+  #   profile of this host, skipping any already set in the provided
+  #   options; returns an empty string if there's no profile
+  #
+  # @param[in] options options already set (as a string)
+  # ===========================================================================
+  def self.profile_options(options = "")
+
+    profile = read_profile
+    return "" if profile.nil?
+
+    tuned = []
+    profile[:parameters].each do |param, value|
+      next if options.include?("-P#{param}=")
+      tuned.push("-P#{param}=#{value}")
+    end
+    if not tuned.empty?
+      puts "    Using tuning profile '#{profile_path}': #{tuned.join(' ')}"
+    end
+    return tuned.join(' ')
+
+  end  # end :profile_options
+
+end  # end EICReconMeasurement
+
+# end =========================================================================
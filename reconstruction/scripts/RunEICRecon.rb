@@ -7,29 +7,21 @@
 # An easy script to interface with EICRecon
 # =============================================================================
 
+require_relative 'EICReconJob'
+require_relative 'EICReconMeasurement'
+
 # i/o parameters
 in_ddsim   = "../forTestingJetPodioRelations.edm4hep.root"
 out_podio  = "forTestingUserConfigurability_change1V2_withMinJetPtAndMinCstPtChanged_recoJetAlgoSetToGarbage_reco2gen12.podio.root"
 out_plugin = "forTestingUserConfigurability_change1V2_withMinJetPtAndMinCstPtChanged_recoJetAlgoSetToGarbage_reco2gen12.plugin.root"
 
-# output collections from EICrecon
-out_collect = [
-  "GeneratedParticles",
-  "GeneratedJets",
-  "GeneratedChargedJets",
-  "ReconstructedJets",
-  "ReconstructedChargedJets"
-].compact.reject(&:empty?).join(',')
-
-# plugins to run in EICrecon
-plugins = [
-  "dump_flags"
-].compact.reject(&:empty?).join(',')
+# output collections, plugins and options (shared with TuneEICRecon.rb)
+out_collect = EICReconJob::OUT_COLLECT.join(',')
+plugins     = EICReconJob::PLUGINS.join(',')
+options     = EICReconJob::OPTIONS.join(' ')
 
-# options
-options = [
-  "-Peicrecon:LogLevel=debug"
-].compact.reject(&:empty?).join(' ')
+# add thread/queue settings from this host's tuning profile (if any)
+options = [options, EICReconMeasurement.profile_options(options)].reject(&:empty?).join(' ')
 
 # run EICrecon
 exec("eicrecon -Pplugins=#{plugins} -Ppodio:output_collections=#{out_collect} #{options} -Ppodio:output_file=#{out_podio} -Phistsfile=#{out_plugin} #{in_ddsim}")
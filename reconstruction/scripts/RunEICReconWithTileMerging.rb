@@ -8,6 +8,8 @@
 # matrix based on the provided number of tiles to merge into towers.
 # =============================================================================
 
+require_relative 'EICReconMeasurement'
+
 
 
 # main body of script =========================================================
@@ -42,6 +44,10 @@ END {
   nmerge = if ARGV.empty? then 1 else ARGV[0] end 
   add_map_and_matrix_to_options(nmerge, options)
 
+  # add thread/queue settings from this host's tuning profile (if any)
+  tuned = EICReconMeasurement.profile_options(options)
+  options.concat(" #{tuned}") if not tuned.empty?
+
   # run EICrecon
   exec("eicrecon -Pplugins=#{plugins} -Ppodio:output_collections=#{out_collect} #{options} -Ppodio:output_file=#{out_podio} #{in_ddsim}")
 
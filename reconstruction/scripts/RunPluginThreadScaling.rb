@@ -0,0 +1,195 @@
+#!/usr/bin/env ruby
+# =============================================================================
+# @file   RunPluginThreadScaling.rb
+# @author Derek Anderson
+# @date   10.17.2026
+#
+# This script runs the BHCal JANA plugins over a fixed, local input at
+# jana:nthreads = 1, 2, 4, ... N and records throughput, CPU utilization,
+# peak memory, and how long the global ROOT lock is held. The resulting
+# scaling curve (speedup and parallel efficiency vs. threads) is written
+# to CSV and JSON.
+#
+# Usage:
+#   ./RunPluginThreadScaling.rb [input] [max threads] [no. of events]
+# =============================================================================
+
+require 'etc'
+require 'json'
+require 'fileutils'
+require_relative 'EICReconMeasurement'
+
+
+
+# main body of script =========================================================
+
+END {
+
+  # i/o parameters
+  in_ddsim = if ARGV[0] then ARGV[0] else "../input/forBHCalOnlyCheck.e10pim.file0.d30m10y2024.edm4hep.root" end
+  out_dir  = "threadScaling"
+  out_csv  = "#{out_dir}/threadScaling.csv"
+  out_json = "#{out_dir}/threadScaling.json"
+
+  # scan parameters
+  nthreads = if ARGV[1] then ARGV[1].to_i else Etc.nprocessors end
+  nevents  = if ARGV[2] then ARGV[2].to_i else 2000 end
+
+  # plugins to benchmark
+  plugins = [
+    "FillBHCalCalibrationTuple",
+    "GetRawEnergies"
+  ]
+
+  # make sure input is local
+  if not File.exist?(in_ddsim)
+    abort "PANIC: input '#{in_ddsim}' doesn't exist! Please provide a local file."
+  end
+  FileUtils.mkdir_p(out_dir)
+
+  # run scan
+  results = []
+  plugins.each do |plugin|
+    EICReconMeasurement.thread_counts(nthreads).each do |nthread|
+
+      puts "    Running plugin #{plugin} with #{nthread} thread(s)..."
+      tag     = "#{out_dir}/#{plugin}.nthread#{nthread}"
+      command = [
+        "eicrecon",
+        "-Pplugins=#{plugin}",
+        "-Pjana:nthreads=#{nthread}",
+        "-Pjana:nevents=#{nevents}",
+        "-Ppodio:output_collections=GeneratedParticles",
+        "-Ppodio:output_file=#{tag}.podio.root",
+        "-Phistsfile=#{tag}.plugin.root",
+        in_ddsim
+      ]
+
+      usage  = EICReconMeasurement.run_measured(command, "#{tag}.log")
+      timing = EICReconMeasurement.parse_lock_timing(usage[:output])[plugin]
+      if timing.nil?
+        warn "WARNING: no lock timing found for #{plugin} (#{nthread} threads)! Skipping."
+        next
+      end
+
+      results.push(make_result(plugin, nthread, usage, timing))
+    end
+  end
+
+  # add speedup, efficiency and lock-wait estimate w.r.t. 1 thread
+  add_scaling(results)
+
+  # write out curve
+  write_csv(out_csv, results)
+  File.write(out_json, JSON.pretty_generate({input: in_ddsim, nevents: nevents, results: results}))
+  puts "    Wrote scaling curve to: #{out_csv}, #{out_json}"
+
+}  # end main body of script
+
+
+
+# =============================================================================
+# Make result
+# -----------------------------------------------------------------------------
+# @brief helper function to collect resource usage and lock timing for
+#   one run into a single hash
+#
+# @param[in] plugin  name of plugin
+# @param[in] nthread number of threads
+# @param[in] usage   resource usage from /usr/bin/time
+# @param[in] timing  lock timing reported by the plugin
+# =============================================================================
+def make_result(plugin, nthread, usage, timing)
+
+  # n.b. throughput is measured over the span between the first and last
+  # event reaching the plugin so that start-up (geometry, etc.) is excluded
+  rate = if timing[:span_s] > 0 then timing[:events] / timing[:span_s] else 0.0 end
+  util = if timing[:span_s] > 0 then timing[:held_s] / timing[:span_s] else 0.0 end
+  return {
+    plugin:          plugin,
+    nthreads:        nthread,
+    events:          timing[:events],
+    wall_s:          usage[:wall_s],
+    span_s:          timing[:span_s],
+    events_per_s:    rate,
+    cpu_pct:         usage[:cpu_pct],
+    max_rss_MB:      if usage[:max_rss_kB] then usage[:max_rss_kB] / 1024.0 else nil end,
+    lock_held_s:     timing[:held_s],
+    lock_util:       util,
+    lock_ceiling:    if timing[:held_s] > 0 then timing[:events] / timing[:held_s] else nil end,
+    lock_wait_est_s: nil,
+    speedup:         nil,
+    efficiency:      nil
+  }
+
+end  # end :make_result
+
+
+
+# =============================================================================
+# Add scaling
+# -----------------------------------------------------------------------------
+# @brief helper function to calculate speedup and parallel efficiency
+#   relative to the single thread run of each plugin
+#
+# The plugins only see the global ROOT lock once it's been acquired, so the
+# time spent waiting on it is estimated: the per-event work done outside
+# the lock is taken from the single thread run (where nothing waits), and
+# whatever thread-time isn't accounted for by that work or by holding the
+# lock is attributed to waiting.
+#
+# @param[in,out] results list of results to update
+# =============================================================================
+def add_scaling(results)
+
+  results.group_by { |result| result[:plugin] }.each do |plugin, runs|
+
+    base = runs.find { |run| run[:nthreads] == 1 }
+    if base.nil? or base[:events_per_s] <= 0
+      warn "WARNING: no single thread run for #{plugin}! Can't calculate scaling."
+      next
+    end
+
+    # per-event work outside of the lock
+    work_out = [(base[:span_s] - base[:lock_held_s]) / base[:events], 0.0].max
+
+    runs.each do |run|
+      run[:speedup]    = run[:events_per_s] / base[:events_per_s]
+      run[:efficiency] = run[:speedup] / run[:nthreads]
+
+      busy = run[:lock_held_s] + (work_out * run[:events])
+      run[:lock_wait_est_s] = [(run[:nthreads] * run[:span_s]) - busy, 0.0].max
+    end
+  end
+
+end  # end :add_scaling
+
+
+
+# =============================================================================
+# Write CSV
+# -----------------------------------------------------------------------------
+# @brief helper function to write results to a CSV file; the header is
+#   commented out so the file can be read with TTree::ReadFile
+#
+# @param[in] path    output file
+# @param[in] results list of results to write
+# =============================================================================
+def write_csv(path, results)
+
+  columns = [
+    :plugin, :nthreads, :events, :wall_s, :span_s, :events_per_s, :speedup,
+    :efficiency, :cpu_pct, :max_rss_MB, :lock_held_s, :lock_util, :lock_ceiling,
+    :lock_wait_est_s
+  ]
+
+  File.open(path, "w") do |file|
+    file.puts("# " + columns.join(','))
+    results.each do |result|
+      file.puts(columns.map { |col| if result[col].nil? then -1 else result[col] end }.join(','))
+    end
+  end
+
+end  # end :write_csv
+
+# end =========================================================================
@@ -0,0 +1,222 @@
+#!/usr/bin/env ruby
+# =============================================================================
+# @file   TuneEICRecon.rb
+# @author Derek Anderson
+# @date   10.17.2026
+#
+# This script runs short bursts of EICrecon over a sample input across a
+# grid of thread counts (jana:nthreads) and event-queue depths (no. of
+# events in flight), measures throughput and peak memory for each, and
+# writes the best configuration to a profile for this host. The profile
+# is then picked up by `RunEICRecon.rb` and `RunEICReconWithTileMerging.rb`.
+#
+# The bursts run the same plugins, options and output collections as
+# `RunEICRecon.rb`, both taken from `EICReconJob.rb`. The input must
+# hold at least 2N events.
+#
+# Usage:
+#   ./TuneEICRecon.rb [input] [max threads] [no. of events] [max RSS (MB)]
+# =============================================================================
+
+require 'etc'
+require 'json'
+require 'socket'
+require 'fileutils'
+require_relative 'EICReconJob'
+require_relative 'EICReconMeasurement'
+
+
+
+# main body of script =========================================================
+
+END {
+
+  # i/o parameters
+  in_ddsim = if ARGV[0] then ARGV[0] else "../input/forBHCalOnlyCheck.e10pim.file0.d30m10y2024.edm4hep.root" end
+  out_dir  = "tuning/#{Socket.gethostname}"
+  out_csv  = "#{out_dir}/tuningGrid.csv"
+
+  # scan parameters
+  nthreads = if ARGV[1] then ARGV[1].to_i else Etc.nprocessors end
+  nevents  = if ARGV[2] then ARGV[2].to_i else 500 end
+  max_rss  = if ARGV[3] then ARGV[3].to_f else nil end
+
+  # queue depths to try, as no. of events in flight per thread
+  # n.b. older versions of JANA2 size the queues with
+  # jana:event_pool_size instead
+  queue_param  = "jana:max_inflight_events"
+  queue_depths = [1, 2, 4]
+
+  # output collections, plugins and options for the bursts
+  # (the same as in RunEICRecon.rb)
+  out_collect = EICReconJob::OUT_COLLECT.join(',')
+  plugins     = EICReconJob::PLUGINS.join(',')
+  options     = EICReconJob::OPTIONS
+
+  # make sure input is local
+  if not File.exist?(in_ddsim)
+    abort "PANIC: input '#{in_ddsim}' doesn't exist! Please provide a local file."
+  end
+  FileUtils.mkdir_p(out_dir)
+
+  # run grid
+  results = []
+  EICReconMeasurement.thread_counts(nthreads).each do |nthread|
+    queue_depths.each do |depth|
+
+      ninflight = nthread * depth
+      puts "    Running #{nthread} thread(s) with #{ninflight} event(s) in flight..."
+
+      # n.b. each point is run twice, with N and 2N events, so
+      # that start-up (geometry, etc.) cancels out of the rate
+      usage = [nevents, 2 * nevents].map do |nevt|
+        tag     = "#{out_dir}/nthread#{nthread}.ninflight#{ninflight}.nevt#{nevt}"
+        command = [
+          "eicrecon",
+          "-Pplugins=#{plugins}",
+          "-Ppodio:output_collections=#{out_collect}",
+          *options,
+          "-Pjana:nthreads=#{nthread}",
+          "-P#{queue_param}=#{ninflight}",
+          "-Pjana:nevents=#{nevt}",
+          "-Ppodio:output_file=#{tag}.podio.root",
+          "-Phistsfile=#{tag}.plugin.root",
+          in_ddsim
+        ]
+        use = EICReconMeasurement.run_measured(command, "#{tag}.log")
+
+        # only the logs are kept
+        FileUtils.rm_f(["#{tag}.podio.root", "#{tag}.plugin.root"])
+        use
+      end
+
+      if usage.any? { |use| use[:status] != 0 or use[:wall_s].nil? }
+        warn "WARNING: burst failed for #{nthread} thread(s), #{ninflight} in flight! Skipping."
+        next
+      end
+
+      # a short input would make both bursts the same length
+      # and the rate meaningless
+      nlong = usage.last[:nevents]
+      if nlong.nil?
+        warn "WARNING: couldn't find no. of events processed in '#{out_dir}' logs! Can't check input is long enough."
+      elsif nlong < 2 * nevents
+        abort "PANIC: input '#{in_ddsim}' only has #{nlong} event(s), but #{2 * nevents} are needed! Please lower the no. of events."
+      end
+      results.push(make_result(nthread, ninflight, nevents, usage))
+    end
+  end
+
+  # pick best configuration
+  best = pick_best(results, max_rss)
+  if best.nil?
+    abort "PANIC: no configuration ran successfully#{max_rss ? " within #{max_rss} MB" : ""}! See logs in '#{out_dir}'."
+  end
+
+  # write out grid and profile
+  write_csv(out_csv, results)
+  path = EICReconMeasurement.write_profile({
+    host:       Socket.gethostname,
+    date:       Time.now.strftime("%Y-%m-%d %H:%M:%S"),
+    input:      in_ddsim,
+    nevents:    nevents,
+    max_rss_MB: max_rss,
+    parameters: {
+      "jana:nthreads" => best[:nthreads],
+      queue_param     => best[:ninflight]
+    },
+    best:       best
+  })
+  puts "    Best: #{best[:nthreads]} thread(s), #{best[:ninflight]} in flight, " \
+       "#{best[:events_per_s].round(2)} events/s, #{best[:max_rss_MB].round(1)} MB"
+  puts "    Wrote grid to: #{out_csv}"
+  puts "    Wrote profile to: #{path}"
+
+}  # end main body of script
+
+
+
+# =============================================================================
+# Make result
+# -----------------------------------------------------------------------------
+# @brief helper function to collect the resource usage of the two bursts
+#   at one grid point into a single hash
+#
+# The rate is taken from the difference of the two bursts, so time spent
+# on start-up and tear-down (which doesn't depend on the no. of events)
+# drops out.
+#
+# @param[in] nthread   number of threads
+# @param[in] ninflight number of events in flight
+# @param[in] nevents   number of events in the shorter burst
+# @param[in] usage     resource usage of the N and 2N event bursts
+# =============================================================================
+def make_result(nthread, ninflight, nevents, usage)
+
+  short, long = usage
+  span = long[:wall_s] - short[:wall_s]
+  rate = if span > 0 then nevents / span else 0.0 end
+  return {
+    nthreads:     nthread,
+    ninflight:    ninflight,
+    wall_short_s: short[:wall_s],
+    wall_long_s:  long[:wall_s],
+    events_per_s: rate,
+    cpu_pct:      long[:cpu_pct],
+    max_rss_MB:   if long[:max_rss_kB] then long[:max_rss_kB] / 1024.0 else 0.0 end
+  }
+
+end  # end :make_result
+
+
+
+# =============================================================================
+# Pick best configuration
+# -----------------------------------------------------------------------------
+# @brief helper function to select the configuration with the highest
+#   throughput within the memory limit (if any); configurations within
+#   2% of the best throughput are treated as tied, and the one using
+#   the least memory is picked
+#
+# @param[in] results list of results to pick from
+# @param[in] max_rss maximum peak memory (MB), or nil for no limit
+# =============================================================================
+def pick_best(results, max_rss)
+
+  allowed = results.select { |result| max_rss.nil? or result[:max_rss_MB] <= max_rss }
+  return nil if allowed.empty?
+
+  top  = allowed.map { |result| result[:events_per_s] }.max
+  tied = allowed.select { |result| result[:events_per_s] >= 0.98 * top }
+  return tied.min_by { |result| [result[:max_rss_MB], result[:nthreads]] }
+
+end  # end :pick_best
+
+
+
+# =============================================================================
+# Write CSV
+# -----------------------------------------------------------------------------
+# @brief helper function to write results to a CSV file; the header is
+#   commented out so the file can be read with TTree::ReadFile
+#
+# @param[in] path    output file
+# @param[in] results list of results to write
+# =============================================================================
+def write_csv(path, results)
+
+  columns = [
+    :nthreads, :ninflight, :wall_short_s, :wall_long_s, :events_per_s,
+    :cpu_pct, :max_rss_MB
+  ]
+
+  File.open(path, "w") do |file|
+    file.puts("# " + columns.join(','))
+    results.each do |result|
+      file.puts(columns.map { |col| if result[col].nil? then -1 else result[col] end }.join(','))
+    end
+  end
+
+end  # end :write_csv
+
+# end =========================================================================
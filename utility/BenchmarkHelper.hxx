@@ -0,0 +1,497 @@
+/// ===========================================================================
+/*! \file   BenchmarkHelper.hxx
+ *  \author Derek Anderson
+ *  \date   10.17.2026
+ *
+ *  A lightweight namespace to help time and
+ *  benchmark pieces of code in ROOT macros.
+ */
+/// ===========================================================================
+
+#ifndef BenchmarkHelper_hxx
+#define BenchmarkHelper_hxx
+
+// c++ utilities
+#include <map>
+#include <cmath>
+#include <ctime>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <limits>
+#include <iostream>
+#include <algorithm>
+#include <functional>
+// root libraries
+#include <TROOT.h>
+#include <TSystem.h>
+
+
+
+// ============================================================================
+//! Benchmark Helper
+// ============================================================================
+/*! A small namespace to help time pieces
+ *  of code and to record the results in
+ *  a format that can be compared between
+ *  runs.
+ */
+namespace BenchmarkHelper {
+
+  // --------------------------------------------------------------------------
+  //! Get current resident memory of process in kB
+  // --------------------------------------------------------------------------
+  inline double GetResidentMemory() {
+
+    ProcInfo_t info;
+    gSystem -> GetProcInfo(&info);
+    return info.fMemResident;
+
+  }  // end 'GetResidentMemory()'
+
+
+
+  // --------------------------------------------------------------------------
+  //! Get peak resident memory of process in kB (linux only)
+  // --------------------------------------------------------------------------
+  /*! Reads VmHWM from /proc/self/status; returns
+   *  -1 if that isn't available.
+   */
+  inline double GetPeakResidentMemory() {
+
+    std::ifstream status("/proc/self/status");
+    std::string   line;
+    while (std::getline(status, line)) {
+      if (line.rfind("VmHWM:", 0) == 0) {
+        return std::stod(line.substr(6));
+      }
+    }
+    return -1.;
+
+  }  // end 'GetPeakResidentMemory()'
+
+
+
+  // --------------------------------------------------------------------------
+  //! Get a quantile (0 - 1) of a list of values
+  // --------------------------------------------------------------------------
+  /*! Uses linear interpolation between closest
+   *  ranks. Values are copied since they need
+   *  to be sorted.
+   */
+  inline double GetQuantile(std::vector<double> values, const double quantile) {
+
+    if (values.empty()) return 0.;
+    std::sort(values.begin(), values.end());
+
+    const double      rank  = quantile * (values.size() - 1);
+    const std::size_t lower = (std::size_t) std::floor(rank);
+    const std::size_t upper = std::min(lower + 1, values.size() - 1);
+    return values[lower] + ((rank - lower) * (values[upper] - values[lower]));
+
+  }  // end 'GetQuantile(std::vector<double>, double)'
+
+
+
+  // ==========================================================================
+  //! Timer
+  // ==========================================================================
+  /*! A small wrapper around a steady clock.
+   */
+  class Timer {
+
+    private:
+
+      // data members
+      std::chrono::steady_clock::time_point m_start;
+
+    public:
+
+      // ----------------------------------------------------------------------
+      //! Start timer
+      // ----------------------------------------------------------------------
+      inline void Start() {m_start = std::chrono::steady_clock::now();}
+
+      // ----------------------------------------------------------------------
+      //! Get elapsed time since start in ns
+      // ----------------------------------------------------------------------
+      inline double GetElapsed() const {
+
+        const auto stop = std::chrono::steady_clock::now();
+        return std::chrono::duration<double, std::nano>(stop - m_start).count();
+
+      }  // end 'GetElapsed()'
+
+      // ----------------------------------------------------------------------
+      //! Default ctor/dtor
+      // ----------------------------------------------------------------------
+      Timer()  {Start();};
+      ~Timer() {};
+
+  };  // end BenchmarkHelper::Timer
+
+
+
+  // ==========================================================================
+  //! Benchmark result
+  // ==========================================================================
+  /*! Struct to consolidate the result of a single
+   *  benchmark: a name, a set of labels (e.g.
+   *  method, backend) and a set of metrics.
+   */
+  struct Result {
+
+    std::string                        name;
+    std::map<std::string, std::string> labels;
+    std::map<std::string, double>      metrics;
+
+  };  // end BenchmarkHelper::Result
+
+
+
+  // --------------------------------------------------------------------------
+  //! Summarize a list of per-call timings (in ns) into metrics
+  // --------------------------------------------------------------------------
+  inline void AddTimingMetrics(Result& result, const std::vector<double>& timings, const std::string& prefix = "") {
+
+    double sum = 0.;
+    for (const double timing : timings) {
+      sum += timing;
+    }
+
+    const double mean = timings.empty() ? 0. : sum / timings.size();
+    result.metrics[prefix + "ns_per_event"] = mean;
+    result.metrics[prefix + "p50_ns"]       = GetQuantile(timings, 0.50);
+    result.metrics[prefix + "p99_ns"]       = GetQuantile(timings, 0.99);
+    result.metrics[prefix + "n_calls"]      = timings.size();
+    return;
+
+  }  // end 'AddTimingMetrics(Result&, std::vector<double>&, std::string&)'
+
+
+
+  // --------------------------------------------------------------------------
+  //! Write a list of results to a JSON file
+  // --------------------------------------------------------------------------
+  /*! Along with the results, a small header with the
+   *  host, ROOT version and time of the run is written
+   *  so that files from different runs can be compared.
+   */
+  inline void WriteJSON(
+    const std::string& path,
+    const std::string& benchmark,
+    const std::vector<Result>& results
+  ) {
+
+    // helper lambda to escape strings
+    auto quote = [](const std::string& str) {
+      std::string quoted("\"");
+      for (const char chr : str) {
+        if ((chr == '"') || (chr == '\\')) quoted += '\\';
+        quoted += chr;
+      }
+      quoted += "\"";
+      return quoted;
+    };
+
+    // get time of run
+    char        stamp[32];
+    std::time_t now = std::time(nullptr);
+    std::strftime(stamp, sizeof(stamp), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+
+    std::ofstream json(path);
+    json << std::setprecision(10);
+    json << "{\n"
+         << "  \"benchmark\": " << quote(benchmark) << ",\n"
+         << "  \"host\": " << quote(gSystem -> HostName()) << ",\n"
+         << "  \"root_version\": " << quote(gROOT -> GetVersion()) << ",\n"
+         << "  \"timestamp\": " << quote(stamp) << ",\n"
+         << "  \"results\": [\n";
+
+    for (std::size_t iResult = 0; iResult < results.size(); ++iResult) {
+
+      const Result& result = results[iResult];
+      json << "    {\n"
+           << "      \"name\": " << quote(result.name) << ",\n"
+           << "      \"labels\": {";
+
+      std::size_t iLabel = 0;
+      for (const auto& label : result.labels) {
+        json << quote(label.first) << ": " << quote(label.second);
+        if (++iLabel < result.labels.size()) json << ", ";
+      }
+      json << "},\n"
+           << "      \"metrics\": {";
+
+      std::size_t iMetric = 0;
+      for (const auto& metric : result.metrics) {
+        json << quote(metric.first) << ": ";
+        if (std::isfinite(metric.second)) {
+          json << metric.second;
+        } else {
+          json << "null";
+        }
+        if (++iMetric < result.metrics.size()) json << ", ";
+      }
+      json << "}\n"
+           << "    }";
+      if (iResult + 1 < results.size()) json << ",";
+      json << "\n";
+    }
+
+    json << "  ]\n"
+         << "}\n";
+    json.close();
+    return;
+
+  }  // end 'WriteJSON(std::string&, std::string&, std::vector<Result>&)'
+
+
+
+  // --------------------------------------------------------------------------
+  //! Print a list of results as a table
+  // --------------------------------------------------------------------------
+  inline void PrintResults(const std::vector<Result>& results, const std::vector<std::string>& metrics) {
+
+    std::cout << "    " << std::left << std::setw(32) << "benchmark";
+    for (const std::string& metric : metrics) {
+      std::cout << std::right << std::setw(16) << metric;
+    }
+    std::cout << std::endl;
+
+    for (const Result& result : results) {
+      std::cout << "    " << std::left << std::setw(32) << result.name;
+      for (const std::string& metric : metrics) {
+        if (result.metrics.count(metric)) {
+          std::cout << std::right << std::setw(16) << result.metrics.at(metric);
+        } else {
+          std::cout << std::right << std::setw(16) << "-";
+        }
+      }
+      std::cout << std::endl;
+    }
+    return;
+
+  }  // end 'PrintResults(std::vector<Result>&, std::vector<std::string>&)'
+
+
+
+  // --------------------------------------------------------------------------
+  //! Prevent the compiler from optimizing away a result
+  // --------------------------------------------------------------------------
+  inline void Consume(const double value) {
+
+    static volatile double sink = 0.;
+    sink = value;
+    return;
+
+  }  // end 'Consume(double)'
+
+
+
+  // --------------------------------------------------------------------------
+  //! Two-sided 95% critical value of Student's t distribution
+  // --------------------------------------------------------------------------
+  inline double GetStudentT95(const std::size_t dof) {
+
+    static const std::vector<double> table = {
+      12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+      2.201,  2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+      2.080,  2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042
+    };
+    if (dof == 0) return std::numeric_limits<double>::infinity();
+    return (dof <= table.size()) ? table[dof - 1] : 1.960;
+
+  }  // end 'GetStudentT95(std::size_t)'
+
+
+
+  // ==========================================================================
+  //! Configuration of a repeated benchmark
+  // ==========================================================================
+  /*! Each repetition times a block of `iterations`
+   *  calls, so that the clock overhead is amortized
+   *  for very cheap operations. Warm-up calls are
+   *  made (and discarded) before the first one.
+   */
+  struct Config {
+
+    std::size_t warmup      = 100;   // no. of warm-up calls
+    std::size_t repetitions = 30;    // no. of timed repetitions
+    std::size_t iterations  = 1000;  // no. of calls per repetition
+
+  };  // end BenchmarkHelper::Config
+
+
+
+  // --------------------------------------------------------------------------
+  //! Run a repeated benchmark of a single operation
+  // --------------------------------------------------------------------------
+  /*! Records the mean, standard deviation, median and
+   *  minimum of the time per call (in ns) over the
+   *  repetitions, along with the half-width of the
+   *  95% confidence interval on the mean.
+   */
+  inline Result Run(
+    const std::string& name,
+    const std::function<void()>& operation,
+    const Config& config = Config()
+  ) {
+
+    // warm up caches, branch predictors, lazy initialization, etc.
+    for (std::size_t iWarm = 0; iWarm < config.warmup; ++iWarm) {
+      operation();
+    }
+
+    // timed repetitions
+    Timer               timer;
+    std::vector<double> samples(config.repetitions, 0.);
+    for (std::size_t iRep = 0; iRep < config.repetitions; ++iRep) {
+      timer.Start();
+      for (std::size_t iIter = 0; iIter < config.iterations; ++iIter) {
+        operation();
+      }
+      samples[iRep] = timer.GetElapsed() / std::max((std::size_t) 1, config.iterations);
+    }
+
+    // calculate statistics
+    double sum = 0.;
+    for (const double sample : samples) {
+      sum += sample;
+    }
+    const double mean = samples.empty() ? 0. : sum / samples.size();
+
+    double var = 0.;
+    for (const double sample : samples) {
+      var += (sample - mean) * (sample - mean);
+    }
+    var = (samples.size() > 1) ? var / (samples.size() - 1) : 0.;
+
+    const double stddev = std::sqrt(var);
+    const double ci95   = (samples.size() > 1)
+                        ? GetStudentT95(samples.size() - 1) * stddev / std::sqrt(samples.size())
+                        : 0.;
+
+    Result result;
+    result.name                  = name;
+    result.metrics["ns_per_op"]  = mean;
+    result.metrics["stddev_ns"]  = stddev;
+    result.metrics["ci95_ns"]    = ci95;
+    result.metrics["median_ns"]  = GetQuantile(samples, 0.5);
+    result.metrics["min_ns"]     = samples.empty() ? 0. : *std::min_element(samples.begin(), samples.end());
+    result.metrics["reps"]       = config.repetitions;
+    result.metrics["iterations"] = config.iterations;
+    return result;
+
+  }  // end 'Run(std::string&, std::function<void()>&, Config&)'
+
+
+
+  // --------------------------------------------------------------------------
+  //! Write a baseline file
+  // --------------------------------------------------------------------------
+  /*! Baselines are plain text so they're easy to diff
+   *  and to keep under version control. Each line is
+   *  "<name> <ns_per_op> <ci95_ns>", tab-separated
+   *  since benchmark names can contain spaces.
+   */
+  inline void WriteBaseline(const std::string& path, const std::vector<Result>& results) {
+
+    std::ofstream baseline(path);
+    baseline << "# benchmark\tns_per_op\tci95_ns (host: " << gSystem -> HostName() << ")\n";
+    baseline << std::setprecision(10);
+    for (const Result& result : results) {
+      baseline << result.name << "\t"
+               << result.metrics.at("ns_per_op") << "\t"
+               << result.metrics.at("ci95_ns") << "\n";
+    }
+    baseline.close();
+    return;
+
+  }  // end 'WriteBaseline(std::string&, std::vector<Result>&)'
+
+
+
+  // --------------------------------------------------------------------------
+  //! Read a baseline file
+  // --------------------------------------------------------------------------
+  /*! Returns a map of benchmark name onto
+   *  (ns_per_op, ci95_ns).
+   */
+  inline std::map<std::string, std::pair<double, double>> ReadBaseline(const std::string& path) {
+
+    std::map<std::string, std::pair<double, double>> baseline;
+
+    std::ifstream file(path);
+    std::string   line;
+    while (std::getline(file, line)) {
+      if (line.empty() || (line[0] == '#')) continue;
+
+      std::istringstream stream(line);
+      std::string        name;
+      double             mean = 0.;
+      double             ci95 = 0.;
+      if (std::getline(stream, name, '\t') && (stream >> mean >> ci95)) {
+        baseline[name] = {mean, ci95};
+      }
+    }
+    return baseline;
+
+  }  // end 'ReadBaseline(std::string&)'
+
+
+
+  // --------------------------------------------------------------------------
+  //! Compare results against a baseline
+  // --------------------------------------------------------------------------
+  /*! A benchmark is flagged as a regression only if
+   *  its confidence interval lies entirely above the
+   *  baseline's inflated by `tolerance` (e.g. 0.1 =
+   *  10%). Adds the ratio to baseline to each result
+   *  and returns the no. of regressions.
+   */
+  inline std::size_t CompareToBaseline(
+    std::vector<Result>& results,
+    const std::map<std::string, std::pair<double, double>>& baseline,
+    const double tolerance = 0.1
+  ) {
+
+    std::size_t nRegress = 0;
+    for (Result& result : results) {
+
+      if (!baseline.count(result.name)) {
+        std::cout << "      " << result.name << ": no baseline" << std::endl;
+        continue;
+      }
+
+      const double mean    = result.metrics.at("ns_per_op");
+      const double ci95    = result.metrics.at("ci95_ns");
+      const double refMean = baseline.at(result.name).first;
+      const double refCI95 = baseline.at(result.name).second;
+
+      const bool isSlower = (mean - ci95) > ((refMean + refCI95) * (1. + tolerance));
+      const bool isFaster = (mean + ci95) < ((refMean - refCI95) * (1. - tolerance));
+      result.metrics["ratio_to_baseline"] = (refMean > 0.) ? mean / refMean : 0.;
+
+      std::cout << "      " << std::left << std::setw(40) << result.name << std::right
+                << std::setw(12) << mean << " vs. " << std::setw(12) << refMean << " ns";
+      if (isSlower) {
+        std::cout << "  <-- SLOWER";
+        ++nRegress;
+      } else if (isFaster) {
+        std::cout << "  <-- faster";
+      }
+      std::cout << std::endl;
+    }
+    return nRegress;
+
+  }  // end 'CompareToBaseline(std::vector<Result>&, std::map<std::string, std::pair<double, double>>&, double)'
+
+}  // end BenchmarkHelper namespace
+
+#endif
+
+// end ========================================================================
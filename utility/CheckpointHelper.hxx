@@ -0,0 +1,268 @@
+/// ===========================================================================
+/*! \file   CheckpointHelper.hxx
+ *  \author Derek Anderson
+ *  \date   10.17.2026
+ *
+ *  A lightweight namespace to periodically
+ *  checkpoint long frame loops, so that a job
+ *  which dies partway through can be resumed
+ *  instead of restarted from the first frame.
+ */
+/// ===========================================================================
+
+#ifndef CheckpointHelper_hxx
+#define CheckpointHelper_hxx
+
+// c++ utilities
+#include <cstdio>
+#include <string>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+// root libraries
+#include <TTree.h>
+#include <TBranch.h>
+#include <TObjArray.h>
+
+
+
+// ============================================================================
+//! Checkpoint Helper
+// ============================================================================
+/*! A small namespace to hold the state of a
+ *  frame loop and to save it alongside an
+ *  output tree.
+ *
+ *  A checkpoint consists of an AutoSave of the
+ *  output tree followed by a small text file
+ *  (<output>.checkpoint) recording the next
+ *  frame to process and the no. of entries in
+ *  the tree at that point. The state file is
+ *  removed once the loop finishes.
+ */
+namespace CheckpointHelper {
+
+  // ==========================================================================
+  //! State of a frame loop
+  // ==========================================================================
+  struct State {
+
+    std::string in_file    = "";
+    uint64_t    next_frame = 0;
+    uint64_t    n_entries  = 0;
+
+  };  // end State
+
+
+
+  // --------------------------------------------------------------------------
+  //! Get path of state file for an output file
+  // --------------------------------------------------------------------------
+  inline std::string GetStateFile(const std::string& out_file) {
+
+    return out_file + ".checkpoint";
+
+  }  // end 'GetStateFile(std::string&)'
+
+
+
+  // --------------------------------------------------------------------------
+  //! Read state file, returns false if there isn't one
+  // --------------------------------------------------------------------------
+  inline bool ReadState(const std::string& path, State& state) {
+
+    std::ifstream file(path);
+    if (!file.is_open()) return false;
+
+    // n.b. each line is "<key> <value>"
+    std::string line;
+    while (std::getline(file, line)) {
+      const std::size_t split = line.find(' ');
+      if (split == std::string::npos) continue;
+
+      const std::string key   = line.substr(0, split);
+      const std::string value = line.substr(split + 1);
+      if (key == "in_file")    state.in_file    = value;
+      if (key == "next_frame") state.next_frame = std::stoull(value);
+      if (key == "n_entries")  state.n_entries  = std::stoull(value);
+    }
+    return true;
+
+  }  // end 'ReadState(std::string&, State&)'
+
+
+
+  // --------------------------------------------------------------------------
+  //! Write state file
+  // --------------------------------------------------------------------------
+  /*! n.b. the state is written to a temporary
+   *  file and then renamed, so a job dying
+   *  mid-write never leaves a corrupt state.
+   */
+  inline void WriteState(const std::string& path, const State& state) {
+
+    const std::string temp = path + ".tmp";
+    {
+      std::ofstream file(temp, std::ios::trunc);
+      file << "in_file "    << state.in_file    << "\n"
+           << "next_frame " << state.next_frame << "\n"
+           << "n_entries "  << state.n_entries  << std::endl;
+    }
+    std::rename(temp.data(), path.data());
+
+  }  // end 'WriteState(std::string&, State&)'
+
+
+
+  // --------------------------------------------------------------------------
+  //! Check if a tree is consistent with a saved state
+  // --------------------------------------------------------------------------
+  /*! The tree is only consistent if it has exactly
+   *  as many entries as were recorded: if the job
+   *  died between the AutoSave and the update of
+   *  the state file, the two won't match and the
+   *  job has to be rerun from scratch.
+   *
+   *  The tree's branches also have to match the
+   *  colon-separated list of variables about to
+   *  be filled (e.g. NTupleHelper::CompressVariables()),
+   *  since resuming with different options would
+   *  otherwise fill rows of the wrong length.
+   */
+  inline bool IsConsistent(
+    TTree* tree,
+    const State& state,
+    const std::string& in_file,
+    const std::string& variables
+  ) {
+
+    if (!tree) {
+      std::cerr << "WARNING: no tree to resume in output file!" << std::endl;
+      return false;
+    }
+    if (state.in_file != in_file) {
+      std::cerr << "WARNING: checkpoint is for a different input!\n"
+                << "         checkpoint = " << state.in_file << "\n"
+                << "         input      = " << in_file
+                << std::endl;
+      return false;
+    }
+    std::string branches("");
+    TObjArray*  list = tree -> GetListOfBranches();
+    for (int iBranch = 0; iBranch < list -> GetEntries(); ++iBranch) {
+      if (iBranch > 0) branches.append(":");
+      branches.append( list -> At(iBranch) -> GetName() );
+    }
+    if (branches != variables) {
+      std::cerr << "WARNING: tree has different variables than the ones to be filled!\n"
+                << "         tree    = " << branches << "\n"
+                << "         to fill = " << variables
+                << std::endl;
+      return false;
+    }
+    if ((uint64_t) tree -> GetEntries() != state.n_entries) {
+      std::cerr << "WARNING: tree has " << tree -> GetEntries() << " entries, "
+                << "but checkpoint expects " << state.n_entries << "!"
+                << std::endl;
+      return false;
+    }
+    return true;
+
+  }  // end 'IsConsistent(TTree*, State&, std::string& x 2)'
+
+
+
+  // ==========================================================================
+  //! Checkpointer
+  // ==========================================================================
+  /*! Call Update() at the top of each iteration
+   *  of the frame loop (so frames skipped with
+   *  'continue' are still counted), and Finish()
+   *  after the loop.
+   */
+  class Checkpointer {
+
+    private:
+
+      // data members
+      TTree*      m_tree     = nullptr;
+      uint64_t    m_interval = 0;
+      uint64_t    m_last     = 0;
+      std::string m_path     = "";
+      std::string m_in_file  = "";
+
+    public:
+
+      // ----------------------------------------------------------------------
+      //! Checkpoint if due
+      // ----------------------------------------------------------------------
+      /*! n.b. all frames before 'frame' are assumed
+       *  to be complete.
+       */
+      void Update(const uint64_t frame) {
+
+        if ((m_interval == 0) || (frame < m_last + m_interval)) return;
+        Save(frame);
+
+      }  // end 'Update(uint64_t)'
+
+      // ----------------------------------------------------------------------
+      //! Save tree and state
+      // ----------------------------------------------------------------------
+      void Save(const uint64_t frame) {
+
+        m_tree -> AutoSave("SaveSelf");
+        WriteState(m_path, {m_in_file, frame, (uint64_t) m_tree -> GetEntries()});
+        m_last = frame;
+
+      }  // end 'Save(uint64_t)'
+
+      // ----------------------------------------------------------------------
+      //! Clean up state file once loop is done
+      // ----------------------------------------------------------------------
+      /*! n.b. the state file is removed even if
+       *  checkpointing is off, since it may be
+       *  left over from the run being resumed.
+       */
+      void Finish() {
+
+        std::remove(m_path.data());
+
+      }  // end 'Finish()'
+
+      // ----------------------------------------------------------------------
+      //! default ctor/dtor
+      // ----------------------------------------------------------------------
+      Checkpointer()  {};
+      ~Checkpointer() {};
+
+      // ----------------------------------------------------------------------
+      //! ctor accepting arguments
+      // ----------------------------------------------------------------------
+      /*! An interval of 0 turns off checkpointing.
+       *  'first' is the first frame to be processed
+       *  (i.e. nonzero when resuming).
+       */
+      Checkpointer(
+        TTree* tree,
+        const std::string& in_file,
+        const std::string& out_file,
+        const uint64_t interval,
+        const uint64_t first = 0
+      ) {
+
+        m_tree     = tree;
+        m_interval = interval;
+        m_last     = first;
+        m_path     = GetStateFile(out_file);
+        m_in_file  = in_file;
+
+      }  // end ctor(TTree*, std::string& x 2, uint64_t x 2)
+
+  };  // end CheckpointHelper::Checkpointer
+
+}  // end CheckpointHelper namespace
+
+#endif
+
+// end ========================================================================
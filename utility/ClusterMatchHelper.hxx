@@ -0,0 +1,342 @@
+/// ===========================================================================
+/*! \file   ClusterMatchHelper.hxx
+ *  \author Derek Anderson
+ *  \date   10.17.2026
+ *
+ *  A lightweight namespace to match reconstructed
+ *  clusters to truth clusters by the energy of
+ *  the hits (cells) they share, and to score the
+ *  clustering with the result.
+ */
+/// ===========================================================================
+
+#ifndef ClusterMatchHelper_hxx
+#define ClusterMatchHelper_hxx
+
+// c++ utilities
+#include <cmath>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+
+
+
+// ============================================================================
+//! Cluster Match Helper
+// ============================================================================
+/*! A small namespace to build lists of the
+ *  cells in a set of clusters, the matrix of
+ *  energy shared between two such sets, and
+ *  per-event clustering metrics.
+ */
+namespace ClusterMatchHelper {
+
+  // ==========================================================================
+  //! A cell in a cluster
+  // ==========================================================================
+  struct CellHit {
+
+    uint64_t cell    = 0;
+    uint32_t cluster = 0;
+    double   energy  = 0.;
+
+  };  // end CellHit
+
+
+
+  // ==========================================================================
+  //! Cell list
+  // ==========================================================================
+  /*! Holds the cells of every cluster in a
+   *  collection. Once sorted, the cells are in
+   *  ascending order of cellID (and cluster), so
+   *  the list is the concatenation of the sorted
+   *  cellID vectors of each cluster.
+   */
+  class CellList {
+
+    private:
+
+      // data members
+      std::vector<CellHit> m_hits;
+      std::vector<double>  m_energies;
+
+    public:
+
+      // ----------------------------------------------------------------------
+      //! Getters
+      // ----------------------------------------------------------------------
+      std::size_t                 GetNClusters() const {return m_energies.size();}
+      const std::vector<CellHit>& GetHits()      const {return m_hits;}
+      const std::vector<double>&  GetEnergies()  const {return m_energies;}
+
+      // ----------------------------------------------------------------------
+      //! Clear list (keeps capacity)
+      // ----------------------------------------------------------------------
+      void Clear() {
+
+        m_hits.clear();
+        m_energies.clear();
+
+      }  // end 'Clear()'
+
+      // ----------------------------------------------------------------------
+      //! Start a new cluster, returns its index
+      // ----------------------------------------------------------------------
+      uint32_t AddCluster() {
+
+        m_energies.push_back(0.);
+        return (uint32_t) (m_energies.size() - 1);
+
+      }  // end 'AddCluster()'
+
+      // ----------------------------------------------------------------------
+      //! Add a cell to the current cluster
+      // ----------------------------------------------------------------------
+      void AddHit(const uint64_t cell, const double energy) {
+
+        m_hits.push_back( {cell, (uint32_t) (m_energies.size() - 1), energy} );
+        m_energies.back() += energy;
+
+      }  // end 'AddHit(uint64_t, double)'
+
+      // ----------------------------------------------------------------------
+      //! Sort cells (call after all clusters are added)
+      // ----------------------------------------------------------------------
+      void Sort() {
+
+        std::sort(
+          m_hits.begin(),
+          m_hits.end(),
+          [](const CellHit& lhs, const CellHit& rhs) {
+            return (lhs.cell < rhs.cell) || ((lhs.cell == rhs.cell) && (lhs.cluster < rhs.cluster));
+          }
+        );
+
+      }  // end 'Sort()'
+
+  };  // end ClusterMatchHelper::CellList
+
+
+
+  // ==========================================================================
+  //! Shared-energy matrix
+  // ==========================================================================
+  /*! Entry (r, t) is the energy of the cells in
+   *  both reco cluster r and truth cluster t,
+   *  where a cell present in both counts with
+   *  the lesser of its two energies.
+   */
+  class SharedMatrix {
+
+    private:
+
+      // data members
+      std::size_t         m_nReco  = 0;
+      std::size_t         m_nTruth = 0;
+      std::vector<double> m_shared;
+      std::vector<double> m_eReco;
+      std::vector<double> m_eTruth;
+
+    public:
+
+      // ----------------------------------------------------------------------
+      //! Getters
+      // ----------------------------------------------------------------------
+      std::size_t GetNReco()                             const {return m_nReco;}
+      std::size_t GetNTruth()                            const {return m_nTruth;}
+      double      GetRecoEnergy(const std::size_t reco)   const {return m_eReco[reco];}
+      double      GetTruthEnergy(const std::size_t truth) const {return m_eTruth[truth];}
+
+      double Get(const std::size_t reco, const std::size_t truth) const {
+
+        return m_shared[(reco * m_nTruth) + truth];
+
+      }  // end 'Get(std::size_t, std::size_t)'
+
+      // ----------------------------------------------------------------------
+      //! Fill from two sorted cell lists
+      // ----------------------------------------------------------------------
+      /*! Both lists are walked once in step, so the
+       *  cost is linear in the total no. of cells
+       *  (plus the size of the matrix), rather than
+       *  comparing every hit of every reco cluster
+       *  to every hit of every truth cluster.
+       */
+      void Fill(const CellList& reco, const CellList& truth) {
+
+        m_nReco  = reco.GetNClusters();
+        m_nTruth = truth.GetNClusters();
+        m_eReco  = reco.GetEnergies();
+        m_eTruth = truth.GetEnergies();
+        m_shared.assign(m_nReco * m_nTruth, 0.);
+
+        const std::vector<CellHit>& rHits = reco.GetHits();
+        const std::vector<CellHit>& tHits = truth.GetHits();
+
+        std::size_t iReco  = 0;
+        std::size_t iTruth = 0;
+        while ((iReco < rHits.size()) && (iTruth < tHits.size())) {
+
+          // advance whichever list is behind
+          const uint64_t cell = rHits[iReco].cell;
+          if (cell < tHits[iTruth].cell) {
+            ++iReco;
+            continue;
+          }
+          if (tHits[iTruth].cell < cell) {
+            ++iTruth;
+            continue;
+          }
+
+          // find runs with this cell in each list
+          // n.b. these are normally 1 long, unless
+          // clusters in a collection share cells
+          std::size_t stopReco  = iReco;
+          std::size_t stopTruth = iTruth;
+          while ((stopReco < rHits.size()) && (rHits[stopReco].cell == cell)) ++stopReco;
+          while ((stopTruth < tHits.size()) && (tHits[stopTruth].cell == cell)) ++stopTruth;
+
+          for (std::size_t jReco = iReco; jReco < stopReco; ++jReco) {
+            for (std::size_t jTruth = iTruth; jTruth < stopTruth; ++jTruth) {
+              m_shared[(rHits[jReco].cluster * m_nTruth) + tHits[jTruth].cluster]
+                += std::min(rHits[jReco].energy, tHits[jTruth].energy);
+            }
+          }
+          iReco  = stopReco;
+          iTruth = stopTruth;
+        }
+
+      }  // end 'Fill(CellList&, CellList&)'
+
+      // ----------------------------------------------------------------------
+      //! default ctor/dtor
+      // ----------------------------------------------------------------------
+      SharedMatrix()  {};
+      ~SharedMatrix() {};
+
+      // ----------------------------------------------------------------------
+      //! ctor accepting cell lists
+      // ----------------------------------------------------------------------
+      SharedMatrix(const CellList& reco, const CellList& truth) {
+
+        Fill(reco, truth);
+
+      }  // end ctor(CellList&, CellList&)
+
+  };  // end ClusterMatchHelper::SharedMatrix
+
+
+
+  // ==========================================================================
+  //! Per-event clustering metrics
+  // ==========================================================================
+  /*! Definitions:
+   *    efficiency = fraction of truth clusters with
+   *                 a reco cluster holding at least
+   *                 'matchFrac' of their energy
+   *    purity     = fraction of reco energy which is
+   *                 shared with the best-matched truth
+   *                 cluster of each reco cluster
+   *    split rate = fraction of truth clusters with
+   *                 2+ reco clusters each holding at
+   *                 least 'minFrac' of their energy
+   *    merge rate = fraction of reco clusters with 2+
+   *                 truth clusters each contributing
+   *                 at least 'minFrac' of their energy
+   *
+   *  Rates are -1 if there's nothing to normalize by.
+   */
+  struct Metrics {
+
+    std::size_t nReco      = 0;
+    std::size_t nTruth     = 0;
+    std::size_t nMatched   = 0;
+    std::size_t nSplit     = 0;
+    std::size_t nMerged    = 0;
+    double      efficiency = -1.;
+    double      purity     = -1.;
+    double      splitRate  = -1.;
+    double      mergeRate  = -1.;
+
+  };  // end Metrics
+
+
+
+  // --------------------------------------------------------------------------
+  //! Calculate metrics from a shared-energy matrix
+  // --------------------------------------------------------------------------
+  /*! n.b. the best-matched fraction of each truth
+   *  cluster is appended to 'bestFracs' (if given)
+   *  for e.g. histogramming.
+   */
+  inline Metrics GetMetrics(
+    const SharedMatrix& matrix,
+    const double matchFrac = 0.5,
+    const double minFrac = 0.1,
+    std::vector<double>* bestFracs = nullptr
+  ) {
+
+    Metrics metrics;
+    metrics.nReco  = matrix.GetNReco();
+    metrics.nTruth = matrix.GetNTruth();
+
+    // truth-side: efficiency and splitting
+    for (std::size_t iTruth = 0; iTruth < matrix.GetNTruth(); ++iTruth) {
+
+      const double eTruth = matrix.GetTruthEnergy(iTruth);
+      if (eTruth <= 0.) continue;
+
+      double      best   = 0.;
+      std::size_t nParts = 0;
+      for (std::size_t iReco = 0; iReco < matrix.GetNReco(); ++iReco) {
+        const double frac = matrix.Get(iReco, iTruth) / eTruth;
+        best = std::max(best, frac);
+        if (frac >= minFrac) ++nParts;
+      }
+      if (best >= matchFrac) ++metrics.nMatched;
+      if (nParts >= 2)       ++metrics.nSplit;
+      if (bestFracs)         bestFracs -> push_back(best);
+    }
+
+    // reco-side: purity and merging
+    double eRecoSum = 0.;
+    double eBestSum = 0.;
+    for (std::size_t iReco = 0; iReco < matrix.GetNReco(); ++iReco) {
+
+      const double eReco = matrix.GetRecoEnergy(iReco);
+      if (eReco <= 0.) continue;
+
+      double      best   = 0.;
+      std::size_t nParts = 0;
+      for (std::size_t iTruth = 0; iTruth < matrix.GetNTruth(); ++iTruth) {
+        const double shared = matrix.Get(iReco, iTruth);
+        best = std::max(best, shared);
+        if ((shared / eReco) >= minFrac) ++nParts;
+      }
+      if (nParts >= 2) ++metrics.nMerged;
+      eRecoSum += eReco;
+      eBestSum += best;
+    }
+
+    // normalize
+    if (metrics.nTruth > 0) {
+      metrics.efficiency = (double) metrics.nMatched / metrics.nTruth;
+      metrics.splitRate  = (double) metrics.nSplit / metrics.nTruth;
+    }
+    if (metrics.nReco > 0) {
+      metrics.mergeRate = (double) metrics.nMerged / metrics.nReco;
+    }
+    if (eRecoSum > 0.) {
+      metrics.purity = eBestSum / eRecoSum;
+    }
+    return metrics;
+
+  }  // end 'GetMetrics(SharedMatrix&, double x 2, std::vector<double>*)'
+
+}  // end ClusterMatchHelper namespace
+
+#endif
+
+// end ========================================================================
@@ -0,0 +1,217 @@
+/// ===========================================================================
+/*! \file   ClusterShapeHelper.hxx
+ *  \author Derek Anderson
+ *  \date   10.17.2026
+ *
+ *  A lightweight namespace to calculate the
+ *  lateral and longitudinal shape of clusters
+ *  from their hits in a single pass.
+ */
+/// ===========================================================================
+
+#ifndef ClusterShapeHelper_hxx
+#define ClusterShapeHelper_hxx
+
+// c++ utilities
+#include <cmath>
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+
+
+
+// ============================================================================
+//! Cluster Shape Helper
+// ============================================================================
+/*! A small namespace to hold hits of many
+ *  clusters in a structure-of-arrays layout,
+ *  and a kernel to compute their energy-weighted
+ *  moments.
+ */
+namespace ClusterShapeHelper {
+
+  // --------------------------------------------------------------------------
+  //! Names of shape variables (e.g. for tuple columns)
+  // --------------------------------------------------------------------------
+  inline const std::vector<std::string> Variables = {
+    "sigEta",
+    "sigPhi",
+    "meanDepth",
+    "sigDepth",
+    "disp",
+    "fracLeadHit"
+  };
+
+
+
+  // ==========================================================================
+  //! Shape of a cluster
+  // ==========================================================================
+  struct Shape {
+
+    float sumEne    = 0.;  // sum of hit energies
+    float meanEta   = 0.;  // energy-weighted mean eta
+    float meanPhi   = 0.;  // energy-weighted mean phi
+    float meanDepth = 0.;  // energy-weighted mean depth (radius)
+    float sigEta    = 0.;  // energy-weighted std. dev. in eta
+    float sigPhi    = 0.;  // energy-weighted std. dev. in phi
+    float sigDepth  = 0.;  // energy-weighted std. dev. in depth
+    float disp      = 0.;  // dispersion, i.e. sigEta^2 + sigPhi^2
+    float leadFrac  = 0.;  // fraction of energy in most energetic hit
+
+    // ------------------------------------------------------------------------
+    //! Get values in the same order as Variables
+    // ------------------------------------------------------------------------
+    std::vector<float> GetValues() const {
+
+      return {sigEta, sigPhi, meanDepth, sigDepth, disp, leadFrac};
+
+    }  // end 'GetValues()'
+
+  };  // end Shape
+
+
+
+  // ==========================================================================
+  //! Hit arrays
+  // ==========================================================================
+  /*! Hits of all clusters are stored back-to-back
+   *  in flat arrays; the hits of cluster c are at
+   *  [offsets[c], offsets[c + 1]). Phi is stored
+   *  relative to a reference (e.g. the cluster
+   *  position) so that the kernel needn't handle
+   *  the wraparound.
+   */
+  struct HitArrays {
+
+    std::vector<float>    energy;
+    std::vector<float>    eta;
+    std::vector<float>    dPhi;
+    std::vector<float>    depth;
+    std::vector<float>    phiRef;
+    std::vector<uint32_t> offsets = {0};
+
+    // ------------------------------------------------------------------------
+    //! Clear arrays (keeps capacity)
+    // ------------------------------------------------------------------------
+    void Clear() {
+
+      energy.clear();
+      eta.clear();
+      dPhi.clear();
+      depth.clear();
+      phiRef.clear();
+      offsets.assign(1, 0);
+
+    }  // end 'Clear()'
+
+    // ------------------------------------------------------------------------
+    //! Start a new cluster
+    // ------------------------------------------------------------------------
+    void AddCluster(const float phi) {
+
+      phiRef.push_back(phi);
+      offsets.push_back(offsets.back());
+
+    }  // end 'AddCluster(float)'
+
+    // ------------------------------------------------------------------------
+    //! Add a hit to the current cluster
+    // ------------------------------------------------------------------------
+    void AddHit(const float ene, const float h, const float f, const float r) {
+
+      energy.push_back(ene);
+      eta.push_back(h);
+      dPhi.push_back( (float) std::remainder(f - phiRef.back(), 2. * M_PI) );
+      depth.push_back(r);
+      ++offsets.back();
+
+    }  // end 'AddHit(float x 4)'
+
+    // ------------------------------------------------------------------------
+    //! Get no. of clusters
+    // ------------------------------------------------------------------------
+    std::size_t GetNClusters() const {
+
+      return offsets.size() - 1;
+
+    }  // end 'GetNClusters()'
+
+  };  // end HitArrays
+
+
+
+  // --------------------------------------------------------------------------
+  //! Compute shapes of all clusters
+  // --------------------------------------------------------------------------
+  /*! For each cluster, all sums are accumulated
+   *  in one pass over contiguous arrays with no
+   *  branches in the loop body, so the compiler
+   *  can vectorize it.
+   *
+   *  n.b. since the sums are floating point, the
+   *  reductions are only vectorized if allowed to
+   *  be reordered (e.g. when built with -fopenmp).
+   */
+  inline void ComputeShapes(const HitArrays& hits, std::vector<Shape>& shapes) {
+
+    shapes.resize(hits.GetNClusters());
+
+    const float* energy = hits.energy.data();
+    const float* eta    = hits.eta.data();
+    const float* dPhi   = hits.dPhi.data();
+    const float* depth  = hits.depth.data();
+    for (std::size_t iClust = 0; iClust < hits.GetNClusters(); ++iClust) {
+
+      const uint32_t start = hits.offsets[iClust];
+      const uint32_t stop  = hits.offsets[iClust + 1];
+
+      float sumW   = 0.;
+      float sumH   = 0.;
+      float sumH2  = 0.;
+      float sumF   = 0.;
+      float sumF2  = 0.;
+      float sumR   = 0.;
+      float sumR2  = 0.;
+      float maxEne = 0.;
+#ifdef _OPENMP
+      #pragma omp simd reduction(+:sumW,sumH,sumH2,sumF,sumF2,sumR,sumR2) reduction(max:maxEne)
+#endif
+      for (uint32_t iHit = start; iHit < stop; ++iHit) {
+        const float w = energy[iHit];
+        sumW  += w;
+        sumH  += w * eta[iHit];
+        sumH2 += w * eta[iHit] * eta[iHit];
+        sumF  += w * dPhi[iHit];
+        sumF2 += w * dPhi[iHit] * dPhi[iHit];
+        sumR  += w * depth[iHit];
+        sumR2 += w * depth[iHit] * depth[iHit];
+        maxEne = std::max(maxEne, w);
+      }
+
+      // turn sums into moments
+      Shape& shape = shapes[iClust];
+      shape = Shape();
+      if (sumW <= 0.) continue;
+
+      const float meanF = sumF / sumW;
+      shape.sumEne    = sumW;
+      shape.meanEta   = sumH / sumW;
+      shape.meanPhi   = (float) std::remainder(hits.phiRef[iClust] + meanF, 2. * M_PI);
+      shape.meanDepth = sumR / sumW;
+      shape.sigEta    = std::sqrt(std::max(0.f, (sumH2 / sumW) - (shape.meanEta * shape.meanEta)));
+      shape.sigPhi    = std::sqrt(std::max(0.f, (sumF2 / sumW) - (meanF * meanF)));
+      shape.sigDepth  = std::sqrt(std::max(0.f, (sumR2 / sumW) - (shape.meanDepth * shape.meanDepth)));
+      shape.disp      = (shape.sigEta * shape.sigEta) + (shape.sigPhi * shape.sigPhi);
+      shape.leadFrac  = maxEne / sumW;
+    }
+
+  }  // end 'ComputeShapes(HitArrays&, std::vector<Shape>&)'
+
+}  // end ClusterShapeHelper namespace
+
+#endif
+
+// end ========================================================================
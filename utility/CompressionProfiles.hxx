@@ -0,0 +1,301 @@
+/// ===========================================================================
+/*! \file   CompressionProfiles.hxx
+ *  \author Derek Anderson
+ *  \date   10.17.2026
+ *
+ *  A lightweight namespace to hold named sets of
+ *  output settings (compression algorithm/level,
+ *  basket size, and auto-flush) per type of file
+ *  written by the repo, so writers can select them
+ *  by name.
+ */
+/// ===========================================================================
+
+#ifndef CompressionProfiles_hxx
+#define CompressionProfiles_hxx
+
+// c++ utilities
+#include <map>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+// root libraries
+#include <TFile.h>
+#include <TTree.h>
+#include <TBranch.h>
+#include <TObjArray.h>
+#include <Compression.h>
+
+
+
+// ============================================================================
+//! Compression Profiles
+// ============================================================================
+/*! A small namespace to look up output settings
+ *  by name and apply them to files and trees.
+ *
+ *  Built-in profiles are provided for each type
+ *  of file (e.g. "tuple"), and can be overridden
+ *  by a profile file such as the one written by
+ *  'utility/macros/BenchmarkCompression.cxx'
+ *  (either via Load or by pointing the env.
+ *  variable BHCAL_COMPRESSION_PROFILES at it),
+ *  where each line is
+ *
+ *    <name> <algorithm> <level> <basket size> <auto-flush>
+ *
+ *  Algorithms are "zlib", "lzma", "lz4", "zstd",
+ *  or "default" (i.e. leave ROOT's setting).
+ */
+namespace CompressionProfiles {
+
+  // ==========================================================================
+  //! Output settings
+  // ==========================================================================
+  /*! A basket size or auto-flush of 0 leaves the
+   *  ROOT default. As in TTree::SetAutoFlush, a
+   *  positive auto-flush is a no. of entries and
+   *  a negative one is a no. of bytes.
+   */
+  struct Profile {
+
+    std::string name       = "default";
+    std::string algorithm  = "default";
+    int         level      = -1;
+    int         basketSize = 0;
+    Long64_t    autoFlush  = 0;
+
+  };  // end Profile
+
+
+
+  // --------------------------------------------------------------------------
+  //! Built-in profiles
+  // --------------------------------------------------------------------------
+  /*! The per-type profiles leave ROOT's settings
+   *  until 'BenchmarkCompression.cxx' has measured
+   *  a recommendation to load over them:
+   *    "podio"      = reconstruction output
+   *    "tuple"      = calibration tuples
+   *    "tmva"       = TMVA training output
+   *    "histograms" = histogram files
+   */
+  inline std::map<std::string, Profile>& GetBuiltInProfiles() {
+
+    static std::map<std::string, Profile> profiles = {
+      {"default",    {"default",    "default", -1, 0,      0}},
+      {"fast",       {"fast",       "lz4",      4, 0,      0}},
+      {"balanced",   {"balanced",   "zstd",     5, 0,      0}},
+      {"small",      {"small",      "lzma",     8, 0,      0}},
+      {"podio",      {"podio",      "default", -1, 0,      0}},
+      {"tuple",      {"tuple",      "default", -1, 0,      0}},
+      {"tmva",       {"tmva",       "default", -1, 0,      0}},
+      {"histograms", {"histograms", "default", -1, 0,      0}}
+    };
+    return profiles;
+
+  }  // end 'GetBuiltInProfiles()'
+
+
+
+  // --------------------------------------------------------------------------
+  //! Convert an algorithm name to a ROOT compression algorithm
+  // --------------------------------------------------------------------------
+  inline bool GetAlgorithm(const std::string& name, ROOT::RCompressionSetting::EAlgorithm::EValues& algorithm) {
+
+    if (name == "zlib") {
+      algorithm = ROOT::RCompressionSetting::EAlgorithm::kZLIB;
+    } else if (name == "lzma") {
+      algorithm = ROOT::RCompressionSetting::EAlgorithm::kLZMA;
+    } else if (name == "lz4") {
+      algorithm = ROOT::RCompressionSetting::EAlgorithm::kLZ4;
+    } else if (name == "zstd") {
+      algorithm = ROOT::RCompressionSetting::EAlgorithm::kZSTD;
+    } else {
+      return false;
+    }
+    return true;
+
+  }  // end 'GetAlgorithm(std::string&, ROOT::RCompressionSetting::EAlgorithm::EValues&)'
+
+
+
+  // --------------------------------------------------------------------------
+  //! Get ROOT compression setting (e.g. 505) of a profile
+  // --------------------------------------------------------------------------
+  /*! Returns -1 if the profile leaves ROOT's default.
+   */
+  inline int GetSettings(const Profile& profile) {
+
+    ROOT::RCompressionSetting::EAlgorithm::EValues algorithm;
+    if (!GetAlgorithm(profile.algorithm, algorithm) || (profile.level < 0)) return -1;
+    return ROOT::CompressionSettings(algorithm, profile.level);
+
+  }  // end 'GetSettings(Profile&)'
+
+
+
+  // --------------------------------------------------------------------------
+  //! Load profiles from a file, returns no. loaded
+  // --------------------------------------------------------------------------
+  /*! Loaded profiles replace built-in ones of the
+   *  same name.
+   */
+  inline std::size_t Load(const std::string& path) {
+
+    std::ifstream file(path);
+    if (!file.is_open()) {
+      std::cerr << "WARNING: couldn't open compression profiles '" << path << "'!" << std::endl;
+      return 0;
+    }
+
+    std::size_t nLoaded = 0;
+    std::string line;
+    while (std::getline(file, line)) {
+      if (line.empty() || (line[0] == '#')) continue;
+
+      Profile            profile;
+      std::istringstream stream(line);
+      if (stream >> profile.name >> profile.algorithm >> profile.level >> profile.basketSize >> profile.autoFlush) {
+        GetBuiltInProfiles()[profile.name] = profile;
+        ++nLoaded;
+      }
+    }
+    return nLoaded;
+
+  }  // end 'Load(std::string&)'
+
+
+
+  // --------------------------------------------------------------------------
+  //! Get all profiles
+  // --------------------------------------------------------------------------
+  /*! On the first call, profiles are loaded from
+   *  $BHCAL_COMPRESSION_PROFILES (if set).
+   */
+  inline std::map<std::string, Profile>& GetProfiles() {
+
+    static const bool isLoaded = []() {
+      const char* path = std::getenv("BHCAL_COMPRESSION_PROFILES");
+      if (path && (std::string(path) != "")) Load(path);
+      return true;
+    }();
+    (void) isLoaded;
+    return GetBuiltInProfiles();
+
+  }  // end 'GetProfiles()'
+
+
+
+  // --------------------------------------------------------------------------
+  //! Look up a profile by name
+  // --------------------------------------------------------------------------
+  /*! Unknown names fall back to "default" with
+   *  a warning.
+   */
+  inline Profile Get(const std::string& name) {
+
+    const auto& profiles = GetProfiles();
+    if (name.empty()) return profiles.at("default");
+
+    auto profile = profiles.find(name);
+    if (profile == profiles.end()) {
+      std::cerr << "WARNING: unknown compression profile '" << name << "'! Using ROOT defaults." << std::endl;
+      return profiles.at("default");
+    }
+    return profile -> second;
+
+  }  // end 'Get(std::string&)'
+
+
+
+  // --------------------------------------------------------------------------
+  //! Write a list of profiles to a file
+  // --------------------------------------------------------------------------
+  inline void Write(const std::string& path, const std::vector<Profile>& profiles) {
+
+    std::ofstream file(path);
+    file << "# name algorithm level basket_size auto_flush\n";
+    for (const Profile& profile : profiles) {
+      file << profile.name       << " "
+           << profile.algorithm  << " "
+           << profile.level      << " "
+           << profile.basketSize << " "
+           << profile.autoFlush  << "\n";
+    }
+    file.close();
+    return;
+
+  }  // end 'Write(std::string&, std::vector<Profile>&)'
+
+
+
+  // --------------------------------------------------------------------------
+  //! Apply a profile to a file
+  // --------------------------------------------------------------------------
+  /*! n.b. only affects objects written after this
+   *  is called.
+   */
+  inline void Apply(TFile* file, const Profile& profile) {
+
+    const int settings = GetSettings(profile);
+    if (file && (settings >= 0)) {
+      file -> SetCompressionSettings(settings);
+    }
+    return;
+
+  }  // end 'Apply(TFile*, Profile&)'
+
+
+
+  // --------------------------------------------------------------------------
+  //! Set compression of a list of branches (and their sub-branches)
+  // --------------------------------------------------------------------------
+  inline void SetBranchSettings(TObjArray* branches, const int settings) {
+
+    if (!branches) return;
+    for (TObject* object : *branches) {
+      TBranch* branch = (TBranch*) object;
+      branch -> SetCompressionSettings(settings);
+      SetBranchSettings(branch -> GetListOfBranches(), settings);
+    }
+    return;
+
+  }  // end 'SetBranchSettings(TObjArray*, int)'
+
+
+
+  // --------------------------------------------------------------------------
+  //! Apply a profile to a tree
+  // --------------------------------------------------------------------------
+  /*! n.b. should be called before the tree is
+   *  filled. The compression is set on the
+   *  branches directly, so this also works for
+   *  trees in files shared with other writers.
+   */
+  inline void Apply(TTree* tree, const Profile& profile) {
+
+    if (!tree) return;
+
+    const int settings = GetSettings(profile);
+    if (settings >= 0) {
+      SetBranchSettings(tree -> GetListOfBranches(), settings);
+    }
+    if (profile.basketSize > 0) {
+      tree -> SetBasketSize("*", profile.basketSize);
+    }
+    if (profile.autoFlush != 0) {
+      tree -> SetAutoFlush(profile.autoFlush);
+    }
+    return;
+
+  }  // end 'Apply(TTree*, Profile&)'
+
+}  // end CompressionProfiles namespace
+
+#endif
+
+// end ========================================================================
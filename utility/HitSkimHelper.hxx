@@ -0,0 +1,370 @@
+/// ===========================================================================
+/*! \file   HitSkimHelper.hxx
+ *  \author Derek Anderson
+ *  \date   10.17.2026
+ *
+ *  A lightweight namespace to write and read
+ *  region-of-interest hit skims: the hits of a
+ *  few calorimeter collections within an eta-phi
+ *  window of the primary particle, stored as
+ *  columns of cellID and energy, with positions
+ *  looked up from a table of cells.
+ */
+/// ===========================================================================
+
+#ifndef HitSkimHelper_hxx
+#define HitSkimHelper_hxx
+
+// c++ utilities
+#include <cmath>
+#include <array>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <iostream>
+#include <unordered_map>
+// root libraries
+#include <TList.h>
+#include <TFile.h>
+#include <TTree.h>
+#include <TObjString.h>
+
+
+
+// ============================================================================
+//! Hit Skim Helper
+// ============================================================================
+/*! A small namespace to hold the writer and
+ *  reader of the skim format. A skim file has
+ *  two trees:
+ *
+ *    HitSkim       -- one entry per event: the
+ *                     frame no., the primary's
+ *                     PDG code, energy, eta and
+ *                     phi, and for each collection
+ *                     (tagged e.g. "BHCal") the
+ *                     vectors <tag>CellID and
+ *                     <tag>Energy
+ *    CellPositions -- one entry per cell seen in
+ *                     the skim: collection index,
+ *                     cellID and x, y, z [mm]
+ *
+ *  The collection tags are saved (in order) in
+ *  the user info of HitSkim.
+ */
+namespace HitSkimHelper {
+
+  // --------------------------------------------------------------------------
+  //! Check if a point is in an eta-phi window
+  // --------------------------------------------------------------------------
+  inline bool IsInWindow(
+    const double eta,
+    const double phi,
+    const double etaCenter,
+    const double phiCenter,
+    const double dEta,
+    const double dPhi
+  ) {
+
+    return (std::abs(eta - etaCenter) <= dEta)
+        && (std::abs(std::remainder(phi - phiCenter, 2. * M_PI)) <= dPhi);
+
+  }  // end 'IsInWindow(double x 6)'
+
+
+
+  // ==========================================================================
+  //! Skim writer
+  // ==========================================================================
+  /*! Trees are created in the current directory,
+   *  so cd into the output file first. Positions
+   *  are only stored the first time a cell is
+   *  seen, so the table grows with the no. of
+   *  distinct cells rather than with the no. of
+   *  hits.
+   */
+  class Writer {
+
+    private:
+
+      // data members
+      std::vector<std::string>                                          m_tags;
+      std::vector<std::vector<ULong64_t>>                               m_cellIDs;
+      std::vector<std::vector<Float_t>>                                 m_energies;
+      std::vector<std::unordered_map<uint64_t, std::array<Float_t, 3>>> m_positions;
+      ULong64_t                                                         m_event  = 0;
+      Int_t                                                             m_parPdg = 0;
+      Float_t                                                           m_parEne = 0.;
+      Float_t                                                           m_parEta = 0.;
+      Float_t                                                           m_parPhi = 0.;
+      TTree*                                                            m_tree   = nullptr;
+
+    public:
+
+      // ----------------------------------------------------------------------
+      //! Getters
+      // ----------------------------------------------------------------------
+      TTree*                          GetTree() const {return m_tree;}
+      const std::vector<std::string>& GetTags() const {return m_tags;}
+
+      // ----------------------------------------------------------------------
+      //! Set primary particle of current event
+      // ----------------------------------------------------------------------
+      void SetParticle(
+        const uint64_t event,
+        const int pdg,
+        const float ene,
+        const float eta,
+        const float phi
+      ) {
+
+        m_event  = event;
+        m_parPdg = pdg;
+        m_parEne = ene;
+        m_parEta = eta;
+        m_parPhi = phi;
+
+      }  // end 'SetParticle(uint64_t, int, float x 3)'
+
+      // ----------------------------------------------------------------------
+      //! Add a hit to a collection of the current event
+      // ----------------------------------------------------------------------
+      void AddHit(
+        const std::size_t iColl,
+        const uint64_t cellID,
+        const float energy,
+        const float x,
+        const float y,
+        const float z
+      ) {
+
+        m_cellIDs[iColl].push_back(cellID);
+        m_energies[iColl].push_back(energy);
+        m_positions[iColl].emplace(cellID, std::array<Float_t, 3>{x, y, z});
+
+      }  // end 'AddHit(std::size_t, uint64_t, float x 4)'
+
+      // ----------------------------------------------------------------------
+      //! Fill current event and clear hits
+      // ----------------------------------------------------------------------
+      void Fill() {
+
+        m_tree -> Fill();
+        for (std::size_t iColl = 0; iColl < m_tags.size(); ++iColl) {
+          m_cellIDs[iColl].clear();
+          m_energies[iColl].clear();
+        }
+
+      }  // end 'Fill()'
+
+      // ----------------------------------------------------------------------
+      //! Write skim and table of cell positions
+      // ----------------------------------------------------------------------
+      void Write() {
+
+        m_tree -> Write();
+
+        Int_t     collection = 0;
+        ULong64_t cellID     = 0;
+        Float_t   position[3];
+
+        TTree* cells = new TTree("CellPositions", "Positions of cells in hit skim");
+        cells -> Branch("collection", &collection, "collection/I");
+        cells -> Branch("cellID",     &cellID,     "cellID/l");
+        cells -> Branch("x",          &position[0], "x/F");
+        cells -> Branch("y",          &position[1], "y/F");
+        cells -> Branch("z",          &position[2], "z/F");
+        for (std::size_t iColl = 0; iColl < m_tags.size(); ++iColl) {
+          collection = (Int_t) iColl;
+          for (const auto& cell : m_positions[iColl]) {
+            cellID      = cell.first;
+            position[0] = cell.second[0];
+            position[1] = cell.second[1];
+            position[2] = cell.second[2];
+            cells -> Fill();
+          }
+        }
+        cells -> Write();
+
+      }  // end 'Write()'
+
+      // ----------------------------------------------------------------------
+      //! default ctor/dtor
+      // ----------------------------------------------------------------------
+      Writer()  {};
+      ~Writer() {};
+
+      // ----------------------------------------------------------------------
+      //! ctor accepting collection tags
+      // ----------------------------------------------------------------------
+      Writer(const std::vector<std::string>& tags) : m_tags(tags) {
+
+        m_cellIDs.resize(m_tags.size());
+        m_energies.resize(m_tags.size());
+        m_positions.resize(m_tags.size());
+
+        m_tree = new TTree("HitSkim", "Hits in region of interest around primary");
+        m_tree -> Branch("event",  &m_event,  "event/l");
+        m_tree -> Branch("parPdg", &m_parPdg, "parPdg/I");
+        m_tree -> Branch("parEne", &m_parEne, "parEne/F");
+        m_tree -> Branch("parEta", &m_parEta, "parEta/F");
+        m_tree -> Branch("parPhi", &m_parPhi, "parPhi/F");
+        for (std::size_t iColl = 0; iColl < m_tags.size(); ++iColl) {
+          m_tree -> Branch((m_tags[iColl] + "CellID").data(), &m_cellIDs[iColl]);
+          m_tree -> Branch((m_tags[iColl] + "Energy").data(), &m_energies[iColl]);
+          m_tree -> GetUserInfo() -> Add(new TObjString(m_tags[iColl].data()));
+        }
+
+      }  // end ctor(std::vector<std::string>&)
+
+  };  // end HitSkimHelper::Writer
+
+
+
+  // ==========================================================================
+  //! Skim reader
+  // ==========================================================================
+  /*! The table of cell positions is loaded into
+   *  memory when attaching, so looking up the
+   *  position of a hit is a hash-map lookup.
+   */
+  class Reader {
+
+    private:
+
+      // data members
+      std::vector<std::string>                                          m_tags;
+      std::vector<std::vector<ULong64_t>*>                              m_cellIDs;
+      std::vector<std::vector<Float_t>*>                                m_energies;
+      std::vector<std::unordered_map<uint64_t, std::array<Float_t, 3>>> m_positions;
+      ULong64_t                                                         m_event  = 0;
+      Int_t                                                             m_parPdg = 0;
+      Float_t                                                           m_parEne = 0.;
+      Float_t                                                           m_parEta = 0.;
+      Float_t                                                           m_parPhi = 0.;
+      TTree*                                                            m_tree   = nullptr;
+
+    public:
+
+      // ----------------------------------------------------------------------
+      //! Getters
+      // ----------------------------------------------------------------------
+      uint64_t                        GetEvent()   const {return m_event;}
+      int                             GetParPdg()  const {return m_parPdg;}
+      float                           GetParEne()  const {return m_parEne;}
+      float                           GetParEta()  const {return m_parEta;}
+      float                           GetParPhi()  const {return m_parPhi;}
+      const std::vector<std::string>& GetTags()    const {return m_tags;}
+      uint64_t                        GetEntries() const {return m_tree ? m_tree -> GetEntries() : 0;}
+
+      const std::vector<ULong64_t>& GetCellIDs(const std::size_t iColl)  const {return *m_cellIDs[iColl];}
+      const std::vector<Float_t>&   GetEnergies(const std::size_t iColl) const {return *m_energies[iColl];}
+
+      // ----------------------------------------------------------------------
+      //! Get index of a collection by tag (-1 if not in skim)
+      // ----------------------------------------------------------------------
+      int GetIndex(const std::string& tag) const {
+
+        for (std::size_t iColl = 0; iColl < m_tags.size(); ++iColl) {
+          if (m_tags[iColl] == tag) return (int) iColl;
+        }
+        return -1;
+
+      }  // end 'GetIndex(std::string&)'
+
+      // ----------------------------------------------------------------------
+      //! Get position of a cell (false if not in table)
+      // ----------------------------------------------------------------------
+      bool GetPosition(const std::size_t iColl, const uint64_t cellID, std::array<Float_t, 3>& position) const {
+
+        auto cell = m_positions[iColl].find(cellID);
+        if (cell == m_positions[iColl].end()) return false;
+
+        position = cell -> second;
+        return true;
+
+      }  // end 'GetPosition(std::size_t, uint64_t, std::array<Float_t, 3>&)'
+
+      // ----------------------------------------------------------------------
+      //! Load an event
+      // ----------------------------------------------------------------------
+      void GetEntry(const uint64_t entry) {
+
+        m_tree -> GetEntry(entry);
+
+      }  // end 'GetEntry(uint64_t)'
+
+      // ----------------------------------------------------------------------
+      //! Attach to a skim file, returns false if it isn't one
+      // ----------------------------------------------------------------------
+      bool Attach(TFile* file) {
+
+        m_tree = file ? (TTree*) file -> Get("HitSkim") : nullptr;
+        TTree* cells = file ? (TTree*) file -> Get("CellPositions") : nullptr;
+        if (!m_tree || !cells) {
+          std::cerr << "WARNING: no hit skim found in file!" << std::endl;
+          m_tree = nullptr;
+          return false;
+        }
+
+        // get collection tags
+        m_tags.clear();
+        for (TObject* tag : *(m_tree -> GetUserInfo())) {
+          m_tags.push_back( ((TObjString*) tag) -> GetString().Data() );
+        }
+
+        // set branch addresses
+        m_cellIDs.assign(m_tags.size(), nullptr);
+        m_energies.assign(m_tags.size(), nullptr);
+        m_tree -> SetBranchAddress("event",  &m_event);
+        m_tree -> SetBranchAddress("parPdg", &m_parPdg);
+        m_tree -> SetBranchAddress("parEne", &m_parEne);
+        m_tree -> SetBranchAddress("parEta", &m_parEta);
+        m_tree -> SetBranchAddress("parPhi", &m_parPhi);
+        for (std::size_t iColl = 0; iColl < m_tags.size(); ++iColl) {
+          m_tree -> SetBranchAddress((m_tags[iColl] + "CellID").data(), &m_cellIDs[iColl]);
+          m_tree -> SetBranchAddress((m_tags[iColl] + "Energy").data(), &m_energies[iColl]);
+        }
+
+        // load table of cell positions
+        Int_t     collection = 0;
+        ULong64_t cellID     = 0;
+        Float_t   position[3];
+        cells -> SetBranchAddress("collection", &collection);
+        cells -> SetBranchAddress("cellID",     &cellID);
+        cells -> SetBranchAddress("x",          &position[0]);
+        cells -> SetBranchAddress("y",          &position[1]);
+        cells -> SetBranchAddress("z",          &position[2]);
+
+        m_positions.assign(m_tags.size(), {});
+        for (Long64_t iCell = 0; iCell < cells -> GetEntries(); ++iCell) {
+          cells -> GetEntry(iCell);
+          if ((collection < 0) || ((std::size_t) collection >= m_tags.size())) continue;
+          m_positions[collection][cellID] = {position[0], position[1], position[2]};
+        }
+        return true;
+
+      }  // end 'Attach(TFile*)'
+
+      // ----------------------------------------------------------------------
+      //! default ctor/dtor
+      // ----------------------------------------------------------------------
+      Reader()  {};
+      ~Reader() {};
+
+      // ----------------------------------------------------------------------
+      //! ctor accepting a file
+      // ----------------------------------------------------------------------
+      Reader(TFile* file) {
+
+        Attach(file);
+
+      }  // end ctor(TFile*)
+
+  };  // end HitSkimHelper::Reader
+
+}  // end HitSkimHelper namespace
+
+#endif
+
+// end ========================================================================
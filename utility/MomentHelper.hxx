@@ -0,0 +1,479 @@
+/// ===========================================================================
+/*! \file   MomentHelper.hxx
+ *  \author Derek Anderson
+ *  \date   10.17.2026
+ *
+ *  A lightweight namespace to accumulate the mean,
+ *  variance, and higher moments of a quantity in a
+ *  single pass, without storing or binning values,
+ *  and to save/merge them across files.
+ */
+/// ===========================================================================
+
+#ifndef MomentHelper_hxx
+#define MomentHelper_hxx
+
+// c++ utilities
+#include <map>
+#include <cmath>
+#include <deque>
+#include <tuple>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <utility>
+#include <algorithm>
+// root libraries
+#include <TTree.h>
+
+
+
+// ============================================================================
+//! Moment Helper
+// ============================================================================
+/*! A small namespace to hold streaming moment
+ *  accumulators, which can be merged exactly
+ *  (e.g. across threads or files).
+ */
+namespace MomentHelper {
+
+  // ==========================================================================
+  //! Accumulator
+  // ==========================================================================
+  /*! Accumulates the count, mean, and the 2nd, 3rd
+   *  and 4th central moment sums of a quantity.
+   *  Values are added with Welford's update (as
+   *  extended by Terriberry), and accumulators are
+   *  combined with the pairwise formulas of Pébay
+   *  (SAND2008-6212), so merging is exact up to
+   *  rounding, independent of order.
+   */
+  class Accumulator {
+
+    private:
+
+      // data members
+      uint64_t m_count = 0;
+      double   m_mean  = 0.;
+      double   m_m2    = 0.;
+      double   m_m3    = 0.;
+      double   m_m4    = 0.;
+
+    public:
+
+      // ----------------------------------------------------------------------
+      //! Getters
+      // ----------------------------------------------------------------------
+      uint64_t GetCount() const {return m_count;}
+      double   GetMean()  const {return m_mean;}
+      double   GetM2()    const {return m_m2;}
+      double   GetM3()    const {return m_m3;}
+      double   GetM4()    const {return m_m4;}
+
+      // ----------------------------------------------------------------------
+      //! Add a value
+      // ----------------------------------------------------------------------
+      void Add(const double value) {
+
+        const double n1     = m_count;
+        const double n      = ++m_count;
+        const double delta  = value - m_mean;
+        const double deltaN = delta / n;
+        const double delta2 = deltaN * deltaN;
+        const double term1  = delta * deltaN * n1;
+
+        m_mean += deltaN;
+        m_m4   += (term1 * delta2 * ((n * n) - (3. * n) + 3.)) + (6. * delta2 * m_m2) - (4. * deltaN * m_m3);
+        m_m3   += (term1 * deltaN * (n - 2.)) - (3. * deltaN * m_m2);
+        m_m2   += term1;
+
+      }  // end 'Add(double)'
+
+      // ----------------------------------------------------------------------
+      //! Merge another accumulator into this one
+      // ----------------------------------------------------------------------
+      void Merge(const Accumulator& other) {
+
+        if (other.m_count == 0) return;
+        if (m_count == 0) {
+          *this = other;
+          return;
+        }
+
+        const double nA     = m_count;
+        const double nB     = other.m_count;
+        const double n      = nA + nB;
+        const double delta  = other.m_mean - m_mean;
+        const double delta2 = delta * delta;
+        const double delta3 = delta2 * delta;
+        const double delta4 = delta2 * delta2;
+
+        const double m2 = m_m2 + other.m_m2 + (delta2 * nA * nB / n);
+        const double m3 = m_m3 + other.m_m3
+                        + (delta3 * nA * nB * (nA - nB) / (n * n))
+                        + (3. * delta * ((nA * other.m_m2) - (nB * m_m2)) / n);
+        const double m4 = m_m4 + other.m_m4
+                        + (delta4 * nA * nB * ((nA * nA) - (nA * nB) + (nB * nB)) / (n * n * n))
+                        + (6. * delta2 * ((nA * nA * other.m_m2) + (nB * nB * m_m2)) / (n * n))
+                        + (4. * delta * ((nA * other.m_m3) - (nB * m_m3)) / n);
+
+        m_count += other.m_count;
+        m_mean  += delta * nB / n;
+        m_m2     = m2;
+        m_m3     = m3;
+        m_m4     = m4;
+
+      }  // end 'Merge(Accumulator&)'
+
+      // ----------------------------------------------------------------------
+      //! Set state directly (e.g. when reading back from a file)
+      // ----------------------------------------------------------------------
+      void Set(const uint64_t count, const double mean, const double m2, const double m3, const double m4) {
+
+        m_count = count;
+        m_mean  = mean;
+        m_m2    = m2;
+        m_m3    = m3;
+        m_m4    = m4;
+
+      }  // end 'Set(uint64_t, double x 4)'
+
+      // ----------------------------------------------------------------------
+      //! Reset accumulator
+      // ----------------------------------------------------------------------
+      void Reset() {
+
+        m_count = 0;
+        m_mean  = 0.;
+        m_m2    = 0.;
+        m_m3    = 0.;
+        m_m4    = 0.;
+
+      }  // end 'Reset()'
+
+      // ----------------------------------------------------------------------
+      //! Get (sample) variance
+      // ----------------------------------------------------------------------
+      double GetVariance() const {
+
+        return (m_count > 1) ? m_m2 / (m_count - 1.) : 0.;
+
+      }  // end 'GetVariance()'
+
+      // ----------------------------------------------------------------------
+      //! Get (sample) standard deviation
+      // ----------------------------------------------------------------------
+      double GetStdDev() const {
+
+        return std::sqrt(GetVariance());
+
+      }  // end 'GetStdDev()'
+
+      // ----------------------------------------------------------------------
+      //! Get skewness
+      // ----------------------------------------------------------------------
+      double GetSkewness() const {
+
+        return (m_m2 > 0.) ? std::sqrt((double) m_count) * m_m3 / std::pow(m_m2, 1.5) : 0.;
+
+      }  // end 'GetSkewness()'
+
+      // ----------------------------------------------------------------------
+      //! Get excess kurtosis
+      // ----------------------------------------------------------------------
+      double GetKurtosis() const {
+
+        return (m_m2 > 0.) ? (m_count * m_m4 / (m_m2 * m_m2)) - 3. : 0.;
+
+      }  // end 'GetKurtosis()'
+
+      // ----------------------------------------------------------------------
+      //! Get error on mean
+      // ----------------------------------------------------------------------
+      double GetMeanError() const {
+
+        return (m_count > 0) ? GetStdDev() / std::sqrt((double) m_count) : 0.;
+
+      }  // end 'GetMeanError()'
+
+      // ----------------------------------------------------------------------
+      //! Get error on standard deviation
+      // ----------------------------------------------------------------------
+      /*! Uses the 4th moment rather than assuming a
+       *  gaussian, i.e. var(s^2) = (mu4 - s^4 (n - 3)/(n - 1)) / n
+       *  and err(s) = sqrt(var(s^2)) / 2s.
+       */
+      double GetStdDevError() const {
+
+        if ((m_count < 2) || (m_m2 <= 0.)) return 0.;
+
+        const double n     = m_count;
+        const double var   = GetVariance();
+        const double mu4   = m_m4 / n;
+        const double varS2 = (mu4 - (var * var * (n - 3.) / (n - 1.))) / n;
+        return (varS2 > 0.) ? std::sqrt(varS2) / (2. * std::sqrt(var)) : 0.;
+
+      }  // end 'GetStdDevError()'
+
+      // ----------------------------------------------------------------------
+      //! Get resolution (standard deviation over mean)
+      // ----------------------------------------------------------------------
+      double GetResolution() const {
+
+        return (m_mean != 0.) ? GetStdDev() / m_mean : 0.;
+
+      }  // end 'GetResolution()'
+
+      // ----------------------------------------------------------------------
+      //! Get error on resolution
+      // ----------------------------------------------------------------------
+      double GetResolutionError() const {
+
+        const double sd = GetStdDev();
+        if ((m_mean == 0.) || (sd == 0.)) return 0.;
+
+        return GetResolution() * std::hypot(GetMeanError() / m_mean, GetStdDevError() / sd);
+
+      }  // end 'GetResolutionError()'
+
+      // ----------------------------------------------------------------------
+      //! default ctor/dtor
+      // ----------------------------------------------------------------------
+      Accumulator()  {};
+      ~Accumulator() {};
+
+  };  // end MomentHelper::Accumulator
+
+
+
+  // ==========================================================================
+  //! Slice
+  // ==========================================================================
+  /*! An accumulator for a variable in a slice
+   *  (e.g. a bin of particle energy), along
+   *  with the slice's edges and center.
+   */
+  struct Slice {
+
+    std::string variable = "";
+    std::string tag      = "";
+    double      center   = 0.;
+    double      low      = 0.;
+    double      high     = 0.;
+    Accumulator moments;
+
+  };  // end Slice
+
+
+
+  // ==========================================================================
+  //! Table
+  // ==========================================================================
+  /*! A collection of slices which can be saved
+   *  to (and read back from) a TTree with one
+   *  row per slice. Since hadd concatenates the
+   *  rows of trees, merging many files is just
+   *  a matter of reading all of the rows: rows
+   *  with the same variable, tag and edges are
+   *  merged. Rows whose edges differ are kept as
+   *  separate slices even if their tags match,
+   *  since tags of data-derived slices (e.g.
+   *  "EneSlice0") aren't unique across inputs.
+   *
+   *  n.b. slices are held in a deque so that
+   *  references returned by Get() stay valid
+   *  as new slices are added.
+   */
+  class Table {
+
+    private:
+
+      // slices are keyed by (variable, tag, low, high)
+      typedef std::tuple<std::string, std::string, double, double> Key;
+
+      // data members
+      std::deque<Slice>          m_slices;
+      std::map<Key, std::size_t> m_index;
+
+    public:
+
+      // ----------------------------------------------------------------------
+      //! Getters
+      // ----------------------------------------------------------------------
+      const std::deque<Slice>& GetSlices() const {return m_slices;}
+
+      // ----------------------------------------------------------------------
+      //! Get accumulator for a variable in a slice, creating it if needed
+      // ----------------------------------------------------------------------
+      Accumulator& Get(
+        const std::string& variable,
+        const std::string& tag,
+        const double center = 0.,
+        const double low = 0.,
+        const double high = 0.
+      ) {
+
+        const Key key = std::make_tuple(variable, tag, low, high);
+        auto it = m_index.find(key);
+        if (it != m_index.end()) {
+          return m_slices[it -> second].moments;
+        }
+
+        m_slices.push_back( {variable, tag, center, low, high, Accumulator()} );
+        m_index[key] = m_slices.size() - 1;
+        return m_slices.back().moments;
+
+      }  // end 'Get(std::string&, std::string&, double x 3)'
+
+      // ----------------------------------------------------------------------
+      //! Get list of variables (in order of first appearance)
+      // ----------------------------------------------------------------------
+      std::vector<std::string> GetVariables() const {
+
+        std::vector<std::string> variables;
+        for (const Slice& slice : m_slices) {
+          if (std::find(variables.begin(), variables.end(), slice.variable) == variables.end()) {
+            variables.push_back(slice.variable);
+          }
+        }
+        return variables;
+
+      }  // end 'GetVariables()'
+
+      // ----------------------------------------------------------------------
+      //! Get slices of a variable, sorted by center
+      // ----------------------------------------------------------------------
+      std::vector<Slice> GetSlices(const std::string& variable) const {
+
+        std::vector<Slice> slices;
+        for (const Slice& slice : m_slices) {
+          if (slice.variable == variable) {
+            slices.push_back(slice);
+          }
+        }
+        std::sort(
+          slices.begin(),
+          slices.end(),
+          [](const Slice& lhs, const Slice& rhs) {return lhs.center < rhs.center;}
+        );
+        return slices;
+
+      }  // end 'GetSlices(std::string&)'
+
+      // ----------------------------------------------------------------------
+      //! Merge another table into this one
+      // ----------------------------------------------------------------------
+      void Merge(const Table& other) {
+
+        for (const Slice& slice : other.m_slices) {
+          Get(slice.variable, slice.tag, slice.center, slice.low, slice.high).Merge(slice.moments);
+        }
+
+      }  // end 'Merge(Table&)'
+
+      // ----------------------------------------------------------------------
+      //! Make a TTree of the table in the current directory
+      // ----------------------------------------------------------------------
+      /*! n.b. the tree isn't written, that's left
+       *  to the caller. Branch addresses point at
+       *  locals here, so they're reset before
+       *  returning.
+       */
+      TTree* MakeTree(const std::string& name) const {
+
+        std::string variable;
+        std::string tag;
+        double      center = 0.;
+        double      low    = 0.;
+        double      high   = 0.;
+        ULong64_t   count  = 0;
+        double      mean   = 0.;
+        double      m2     = 0.;
+        double      m3     = 0.;
+        double      m4     = 0.;
+
+        TTree* tree = new TTree(name.data(), "Moments per variable and slice");
+        tree -> Branch("variable", &variable);
+        tree -> Branch("tag", &tag);
+        tree -> Branch("center", &center, "center/D");
+        tree -> Branch("low", &low, "low/D");
+        tree -> Branch("high", &high, "high/D");
+        tree -> Branch("count", &count, "count/l");
+        tree -> Branch("mean", &mean, "mean/D");
+        tree -> Branch("m2", &m2, "m2/D");
+        tree -> Branch("m3", &m3, "m3/D");
+        tree -> Branch("m4", &m4, "m4/D");
+
+        for (const Slice& slice : m_slices) {
+          variable = slice.variable;
+          tag      = slice.tag;
+          center   = slice.center;
+          low      = slice.low;
+          high     = slice.high;
+          count    = slice.moments.GetCount();
+          mean     = slice.moments.GetMean();
+          m2       = slice.moments.GetM2();
+          m3       = slice.moments.GetM3();
+          m4       = slice.moments.GetM4();
+          tree -> Fill();
+        }
+        tree -> ResetBranchAddresses();
+        return tree;
+
+      }  // end 'MakeTree(std::string&)'
+
+      // ----------------------------------------------------------------------
+      //! Read rows of a TTree (or TChain) into the table
+      // ----------------------------------------------------------------------
+      void ReadTree(TTree* tree) {
+
+        std::string variable;
+        std::string tag;
+        double      center = 0.;
+        double      low    = 0.;
+        double      high   = 0.;
+        ULong64_t   count  = 0;
+        double      mean   = 0.;
+        double      m2     = 0.;
+        double      m3     = 0.;
+        double      m4     = 0.;
+
+        // n.b. point the string branches at the strings
+        // above, so ROOT doesn't allocate (and leak) its own
+        std::string* pVariable = &variable;
+        std::string* pTag      = &tag;
+
+        tree -> SetBranchAddress("variable", &pVariable);
+        tree -> SetBranchAddress("tag", &pTag);
+        tree -> SetBranchAddress("center", &center);
+        tree -> SetBranchAddress("low", &low);
+        tree -> SetBranchAddress("high", &high);
+        tree -> SetBranchAddress("count", &count);
+        tree -> SetBranchAddress("mean", &mean);
+        tree -> SetBranchAddress("m2", &m2);
+        tree -> SetBranchAddress("m3", &m3);
+        tree -> SetBranchAddress("m4", &m4);
+
+        Accumulator row;
+        for (Long64_t iEntry = 0; iEntry < tree -> GetEntries(); ++iEntry) {
+          tree -> GetEntry(iEntry);
+          row.Set(count, mean, m2, m3, m4);
+          Get(variable, tag, center, low, high).Merge(row);
+        }
+        tree -> ResetBranchAddresses();
+
+      }  // end 'ReadTree(TTree*)'
+
+      // ----------------------------------------------------------------------
+      //! default ctor/dtor
+      // ----------------------------------------------------------------------
+      Table()  {};
+      ~Table() {};
+
+  };  // end MomentHelper::Table
+
+}  // end MomentHelper namespace
+
+#endif
+
+// end ========================================================================
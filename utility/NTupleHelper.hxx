@@ -81,6 +81,22 @@ class NTupleHelper {
 
     }  // end 'SetVariable(std::string&, float)'
 
+    // ------------------------------------------------------------------------
+    //! Add a variable (e.g. an optional one) to the end of the list
+    // ------------------------------------------------------------------------
+    inline void AddVariable(const std::string& var) {
+
+      // check if variable already exists
+      if (m_index.count(var)) return;
+
+      // then add variable
+      m_index[var] = m_variables.size();
+      m_variables.push_back(var);
+      m_values.resize(m_variables.size());
+      return;
+
+    }  // end 'AddVariable(std::string&)'
+
     // ------------------------------------------------------------------------
     //! Assign variables to TNtuple branches
     // ------------------------------------------------------------------------
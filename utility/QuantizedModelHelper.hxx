@@ -0,0 +1,1115 @@
+/// ===========================================================================
+/*! \file   QuantizedModelHelper.hxx
+ *  \author Derek Anderson
+ *  \date   10.17.2026
+ *
+ *  A lightweight namespace to evaluate TMVA regression
+ *  models (LD, MLP, BDT/BDTG) with reduced-precision
+ *  (fp16/int8) weights over batches of events.
+ */
+/// ===========================================================================
+
+#ifndef QuantizedModelHelper_hxx
+#define QuantizedModelHelper_hxx
+
+// c++ utilities
+#include <map>
+#include <cmath>
+#include <limits>
+#include <string>
+#include <vector>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <sstream>
+#include <iostream>
+#include <algorithm>
+// root libraries
+#include <TXMLEngine.h>
+
+
+
+// ============================================================================
+//! Quantized Model Helper
+// ============================================================================
+/*! A small namespace to evaluate models trained with
+ *  ROOT TMVA without going through TMVA::Reader. The
+ *  weights file is parsed directly and the model
+ *  parameters are stored in the requested precision:
+ *
+ *    - LD:   coefficients;
+ *    - MLP:  synapse matrices (biases are kept in fp32);
+ *    - BDT:  split thresholds are always stored as uint16
+ *            bin indices, leaf responses in the requested
+ *            precision.
+ *
+ *  Models are evaluated over batches of events laid out
+ *  as structure-of-arrays (i.e. input[iVar * nEvt + iEvt])
+ *  so that the inner loops run over events and can be
+ *  vectorized.
+ */
+namespace QuantizedModelHelper {
+
+  // --------------------------------------------------------------------------
+  //! Precisions available for model parameters
+  // --------------------------------------------------------------------------
+  enum Precision {Float32, Float16, Int8};
+
+
+
+  // --------------------------------------------------------------------------
+  //! Helper method to translate a precision into a string
+  // --------------------------------------------------------------------------
+  inline std::string GetPrecisionName(const Precision precision) {
+
+    std::string name("");
+    switch (precision) {
+      case Precision::Float16:
+        name = "fp16";
+        break;
+      case Precision::Int8:
+        name = "int8";
+        break;
+      case Precision::Float32:
+        [[fallthrough]];
+      default:
+        name = "fp32";
+        break;
+    }
+    return name;
+
+  }  // end 'GetPrecisionName(Precision)'
+
+
+
+  // --------------------------------------------------------------------------
+  //! Convert a float to IEEE 754 half precision (round to nearest even)
+  // --------------------------------------------------------------------------
+  inline uint16_t FloatToHalf(const float value) {
+
+    uint32_t bits = 0;
+    std::memcpy(&bits, &value, sizeof(bits));
+
+    const uint32_t sign = (bits >> 16) & 0x8000;
+    const uint32_t raw  = (bits >> 23) & 0xff;
+    const int32_t  expo = (int32_t) raw - 127 + 15;
+    uint32_t       mant = bits & 0x7fffff;
+
+    // inf/nan
+    if (raw == 0xff) {
+      return sign | 0x7c00 | (mant ? 0x200 : 0);
+    }
+
+    // overflow
+    if (expo >= 0x1f) {
+      return sign | 0x7c00;
+    }
+
+    // subnormal or underflow
+    if (expo <= 0) {
+      if (expo < -10) return sign;
+      mant |= 0x800000;
+      const uint32_t shift = 14 - expo;
+      const uint32_t rem   = mant & ((1u << shift) - 1);
+      const uint32_t mid   = 1u << (shift - 1);
+      uint32_t       half  = mant >> shift;
+      if ((rem > mid) || ((rem == mid) && (half & 1))) ++half;
+      return sign | half;
+    }
+
+    // normal (a carry out of the mantissa correctly bumps the exponent)
+    uint32_t       half = ((uint32_t) expo << 10) | (mant >> 13);
+    const uint32_t rem  = mant & 0x1fff;
+    if ((rem > 0x1000) || ((rem == 0x1000) && (half & 1))) ++half;
+    return sign | half;
+
+  }  // end 'FloatToHalf(float)'
+
+
+
+  // --------------------------------------------------------------------------
+  //! Convert IEEE 754 half precision to a float
+  // --------------------------------------------------------------------------
+  inline float HalfToFloat(const uint16_t half) {
+
+    const uint32_t sign = ((uint32_t) half & 0x8000) << 16;
+    int32_t        expo = (half >> 10) & 0x1f;
+    uint32_t       mant = half & 0x3ff;
+
+    uint32_t bits = 0;
+    if (expo == 0) {
+      if (mant == 0) {
+        bits = sign;
+      } else {
+        expo = 1;
+        while (!(mant & 0x400)) {
+          mant <<= 1;
+          --expo;
+        }
+        mant &= 0x3ff;
+        bits  = sign | ((uint32_t) (expo + 127 - 15) << 23) | (mant << 13);
+      }
+    } else if (expo == 0x1f) {
+      bits = sign | 0x7f800000 | (mant << 13);
+    } else {
+      bits = sign | ((uint32_t) (expo + 127 - 15) << 23) | (mant << 13);
+    }
+
+    float value = 0.;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+
+  }  // end 'HalfToFloat(uint16_t)'
+
+
+
+  // --------------------------------------------------------------------------
+  //! Symmetric int8 scale for a range of values
+  // --------------------------------------------------------------------------
+  inline float GetInt8Scale(const float* values, const std::size_t nValues) {
+
+    float maxAbs = 0.;
+    for (std::size_t iVal = 0; iVal < nValues; ++iVal) {
+      maxAbs = std::max(maxAbs, std::abs(values[iVal]));
+    }
+    return (maxAbs > 0.) ? (maxAbs / 127.) : 1.;
+
+  }  // end 'GetInt8Scale(float*, std::size_t)'
+
+
+
+  // --------------------------------------------------------------------------
+  //! Quantize a value to int8 given a scale
+  // --------------------------------------------------------------------------
+  inline int8_t ToInt8(const float value, const float scale) {
+
+    const long quant = std::lround(value / scale);
+    return (int8_t) std::clamp(quant, -127L, 127L);
+
+  }  // end 'ToInt8(float, float)'
+
+
+
+  // ==========================================================================
+  //! Quantized Array
+  // ==========================================================================
+  /*! Stores a row-major (nRow x nCol) array of
+   *  parameters in the requested precision. For
+   *  int8, each row gets its own symmetric scale.
+   */
+  class QuantizedArray {
+
+    private:
+
+      // data members
+      Precision             m_precision = Precision::Float32;
+      std::size_t           m_rows      = 0;
+      std::size_t           m_cols      = 0;
+      std::vector<float>    m_f32;
+      std::vector<uint16_t> m_f16;
+      std::vector<int8_t>   m_i8;
+      std::vector<float>    m_scale;
+
+    public:
+
+      // ----------------------------------------------------------------------
+      //! Getters
+      // ----------------------------------------------------------------------
+      inline Precision     GetPrecision()        const {return m_precision;}
+      inline std::size_t   GetNRows()            const {return m_rows;}
+      inline std::size_t   GetNCols()            const {return m_cols;}
+      inline float         GetScale(std::size_t row) const {return m_scale.at(row);}
+      inline const int8_t* GetInt8Row(std::size_t row) const {return m_i8.data() + (row * m_cols);}
+
+      // ----------------------------------------------------------------------
+      //! Get size of stored parameters in bytes
+      // ----------------------------------------------------------------------
+      inline std::size_t GetNBytes() const {
+
+        return (m_f32.size() * sizeof(float))
+             + (m_f16.size() * sizeof(uint16_t))
+             + (m_i8.size() * sizeof(int8_t))
+             + (m_scale.size() * sizeof(float));
+
+      }  // end 'GetNBytes()'
+
+      // ----------------------------------------------------------------------
+      //! Get a single (dequantized) value
+      // ----------------------------------------------------------------------
+      inline float Get(const std::size_t row, const std::size_t col) const {
+
+        const std::size_t index = (row * m_cols) + col;
+
+        float value = 0.;
+        switch (m_precision) {
+          case Precision::Float16:
+            value = HalfToFloat(m_f16[index]);
+            break;
+          case Precision::Int8:
+            value = m_i8[index] * m_scale[row];
+            break;
+          case Precision::Float32:
+            [[fallthrough]];
+          default:
+            value = m_f32[index];
+            break;
+        }
+        return value;
+
+      }  // end 'Get(std::size_t, std::size_t)'
+
+      // ----------------------------------------------------------------------
+      //! Dequantize the full array into a buffer
+      // ----------------------------------------------------------------------
+      inline void Dequantize(std::vector<float>& buffer) const {
+
+        buffer.resize(m_rows * m_cols);
+        for (std::size_t iRow = 0; iRow < m_rows; ++iRow) {
+          for (std::size_t iCol = 0; iCol < m_cols; ++iCol) {
+            buffer[(iRow * m_cols) + iCol] = Get(iRow, iCol);
+          }
+        }
+        return;
+
+      }  // end 'Dequantize(std::vector<float>&)'
+
+      // ----------------------------------------------------------------------
+      //! Default ctor/dtor
+      // ----------------------------------------------------------------------
+      QuantizedArray()  {};
+      ~QuantizedArray() {};
+
+      // ----------------------------------------------------------------------
+      //! ctor accepting full-precision values
+      // ----------------------------------------------------------------------
+      QuantizedArray(
+        const std::vector<float>& values,
+        const std::size_t rows,
+        const std::size_t cols,
+        const Precision precision
+      ) {
+
+        // make sure dimensions are consistent
+        if (values.size() != (rows * cols)) {
+          std::cerr << "PANIC: trying to quantize " << values.size() << " values into a " << rows << "x" << cols << " array!" << std::endl;
+          assert(values.size() == (rows * cols));
+        }
+
+        m_precision = precision;
+        m_rows      = rows;
+        m_cols      = cols;
+        switch (m_precision) {
+          case Precision::Float16:
+            m_f16.resize(values.size());
+            for (std::size_t iVal = 0; iVal < values.size(); ++iVal) {
+              m_f16[iVal] = FloatToHalf(values[iVal]);
+            }
+            break;
+          case Precision::Int8:
+            m_i8.resize(values.size());
+            m_scale.resize(m_rows);
+            for (std::size_t iRow = 0; iRow < m_rows; ++iRow) {
+              m_scale[iRow] = GetInt8Scale(values.data() + (iRow * m_cols), m_cols);
+              for (std::size_t iCol = 0; iCol < m_cols; ++iCol) {
+                const std::size_t index = (iRow * m_cols) + iCol;
+                m_i8[index] = ToInt8(values[index], m_scale[iRow]);
+              }
+            }
+            break;
+          case Precision::Float32:
+            [[fallthrough]];
+          default:
+            m_f32 = values;
+            break;
+        }
+
+      }  // end ctor(std::vector<float>&, std::size_t, std::size_t, Precision)
+
+  };  // end QuantizedModelHelper::QuantizedArray
+
+
+
+  // ==========================================================================
+  //! Quantized Model
+  // ==========================================================================
+  /*! Parses a TMVA weights file and evaluates
+   *  the first regression target of the model.
+   *  Supported methods are LD, MLP (sum input,
+   *  tanh/sigmoid/linear activations) and BDT
+   *  with gradient or plain boosting. The only
+   *  supported variable transformation is
+   *  normalization (VarTransform=Norm).
+   */
+  class Model {
+
+    private:
+
+      // kinds of inputs a transform can select
+      enum Input {Var, Tgt, Spec};
+
+      // general members
+      std::string              m_method    = "";
+      std::string              m_type      = "";
+      Precision                m_precision = Precision::Float32;
+      std::vector<std::string> m_variables;
+
+      // normalization transform
+      bool               m_doNorm = false;
+      std::vector<float> m_varMin;
+      std::vector<float> m_varScale;
+      float              m_tgtMin   = 0.;
+      float              m_tgtScale = 1.;
+
+      // LD members
+      QuantizedArray m_coeffs;
+
+      // MLP members
+      std::string                     m_activation = "tanh";
+      std::vector<QuantizedArray>     m_weights;
+      std::vector<std::vector<float>> m_biases;
+
+      // BDT members
+      float                           m_offset = 0.;
+      std::vector<int32_t>            m_roots;
+      std::vector<int16_t>            m_nodeVar;
+      std::vector<uint16_t>           m_nodeCut;
+      std::vector<int32_t>            m_nodeLeft;
+      std::vector<int32_t>            m_nodeRight;
+      std::vector<int32_t>            m_nodeLeaf;
+      std::vector<std::vector<float>> m_edges;
+      QuantizedArray                  m_leaves;
+      std::vector<float>              m_leafValues;
+
+      // ----------------------------------------------------------------------
+      //! Find first child of a node with a given name
+      // ----------------------------------------------------------------------
+      inline XMLNodePointer_t FindChild(TXMLEngine& xml, XMLNodePointer_t node, const std::string& name) const {
+
+        XMLNodePointer_t child = xml.GetChild(node);
+        while (child) {
+          if (name == xml.GetNodeName(child)) break;
+          child = xml.GetNext(child);
+        }
+        return child;
+
+      }  // end 'FindChild(TXMLEngine&, XMLNodePointer_t, std::string&)'
+
+      // ----------------------------------------------------------------------
+      //! Get an attribute of a node as a float
+      // ----------------------------------------------------------------------
+      inline double GetAttrAsDouble(TXMLEngine& xml, XMLNodePointer_t node, const std::string& attr) const {
+
+        const char* value = xml.GetAttr(node, attr.data());
+        if (!value) {
+          std::cerr << "PANIC: node '" << xml.GetNodeName(node) << "' has no attribute '" << attr << "'!" << std::endl;
+          assert(value);
+        }
+        return std::stod(value);
+
+      }  // end 'GetAttrAsDouble(TXMLEngine&, XMLNodePointer_t, std::string&)'
+
+      // ----------------------------------------------------------------------
+      //! Get the value of a method option
+      // ----------------------------------------------------------------------
+      inline std::string GetOption(TXMLEngine& xml, XMLNodePointer_t top, const std::string& option) const {
+
+        std::string value("");
+
+        XMLNodePointer_t options = FindChild(xml, top, "Options");
+        if (!options) return value;
+
+        XMLNodePointer_t child = xml.GetChild(options);
+        while (child) {
+          const char* name = xml.GetAttr(child, "name");
+          if (name && (option == name)) {
+            const char* content = xml.GetNodeContent(child);
+            if (content) value = content;
+            break;
+          }
+          child = xml.GetNext(child);
+        }
+        return value;
+
+      }  // end 'GetOption(TXMLEngine&, XMLNodePointer_t, std::string&)'
+
+      // ----------------------------------------------------------------------
+      //! Read input variables
+      // ----------------------------------------------------------------------
+      inline void ReadVariables(TXMLEngine& xml, XMLNodePointer_t top) {
+
+        XMLNodePointer_t variables = FindChild(xml, top, "Variables");
+        if (!variables) {
+          std::cerr << "PANIC: weights file has no 'Variables' node!" << std::endl;
+          assert(variables);
+        }
+
+        XMLNodePointer_t variable = xml.GetChild(variables);
+        while (variable) {
+          m_variables.push_back( xml.GetAttr(variable, "Expression") );
+          variable = xml.GetNext(variable);
+        }
+        return;
+
+      }  // end 'ReadVariables(TXMLEngine&, XMLNodePointer_t)'
+
+      // ----------------------------------------------------------------------
+      //! Read variable transformations
+      // ----------------------------------------------------------------------
+      /*! Normalization maps x into 2(x - min)/(max - min) - 1
+       *  for both input variables and targets. Ranges are
+       *  listed in the order of the transform's selection
+       *  (variables first, then targets, by default).
+       */
+      inline void ReadTransformations(TXMLEngine& xml, XMLNodePointer_t top) {
+
+        XMLNodePointer_t transforms = FindChild(xml, top, "Transformations");
+        if (!transforms) return;
+
+        XMLNodePointer_t transform = xml.GetChild(transforms);
+        while (transform) {
+
+          // only normalization is supported
+          const std::string name = xml.GetAttr(transform, "Name");
+          if (name != "Normalize") {
+            std::cerr << "PANIC: variable transformation '" << name << "' not supported!" << std::endl;
+            assert(name == "Normalize");
+          }
+          if (m_doNorm) {
+            std::cerr << "PANIC: only a single normalization transform is supported!" << std::endl;
+            assert(!m_doNorm);
+          }
+          m_doNorm = true;
+
+          // determine which ranges go with which variable/target:
+          // spectators can be part of the selection, but they
+          // aren't inputs to the model so their ranges are skipped
+          std::vector<std::pair<int, std::size_t>> selected;
+          XMLNodePointer_t selection = FindChild(xml, transform, "Selection");
+          if (selection) {
+            std::size_t      nVar   = 0;
+            std::size_t      nTgt   = 0;
+            XMLNodePointer_t inputs = FindChild(xml, selection, "Input");
+            XMLNodePointer_t input  = xml.GetChild(inputs);
+            while (input) {
+              const std::string type = xml.GetAttr(input, "Type");
+              if (type == "Target") {
+                selected.push_back( {Input::Tgt, nTgt++} );
+              } else if (type == "Variable") {
+                selected.push_back( {Input::Var, nVar++} );
+              } else {
+                selected.push_back( {Input::Spec, 0} );
+              }
+              input = xml.GetNext(input);
+            }
+          } else {
+            for (std::size_t iVar = 0; iVar < m_variables.size(); ++iVar) {
+              selected.push_back( {Input::Var, iVar} );
+            }
+            selected.push_back( {Input::Tgt, 0} );
+          }
+
+          // initialize to identity
+          m_varMin.assign(m_variables.size(), 0.);
+          m_varScale.assign(m_variables.size(), 1.);
+
+          // ranges are stored per class: regression only has one
+          XMLNodePointer_t cls    = FindChild(xml, transform, "Class");
+          XMLNodePointer_t ranges = FindChild(xml, cls, "Ranges");
+          XMLNodePointer_t range  = xml.GetChild(ranges);
+          while (range) {
+
+            const std::size_t index = (std::size_t) GetAttrAsDouble(xml, range, "Index");
+            const float       min   = GetAttrAsDouble(xml, range, "Min");
+            const float       max   = GetAttrAsDouble(xml, range, "Max");
+            const float       scale = (max > min) ? (1. / (max - min)) : 1.;
+
+            const auto& which = selected.at(index);
+            if ((which.first == Input::Tgt) && (which.second == 0)) {
+              m_tgtMin   = min;
+              m_tgtScale = scale;
+            } else if (which.first == Input::Var) {
+              m_varMin.at(which.second)   = min;
+              m_varScale.at(which.second) = scale;
+            }
+            range = xml.GetNext(range);
+          }
+          transform = xml.GetNext(transform);
+        }  // end transform loop
+        return;
+
+      }  // end 'ReadTransformations(TXMLEngine&, XMLNodePointer_t)'
+
+      // ----------------------------------------------------------------------
+      //! Read LD coefficients
+      // ----------------------------------------------------------------------
+      inline void ReadLD(TXMLEngine& xml, XMLNodePointer_t weights) {
+
+        // coefficient 0 is the constant term
+        std::vector<float> coeffs(m_variables.size() + 1, 0.);
+
+        XMLNodePointer_t coeff = xml.GetChild(weights);
+        while (coeff) {
+          const std::size_t iOut   = (std::size_t) GetAttrAsDouble(xml, coeff, "IndexOut");
+          const std::size_t iCoeff = (std::size_t) GetAttrAsDouble(xml, coeff, "IndexCoeff");
+          if (iOut == 0) {
+            coeffs.at(iCoeff) = GetAttrAsDouble(xml, coeff, "Value");
+          }
+          coeff = xml.GetNext(coeff);
+        }
+        m_coeffs = QuantizedArray(coeffs, 1, coeffs.size(), m_precision);
+        return;
+
+      }  // end 'ReadLD(TXMLEngine&, XMLNodePointer_t)'
+
+      // ----------------------------------------------------------------------
+      //! Read MLP layout
+      // ----------------------------------------------------------------------
+      /*! Every layer but the output one has a bias
+       *  neuron as its last neuron. The content of
+       *  each neuron node is the list of weights of
+       *  synapses to the (non-bias) neurons of the
+       *  next layer.
+       */
+      inline void ReadMLP(TXMLEngine& xml, XMLNodePointer_t top, XMLNodePointer_t weights) {
+
+        // check network options
+        m_activation = GetOption(xml, top, "NeuronType");
+        if (m_activation.empty()) m_activation = "sigmoid";
+        if ((m_activation != "tanh") && (m_activation != "sigmoid") && (m_activation != "linear")) {
+          std::cerr << "PANIC: MLP neuron type '" << m_activation << "' not supported!" << std::endl;
+          assert(false);
+        }
+
+        const std::string input = GetOption(xml, top, "NeuronInputType");
+        if (!input.empty() && (input != "sum")) {
+          std::cerr << "PANIC: MLP neuron input type '" << input << "' not supported!" << std::endl;
+          assert(input == "sum");
+        }
+
+        // collect synapse weights for each neuron of each layer
+        std::vector<std::vector<std::vector<float>>> layers;
+
+        XMLNodePointer_t layout = FindChild(xml, weights, "Layout");
+        XMLNodePointer_t layer  = xml.GetChild(layout);
+        while (layer) {
+          layers.emplace_back();
+          XMLNodePointer_t neuron = xml.GetChild(layer);
+          while (neuron) {
+            std::vector<float> synapses;
+            const char*        content = xml.GetNodeContent(neuron);
+            if (content) {
+              std::istringstream stream(content);
+              double weight = 0.;
+              while (stream >> weight) synapses.push_back(weight);
+            }
+            layers.back().push_back(synapses);
+            neuron = xml.GetNext(neuron);
+          }
+          layer = xml.GetNext(layer);
+        }
+
+        // build (nOut x nIn) matrices & biases between each pair of layers
+        for (std::size_t iLayer = 0; iLayer + 1 < layers.size(); ++iLayer) {
+
+          const std::size_t nIn  = layers[iLayer].size() - 1;
+          const std::size_t nOut = layers[iLayer].back().size();
+
+          std::vector<float> matrix(nOut * nIn, 0.);
+          std::vector<float> bias(nOut, 0.);
+          for (std::size_t iOut = 0; iOut < nOut; ++iOut) {
+            for (std::size_t iIn = 0; iIn < nIn; ++iIn) {
+              matrix[(iOut * nIn) + iIn] = layers[iLayer][iIn].at(iOut);
+            }
+            bias[iOut] = layers[iLayer].back().at(iOut);
+          }
+          m_weights.push_back( QuantizedArray(matrix, nOut, nIn, m_precision) );
+          m_biases.push_back( bias );
+        }
+
+        // make sure input layer matches variables
+        if (m_weights.empty() || (m_weights.front().GetNCols() != m_variables.size())) {
+          std::cerr << "PANIC: MLP input layer doesn't match number of variables!" << std::endl;
+          assert(!m_weights.empty() && (m_weights.front().GetNCols() == m_variables.size()));
+        }
+        return;
+
+      }  // end 'ReadMLP(TXMLEngine&, XMLNodePointer_t, XMLNodePointer_t)'
+
+      // ----------------------------------------------------------------------
+      //! Recursively read a BDT node
+      // ----------------------------------------------------------------------
+      /*! Returns index of node in the flattened forest.
+       *  Cuts are stored as raw values here, and are
+       *  converted into bin indices once all trees have
+       *  been read. Nodes with cType = 0 have their
+       *  children swapped so that "x >= cut" always
+       *  means go right.
+       */
+      inline int32_t ReadNode(
+        TXMLEngine& xml,
+        XMLNodePointer_t node,
+        const float weight,
+        std::vector<float>& cuts,
+        std::vector<float>& leaves
+      ) {
+
+        // collect children
+        XMLNodePointer_t left  = nullptr;
+        XMLNodePointer_t right = nullptr;
+        XMLNodePointer_t child = xml.GetChild(node);
+        while (child) {
+          const std::string pos = xml.GetAttr(child, "pos");
+          if (pos == "l") left  = child;
+          if (pos == "r") right = child;
+          child = xml.GetNext(child);
+        }
+
+        // add node
+        const int32_t index = m_nodeVar.size();
+        m_nodeVar.push_back(-1);
+        m_nodeCut.push_back(0);
+        m_nodeLeft.push_back(-1);
+        m_nodeRight.push_back(-1);
+        m_nodeLeaf.push_back(-1);
+        cuts.push_back(0.);
+
+        // if leaf, store response & exit
+        if (!left || !right) {
+          m_nodeLeaf[index] = leaves.size();
+          leaves.push_back( weight * GetAttrAsDouble(xml, node, "res") );
+          return index;
+        }
+
+        // only rectangular cuts are supported
+        const char* nCoef = xml.GetAttr(node, "NCoef");
+        if (nCoef && (std::stoi(nCoef) > 0)) {
+          std::cerr << "PANIC: BDT nodes with fisher cuts not supported!" << std::endl;
+          assert(false);
+        }
+
+        // otherwise store cut & recurse
+        const bool cutType   = (GetAttrAsDouble(xml, node, "cType") > 0.5);
+        m_nodeVar[index]     = (int16_t) GetAttrAsDouble(xml, node, "IVar");
+        cuts[index]          = GetAttrAsDouble(xml, node, "Cut");
+
+        const int32_t iLeft  = ReadNode(xml, left,  weight, cuts, leaves);
+        const int32_t iRight = ReadNode(xml, right, weight, cuts, leaves);
+        m_nodeLeft[index]    = cutType ? iLeft  : iRight;
+        m_nodeRight[index]   = cutType ? iRight : iLeft;
+        return index;
+
+      }  // end 'ReadNode(TXMLEngine&, XMLNodePointer_t, float, std::vector<float>&, std::vector<float>&)'
+
+      // ----------------------------------------------------------------------
+      //! Read BDT forest
+      // ----------------------------------------------------------------------
+      /*! With gradient boosting, the response is the sum
+       *  of the leaves plus the boost weight of the first
+       *  tree. Otherwise it's the boost-weighted average
+       *  of the leaves, so the weights are folded into
+       *  the leaves here.
+       */
+      inline void ReadBDT(TXMLEngine& xml, XMLNodePointer_t top, XMLNodePointer_t weights) {
+
+        const std::string boost = GetOption(xml, top, "BoostType");
+        if (boost == "AdaBoostR2") {
+          std::cerr << "PANIC: BDT boost type '" << boost << "' not supported!" << std::endl;
+          assert(boost != "AdaBoostR2");
+        }
+        const bool isGrad = (boost == "Grad");
+
+        // collect boost weights
+        std::vector<float> boostWeights;
+        XMLNodePointer_t   tree = xml.GetChild(weights);
+        while (tree) {
+          boostWeights.push_back( GetAttrAsDouble(xml, tree, "boostWeight") );
+          tree = xml.GetNext(tree);
+        }
+
+        double norm = 0.;
+        for (const float boostWeight : boostWeights) {
+          norm += boostWeight;
+        }
+        m_offset = (isGrad && !boostWeights.empty()) ? boostWeights.front() : 0.;
+
+        // read trees
+        std::vector<float> cuts;
+        std::vector<float> leaves;
+
+        std::size_t iTree = 0;
+        tree = xml.GetChild(weights);
+        while (tree) {
+          float weight = 1.;
+          if (!isGrad) {
+            weight = (norm > std::numeric_limits<double>::epsilon()) ? (boostWeights[iTree] / norm) : 0.;
+          }
+          m_roots.push_back( ReadNode(xml, FindChild(xml, tree, "Node"), weight, cuts, leaves) );
+          tree = xml.GetNext(tree);
+          ++iTree;
+        }
+
+        // build per-variable bin edges out of the unique cut values
+        m_edges.resize(m_variables.size());
+        for (std::size_t iNode = 0; iNode < m_nodeVar.size(); ++iNode) {
+          if (m_nodeVar[iNode] >= 0) {
+            m_edges.at(m_nodeVar[iNode]).push_back(cuts[iNode]);
+          }
+        }
+        for (auto& edges : m_edges) {
+          std::sort(edges.begin(), edges.end());
+          edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+          if (edges.size() >= std::numeric_limits<uint16_t>::max()) {
+            std::cerr << "PANIC: too many unique BDT cuts (" << edges.size() << ") to store as uint16!" << std::endl;
+            assert(edges.size() < std::numeric_limits<uint16_t>::max());
+          }
+        }
+
+        // and replace cuts by their bin index
+        for (std::size_t iNode = 0; iNode < m_nodeVar.size(); ++iNode) {
+          if (m_nodeVar[iNode] < 0) continue;
+          const auto& edges = m_edges[m_nodeVar[iNode]];
+          m_nodeCut[iNode]  = std::lower_bound(edges.begin(), edges.end(), cuts[iNode]) - edges.begin();
+        }
+
+        // finally, store leaves
+        m_leaves = QuantizedArray(leaves, 1, leaves.size(), m_precision);
+        m_leaves.Dequantize(m_leafValues);
+        return;
+
+      }  // end 'ReadBDT(TXMLEngine&, XMLNodePointer_t, XMLNodePointer_t)'
+
+      // ----------------------------------------------------------------------
+      //! Apply activation function to a layer
+      // ----------------------------------------------------------------------
+      /*! The tanh is the same rational approximation
+       *  TMVA uses by default (TActivationTanh).
+       */
+      inline void Activate(float* values, const std::size_t nValues) const {
+
+        if (m_activation == "tanh") {
+          for (std::size_t iVal = 0; iVal < nValues; ++iVal) {
+            const float arg  = std::clamp(values[iVal], -4.97f, 4.97f);
+            const float arg2 = arg * arg;
+            const float num  = arg * (135135.0f + arg2 * (17325.0f + arg2 * (378.0f + arg2)));
+            const float den  = 135135.0f + arg2 * (62370.0f + arg2 * (3150.0f + arg2 * 28.0f));
+            values[iVal] = (std::abs(values[iVal]) >= 4.97f) ? std::copysign(1.0f, values[iVal]) : (num / den);
+          }
+        } else if (m_activation == "sigmoid") {
+          for (std::size_t iVal = 0; iVal < nValues; ++iVal) {
+            values[iVal] = 1. / (1. + std::exp(-values[iVal]));
+          }
+        }
+        return;
+
+      }  // end 'Activate(float*, std::size_t)'
+
+      // ----------------------------------------------------------------------
+      //! Evaluate LD over a batch
+      // ----------------------------------------------------------------------
+      inline void EvaluateLD(const float* inputs, const std::size_t nEvts, float* outputs) const {
+
+        const float constant = m_coeffs.Get(0, 0);
+        std::fill(outputs, outputs + nEvts, constant);
+
+        for (std::size_t iVar = 0; iVar < m_variables.size(); ++iVar) {
+          const float  coeff  = m_coeffs.Get(0, iVar + 1);
+          const float* column = inputs + (iVar * nEvts);
+          for (std::size_t iEvt = 0; iEvt < nEvts; ++iEvt) {
+            outputs[iEvt] += coeff * column[iEvt];
+          }
+        }
+        return;
+
+      }  // end 'EvaluateLD(float*, std::size_t, float*)'
+
+      // ----------------------------------------------------------------------
+      //! Evaluate MLP over a batch
+      // ----------------------------------------------------------------------
+      /*! For int8, the activations feeding each layer are
+       *  quantized with a symmetric scale computed for
+       *  each event (so that an event's output doesn't
+       *  depend on what else is in its batch), and the
+       *  products are accumulated in int32 before being
+       *  rescaled.
+       */
+      inline void EvaluateMLP(const float* inputs, const std::size_t nEvts, float* outputs) const {
+
+        // the first layer reads straight from the inputs
+        const float*         layerIn = inputs;
+        std::vector<float>   current;
+        std::vector<float>   next;
+        std::vector<float>   matrix;
+        std::vector<float>   actScale;
+        std::vector<int8_t>  quant;
+        std::vector<int32_t> accum;
+
+        for (std::size_t iLayer = 0; iLayer < m_weights.size(); ++iLayer) {
+
+          const QuantizedArray& weights = m_weights[iLayer];
+          const std::size_t     nIn     = weights.GetNCols();
+          const std::size_t     nOut    = weights.GetNRows();
+          next.assign(nOut * nEvts, 0.);
+
+          if (m_precision == Precision::Int8) {
+
+            // find per-event scales, then quantize activations
+            actScale.assign(nEvts, 0.);
+            for (std::size_t iIn = 0; iIn < nIn; ++iIn) {
+              const float* column = layerIn + (iIn * nEvts);
+              for (std::size_t iEvt = 0; iEvt < nEvts; ++iEvt) {
+                actScale[iEvt] = std::max(actScale[iEvt], std::abs(column[iEvt]));
+              }
+            }
+            for (std::size_t iEvt = 0; iEvt < nEvts; ++iEvt) {
+              actScale[iEvt] = (actScale[iEvt] > 0.) ? (actScale[iEvt] / 127.) : 1.;
+            }
+
+            quant.resize(nIn * nEvts);
+            for (std::size_t iIn = 0; iIn < nIn; ++iIn) {
+              for (std::size_t iEvt = 0; iEvt < nEvts; ++iEvt) {
+                const std::size_t iAct = (iIn * nEvts) + iEvt;
+                quant[iAct] = ToInt8(layerIn[iAct], actScale[iEvt]);
+              }
+            }
+
+            // int8 x int8 -> int32 products
+            accum.resize(nEvts);
+            for (std::size_t iOut = 0; iOut < nOut; ++iOut) {
+              std::fill(accum.begin(), accum.end(), 0);
+              const int8_t* row = weights.GetInt8Row(iOut);
+              for (std::size_t iIn = 0; iIn < nIn; ++iIn) {
+                const int32_t weight = row[iIn];
+                const int8_t* column = quant.data() + (iIn * nEvts);
+                for (std::size_t iEvt = 0; iEvt < nEvts; ++iEvt) {
+                  accum[iEvt] += weight * (int32_t) column[iEvt];
+                }
+              }
+              const float scale = weights.GetScale(iOut);
+              const float bias  = m_biases[iLayer][iOut];
+              float*      out   = next.data() + (iOut * nEvts);
+              for (std::size_t iEvt = 0; iEvt < nEvts; ++iEvt) {
+                out[iEvt] = bias + (scale * actScale[iEvt] * accum[iEvt]);
+              }
+            }
+
+          } else {
+
+            // dequantize once per batch, then fp32 products
+            weights.Dequantize(matrix);
+            for (std::size_t iOut = 0; iOut < nOut; ++iOut) {
+              float* out = next.data() + (iOut * nEvts);
+              std::fill(out, out + nEvts, m_biases[iLayer][iOut]);
+              for (std::size_t iIn = 0; iIn < nIn; ++iIn) {
+                const float  weight = matrix[(iOut * nIn) + iIn];
+                const float* column = layerIn + (iIn * nEvts);
+                for (std::size_t iEvt = 0; iEvt < nEvts; ++iEvt) {
+                  out[iEvt] += weight * column[iEvt];
+                }
+              }
+            }
+          }
+
+          // output layer is linear for regression
+          if (iLayer + 1 < m_weights.size()) {
+            Activate(next.data(), next.size());
+          }
+          current.swap(next);
+          layerIn = current.data();
+        }  // end layer loop
+
+        // first output neuron is the first target
+        std::copy(current.begin(), current.begin() + nEvts, outputs);
+        return;
+
+      }  // end 'EvaluateMLP(float*, std::size_t, float*)'
+
+      // ----------------------------------------------------------------------
+      //! Evaluate BDT over a batch
+      // ----------------------------------------------------------------------
+      /*! Inputs are first converted to bin indices, so
+       *  that tree traversal only compares uint16's.
+       *  Trees are looped over in the outer loop to
+       *  keep each tree hot in cache.
+       */
+      inline void EvaluateBDT(const float* inputs, const std::size_t nEvts, float* outputs) const {
+
+        // bin inputs
+        std::vector<uint16_t> bins(m_variables.size() * nEvts, 0);
+        for (std::size_t iVar = 0; iVar < m_variables.size(); ++iVar) {
+          const auto& edges = m_edges[iVar];
+          for (std::size_t iEvt = 0; iEvt < nEvts; ++iEvt) {
+            const float value = inputs[(iVar * nEvts) + iEvt];
+            bins[(iVar * nEvts) + iEvt] = std::upper_bound(edges.begin(), edges.end(), value) - edges.begin();
+          }
+        }
+
+        // traverse trees
+        std::fill(outputs, outputs + nEvts, m_offset);
+        for (const int32_t root : m_roots) {
+          for (std::size_t iEvt = 0; iEvt < nEvts; ++iEvt) {
+            int32_t node = root;
+            while (m_nodeLeaf[node] < 0) {
+              const bool goesRight = bins[(m_nodeVar[node] * nEvts) + iEvt] > m_nodeCut[node];
+              node = goesRight ? m_nodeRight[node] : m_nodeLeft[node];
+            }
+            outputs[iEvt] += m_leafValues[m_nodeLeaf[node]];
+          }
+        }
+        return;
+
+      }  // end 'EvaluateBDT(float*, std::size_t, float*)'
+
+    public:
+
+      // ----------------------------------------------------------------------
+      //! Getters
+      // ----------------------------------------------------------------------
+      inline std::string              GetMethod()    const {return m_method;}
+      inline std::string              GetType()      const {return m_type;}
+      inline Precision                GetPrecision() const {return m_precision;}
+      inline std::vector<std::string> GetVariables() const {return m_variables;}
+
+      // ----------------------------------------------------------------------
+      //! Get size of stored model parameters in bytes
+      // ----------------------------------------------------------------------
+      inline std::size_t GetNBytes() const {
+
+        std::size_t nBytes = m_coeffs.GetNBytes() + m_leaves.GetNBytes();
+        for (std::size_t iLayer = 0; iLayer < m_weights.size(); ++iLayer) {
+          nBytes += m_weights[iLayer].GetNBytes();
+          nBytes += m_biases[iLayer].size() * sizeof(float);
+        }
+        nBytes += m_nodeVar.size() * sizeof(int16_t);
+        nBytes += m_nodeCut.size() * sizeof(uint16_t);
+        for (const auto& edges : m_edges) {
+          nBytes += edges.size() * sizeof(float);
+        }
+        return nBytes;
+
+      }  // end 'GetNBytes()'
+
+      // ----------------------------------------------------------------------
+      //! Evaluate model over a batch of events
+      // ----------------------------------------------------------------------
+      /*! Inputs should be laid out as input[iVar * nEvts + iEvt]
+       *  with variables in the order of GetVariables(). The
+       *  (un-normalized) first target is written to outputs.
+       */
+      inline void EvaluateBatch(
+        const std::vector<float>& inputs,
+        const std::size_t nEvts,
+        std::vector<float>& outputs
+      ) const {
+
+        // make sure input has right size
+        if (inputs.size() != (nEvts * m_variables.size())) {
+          std::cerr << "PANIC: batch has " << inputs.size() << " values but expected " << nEvts * m_variables.size() << "!" << std::endl;
+          assert(inputs.size() == (nEvts * m_variables.size()));
+        }
+        outputs.resize(nEvts);
+
+        // apply normalization if needed: only then is a
+        // separate buffer needed, otherwise the inputs are
+        // used as-is
+        const float*       source = inputs.data();
+        std::vector<float> transformed;
+        if (m_doNorm) {
+          transformed.resize(inputs.size());
+          for (std::size_t iVar = 0; iVar < m_variables.size(); ++iVar) {
+            const float  min   = m_varMin[iVar];
+            const float  scale = 2. * m_varScale[iVar];
+            const float* in    = inputs.data() + (iVar * nEvts);
+            float*       out   = transformed.data() + (iVar * nEvts);
+            for (std::size_t iEvt = 0; iEvt < nEvts; ++iEvt) {
+              out[iEvt] = ((in[iEvt] - min) * scale) - 1.;
+            }
+          }
+          source = transformed.data();
+        }
+
+        // evaluate model
+        if (m_type == "LD") {
+          EvaluateLD(source, nEvts, outputs.data());
+        } else if (m_type == "MLP") {
+          EvaluateMLP(source, nEvts, outputs.data());
+        } else {
+          EvaluateBDT(source, nEvts, outputs.data());
+        }
+
+        // and invert target normalization
+        if (m_doNorm) {
+          const float inverse = 1. / (2. * m_tgtScale);
+          for (std::size_t iEvt = 0; iEvt < nEvts; ++iEvt) {
+            outputs[iEvt] = ((outputs[iEvt] + 1.) * inverse) + m_tgtMin;
+          }
+        }
+        return;
+
+      }  // end 'EvaluateBatch(std::vector<float>&, std::size_t, std::vector<float>&)'
+
+      // ----------------------------------------------------------------------
+      //! Evaluate model for a single event
+      // ----------------------------------------------------------------------
+      inline float Evaluate(const std::vector<float>& inputs) const {
+
+        std::vector<float> output;
+        EvaluateBatch(inputs, 1, output);
+        return output.front();
+
+      }  // end 'Evaluate(std::vector<float>&)'
+
+      // ----------------------------------------------------------------------
+      //! Default ctor/dtor
+      // ----------------------------------------------------------------------
+      Model()  {};
+      ~Model() {};
+
+      // ----------------------------------------------------------------------
+      //! ctor accepting path to a weights file and a precision
+      // ----------------------------------------------------------------------
+      Model(const std::string& file, const Precision precision = Precision::Float32) {
+
+        m_precision = precision;
+
+        // parse weights file
+        TXMLEngine      xml;
+        XMLDocPointer_t doc = xml.ParseFile(file.data());
+        if (!doc) {
+          std::cerr << "PANIC: couldn't parse weights file '" << file << "'!" << std::endl;
+          assert(doc);
+        }
+        XMLNodePointer_t top = xml.DocGetRootElement(doc);
+
+        // method is stored as "<type>::<name>"
+        const std::string method = xml.GetAttr(top, "Method");
+        const std::size_t split  = method.find("::");
+        m_type   = method.substr(0, split);
+        m_method = (split != std::string::npos) ? method.substr(split + 2) : method;
+
+        // read variables & transforms
+        ReadVariables(xml, top);
+        ReadTransformations(xml, top);
+
+        // read model weights
+        XMLNodePointer_t weights = FindChild(xml, top, "Weights");
+        if (m_type == "LD") {
+          ReadLD(xml, weights);
+        } else if (m_type == "MLP") {
+          ReadMLP(xml, top, weights);
+        } else if (m_type == "BDT") {
+          ReadBDT(xml, top, weights);
+        } else {
+          std::cerr << "PANIC: method type '" << m_type << "' not supported!" << std::endl;
+          assert((m_type == "LD") || (m_type == "MLP") || (m_type == "BDT"));
+        }
+        xml.FreeDoc(doc);
+
+      }  // end ctor(std::string&, Precision)
+
+  };  // end QuantizedModelHelper::Model
+
+}  // end QuantizedModelHelper namespace
+
+#endif
+
+// end ========================================================================
@@ -0,0 +1,602 @@
+/// ===========================================================================
+/*! \file   SketchHelper.hxx
+ *  \author Derek Anderson
+ *  \date   10.17.2026
+ *
+ *  A lightweight namespace to hold streaming
+ *  quantile sketches, from which robust estimates
+ *  of a distribution (median, IQR, sigma_eff) can
+ *  be calculated without storing or binning values.
+ */
+/// ===========================================================================
+
+#ifndef SketchHelper_hxx
+#define SketchHelper_hxx
+
+// c++ utilities
+#include <map>
+#include <cmath>
+#include <deque>
+#include <limits>
+#include <tuple>
+#include <string>
+#include <vector>
+#include <utility>
+#include <algorithm>
+// root libraries
+#include <TTree.h>
+
+
+
+// ============================================================================
+//! Sketch Helper
+// ============================================================================
+/*! A small namespace to hold mergeable quantile
+ *  sketches, and tables of them which can be
+ *  saved to and merged across files.
+ */
+namespace SketchHelper {
+
+  // --------------------------------------------------------------------------
+  //! Fraction of a gaussian within +-1 sigma
+  // --------------------------------------------------------------------------
+  inline constexpr double OneSigma = 0.682689492137;
+
+
+
+  // ==========================================================================
+  //! Centroid
+  // ==========================================================================
+  struct Centroid {
+
+    double mean   = 0.;
+    double weight = 0.;
+
+  };  // end Centroid
+
+
+
+  // ==========================================================================
+  //! T-Digest
+  // ==========================================================================
+  /*! A merging t-digest (Dunning & Ertl,
+   *  arXiv:1902.04023). Values are buffered and
+   *  periodically merged into a sorted list of
+   *  centroids, whose sizes are bounded by the
+   *  k1 scale function, so that no. of centroids
+   *  stays below ~compression regardless of the
+   *  no. of values, and the tails are resolved
+   *  more finely than the bulk.
+   *
+   *  Digests can be merged exactly in the sense
+   *  that merging preserves all weight and keeps
+   *  the same error bounds.
+   */
+  class TDigest {
+
+    private:
+
+      // data members
+      double                m_compression = 200.;
+      double                m_total       = 0.;
+      double                m_min         = std::numeric_limits<double>::max();
+      double                m_max         = std::numeric_limits<double>::lowest();
+      std::vector<Centroid> m_centroids;
+      std::vector<Centroid> m_buffer;
+
+      // ----------------------------------------------------------------------
+      //! k1 scale function and its inverse
+      // ----------------------------------------------------------------------
+      double GetK(const double quantile) const {
+
+        return (m_compression / (2. * M_PI)) * std::asin((2. * quantile) - 1.);
+
+      }  // end 'GetK(double)'
+
+      double GetQuantileFromK(const double k) const {
+
+        return 0.5 * (std::sin(2. * M_PI * k / m_compression) + 1.);
+
+      }  // end 'GetQuantileFromK(double)'
+
+      // ----------------------------------------------------------------------
+      //! Largest quantile a centroid starting at a quantile can reach
+      // ----------------------------------------------------------------------
+      /*! k tops out at compression / 4 (q = 1): past
+       *  that the sine would wrap around and the
+       *  limit would fall below q, so it's clamped.
+       */
+      double GetQuantileLimit(const double quantile) const {
+
+        const double k = GetK(quantile) + 1.;
+        return (k >= (m_compression / 4.)) ? 1. : GetQuantileFromK(k);
+
+      }  // end 'GetQuantileLimit(double)'
+
+    public:
+
+      // ----------------------------------------------------------------------
+      //! Getters
+      // ----------------------------------------------------------------------
+      double GetCompression() const {return m_compression;}
+      double GetTotal()       const {return m_total;}
+      double GetMin()         const {return m_min;}
+      double GetMax()         const {return m_max;}
+
+      // ----------------------------------------------------------------------
+      //! Get (compressed) centroids
+      // ----------------------------------------------------------------------
+      const std::vector<Centroid>& GetCentroids() {
+
+        Compress();
+        return m_centroids;
+
+      }  // end 'GetCentroids()'
+
+      // ----------------------------------------------------------------------
+      //! Add a value
+      // ----------------------------------------------------------------------
+      void Add(const double value, const double weight = 1.) {
+
+        if (weight <= 0.) return;
+
+        m_buffer.push_back( {value, weight} );
+        m_total += weight;
+        m_min    = std::min(m_min, value);
+        m_max    = std::max(m_max, value);
+
+        // n.b. the buffer is what bounds memory between compressions
+        if (m_buffer.size() >= (std::size_t) (5. * m_compression)) {
+          Compress();
+        }
+
+      }  // end 'Add(double, double)'
+
+      // ----------------------------------------------------------------------
+      //! Merge another digest into this one
+      // ----------------------------------------------------------------------
+      void Merge(const TDigest& other) {
+
+        if (other.m_total <= 0.) return;
+
+        m_buffer.insert(m_buffer.end(), other.m_centroids.begin(), other.m_centroids.end());
+        m_buffer.insert(m_buffer.end(), other.m_buffer.begin(), other.m_buffer.end());
+        m_total += other.m_total;
+        m_min    = std::min(m_min, other.m_min);
+        m_max    = std::max(m_max, other.m_max);
+        Compress();
+
+      }  // end 'Merge(TDigest&)'
+
+      // ----------------------------------------------------------------------
+      //! Set state directly (e.g. when reading back from a file)
+      // ----------------------------------------------------------------------
+      void Set(
+        const double compression,
+        const double min,
+        const double max,
+        const std::vector<double>& means,
+        const std::vector<double>& weights
+      ) {
+
+        m_compression = compression;
+        m_min         = min;
+        m_max         = max;
+        m_total       = 0.;
+        m_buffer.clear();
+        m_centroids.clear();
+        for (std::size_t iCent = 0; iCent < std::min(means.size(), weights.size()); ++iCent) {
+          m_centroids.push_back( {means[iCent], weights[iCent]} );
+          m_total += weights[iCent];
+        }
+
+      }  // end 'Set(double x 3, std::vector<double>& x 2)'
+
+      // ----------------------------------------------------------------------
+      //! Merge buffered values into centroids
+      // ----------------------------------------------------------------------
+      void Compress() {
+
+        if (m_buffer.empty()) return;
+
+        // combine existing centroids and buffer, sort by mean
+        m_buffer.insert(m_buffer.end(), m_centroids.begin(), m_centroids.end());
+        std::sort(
+          m_buffer.begin(),
+          m_buffer.end(),
+          [](const Centroid& lhs, const Centroid& rhs) {return lhs.mean < rhs.mean;}
+        );
+
+        // greedily merge neighbors while the merged centroid
+        // stays within one unit of the scale function
+        m_centroids.clear();
+
+        Centroid current = m_buffer.front();
+        double   wSoFar  = 0.;
+        double   qLimit  = GetQuantileLimit(0.);
+        for (std::size_t iCent = 1; iCent < m_buffer.size(); ++iCent) {
+
+          const Centroid& next      = m_buffer[iCent];
+          const double    qProposed = (wSoFar + current.weight + next.weight) / m_total;
+          if (qProposed <= qLimit) {
+            const double weight = current.weight + next.weight;
+            current.mean  += (next.mean - current.mean) * next.weight / weight;
+            current.weight = weight;
+          } else {
+            wSoFar += current.weight;
+            m_centroids.push_back(current);
+            qLimit  = GetQuantileLimit(wSoFar / m_total);
+            current = next;
+          }
+        }
+        m_centroids.push_back(current);
+        m_buffer.clear();
+
+      }  // end 'Compress()'
+
+      // ----------------------------------------------------------------------
+      //! Get value at a quantile (0 - 1)
+      // ----------------------------------------------------------------------
+      /*! Interpolates linearly between centroid
+       *  centers, and between the outermost
+       *  centroids and the min/max.
+       */
+      double GetQuantile(const double quantile) {
+
+        Compress();
+        if (m_centroids.empty()) return 0.;
+        if (m_centroids.size() == 1) return m_centroids.front().mean;
+
+        const double index = std::clamp(quantile, 0., 1.) * m_total;
+
+        // left tail
+        const Centroid& first = m_centroids.front();
+        if (index < (0.5 * first.weight)) {
+          return m_min + ((first.mean - m_min) * index / (0.5 * first.weight));
+        }
+
+        // bulk
+        double wSoFar = 0.5 * first.weight;
+        for (std::size_t iCent = 0; iCent + 1 < m_centroids.size(); ++iCent) {
+          const Centroid& left  = m_centroids[iCent];
+          const Centroid& right = m_centroids[iCent + 1];
+          const double    dW    = 0.5 * (left.weight + right.weight);
+          if (index < (wSoFar + dW)) {
+            return left.mean + ((right.mean - left.mean) * (index - wSoFar) / dW);
+          }
+          wSoFar += dW;
+        }
+
+        // right tail
+        const Centroid& last  = m_centroids.back();
+        const double    wLeft = m_total - index;
+        return m_max - ((m_max - last.mean) * wLeft / (0.5 * last.weight));
+
+      }  // end 'GetQuantile(double)'
+
+      // ----------------------------------------------------------------------
+      //! Get median
+      // ----------------------------------------------------------------------
+      double GetMedian() {
+
+        return GetQuantile(0.5);
+
+      }  // end 'GetMedian()'
+
+      // ----------------------------------------------------------------------
+      //! Get interquartile range
+      // ----------------------------------------------------------------------
+      double GetIQR() {
+
+        return GetQuantile(0.75) - GetQuantile(0.25);
+
+      }  // end 'GetIQR()'
+
+      // ----------------------------------------------------------------------
+      //! Get sigma_eff
+      // ----------------------------------------------------------------------
+      /*! Half the width of the smallest interval
+       *  containing the provided fraction (68.3%
+       *  by default) of the distribution.
+       */
+      double GetSigmaEff(const double fraction = OneSigma, const std::size_t nSteps = 200) {
+
+        if (m_total <= 0.) return 0.;
+
+        double minWidth = std::numeric_limits<double>::max();
+        for (std::size_t iStep = 0; iStep <= nSteps; ++iStep) {
+          const double qLow  = (1. - fraction) * iStep / nSteps;
+          const double width = GetQuantile(qLow + fraction) - GetQuantile(qLow);
+          minWidth = std::min(minWidth, width);
+        }
+        return 0.5 * minWidth;
+
+      }  // end 'GetSigmaEff(double, std::size_t)'
+
+      // ----------------------------------------------------------------------
+      //! Get robust resolution (sigma_eff / median)
+      // ----------------------------------------------------------------------
+      double GetResolution() {
+
+        const double median = GetMedian();
+        return (median != 0.) ? GetSigmaEff() / median : 0.;
+
+      }  // end 'GetResolution()'
+
+      // ----------------------------------------------------------------------
+      //! Get errors on median, sigma_eff, and resolution
+      // ----------------------------------------------------------------------
+      /*! n.b. these are the large-N gaussian
+       *  approximations, with sigma_eff standing
+       *  in for sigma, i.e. sqrt(pi/2) sigma/sqrt(N)
+       *  for the median and sigma/sqrt(2N) for
+       *  sigma_eff.
+       */
+      double GetMedianError() {
+
+        if (m_total <= 1.) return 0.;
+        return std::sqrt(0.5 * M_PI) * GetSigmaEff() / std::sqrt(m_total);
+
+      }  // end 'GetMedianError()'
+
+      double GetSigmaEffError() {
+
+        if (m_total <= 1.) return 0.;
+        return GetSigmaEff() / std::sqrt(2. * m_total);
+
+      }  // end 'GetSigmaEffError()'
+
+      double GetResolutionError() {
+
+        const double median = GetMedian();
+        const double sigma  = GetSigmaEff();
+        if ((median == 0.) || (sigma == 0.)) return 0.;
+        return (sigma / median) * std::hypot(GetMedianError() / median, GetSigmaEffError() / sigma);
+
+      }  // end 'GetResolutionError()'
+
+      // ----------------------------------------------------------------------
+      //! default ctor/dtor
+      // ----------------------------------------------------------------------
+      TDigest()  {};
+      ~TDigest() {};
+
+      // ----------------------------------------------------------------------
+      //! ctor accepting a compression
+      // ----------------------------------------------------------------------
+      TDigest(const double compression) : m_compression(compression) {};
+
+  };  // end SketchHelper::TDigest
+
+
+
+  // ==========================================================================
+  //! Slice
+  // ==========================================================================
+  /*! A sketch for a variable in a slice (e.g. a
+   *  bin of particle energy), along with the
+   *  slice's edges and center.
+   */
+  struct Slice {
+
+    std::string variable = "";
+    std::string tag      = "";
+    double      center   = 0.;
+    double      low      = 0.;
+    double      high     = 0.;
+    TDigest     sketch;
+
+  };  // end Slice
+
+
+
+  // ==========================================================================
+  //! Table
+  // ==========================================================================
+  /*! A collection of slices which can be saved
+   *  to (and read back from) a TTree with one
+   *  row per slice, like MomentHelper::Table.
+   *  Rows with the same variable, tag and edges
+   *  are merged when read back in.
+   *
+   *  n.b. slices are returned by pointer since
+   *  querying a sketch may compress it.
+   */
+  class Table {
+
+    private:
+
+      // slices are keyed by (variable, tag, low, high)
+      typedef std::tuple<std::string, std::string, double, double> Key;
+
+      // data members
+      double                     m_compression = 200.;
+      std::deque<Slice>          m_slices;
+      std::map<Key, std::size_t> m_index;
+
+    public:
+
+      // ----------------------------------------------------------------------
+      //! Getters
+      // ----------------------------------------------------------------------
+      std::deque<Slice>& GetSlices() {return m_slices;}
+
+      // ----------------------------------------------------------------------
+      //! Get sketch for a variable in a slice, creating it if needed
+      // ----------------------------------------------------------------------
+      TDigest& Get(
+        const std::string& variable,
+        const std::string& tag,
+        const double center = 0.,
+        const double low = 0.,
+        const double high = 0.
+      ) {
+
+        const Key key = std::make_tuple(variable, tag, low, high);
+        auto it = m_index.find(key);
+        if (it != m_index.end()) {
+          return m_slices[it -> second].sketch;
+        }
+
+        m_slices.push_back( {variable, tag, center, low, high, TDigest(m_compression)} );
+        m_index[key] = m_slices.size() - 1;
+        return m_slices.back().sketch;
+
+      }  // end 'Get(std::string&, std::string&, double x 3)'
+
+      // ----------------------------------------------------------------------
+      //! Get list of variables (in order of first appearance)
+      // ----------------------------------------------------------------------
+      std::vector<std::string> GetVariables() const {
+
+        std::vector<std::string> variables;
+        for (const Slice& slice : m_slices) {
+          if (std::find(variables.begin(), variables.end(), slice.variable) == variables.end()) {
+            variables.push_back(slice.variable);
+          }
+        }
+        return variables;
+
+      }  // end 'GetVariables()'
+
+      // ----------------------------------------------------------------------
+      //! Get slices of a variable, sorted by center
+      // ----------------------------------------------------------------------
+      std::vector<Slice*> GetSlices(const std::string& variable) {
+
+        std::vector<Slice*> slices;
+        for (Slice& slice : m_slices) {
+          if (slice.variable == variable) {
+            slices.push_back(&slice);
+          }
+        }
+        std::sort(
+          slices.begin(),
+          slices.end(),
+          [](const Slice* lhs, const Slice* rhs) {return lhs -> center < rhs -> center;}
+        );
+        return slices;
+
+      }  // end 'GetSlices(std::string&)'
+
+      // ----------------------------------------------------------------------
+      //! Merge another table into this one
+      // ----------------------------------------------------------------------
+      void Merge(const Table& other) {
+
+        for (const Slice& slice : other.m_slices) {
+          Get(slice.variable, slice.tag, slice.center, slice.low, slice.high).Merge(slice.sketch);
+        }
+
+      }  // end 'Merge(Table&)'
+
+      // ----------------------------------------------------------------------
+      //! Make a TTree of the table in the current directory
+      // ----------------------------------------------------------------------
+      /*! n.b. the tree isn't written, that's left
+       *  to the caller. Branch addresses point at
+       *  locals here, so they're reset before
+       *  returning.
+       */
+      TTree* MakeTree(const std::string& name) {
+
+        std::string         variable;
+        std::string         tag;
+        double              center      = 0.;
+        double              low         = 0.;
+        double              high        = 0.;
+        double              compression = 0.;
+        double              min         = 0.;
+        double              max         = 0.;
+        std::vector<double> means;
+        std::vector<double> weights;
+
+        TTree* tree = new TTree(name.data(), "Quantile sketches per variable and slice");
+        tree -> Branch("variable", &variable);
+        tree -> Branch("tag", &tag);
+        tree -> Branch("center", &center, "center/D");
+        tree -> Branch("low", &low, "low/D");
+        tree -> Branch("high", &high, "high/D");
+        tree -> Branch("compression", &compression, "compression/D");
+        tree -> Branch("min", &min, "min/D");
+        tree -> Branch("max", &max, "max/D");
+        tree -> Branch("means", &means);
+        tree -> Branch("weights", &weights);
+
+        for (Slice& slice : m_slices) {
+          variable    = slice.variable;
+          tag         = slice.tag;
+          center      = slice.center;
+          low         = slice.low;
+          high        = slice.high;
+          compression = slice.sketch.GetCompression();
+          min         = slice.sketch.GetMin();
+          max         = slice.sketch.GetMax();
+          means.clear();
+          weights.clear();
+          for (const Centroid& centroid : slice.sketch.GetCentroids()) {
+            means.push_back(centroid.mean);
+            weights.push_back(centroid.weight);
+          }
+          tree -> Fill();
+        }
+        tree -> ResetBranchAddresses();
+        return tree;
+
+      }  // end 'MakeTree(std::string&)'
+
+      // ----------------------------------------------------------------------
+      //! Read rows of a TTree (or TChain) into the table
+      // ----------------------------------------------------------------------
+      void ReadTree(TTree* tree) {
+
+        std::string*         variable    = nullptr;
+        std::string*         tag         = nullptr;
+        std::vector<double>* means       = nullptr;
+        std::vector<double>* weights     = nullptr;
+        double               center      = 0.;
+        double               low         = 0.;
+        double               high        = 0.;
+        double               compression = 0.;
+        double               min         = 0.;
+        double               max         = 0.;
+
+        tree -> SetBranchAddress("variable", &variable);
+        tree -> SetBranchAddress("tag", &tag);
+        tree -> SetBranchAddress("center", &center);
+        tree -> SetBranchAddress("low", &low);
+        tree -> SetBranchAddress("high", &high);
+        tree -> SetBranchAddress("compression", &compression);
+        tree -> SetBranchAddress("min", &min);
+        tree -> SetBranchAddress("max", &max);
+        tree -> SetBranchAddress("means", &means);
+        tree -> SetBranchAddress("weights", &weights);
+
+        TDigest row;
+        for (Long64_t iEntry = 0; iEntry < tree -> GetEntries(); ++iEntry) {
+          tree -> GetEntry(iEntry);
+          row.Set(compression, min, max, *means, *weights);
+          Get(*variable, *tag, center, low, high).Merge(row);
+        }
+        tree -> ResetBranchAddresses();
+
+      }  // end 'ReadTree(TTree*)'
+
+      // ----------------------------------------------------------------------
+      //! default ctor/dtor
+      // ----------------------------------------------------------------------
+      Table()  {};
+      ~Table() {};
+
+      // ----------------------------------------------------------------------
+      //! ctor accepting a compression for new sketches
+      // ----------------------------------------------------------------------
+      Table(const double compression) : m_compression(compression) {};
+
+  };  // end SketchHelper::Table
+
+}  // end SketchHelper namespace
+
+#endif
+
+// end ========================================================================
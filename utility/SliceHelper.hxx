@@ -0,0 +1,241 @@
+/// ===========================================================================
+/*! \file   SliceHelper.hxx
+ *  \author Derek Anderson
+ *  \date   10.17.2026
+ *
+ *  A lightweight namespace to derive slices of a
+ *  variable (e.g. particle energy) from the data
+ *  itself, such that each slice has (roughly) the
+ *  same no. of entries.
+ */
+/// ===========================================================================
+
+#ifndef SliceHelper_hxx
+#define SliceHelper_hxx
+
+// c++ utilities
+#include <cmath>
+#include <limits>
+#include <string>
+#include <vector>
+#include <tuple>
+#include <cassert>
+#include <iostream>
+#include <algorithm>
+// root libraries
+#include <TTree.h>
+#include <TVectorD.h>
+// analysis utilities
+#include "SketchHelper.hxx"
+
+
+
+// ============================================================================
+//! Slice Helper
+// ============================================================================
+/*! A small namespace to build equal-statistics
+ *  slices from a quick first pass over a tree,
+ *  in the format expected by the histogram
+ *  filling routines.
+ */
+namespace SliceHelper {
+
+  // --------------------------------------------------------------------------
+  //! Convenience types
+  // --------------------------------------------------------------------------
+  /*! Particle bins are defined as in the fill
+   *  routines:
+   *    <0> = tag
+   *    <1> = bin center
+   *    <2> = bin low edge
+   *    <3> = bin high edge
+   */
+  typedef std::tuple<std::string, float, float, float> ParBin;
+
+
+
+  // --------------------------------------------------------------------------
+  //! Sketch a single variable of a tree
+  // --------------------------------------------------------------------------
+  /*! Only the branch of the variable is read,
+   *  so this is fast compared to a full pass.
+   *  Assumes a float branch, as in a TNtuple.
+   */
+  SketchHelper::TDigest SketchVariable(
+    TTree* tree,
+    const std::string& variable,
+    const double compression = 200.
+  ) {
+
+    if (!tree -> GetBranch(variable.data())) {
+      std::cerr << "PANIC: variable '" << variable << "' not found in tree '" << tree -> GetName() << "'!" << std::endl;
+      assert(tree -> GetBranch(variable.data()));
+    }
+
+    // turn off all but the relevant branch
+    float value = 0.;
+    tree -> SetBranchStatus("*", 0);
+    tree -> SetBranchStatus(variable.data(), 1);
+    tree -> SetBranchAddress(variable.data(), &value);
+
+    SketchHelper::TDigest sketch(compression);
+    for (Long64_t iEntry = 0; iEntry < tree -> GetEntries(); ++iEntry) {
+      tree -> GetEntry(iEntry);
+      sketch.Add(value);
+    }
+
+    // restore tree for full pass
+    tree -> ResetBranchAddresses();
+    tree -> SetBranchStatus("*", 1);
+    return sketch;
+
+  }  // end 'SketchVariable(TTree*, std::string&, double)'
+
+
+
+  // --------------------------------------------------------------------------
+  //! Get no. of slices needed for a target no. of entries per slice
+  // --------------------------------------------------------------------------
+  std::size_t GetNSlices(SketchHelper::TDigest& sketch, const double target) {
+
+    if (target <= 0.) return 1;
+    return std::max((std::size_t) 1, (std::size_t) std::floor(sketch.GetTotal() / target));
+
+  }  // end 'GetNSlices(SketchHelper::TDigest&, double)'
+
+
+
+  // --------------------------------------------------------------------------
+  //! Make equal-statistics bins
+  // --------------------------------------------------------------------------
+  /*! Edges are placed at the quantiles k/N, and
+   *  the center of each bin is its median. Edges
+   *  which coincide (e.g. for a sample with only
+   *  a few discrete energies) are merged, so the
+   *  no. of bins can be less than requested.
+   *
+   *  n.b. the last high edge is nudged upwards (at
+   *  float precision, as the tuples are float) so
+   *  that the max value falls in the last bin.
+   */
+  std::vector<ParBin> MakeEqualStatBins(
+    SketchHelper::TDigest& sketch,
+    const std::size_t nSlices,
+    const std::string& prefix = "EneSlice"
+  ) {
+
+    std::vector<ParBin> bins;
+    if ((nSlices == 0) || (sketch.GetTotal() <= 0.)) return bins;
+
+    double low = sketch.GetMin();
+    double qLow = 0.;
+    for (std::size_t iSlice = 1; iSlice <= nSlices; ++iSlice) {
+
+      const double qHigh = (double) iSlice / nSlices;
+      const double high  = (iSlice < nSlices)
+                         ? sketch.GetQuantile(qHigh)
+                         : std::nextafter((float) sketch.GetMax(), std::numeric_limits<float>::max());
+      if (high <= low) continue;
+
+      bins.push_back(
+        std::make_tuple(
+          prefix + std::to_string(bins.size()),
+          (float) sketch.GetQuantile(0.5 * (qLow + qHigh)),
+          (float) low,
+          (float) high
+        )
+      );
+      low  = high;
+      qLow = qHigh;
+    }
+    return bins;
+
+  }  // end 'MakeEqualStatBins(SketchHelper::TDigest&, std::size_t, std::string&)'
+
+
+
+  // --------------------------------------------------------------------------
+  //! Make bins from a first pass over a tree
+  // --------------------------------------------------------------------------
+  /*! Supported methods:
+   *    "equal" = split into a fixed no. of slices
+   *    "count" = split into slices with a target
+   *              no. of entries each
+   */
+  std::vector<ParBin> MakeBins(
+    TTree* tree,
+    const std::string& variable,
+    const std::string& method,
+    const std::size_t nSlices,
+    const double nPerSlice,
+    const std::string& prefix = "EneSlice"
+  ) {
+
+    SketchHelper::TDigest sketch = SketchVariable(tree, variable);
+    if (method == "equal") {
+      return MakeEqualStatBins(sketch, nSlices, prefix);
+    } else if (method == "count") {
+      return MakeEqualStatBins(sketch, GetNSlices(sketch, nPerSlice), prefix);
+    } else {
+      std::cerr << "PANIC: unknown slicing method '" << method << "'!" << std::endl;
+      assert((method == "equal") || (method == "count"));
+    }
+    return {};
+
+  }  // end 'MakeBins(TTree*, std::string& x 2, std::size_t, double, std::string&)'
+
+
+
+  // --------------------------------------------------------------------------
+  //! Get edges of bins
+  // --------------------------------------------------------------------------
+  std::vector<double> GetEdges(const std::vector<ParBin>& bins) {
+
+    std::vector<double> edges;
+    for (const ParBin& bin : bins) {
+      if (edges.empty()) edges.push_back( std::get<2>(bin) );
+      edges.push_back( std::get<3>(bin) );
+    }
+    return edges;
+
+  }  // end 'GetEdges(std::vector<ParBin>&)'
+
+
+
+  // --------------------------------------------------------------------------
+  //! Make a TVectorD from a list of values
+  // --------------------------------------------------------------------------
+  /*! n.b. the vector isn't written, that's left
+   *  to the caller.
+   */
+  TVectorD MakeVector(const std::vector<double>& values) {
+
+    TVectorD vector(values.size());
+    for (std::size_t iVal = 0; iVal < values.size(); ++iVal) {
+      vector[iVal] = values[iVal];
+    }
+    return vector;
+
+  }  // end 'MakeVector(std::vector<double>&)'
+
+
+
+  // --------------------------------------------------------------------------
+  //! Print bins
+  // --------------------------------------------------------------------------
+  void PrintBins(const std::vector<ParBin>& bins) {
+
+    for (const ParBin& bin : bins) {
+      std::cout << "      " << std::get<0>(bin) << ": "
+                << "[" << std::get<2>(bin) << ", " << std::get<3>(bin) << "), "
+                << "center = " << std::get<1>(bin)
+                << std::endl;
+    }
+
+  }  // end 'PrintBins(std::vector<ParBin>&)'
+
+}  // end SliceHelper namespace
+
+#endif
+
+// end ========================================================================
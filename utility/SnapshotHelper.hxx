@@ -0,0 +1,584 @@
+/// ===========================================================================
+/*! \file   SnapshotHelper.hxx
+ *  \author Derek Anderson
+ *  \date   10.17.2026
+ *
+ *  A lightweight namespace to periodically publish
+ *  snapshots of histograms and counters to a
+ *  memory-mapped file, so that long jobs (e.g.
+ *  EICrecon plugins) can be monitored while they
+ *  run.
+ */
+/// ===========================================================================
+
+#ifndef SnapshotHelper_hxx
+#define SnapshotHelper_hxx
+
+// c++ utilities
+#include <new>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <condition_variable>
+// posix utilities
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+// root libraries
+#include <TH1.h>
+#include <TH1D.h>
+
+
+
+// ============================================================================
+//! Snapshot Helper
+// ============================================================================
+/*! A small namespace to hold a publisher, which
+ *  writes snapshots from a background thread,
+ *  and a reader, which attaches to the file.
+ *
+ *  The file holds a header, a descriptor for
+ *  each item (histogram or counter), and then
+ *  the values of all items. Since the layout is
+ *  fixed once the publisher starts, only the
+ *  values change between snapshots. Writes are
+ *  guarded by a sequence lock: the sequence no.
+ *  is odd while a write is in progress, so a
+ *  reader copies the values and retries if the
+ *  sequence was odd or changed in the meantime.
+ *  Neither side ever waits on the other.
+ */
+namespace SnapshotHelper {
+
+  // --------------------------------------------------------------------------
+  //! File constants
+  // --------------------------------------------------------------------------
+  inline constexpr char     Magic[8]   = {'B', 'H', 'C', 'S', 'N', 'A', 'P', '\0'};
+  inline constexpr uint32_t Version    = 1;
+  inline constexpr uint32_t NameLength = 64;
+
+
+
+  // --------------------------------------------------------------------------
+  //! Item kinds
+  // --------------------------------------------------------------------------
+  enum Kind : uint32_t {Counter = 0, Histogram = 1};
+
+
+
+  // ==========================================================================
+  //! File header
+  // ==========================================================================
+  struct Header {
+
+    char                  magic[8];
+    uint32_t              version;
+    uint32_t              nItems;
+    uint64_t              nValues;
+    std::atomic<uint64_t> sequence;
+    uint64_t              nPublished;
+    double                time;  // unix time of last snapshot
+
+  };  // end Header
+
+  static_assert(std::atomic<uint64_t>::is_always_lock_free, "sequence lock needs a lock-free 64-bit atomic");
+
+
+
+  // ==========================================================================
+  //! Item descriptor
+  // ==========================================================================
+  /*! Histograms are stored as the no. of entries
+   *  followed by the contents of bins 0 to
+   *  nBins + 1 (i.e. including under/overflow),
+   *  so they take nBins + 3 values. Counters
+   *  take a single value.
+   */
+  struct Descriptor {
+
+    char     name[NameLength];
+    uint32_t kind;
+    uint32_t nBins;
+    double   low;
+    double   high;
+    uint64_t offset;
+
+  };  // end Descriptor
+
+
+
+  // ==========================================================================
+  //! Item read back from a snapshot
+  // ==========================================================================
+  struct Item {
+
+    std::string         name   = "";
+    uint32_t            kind   = Kind::Counter;
+    uint32_t            nBins  = 0;
+    double              low    = 0.;
+    double              high   = 0.;
+    std::vector<double> values;
+
+    // ------------------------------------------------------------------------
+    //! Turn a histogram item into a TH1D
+    // ------------------------------------------------------------------------
+    /*! n.b. the histogram is detached from any
+     *  directory, so deleting it is left to the
+     *  caller.
+     */
+    TH1D* MakeHistogram(const std::string& suffix = "") const {
+
+      TH1D* hist = new TH1D((name + suffix).data(), name.data(), nBins, low, high);
+      hist -> SetDirectory(nullptr);
+      for (uint32_t iBin = 0; iBin < nBins + 2; ++iBin) {
+        hist -> SetBinContent(iBin, values[iBin + 1]);
+      }
+      hist -> SetEntries(values[0]);
+      return hist;
+
+    }  // end 'MakeHistogram(std::string&)'
+
+  };  // end Item
+
+
+
+  // --------------------------------------------------------------------------
+  //! Get size of file for a given layout
+  // --------------------------------------------------------------------------
+  inline std::size_t GetFileSize(const uint32_t nItems, const uint64_t nValues) {
+
+    return sizeof(Header) + (nItems * sizeof(Descriptor)) + (nValues * sizeof(double));
+
+  }  // end 'GetFileSize(uint32_t, uint64_t)'
+
+
+
+  // ==========================================================================
+  //! Publisher
+  // ==========================================================================
+  /*! Usage:
+   *    1. add items with AddHistogram()/AddCounter();
+   *    2. Start() to create the file and launch the
+   *       writer thread;
+   *    3. whenever IsDue() (e.g. at the top of each
+   *       event), copy current values with Stage()
+   *       and hand them off with Publish(); and
+   *    4. Stop() at the end of the job.
+   *
+   *  The owner of the histograms copies them
+   *  (under whatever lock already protects them)
+   *  only once per period, and the copy is then
+   *  swapped to the writer thread, so the caller
+   *  never waits on the file.
+   */
+  class Publisher {
+
+    private:
+
+      // layout
+      std::vector<Descriptor> m_items;
+      uint64_t                m_nValues = 0;
+
+      // staged and pending values
+      std::vector<double>     m_staged;
+      std::vector<double>     m_pending;
+      bool                    m_hasPending = false;
+
+      // writer thread
+      std::thread             m_thread;
+      std::mutex              m_mutex;
+      std::condition_variable m_wake;
+      std::atomic<bool>       m_isDue   = {false};
+      bool                    m_doStop  = false;
+      double                  m_period  = 30.;
+
+      // mapped file
+      int         m_file = -1;
+      void*       m_map  = nullptr;
+      std::size_t m_size = 0;
+
+      // ----------------------------------------------------------------------
+      //! Add an item to layout
+      // ----------------------------------------------------------------------
+      std::size_t AddItem(
+        const std::string& name,
+        const uint32_t kind,
+        const uint32_t nBins,
+        const double low,
+        const double high,
+        const uint64_t nValues
+      ) {
+
+        if (m_map) {
+          std::cerr << "WARNING: can't add '" << name << "' to snapshot after publisher has started!" << std::endl;
+          return m_items.size();
+        }
+
+        Descriptor item;
+        std::memset(&item, 0, sizeof(Descriptor));
+        std::strncpy(item.name, name.data(), NameLength - 1);
+        item.kind   = kind;
+        item.nBins  = nBins;
+        item.low    = low;
+        item.high   = high;
+        item.offset = m_nValues;
+
+        m_items.push_back(item);
+        m_nValues += nValues;
+        return m_items.size() - 1;
+
+      }  // end 'AddItem(std::string&, uint32_t x 2, double x 2, uint64_t)'
+
+      // ----------------------------------------------------------------------
+      //! Write values to file under sequence lock
+      // ----------------------------------------------------------------------
+      void Write(const std::vector<double>& values) {
+
+        Header* header = static_cast<Header*>(m_map);
+        double* data   = reinterpret_cast<double*>(static_cast<char*>(m_map) + sizeof(Header) + (m_items.size() * sizeof(Descriptor)));
+
+        const uint64_t sequence = header -> sequence.load(std::memory_order_relaxed);
+        header -> sequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        std::memcpy(data, values.data(), values.size() * sizeof(double));
+        header -> time = std::chrono::duration<double>(std::chrono::system_clock::now().time_since_epoch()).count();
+        ++header -> nPublished;
+
+        header -> sequence.store(sequence + 2, std::memory_order_release);
+
+      }  // end 'Write(std::vector<double>&)'
+
+      // ----------------------------------------------------------------------
+      //! Writer thread loop
+      // ----------------------------------------------------------------------
+      /*! Flags a snapshot as due every period, and
+       *  writes whatever has been published.
+       */
+      void Run() {
+
+        std::vector<double> values(m_nValues, 0.);
+        const auto period = std::chrono::duration<double>(m_period);
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (!m_doStop) {
+          const bool isWoken = m_wake.wait_for(lock, period, [this] {return m_doStop || m_hasPending;});
+          if (m_hasPending) {
+            values.swap(m_pending);
+            m_hasPending = false;
+            lock.unlock();
+            Write(values);
+            lock.lock();
+          }
+          if (!isWoken) {
+            m_isDue.store(true, std::memory_order_relaxed);
+          }
+        }
+
+      }  // end 'Run()'
+
+    public:
+
+      // ----------------------------------------------------------------------
+      //! Getters
+      // ----------------------------------------------------------------------
+      bool IsStarted() const {return (m_map != nullptr);}
+      bool IsDue()     const {return m_isDue.load(std::memory_order_relaxed);}
+
+      // ----------------------------------------------------------------------
+      //! Add items, returns index of item
+      // ----------------------------------------------------------------------
+      std::size_t AddHistogram(const std::string& name, const uint32_t nBins, const double low, const double high) {
+
+        return AddItem(name, Kind::Histogram, nBins, low, high, nBins + 3);
+
+      }  // end 'AddHistogram(std::string&, uint32_t, double x 2)'
+
+      std::size_t AddHistogram(const TH1* hist) {
+
+        return AddHistogram(
+          hist -> GetName(),
+          hist -> GetNbinsX(),
+          hist -> GetXaxis() -> GetXmin(),
+          hist -> GetXaxis() -> GetXmax()
+        );
+
+      }  // end 'AddHistogram(TH1*)'
+
+      std::size_t AddCounter(const std::string& name) {
+
+        return AddItem(name, Kind::Counter, 0, 0., 0., 1);
+
+      }  // end 'AddCounter(std::string&)'
+
+      // ----------------------------------------------------------------------
+      //! Create file and launch writer thread
+      // ----------------------------------------------------------------------
+      bool Start(const std::string& path, const double period) {
+
+        m_size = GetFileSize(m_items.size(), m_nValues);
+        m_file = open(path.data(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if ((m_file < 0) || (ftruncate(m_file, m_size) != 0)) {
+          std::cerr << "WARNING: couldn't create snapshot file '" << path << "'! Not publishing snapshots." << std::endl;
+          if (m_file >= 0) close(m_file);
+          m_file = -1;
+          return false;
+        }
+
+        void* map = mmap(nullptr, m_size, PROT_READ | PROT_WRITE, MAP_SHARED, m_file, 0);
+        if (map == MAP_FAILED) {
+          std::cerr << "WARNING: couldn't map snapshot file '" << path << "'! Not publishing snapshots." << std::endl;
+          close(m_file);
+          m_file = -1;
+          return false;
+        }
+
+        // write header and descriptors
+        // n.b. the magic is written last so readers never see a partial layout
+        Header* header = new (map) Header;
+        header -> version    = Version;
+        header -> nItems     = m_items.size();
+        header -> nValues    = m_nValues;
+        header -> nPublished = 0;
+        header -> time       = 0.;
+        header -> sequence.store(0, std::memory_order_relaxed);
+        std::memcpy(static_cast<char*>(map) + sizeof(Header), m_items.data(), m_items.size() * sizeof(Descriptor));
+        std::atomic_thread_fence(std::memory_order_release);
+        std::memcpy(header -> magic, Magic, sizeof(Magic));
+
+        m_map    = map;
+        m_period = period;
+        m_staged.assign(m_nValues, 0.);
+        m_pending.assign(m_nValues, 0.);
+        m_thread = std::thread(&Publisher::Run, this);
+        return true;
+
+      }  // end 'Start(std::string&, double)'
+
+      // ----------------------------------------------------------------------
+      //! Stage current values of items
+      // ----------------------------------------------------------------------
+      void Stage(const std::size_t index, const TH1* hist) {
+
+        if (!m_map || (index >= m_items.size())) return;
+
+        const Descriptor& item = m_items[index];
+        double*           data = m_staged.data() + item.offset;
+        data[0] = hist -> GetEntries();
+        for (uint32_t iBin = 0; iBin < item.nBins + 2; ++iBin) {
+          data[iBin + 1] = hist -> GetBinContent(iBin);
+        }
+
+      }  // end 'Stage(std::size_t, TH1*)'
+
+      void Stage(const std::size_t index, const double value) {
+
+        if (!m_map || (index >= m_items.size())) return;
+        m_staged[m_items[index].offset] = value;
+
+      }  // end 'Stage(std::size_t, double)'
+
+      // ----------------------------------------------------------------------
+      //! Hand staged values to writer thread
+      // ----------------------------------------------------------------------
+      void Publish() {
+
+        if (!m_map) return;
+        {
+          std::lock_guard<std::mutex> lock(m_mutex);
+          std::copy(m_staged.begin(), m_staged.end(), m_pending.begin());
+          m_hasPending = true;
+          m_isDue.store(false, std::memory_order_relaxed);
+        }
+        m_wake.notify_one();
+
+      }  // end 'Publish()'
+
+      // ----------------------------------------------------------------------
+      //! Stop writer thread and unmap file
+      // ----------------------------------------------------------------------
+      /*! n.b. anything published but not yet written
+       *  is flushed first, and the file is left in
+       *  place for the viewer.
+       */
+      void Stop() {
+
+        if (!m_map) return;
+        {
+          std::lock_guard<std::mutex> lock(m_mutex);
+          m_doStop = true;
+        }
+        m_wake.notify_one();
+        m_thread.join();
+        if (m_hasPending) Write(m_pending);
+
+        munmap(m_map, m_size);
+        close(m_file);
+        m_map  = nullptr;
+        m_file = -1;
+
+      }  // end 'Stop()'
+
+      // ----------------------------------------------------------------------
+      //! default ctor/dtor
+      // ----------------------------------------------------------------------
+      Publisher()  {};
+      ~Publisher() {Stop();};
+
+  };  // end SnapshotHelper::Publisher
+
+
+
+  // ==========================================================================
+  //! Reader
+  // ==========================================================================
+  /*! Attaches to a snapshot file read-only, so
+   *  any no. of readers can watch a job without
+   *  affecting it.
+   */
+  class Reader {
+
+    private:
+
+      // data members
+      int         m_file = -1;
+      void*       m_map  = nullptr;
+      std::size_t m_size = 0;
+
+    public:
+
+      // ----------------------------------------------------------------------
+      //! Getters
+      // ----------------------------------------------------------------------
+      bool IsAttached() const {return (m_map != nullptr);}
+
+      // ----------------------------------------------------------------------
+      //! Attach to a file
+      // ----------------------------------------------------------------------
+      bool Attach(const std::string& path) {
+
+        Detach();
+
+        m_file = open(path.data(), O_RDONLY);
+        if (m_file < 0) return false;
+
+        // make sure file is big enough for its own layout
+        struct stat info;
+        const bool hasHeader = (fstat(m_file, &info) == 0) && ((std::size_t) info.st_size >= sizeof(Header));
+        if (!hasHeader) {
+          Detach();
+          return false;
+        }
+        m_size = info.st_size;
+
+        void* map = mmap(nullptr, m_size, PROT_READ, MAP_SHARED, m_file, 0);
+        if (map == MAP_FAILED) {
+          Detach();
+          return false;
+        }
+        m_map = map;
+
+        const Header* header = static_cast<const Header*>(m_map);
+        const bool    isGood = (std::memcmp(header -> magic, Magic, sizeof(Magic)) == 0)
+                            && (header -> version == Version)
+                            && (GetFileSize(header -> nItems, header -> nValues) <= m_size);
+        if (!isGood) {
+          Detach();
+          return false;
+        }
+        return true;
+
+      }  // end 'Attach(std::string&)'
+
+      // ----------------------------------------------------------------------
+      //! Detach from file
+      // ----------------------------------------------------------------------
+      void Detach() {
+
+        if (m_map)         munmap(m_map, m_size);
+        if (m_file >= 0)   close(m_file);
+        m_map  = nullptr;
+        m_file = -1;
+        m_size = 0;
+
+      }  // end 'Detach()'
+
+      // ----------------------------------------------------------------------
+      //! Read a consistent snapshot
+      // ----------------------------------------------------------------------
+      /*! Returns false if nothing has been published
+       *  yet, or if no consistent copy could be made
+       *  in 'nTries' attempts.
+       */
+      bool Read(
+        std::vector<Item>& items,
+        uint64_t& nPublished,
+        double& time,
+        const std::size_t nTries = 100
+      ) const {
+
+        if (!m_map) return false;
+
+        const Header*     header = static_cast<const Header*>(m_map);
+        const Descriptor* descs  = reinterpret_cast<const Descriptor*>(static_cast<const char*>(m_map) + sizeof(Header));
+        const double*     data   = reinterpret_cast<const double*>(static_cast<const char*>(m_map) + sizeof(Header) + (header -> nItems * sizeof(Descriptor)));
+
+        std::vector<double> values(header -> nValues);
+        for (std::size_t iTry = 0; iTry < nTries; ++iTry) {
+
+          const uint64_t before = header -> sequence.load(std::memory_order_acquire);
+          if (before & 1) {
+            std::this_thread::yield();
+            continue;
+          }
+
+          std::memcpy(values.data(), data, values.size() * sizeof(double));
+          nPublished = header -> nPublished;
+          time       = header -> time;
+          std::atomic_thread_fence(std::memory_order_acquire);
+
+          const uint64_t after = header -> sequence.load(std::memory_order_relaxed);
+          if (before != after) continue;
+          if (nPublished == 0) return false;
+
+          // unpack values into items
+          items.clear();
+          for (uint32_t iItem = 0; iItem < header -> nItems; ++iItem) {
+            const Descriptor& desc    = descs[iItem];
+            const uint64_t    nValues = (desc.kind == Kind::Histogram) ? desc.nBins + 3 : 1;
+
+            Item item;
+            item.name  = std::string(desc.name, strnlen(desc.name, NameLength));
+            item.kind  = desc.kind;
+            item.nBins = desc.nBins;
+            item.low   = desc.low;
+            item.high  = desc.high;
+            item.values.assign(values.begin() + desc.offset, values.begin() + desc.offset + nValues);
+            items.push_back(item);
+          }
+          return true;
+        }
+        return false;
+
+      }  // end 'Read(std::vector<Item>&, uint64_t&, double&, std::size_t)'
+
+      // ----------------------------------------------------------------------
+      //! default ctor/dtor
+      // ----------------------------------------------------------------------
+      Reader()  {};
+      ~Reader() {Detach();};
+
+  };  // end SnapshotHelper::Reader
+
+}  // end SnapshotHelper namespace
+
+#endif
+
+// end ========================================================================
@@ -0,0 +1,357 @@
+/// ===========================================================================
+/*! \file   SpatialIndexHelper.hxx
+ *  \author Derek Anderson
+ *  \date   10.17.2026
+ *
+ *  A lightweight namespace to index objects (e.g.
+ *  clusters or hits) on an eta-phi grid, so that
+ *  everything within a cone of a point can be
+ *  found without looping over all objects.
+ */
+/// ===========================================================================
+
+#ifndef SpatialIndexHelper_hxx
+#define SpatialIndexHelper_hxx
+
+// c++ utilities
+#include <cmath>
+#include <limits>
+#include <vector>
+#include <cassert>
+#include <cstddef>
+#include <iostream>
+#include <algorithm>
+
+
+
+// ============================================================================
+//! Spatial Index Helper
+// ============================================================================
+/*! A small namespace to hold an eta-phi grid
+ *  index and routines to match objects to
+ *  points (e.g. generated particles) with it.
+ */
+namespace SpatialIndexHelper {
+
+  // --------------------------------------------------------------------------
+  //! Wrap a difference in phi into [-pi, pi)
+  // --------------------------------------------------------------------------
+  inline double WrapPhi(const double dPhi) {
+
+    return std::remainder(dPhi, 2. * M_PI);
+
+  }  // end 'WrapPhi(double)'
+
+
+
+  // --------------------------------------------------------------------------
+  //! Get distance in eta-phi
+  // --------------------------------------------------------------------------
+  inline double GetDeltaR(
+    const double etaA,
+    const double phiA,
+    const double etaB,
+    const double phiB
+  ) {
+
+    return std::hypot(etaA - etaB, WrapPhi(phiA - phiB));
+
+  }  // end 'GetDeltaR(double x 4)'
+
+
+
+  // ==========================================================================
+  //! Eta-phi grid
+  // ==========================================================================
+  /*! Objects are bucketed into square(ish) cells
+   *  with a counting sort and stored in a
+   *  compressed-sparse-row layout: the indices
+   *  of objects in cell c are
+   *
+   *    m_items[m_offsets[c]] ... m_items[m_offsets[c + 1] - 1]
+   *
+   *  so building is O(N) and a cone query only
+   *  touches the cells overlapping the cone.
+   *  Cells wrap around in phi.
+   *
+   *  The cell size should be comparable to the
+   *  cone radius used in queries. Objects with
+   *  a non-finite eta or phi are left out of
+   *  the grid.
+   */
+  class EtaPhiGrid {
+
+    private:
+
+      // data members
+      double                   m_etaMin   = 0.;
+      double                   m_etaSize  = 1.;
+      double                   m_phiSize  = 2. * M_PI;
+      std::size_t              m_nEta     = 1;
+      std::size_t              m_nPhi     = 1;
+      std::vector<double>      m_eta;
+      std::vector<double>      m_phi;
+      std::vector<std::size_t> m_offsets;
+      std::vector<std::size_t> m_items;
+
+      // ----------------------------------------------------------------------
+      //! Get cell indices
+      // ----------------------------------------------------------------------
+      std::size_t GetEtaCell(const double eta) const {
+
+        const double cell = std::floor((eta - m_etaMin) / m_etaSize);
+        return (std::size_t) std::clamp(cell, 0., (double) (m_nEta - 1));
+
+      }  // end 'GetEtaCell(double)'
+
+      std::size_t GetPhiCell(const double phi) const {
+
+        // n.b. shift phi into [0, 2pi) first
+        const double shifted = WrapPhi(phi) + M_PI;
+        const double cell    = std::floor(shifted / m_phiSize);
+        return (std::size_t) std::clamp(cell, 0., (double) (m_nPhi - 1));
+
+      }  // end 'GetPhiCell(double)'
+
+    public:
+
+      // ----------------------------------------------------------------------
+      //! Getters
+      // ----------------------------------------------------------------------
+      std::size_t GetSize()   const {return m_eta.size();}
+      std::size_t GetNCells() const {return m_nEta * m_nPhi;}
+
+      // ----------------------------------------------------------------------
+      //! Build index
+      // ----------------------------------------------------------------------
+      void Build(
+        const std::vector<double>& eta,
+        const std::vector<double>& phi,
+        const double cellSize
+      ) {
+
+        // n.b. cells of zero (or negative) size are meaningless
+        if (cellSize <= 0.) {
+          std::cerr << "PANIC: eta-phi grid cell size must be positive! (cell size = " << cellSize << ")" << std::endl;
+          assert(cellSize > 0.);
+        }
+
+        m_eta = eta;
+        m_phi = phi;
+
+        // flag objects which can't be placed on the grid
+        std::vector<bool> isFinite(m_eta.size());
+        std::size_t       nFinite = 0;
+        for (std::size_t iItem = 0; iItem < m_eta.size(); ++iItem) {
+          isFinite[iItem] = std::isfinite(m_eta[iItem]) && std::isfinite(m_phi[iItem]);
+          if (isFinite[iItem]) ++nFinite;
+        }
+        m_items.assign(nFinite, 0);
+
+        // set grid dimensions from (finite) data
+        m_etaSize = cellSize;
+        m_etaMin  = 0.;
+        m_nEta    = 1;
+        if (nFinite > 0) {
+          double etaMin = std::numeric_limits<double>::max();
+          double etaMax = std::numeric_limits<double>::lowest();
+          for (std::size_t iItem = 0; iItem < m_eta.size(); ++iItem) {
+            if (!isFinite[iItem]) continue;
+            etaMin = std::min(etaMin, m_eta[iItem]);
+            etaMax = std::max(etaMax, m_eta[iItem]);
+          }
+          m_etaMin = etaMin;
+          m_nEta   = (std::size_t) std::floor((etaMax - etaMin) / m_etaSize) + 1;
+        }
+        m_nPhi    = std::max((std::size_t) 1, (std::size_t) std::floor(2. * M_PI / cellSize));
+        m_phiSize = 2. * M_PI / m_nPhi;
+
+        // count objects in each cell, then turn counts into offsets
+        m_offsets.assign(GetNCells() + 1, 0);
+        std::vector<std::size_t> cells(m_eta.size());
+        for (std::size_t iItem = 0; iItem < m_eta.size(); ++iItem) {
+          if (!isFinite[iItem]) continue;
+          cells[iItem] = (GetEtaCell(m_eta[iItem]) * m_nPhi) + GetPhiCell(m_phi[iItem]);
+          ++m_offsets[cells[iItem] + 1];
+        }
+        for (std::size_t iCell = 0; iCell < GetNCells(); ++iCell) {
+          m_offsets[iCell + 1] += m_offsets[iCell];
+        }
+
+        // and place objects in their cells
+        std::vector<std::size_t> fill(m_offsets.begin(), m_offsets.end() - 1);
+        for (std::size_t iItem = 0; iItem < m_eta.size(); ++iItem) {
+          if (!isFinite[iItem]) continue;
+          m_items[fill[cells[iItem]]++] = iItem;
+        }
+
+      }  // end 'Build(std::vector<double>& x 2, double)'
+
+      // ----------------------------------------------------------------------
+      //! Apply a function to every object within a cone
+      // ----------------------------------------------------------------------
+      /*! The function is called as func(index, dR),
+       *  where index is the object's position in the
+       *  vectors the grid was built from.
+       */
+      template <typename Func> void ForEachInCone(
+        const double eta,
+        const double phi,
+        const double radius,
+        Func&& func
+      ) const {
+
+        if (m_items.empty()) return;
+        if (!std::isfinite(eta) || !std::isfinite(phi)) return;
+
+        // skip if cone is entirely outside of grid in eta
+        const double etaMax = m_etaMin + (m_nEta * m_etaSize);
+        if (((eta + radius) < m_etaMin) || ((eta - radius) >= etaMax)) return;
+
+        const std::size_t etaLow  = GetEtaCell(eta - radius);
+        const std::size_t etaHigh = GetEtaCell(eta + radius);
+
+        // n.b. if the cone spans the whole ring, visit each phi cell once
+        const long nPhiSide = (long) std::ceil(radius / m_phiSize);
+        const long phiCell  = (long) GetPhiCell(phi);
+        const bool allPhi   = ((2 * nPhiSide) + 1) >= (long) m_nPhi;
+        const long phiLow   = allPhi ? 0 : phiCell - nPhiSide;
+        const long phiHigh  = allPhi ? (long) m_nPhi - 1 : phiCell + nPhiSide;
+
+        for (std::size_t iEta = etaLow; iEta <= etaHigh; ++iEta) {
+          for (long iPhi = phiLow; iPhi <= phiHigh; ++iPhi) {
+
+            const std::size_t wrapped = (std::size_t) ((iPhi + (long) m_nPhi) % (long) m_nPhi);
+            const std::size_t cell    = (iEta * m_nPhi) + wrapped;
+            for (std::size_t iOff = m_offsets[cell]; iOff < m_offsets[cell + 1]; ++iOff) {
+              const std::size_t item = m_items[iOff];
+              const double      dR   = GetDeltaR(eta, phi, m_eta[item], m_phi[item]);
+              if (dR <= radius) func(item, dR);
+            }
+          }
+        }
+
+      }  // end 'ForEachInCone(double x 3, Func&&)'
+
+      // ----------------------------------------------------------------------
+      //! Get indices of all objects within a cone
+      // ----------------------------------------------------------------------
+      std::vector<std::size_t> GetInCone(
+        const double eta,
+        const double phi,
+        const double radius
+      ) const {
+
+        std::vector<std::size_t> items;
+        ForEachInCone(
+          eta,
+          phi,
+          radius,
+          [&items](const std::size_t item, const double) {items.push_back(item);}
+        );
+        return items;
+
+      }  // end 'GetInCone(double x 3)'
+
+      // ----------------------------------------------------------------------
+      //! default ctor/dtor
+      // ----------------------------------------------------------------------
+      EtaPhiGrid()  {};
+      ~EtaPhiGrid() {};
+
+      // ----------------------------------------------------------------------
+      //! ctor accepting objects to index
+      // ----------------------------------------------------------------------
+      EtaPhiGrid(
+        const std::vector<double>& eta,
+        const std::vector<double>& phi,
+        const double cellSize
+      ) {
+
+        Build(eta, phi, cellSize);
+
+      }  // end ctor(std::vector<double>& x 2, double)
+
+  };  // end SpatialIndexHelper::EtaPhiGrid
+
+
+
+  // --------------------------------------------------------------------------
+  //! Assign indexed objects to the nearest of a set of points
+  // --------------------------------------------------------------------------
+  /*! Each object goes to the closest point (e.g.
+   *  generated particle) whose cone contains it,
+   *  so no object is counted twice. Returns the
+   *  index of the point for each object, or -1
+   *  if it isn't in any cone.
+   */
+  inline std::vector<int> AssignToNearest(
+    const EtaPhiGrid& grid,
+    const std::vector<double>& eta,
+    const std::vector<double>& phi,
+    const double radius
+  ) {
+
+    std::vector<int>    owners(grid.GetSize(), -1);
+    std::vector<double> bestDR(grid.GetSize(), std::numeric_limits<double>::max());
+    for (std::size_t iPoint = 0; iPoint < eta.size(); ++iPoint) {
+      grid.ForEachInCone(
+        eta[iPoint],
+        phi[iPoint],
+        radius,
+        [&](const std::size_t item, const double dR) {
+          if (dR < bestDR[item]) {
+            bestDR[item] = dR;
+            owners[item] = (int) iPoint;
+          }
+        }
+      );
+    }
+    return owners;
+
+  }  // end 'AssignToNearest(EtaPhiGrid&, std::vector<double>& x 2, double)'
+
+
+
+  // --------------------------------------------------------------------------
+  //! Split objects between the nearest of a set of points
+  // --------------------------------------------------------------------------
+  /*! Indexes objects with a position (e.g. edm4eic
+   *  clusters or hits) and collects them into a
+   *  list per point (e.g. generated particle) with
+   *  AssignToNearest(). Objects outside of every
+   *  cone are dropped.
+   */
+  template <typename Collection, typename Object> inline void SplitByNearest(
+    const Collection& objects,
+    const std::vector<double>& eta,
+    const std::vector<double>& phi,
+    const double radius,
+    std::vector<std::vector<Object>>& byPoint
+  ) {
+
+    std::vector<double> objEtas;
+    std::vector<double> objPhis;
+    for (const auto& object : objects) {
+      const auto position = object.getPosition();
+      objEtas.push_back( std::asinh(position.z / std::hypot(position.x, position.y)) );
+      objPhis.push_back( std::atan2(position.y, position.x) );
+    }
+
+    const EtaPhiGrid       grid(objEtas, objPhis, radius);
+    const std::vector<int> owners = AssignToNearest(grid, eta, phi, radius);
+
+    byPoint.assign(eta.size(), {});
+    for (std::size_t iObj = 0; iObj < owners.size(); ++iObj) {
+      if (owners[iObj] >= 0) {
+        byPoint[owners[iObj]].push_back( objects[iObj] );
+      }
+    }
+
+  }  // end 'SplitByNearest(Collection&, std::vector<double>& x 2, double, std::vector<std::vector<Object>>&)'
+
+}  // end SpatialIndexHelper namespace
+
+#endif
+
+// end ========================================================================
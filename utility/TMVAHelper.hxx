@@ -539,6 +539,40 @@ namespace TMVAHelper {
 
       }  // end 'EvaluateMethods(TMVA::Reader*, NTupleHelper&)'
 
+      // ----------------------------------------------------------------------
+      //! Evaluate a single booked method
+      // ----------------------------------------------------------------------
+      /*! Only collects the regression outputs of the
+       *  specified method, e.g. for timing methods
+       *  individually.
+       */
+      inline void EvaluateMethod(TMVA::Reader* reader, const std::string& method) {
+
+        // check if method exists
+        auto iter = std::find(m_methods.begin(), m_methods.end(), method);
+        if (iter == m_methods.end()) {
+          std::cerr << "PANIC: method '" << method << "' wasn't booked!" << std::endl;
+          assert(iter != m_methods.end());
+        }
+
+        // if not evaluating method, exit
+        const std::size_t iMethod = iter - m_methods.begin();
+        if (!m_read.at(iMethod)) {
+          return;
+        }
+
+        // construct title & run evaluation
+        const std::string         title   = method + " method";
+        const std::vector<float>& targets = reader -> EvaluateRegression(title);
+
+        // collect regression output
+        for (std::size_t iTarget = 0; iTarget < m_targets.size(); ++iTarget) {
+          m_outvals.at(m_outdex[m_targets[iTarget] + "_" + method]) = targets.at(iTarget);
+        }
+        return;
+
+      }  // end 'EvaluateMethod(TMVA::Reader*, std::string&)'
+
       // ----------------------------------------------------------------------
       //! Default ctor/dtor
       // ----------------------------------------------------------------------
@@ -0,0 +1,424 @@
+/// ===========================================================================
+/*! \file   TimingHelper.hxx
+ *  \author Derek Anderson
+ *  \date   10.17.2026
+ *
+ *  A lightweight namespace to time and count the
+ *  stages of hot loops (e.g. in plugins or in the
+ *  podio macros). Timers are compiled in only if
+ *  `BHCAL_ENABLE_TIMERS` is defined.
+ */
+/// ===========================================================================
+
+#ifndef TimingHelper_hxx
+#define TimingHelper_hxx
+
+// c++ utilities
+#include <deque>
+#include <mutex>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <algorithm>
+// root libraries
+#include <TTree.h>
+
+
+
+// ============================================================================
+//! Instrumentation macros
+// ============================================================================
+/*! Use these rather than the classes below so
+ *  that instrumentation disappears entirely
+ *  when `BHCAL_ENABLE_TIMERS` isn't defined:
+ *
+ *    - `BHCAL_TIME_SCOPE(stage)`: time from here
+ *       to the end of the enclosing scope;
+ *    - `BHCAL_TIME_STAGES()`: declare a stage
+ *       timer for the enclosing scope;
+ *    - `BHCAL_TIME_STAGE(stage)`: end previous
+ *       stage (if any) and start a new one; and
+ *    - `BHCAL_COUNT_ITEMS(stage, n)`: add n items
+ *       processed to a stage.
+ *
+ *  Stage names must be string literals (or
+ *  otherwise fixed for a given call site),
+ *  since they're only looked up once.
+ */
+#ifdef BHCAL_ENABLE_TIMERS
+  #define BHCAL_TIMING_CONCAT_IMPL(a, b) a##b
+  #define BHCAL_TIMING_CONCAT(a, b) BHCAL_TIMING_CONCAT_IMPL(a, b)
+  #define BHCAL_TIME_SCOPE(stage) \
+    static const std::size_t BHCAL_TIMING_CONCAT(bhcalScopeIndex_, __LINE__) = TimingHelper::Registry::Get().GetIndex(stage); \
+    TimingHelper::ScopedTimer BHCAL_TIMING_CONCAT(bhcalScopeTimer_, __LINE__)(BHCAL_TIMING_CONCAT(bhcalScopeIndex_, __LINE__))
+  #define BHCAL_TIME_STAGES() \
+    TimingHelper::StageTimer bhcalStageTimer
+  #define BHCAL_TIME_STAGE(stage) \
+    do { \
+      static const std::size_t bhcalStageIndex = TimingHelper::Registry::Get().GetIndex(stage); \
+      bhcalStageTimer.Next(bhcalStageIndex); \
+    } while (0)
+  #define BHCAL_COUNT_ITEMS(stage, nitems) \
+    do { \
+      static const std::size_t bhcalCountIndex = TimingHelper::Registry::Get().GetIndex(stage); \
+      TimingHelper::Registry::Get().GetLocal(bhcalCountIndex).items += (nitems); \
+    } while (0)
+#else
+  #define BHCAL_TIME_SCOPE(stage)
+  #define BHCAL_TIME_STAGES()
+  #define BHCAL_TIME_STAGE(stage) do {} while (0)
+  #define BHCAL_COUNT_ITEMS(stage, nitems) do {} while (0)
+#endif
+
+
+
+// ============================================================================
+//! Timing Helper
+// ============================================================================
+/*! A small namespace to accumulate time, calls
+ *  and no. of items processed for named stages
+ *  of code. Each thread accumulates into its own
+ *  table, and tables are only merged when a
+ *  summary is requested.
+ */
+namespace TimingHelper {
+
+  // --------------------------------------------------------------------------
+  //! Check if timers are compiled in
+  // --------------------------------------------------------------------------
+  constexpr bool IsEnabled() {
+
+#ifdef BHCAL_ENABLE_TIMERS
+    return true;
+#else
+    return false;
+#endif
+
+  }  // end 'IsEnabled()'
+
+
+
+  // ==========================================================================
+  //! Stage
+  // ==========================================================================
+  /*! Accumulated time (in ns), no. of calls,
+   *  and no. of items processed for a stage.
+   */
+  struct Stage {
+
+    std::string name  = "";
+    double      ns    = 0.;
+    uint64_t    calls = 0;
+    uint64_t    items = 0;
+
+  };  // end Stage
+
+
+
+  // ==========================================================================
+  //! Registry
+  // ==========================================================================
+  /*! Holds the names of all stages and one table
+   *  of stages per thread. Tables are owned by the
+   *  registry so they outlive the threads which
+   *  filled them (e.g. JANA worker threads which
+   *  exit before Finish is called).
+   *
+   *  n.b. summaries should only be requested once
+   *  all threads are done filling.
+   */
+  class Registry {
+
+    private:
+
+      // data members
+      std::mutex                                       m_mutex;
+      std::vector<std::string>                         m_names;
+      std::deque<std::unique_ptr<std::vector<Stage>>> m_tables;
+
+      // ----------------------------------------------------------------------
+      //! Private ctor (use Get())
+      // ----------------------------------------------------------------------
+      Registry() {};
+
+    public:
+
+      // ----------------------------------------------------------------------
+      //! Get global registry
+      // ----------------------------------------------------------------------
+      static Registry& Get() {
+
+        static Registry registry;
+        return registry;
+
+      }  // end 'Get()'
+
+      // ----------------------------------------------------------------------
+      //! Get index of a stage, registering it if needed
+      // ----------------------------------------------------------------------
+      std::size_t GetIndex(const std::string& name) {
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        auto it = std::find(m_names.begin(), m_names.end(), name);
+        if (it != m_names.end()) {
+          return it - m_names.begin();
+        }
+        m_names.push_back(name);
+        return m_names.size() - 1;
+
+      }  // end 'GetIndex(std::string&)'
+
+      // ----------------------------------------------------------------------
+      //! Get this thread's entry for a stage
+      // ----------------------------------------------------------------------
+      Stage& GetLocal(const std::size_t index) {
+
+        thread_local std::vector<Stage>* table = nullptr;
+        if (!table) {
+          std::lock_guard<std::mutex> lock(m_mutex);
+          m_tables.emplace_back( std::make_unique<std::vector<Stage>>() );
+          table = m_tables.back().get();
+        }
+
+        if (index >= table -> size()) {
+          table -> resize(index + 1);
+        }
+        return (*table)[index];
+
+      }  // end 'GetLocal(std::size_t)'
+
+      // ----------------------------------------------------------------------
+      //! Merge all threads' tables into one summary
+      // ----------------------------------------------------------------------
+      std::vector<Stage> GetSummary() {
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        std::vector<Stage> summary(m_names.size());
+        for (std::size_t iStage = 0; iStage < m_names.size(); ++iStage) {
+          summary[iStage].name = m_names[iStage];
+        }
+
+        for (const auto& table : m_tables) {
+          for (std::size_t iStage = 0; iStage < table -> size(); ++iStage) {
+            summary[iStage].ns    += (*table)[iStage].ns;
+            summary[iStage].calls += (*table)[iStage].calls;
+            summary[iStage].items += (*table)[iStage].items;
+          }
+        }
+        return summary;
+
+      }  // end 'GetSummary()'
+
+      // ----------------------------------------------------------------------
+      //! Zero all accumulated values (stage names are kept)
+      // ----------------------------------------------------------------------
+      void Reset() {
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto& table : m_tables) {
+          std::fill(table -> begin(), table -> end(), Stage());
+        }
+
+      }  // end 'Reset()'
+
+  };  // end TimingHelper::Registry
+
+
+
+  // ==========================================================================
+  //! Scoped timer
+  // ==========================================================================
+  /*! Adds the time between construction and
+   *  destruction to a stage.
+   */
+  class ScopedTimer {
+
+    private:
+
+      // data members
+      std::size_t                           m_index;
+      std::chrono::steady_clock::time_point m_start;
+
+    public:
+
+      // ----------------------------------------------------------------------
+      //! ctor/dtor
+      // ----------------------------------------------------------------------
+      ScopedTimer(const std::size_t index) : m_index(index), m_start(std::chrono::steady_clock::now()) {};
+      ~ScopedTimer() {
+
+        const auto stop  = std::chrono::steady_clock::now();
+        Stage&     stage = Registry::Get().GetLocal(m_index);
+        stage.ns += std::chrono::duration<double, std::nano>(stop - m_start).count();
+        ++stage.calls;
+
+      }  // end dtor
+
+  };  // end TimingHelper::ScopedTimer
+
+
+
+  // ==========================================================================
+  //! Stage timer
+  // ==========================================================================
+  /*! Attributes time to whichever stage was last
+   *  started, until the next one is started or the
+   *  timer goes out of scope. Handy for loops with
+   *  early exits (e.g. `continue` or `return`).
+   */
+  class StageTimer {
+
+    private:
+
+      // data members
+      bool                                  m_running = false;
+      std::size_t                           m_index   = 0;
+      std::chrono::steady_clock::time_point m_start;
+
+    public:
+
+      // ----------------------------------------------------------------------
+      //! End current stage
+      // ----------------------------------------------------------------------
+      void Stop() {
+
+        if (!m_running) return;
+
+        const auto stop  = std::chrono::steady_clock::now();
+        Stage&     stage = Registry::Get().GetLocal(m_index);
+        stage.ns += std::chrono::duration<double, std::nano>(stop - m_start).count();
+        ++stage.calls;
+        m_running = false;
+
+      }  // end 'Stop()'
+
+      // ----------------------------------------------------------------------
+      //! End current stage and start another
+      // ----------------------------------------------------------------------
+      void Next(const std::size_t index) {
+
+        Stop();
+        m_index   = index;
+        m_running = true;
+        m_start   = std::chrono::steady_clock::now();
+
+      }  // end 'Next(std::size_t)'
+
+      // ----------------------------------------------------------------------
+      //! default ctor/dtor
+      // ----------------------------------------------------------------------
+      StageTimer()  {};
+      ~StageTimer() {Stop();};
+
+  };  // end TimingHelper::StageTimer
+
+
+
+  // --------------------------------------------------------------------------
+  //! Print summary
+  // --------------------------------------------------------------------------
+  inline void PrintSummary(const std::vector<Stage>& summary) {
+
+    std::cout << "    " << std::left << std::setw(32) << "stage"
+              << std::right << std::setw(14) << "time [ms]"
+              << std::setw(12) << "calls"
+              << std::setw(14) << "items"
+              << std::setw(14) << "ns/call"
+              << std::endl;
+    for (const Stage& stage : summary) {
+      std::cout << "    " << std::left << std::setw(32) << stage.name
+                << std::right << std::fixed << std::setprecision(3)
+                << std::setw(14) << stage.ns * 1e-6
+                << std::setw(12) << stage.calls
+                << std::setw(14) << stage.items
+                << std::setprecision(1)
+                << std::setw(14) << (stage.calls > 0 ? stage.ns / stage.calls : 0.)
+                << std::endl;
+    }
+    std::cout.unsetf(std::ios_base::floatfield);
+
+  }  // end 'PrintSummary(std::vector<Stage>&)'
+
+
+
+  // --------------------------------------------------------------------------
+  //! Write summary to a JSON file
+  // --------------------------------------------------------------------------
+  inline void WriteJSON(
+    const std::string& path,
+    const std::string& source,
+    const std::vector<Stage>& summary
+  ) {
+
+    std::ofstream out(path);
+    if (!out.is_open()) {
+      std::cerr << "WARNING: couldn't open '" << path << "' for writing! Not writing timing summary." << std::endl;
+      return;
+    }
+
+    out << std::setprecision(10);
+    out << "{\n"
+        << "  \"source\": \"" << source << "\",\n"
+        << "  \"stages\": [\n";
+    for (std::size_t iStage = 0; iStage < summary.size(); ++iStage) {
+      const Stage& stage = summary[iStage];
+      out << "    {\"stage\": \"" << stage.name << "\""
+          << ", \"time_ms\": " << stage.ns * 1e-6
+          << ", \"calls\": " << stage.calls
+          << ", \"items\": " << stage.items
+          << ", \"ns_per_call\": " << (stage.calls > 0 ? stage.ns / stage.calls : 0.)
+          << ", \"ns_per_item\": " << (stage.items > 0 ? stage.ns / stage.items : 0.)
+          << "}" << (iStage + 1 < summary.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n"
+        << "}" << std::endl;
+
+  }  // end 'WriteJSON(std::string&, std::string&, std::vector<Stage>&)'
+
+
+
+  // --------------------------------------------------------------------------
+  //! Make a TTree of summary in the current directory
+  // --------------------------------------------------------------------------
+  /*! One entry per stage. n.b. the tree isn't
+   *  written, that's left to the caller. Branch
+   *  addresses point at locals here, so they're
+   *  reset before returning.
+   */
+  inline TTree* MakeTree(const std::string& name, const std::vector<Stage>& summary) {
+
+    std::string stage;
+    double      time  = 0.;
+    ULong64_t   calls = 0;
+    ULong64_t   items = 0;
+
+    TTree* tree = new TTree(name.data(), "Time, calls and items per stage");
+    tree -> Branch("stage", &stage);
+    tree -> Branch("time_ms", &time, "time_ms/D");
+    tree -> Branch("calls", &calls, "calls/l");
+    tree -> Branch("items", &items, "items/l");
+
+    for (const Stage& entry : summary) {
+      stage = entry.name;
+      time  = entry.ns * 1e-6;
+      calls = entry.calls;
+      items = entry.items;
+      tree -> Fill();
+    }
+    tree -> ResetBranchAddresses();
+    return tree;
+
+  }  // end 'MakeTree(std::string&, std::vector<Stage>&)'
+
+}  // end TimingHelper namespace
+
+#endif
+
+// end ========================================================================
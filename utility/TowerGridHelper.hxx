@@ -0,0 +1,267 @@
+/// ===========================================================================
+/*! \file   TowerGridHelper.hxx
+ *  \author Derek Anderson
+ *  \date   10.17.2026
+ *
+ *  A lightweight namespace to sum hit energies
+ *  onto a fixed eta-phi tower grid, so that the
+ *  energy in any rectangular or circular window
+ *  can be had from a handful of lookups.
+ */
+/// ===========================================================================
+
+#ifndef TowerGridHelper_hxx
+#define TowerGridHelper_hxx
+
+// c++ utilities
+#include <cmath>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstddef>
+#include <algorithm>
+
+
+
+// ============================================================================
+//! Tower Grid Helper
+// ============================================================================
+/*! A small namespace to hold a summed-area
+ *  table over an eta-phi tower grid, and
+ *  some related utilities.
+ */
+namespace TowerGridHelper {
+
+  // --------------------------------------------------------------------------
+  //! Make a tag for a cone radius (e.g. 0.25 -> "R0p25")
+  // --------------------------------------------------------------------------
+  inline std::string MakeRadiusTag(const double radius) {
+
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%g", radius);
+
+    std::string tag = "R" + std::string(buffer);
+    std::replace(tag.begin(), tag.end(), '.', 'p');
+    return tag;
+
+  }  // end 'MakeRadiusTag(double)'
+
+
+
+  // ==========================================================================
+  //! Tower grid
+  // ==========================================================================
+  /*! Hits are summed into towers of fixed size in
+   *  eta and phi, after which a summed-area table
+   *  is built: entry (i, j) of the table holds the
+   *  energy of all towers with eta index < i and
+   *  phi index < j, so the energy in a block of
+   *  towers is
+   *
+   *    S(i1, j1) - S(i0, j1) - S(i1, j0) + S(i0, j0)
+   *
+   *  Blocks which wrap around in phi are split in
+   *  two. Circular windows are summed row by row,
+   *  i.e. two lookups per row of towers in the
+   *  cone, independent of the no. of hits.
+   *
+   *  Hits outside of the eta range are dropped.
+   */
+  class TowerGrid {
+
+    private:
+
+      // data members
+      double              m_etaMin  = -1.;
+      double              m_etaSize = 0.1;
+      double              m_phiSize = 2. * M_PI;
+      std::size_t         m_nEta    = 1;
+      std::size_t         m_nPhi    = 1;
+      std::vector<double> m_towers;
+      std::vector<double> m_table;
+
+      // ----------------------------------------------------------------------
+      //! Get entry of summed-area table
+      // ----------------------------------------------------------------------
+      double GetTable(const std::size_t iEta, const std::size_t iPhi) const {
+
+        return m_table[(iEta * (m_nPhi + 1)) + iPhi];
+
+      }  // end 'GetTable(std::size_t, std::size_t)'
+
+      // ----------------------------------------------------------------------
+      //! Sum a block which doesn't wrap (upper edges exclusive)
+      // ----------------------------------------------------------------------
+      double GetBlockSum(
+        const std::size_t etaLow,
+        const std::size_t etaHigh,
+        const std::size_t phiLow,
+        const std::size_t phiHigh
+      ) const {
+
+        return GetTable(etaHigh, phiHigh) - GetTable(etaLow, phiHigh)
+             - GetTable(etaHigh, phiLow) + GetTable(etaLow, phiLow);
+
+      }  // end 'GetBlockSum(std::size_t x 4)'
+
+    public:
+
+      // ----------------------------------------------------------------------
+      //! Getters
+      // ----------------------------------------------------------------------
+      std::size_t GetNEta() const {return m_nEta;}
+      std::size_t GetNPhi() const {return m_nPhi;}
+
+      // ----------------------------------------------------------------------
+      //! Get tower center
+      // ----------------------------------------------------------------------
+      double GetEtaCenter(const std::size_t iEta) const {
+
+        return m_etaMin + ((iEta + 0.5) * m_etaSize);
+
+      }  // end 'GetEtaCenter(std::size_t)'
+
+      double GetPhiCenter(const long iPhi) const {
+
+        return -M_PI + ((iPhi + 0.5) * m_phiSize);
+
+      }  // end 'GetPhiCenter(long)'
+
+      // ----------------------------------------------------------------------
+      //! Clear towers
+      // ----------------------------------------------------------------------
+      void Reset() {
+
+        std::fill(m_towers.begin(), m_towers.end(), 0.);
+
+      }  // end 'Reset()'
+
+      // ----------------------------------------------------------------------
+      //! Add energy to the tower containing (eta, phi)
+      // ----------------------------------------------------------------------
+      bool Add(const double eta, const double phi, const double energy) {
+
+        const double etaCell = std::floor((eta - m_etaMin) / m_etaSize);
+        if ((etaCell < 0.) || (etaCell >= (double) m_nEta)) return false;
+
+        // n.b. shift phi into [0, 2pi) first
+        const double shifted = std::remainder(phi, 2. * M_PI) + M_PI;
+        const double phiCell = std::clamp(std::floor(shifted / m_phiSize), 0., (double) (m_nPhi - 1));
+
+        m_towers[((std::size_t) etaCell * m_nPhi) + (std::size_t) phiCell] += energy;
+        return true;
+
+      }  // end 'Add(double x 3)'
+
+      // ----------------------------------------------------------------------
+      //! Build summed-area table (after all hits are added)
+      // ----------------------------------------------------------------------
+      void Build() {
+
+        const std::size_t stride = m_nPhi + 1;
+        for (std::size_t iEta = 0; iEta < m_nEta; ++iEta) {
+          double row = 0.;
+          for (std::size_t iPhi = 0; iPhi < m_nPhi; ++iPhi) {
+            row += m_towers[(iEta * m_nPhi) + iPhi];
+            m_table[((iEta + 1) * stride) + iPhi + 1] = m_table[(iEta * stride) + iPhi + 1] + row;
+          }
+        }
+
+      }  // end 'Build()'
+
+      // ----------------------------------------------------------------------
+      //! Sum towers in a block of indices (inclusive)
+      // ----------------------------------------------------------------------
+      /*! Eta indices are clipped to the grid, while
+       *  phi indices can run past either end and
+       *  wrap around.
+       */
+      double GetTowerSum(
+        const long etaLow,
+        const long etaHigh,
+        const long phiLow,
+        const long phiHigh
+      ) const {
+
+        const long etaStart = std::max(etaLow, 0L);
+        const long etaStop  = std::min(etaHigh, (long) m_nEta - 1);
+        if ((etaStop < etaStart) || (phiHigh < phiLow)) return 0.;
+
+        // whole ring
+        const long nPhi = (long) m_nPhi;
+        if ((phiHigh - phiLow + 1) >= nPhi) {
+          return GetBlockSum(etaStart, etaStop + 1, 0, m_nPhi);
+        }
+
+        // otherwise split block if it wraps
+        const long start = ((phiLow % nPhi) + nPhi) % nPhi;
+        const long stop  = start + (phiHigh - phiLow);
+        if (stop < nPhi) {
+          return GetBlockSum(etaStart, etaStop + 1, start, stop + 1);
+        }
+        return GetBlockSum(etaStart, etaStop + 1, start, m_nPhi)
+             + GetBlockSum(etaStart, etaStop + 1, 0, (stop - nPhi) + 1);
+
+      }  // end 'GetTowerSum(long x 4)'
+
+      // ----------------------------------------------------------------------
+      //! Sum towers whose centers are within a cone
+      // ----------------------------------------------------------------------
+      double GetConeSum(const double eta, const double phi, const double radius) const {
+
+        const long etaLow  = (long) std::ceil(((eta - radius - m_etaMin) / m_etaSize) - 0.5);
+        const long etaHigh = (long) std::floor(((eta + radius - m_etaMin) / m_etaSize) - 0.5);
+
+        double sum = 0.;
+        for (long iEta = std::max(etaLow, 0L); iEta <= std::min(etaHigh, (long) m_nEta - 1); ++iEta) {
+
+          const double dEta = GetEtaCenter(iEta) - eta;
+          if (std::abs(dEta) > radius) continue;
+
+          // find phi towers in this row whose centers are in the cone
+          const double halfWidth = std::sqrt((radius * radius) - (dEta * dEta));
+          const long   phiLow    = (long) std::ceil(((phi - halfWidth + M_PI) / m_phiSize) - 0.5);
+          const long   phiHigh   = (long) std::floor(((phi + halfWidth + M_PI) / m_phiSize) - 0.5);
+          sum += GetTowerSum(iEta, iEta, phiLow, phiHigh);
+        }
+        return sum;
+
+      }  // end 'GetConeSum(double x 3)'
+
+      // ----------------------------------------------------------------------
+      //! default ctor/dtor
+      // ----------------------------------------------------------------------
+      /*! n.b. there's no default ctor: a grid
+       *  without dimensions has no towers to
+       *  add energy to.
+       */
+      TowerGrid()  = delete;
+      ~TowerGrid() {};
+
+      // ----------------------------------------------------------------------
+      //! ctor accepting grid dimensions
+      // ----------------------------------------------------------------------
+      TowerGrid(
+        const double etaMin,
+        const double etaMax,
+        const double etaSize,
+        const std::size_t nPhi
+      ) {
+
+        m_etaMin  = etaMin;
+        m_etaSize = etaSize;
+        m_nEta    = std::max((std::size_t) 1, (std::size_t) std::ceil((etaMax - etaMin) / etaSize));
+        m_nPhi    = std::max((std::size_t) 1, nPhi);
+        m_phiSize = 2. * M_PI / m_nPhi;
+        m_towers.assign(m_nEta * m_nPhi, 0.);
+        m_table.assign((m_nEta + 1) * (m_nPhi + 1), 0.);
+
+      }  // end ctor(double x 3, std::size_t)
+
+  };  // end TowerGridHelper::TowerGrid
+
+}  // end TowerGridHelper namespace
+
+#endif
+
+// end ========================================================================
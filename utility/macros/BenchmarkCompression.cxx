@@ -0,0 +1,338 @@
+/// ===========================================================================
+/*! \file   BenchmarkCompression.cxx
+ *  \author Derek Anderson
+ *  \date   10.17.2026
+ *
+ *  A ROOT macro to rewrite representative output
+ *  files (podio reconstruction output, calibration
+ *  tuples, TMVA output, histogram files) under a
+ *  matrix of compression and basket settings, and
+ *  to recommend a profile for each type of file
+ *  (see 'utility/CompressionProfiles.hxx').
+ */
+/// ===========================================================================
+
+#define BenchmarkCompression_cxx
+
+// c++ utilities
+#include <set>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <utility>
+#include <iostream>
+#include <algorithm>
+// root libraries
+#include <TKey.h>
+#include <TFile.h>
+#include <TTree.h>
+#include <TClass.h>
+#include <TSystem.h>
+#include <TDirectory.h>
+// analysis utilities
+#include "../BenchmarkHelper.hxx"
+#include "../CompressionProfiles.hxx"
+
+
+
+// ============================================================================
+//! Struct to consolidate user options
+// ============================================================================
+/*! Each input is a (file type, file) pair, where
+ *  the type names the profile to recommend. Every
+ *  input is rewritten for each combination of
+ *  algorithm, level, basket size and auto-flush
+ *  ("default" algorithm and 0 basket size/auto-
+ *  flush leave ROOT's settings), then read back.
+ *
+ *  For each type, the recommended profile is the
+ *  smallest output whose read and write throughput
+ *  are within 'read_tolerance' and 'write_tolerance'
+ *  of the fastest. n.b. reads are of a freshly
+ *  written file, so they're mostly served from the
+ *  page cache and measure decompression rather
+ *  than disk speed.
+ */
+struct Options {
+  std::vector<std::pair<std::string, std::string>> inputs;           // (file type, input file)
+  std::vector<std::string>                         algorithms;       // algorithms to try
+  std::vector<int>                                 levels;           // compression levels to try
+  std::vector<int>                                 basket_sizes;     // basket sizes to try (bytes)
+  std::vector<Long64_t>                            auto_flushes;     // auto-flush settings to try
+  std::string                                      tmp_dir;          // directory for rewritten files
+  double                                           read_tolerance;   // tolerated read slowdown
+  double                                           write_tolerance;  // tolerated write slowdown
+  std::string                                      out_json;         // output json file
+  std::string                                      out_profiles;     // output profile file
+}  DefaultOptions = {
+  {
+    {"podio",      "../../reconstruction/forNewCalibWorkflow.evt5Ke10pim_central.d14m9y2024.podio.root"},
+    {"tuple",      "../../reconstruction/macros/forNewTrainingMacro_noNonzeroEvts_andDefinitePrimary.evt5Ke10pim_central.d14m9y2024.root"},
+    {"tmva",       "../../calibration/macros/forTMVATrainingTest.root"},
+    {"histograms", "../../histograms/calibration/forNewCalibWorkflow.hists.root"}
+  },
+  {"default", "zlib", "lz4", "zstd", "lzma"},
+  {1, 5, 9},
+  {0, 256000},
+  {0, -100000000},
+  "/tmp",
+  0.10,
+  0.50,
+  "benchmarkCompression.json",
+  "compressionProfiles.txt"
+};
+
+
+
+// ============================================================================
+//! Copy contents of a directory, rewriting any trees
+// ============================================================================
+/*! Returns the uncompressed size of everything
+ *  copied (in bytes).
+ */
+double CopyDirectory(
+  TDirectory* input,
+  TDirectory* output,
+  const CompressionProfiles::Profile& profile
+) {
+
+  double totBytes = 0.;
+
+  // n.b. keys are ordered by cycle, so only the
+  // first (i.e. latest) cycle of each is copied
+  std::set<std::string> copied;
+  for (TObject* object : *(input -> GetListOfKeys())) {
+
+    TKey*             key  = (TKey*) object;
+    const std::string name = key -> GetName();
+    if (copied.count(name)) continue;
+    copied.insert(name);
+
+    TClass* type = TClass::GetClass(key -> GetClassName());
+    if (!type) continue;
+
+    // recurse into subdirectories
+    if (type -> InheritsFrom(TDirectory::Class())) {
+      TDirectory* subdir = output -> mkdir(name.data());
+      totBytes += CopyDirectory((TDirectory*) key -> ReadObj(), subdir, profile);
+      continue;
+    }
+
+    // rewrite trees entry-by-entry so they're
+    // recompressed with the new settings
+    output -> cd();
+    if (type -> InheritsFrom(TTree::Class())) {
+      TTree* tree = (TTree*) key -> ReadObj();
+      TTree* copy = tree -> CloneTree(0);
+      CompressionProfiles::Apply(copy, profile);
+      for (Long64_t iEntry = 0; iEntry < tree -> GetEntries(); ++iEntry) {
+        tree -> GetEntry(iEntry);
+        copy -> Fill();
+      }
+      copy -> Write();
+      totBytes += tree -> GetTotBytes();
+      delete copy;
+      delete tree;
+    } else {
+      TObject* copy = key -> ReadObj();
+      copy -> Write(name.data());
+      totBytes += key -> GetObjlen();
+      delete copy;
+    }
+  }
+  return totBytes;
+
+}  // end 'CopyDirectory(TDirectory*, TDirectory*, CompressionProfiles::Profile&)'
+
+
+
+// ============================================================================
+//! Read back all contents of a directory
+// ============================================================================
+double ReadDirectory(TDirectory* input) {
+
+  double nRead = 0.;
+  for (TObject* object : *(input -> GetListOfKeys())) {
+
+    TKey*   key  = (TKey*) object;
+    TClass* type = TClass::GetClass(key -> GetClassName());
+    if (!type) continue;
+
+    if (type -> InheritsFrom(TDirectory::Class())) {
+      nRead += ReadDirectory((TDirectory*) key -> ReadObj());
+    } else if (type -> InheritsFrom(TTree::Class())) {
+      TTree* tree = (TTree*) key -> ReadObj();
+      for (Long64_t iEntry = 0; iEntry < tree -> GetEntries(); ++iEntry) {
+        nRead += tree -> GetEntry(iEntry);
+      }
+      delete tree;
+    } else {
+      delete key -> ReadObj();
+      nRead += key -> GetObjlen();
+    }
+  }
+  return nRead;
+
+}  // end 'ReadDirectory(TDirectory*)'
+
+
+
+// ============================================================================
+//! Reset peak resident memory (linux only)
+// ============================================================================
+/*! Writing 5 to /proc/self/clear_refs resets
+ *  VmHWM, so that each rewrite gets its own
+ *  peak.
+ */
+void ResetPeakMemory() {
+
+  std::ofstream refs("/proc/self/clear_refs");
+  if (refs.is_open()) refs << "5";
+  return;
+
+}  // end 'ResetPeakMemory()'
+
+
+
+// ============================================================================
+//! Benchmark compression settings of output files
+// ============================================================================
+void BenchmarkCompression(const Options& opt = DefaultOptions) {
+
+  // lower verbosity & announce start
+  gErrorIgnoreLevel = kError;
+  std::cout << "\n  Beginning compression benchmarks..." << std::endl;
+
+  // --------------------------------------------------------------------------
+  // Build matrix of settings
+  // --------------------------------------------------------------------------
+  std::vector<CompressionProfiles::Profile> settings;
+  for (const std::string& algorithm : opt.algorithms) {
+
+    // n.b. levels are meaningless for ROOT's default
+    std::vector<int> levels = opt.levels;
+    if (algorithm == "default") levels = {-1};
+
+    for (const int level : levels) {
+      for (const int basket : opt.basket_sizes) {
+        for (const Long64_t flush : opt.auto_flushes) {
+          settings.push_back( {"", algorithm, level, basket, flush} );
+        }
+      }
+    }
+  }
+  std::cout << "    Trying " << settings.size() << " settings per input." << std::endl;
+
+  // --------------------------------------------------------------------------
+  // Rewrite and read back each input
+  // --------------------------------------------------------------------------
+  std::vector<BenchmarkHelper::Result>      results;
+  std::vector<CompressionProfiles::Profile> recommended;
+  for (const auto& typeAndFile : opt.inputs) {
+
+    const std::string& type = typeAndFile.first;
+    const std::string& path = typeAndFile.second;
+
+    TFile* input = new TFile(path.data(), "read");
+    if (!input || input -> IsZombie()) {
+      std::cerr << "WARNING: couldn't open '" << path << "'! Skipping " << type << " input." << std::endl;
+      continue;
+    }
+    std::cout << "    Benchmarking " << type << " (" << path << ")..." << std::endl;
+
+    const std::size_t firstResult = results.size();
+    const std::string rewritten   = opt.tmp_dir + "/benchmarkCompression." + type + ".root";
+    for (const CompressionProfiles::Profile& setting : settings) {
+
+      BenchmarkHelper::Result result;
+      result.name = type + " " + setting.algorithm
+                  + "-" + std::to_string(setting.level)
+                  + " b" + std::to_string(setting.basketSize)
+                  + " f" + std::to_string(setting.autoFlush);
+      result.labels["type"]      = type;
+      result.labels["algorithm"] = setting.algorithm;
+
+      // rewrite
+      ResetPeakMemory();
+      BenchmarkHelper::Timer timer;
+      TFile* output = new TFile(rewritten.data(), "recreate");
+      CompressionProfiles::Apply(output, setting);
+      const double totBytes = CopyDirectory(input, output, setting);
+      output -> Close();
+      const double tWrite   = timer.GetElapsed() * 1e-9;
+      const double peakMem  = BenchmarkHelper::GetPeakResidentMemory();
+      delete output;
+
+      // read back
+      timer.Start();
+      TFile* check = new TFile(rewritten.data(), "read");
+      const double nRead = ReadDirectory(check);
+      const double size  = check -> GetSize();
+      check -> Close();
+      const double tRead = timer.GetElapsed() * 1e-9;
+      delete check;
+
+      // n.b. throughputs are of uncompressed bytes
+      result.metrics["level"]          = setting.level;
+      result.metrics["basket_size"]    = setting.basketSize;
+      result.metrics["auto_flush"]     = setting.autoFlush;
+      result.metrics["size_mb"]        = size / 1e6;
+      result.metrics["ratio"]          = (size > 0.) ? totBytes / size : 0.;
+      result.metrics["write_mb_per_s"] = (tWrite > 0.) ? (totBytes / 1e6) / tWrite : 0.;
+      result.metrics["read_mb_per_s"]  = (tRead > 0.) ? (nRead / 1e6) / tRead : 0.;
+      result.metrics["peak_rss_mb"]    = peakMem / 1e3;
+      results.push_back(result);
+
+    }  // end setting loop
+    input -> Close();
+    gSystem -> Unlink(rewritten.data());
+
+    // ------------------------------------------------------------------------
+    // Pick recommended profile for type
+    // ------------------------------------------------------------------------
+    double bestRead  = 0.;
+    double bestWrite = 0.;
+    for (std::size_t iResult = firstResult; iResult < results.size(); ++iResult) {
+      bestRead  = std::max(bestRead,  results[iResult].metrics["read_mb_per_s"]);
+      bestWrite = std::max(bestWrite, results[iResult].metrics["write_mb_per_s"]);
+    }
+
+    std::size_t iBest = results.size();
+    for (std::size_t iResult = firstResult; iResult < results.size(); ++iResult) {
+      auto& metrics = results[iResult].metrics;
+      if (metrics["read_mb_per_s"]  < ((1. - opt.read_tolerance)  * bestRead))  continue;
+      if (metrics["write_mb_per_s"] < ((1. - opt.write_tolerance) * bestWrite)) continue;
+      if ((iBest == results.size()) || (metrics["size_mb"] < results[iBest].metrics["size_mb"])) {
+        iBest = iResult;
+      }
+    }
+    if (iBest < results.size()) {
+      const std::size_t iSetting = iBest - firstResult;
+      CompressionProfiles::Profile profile = settings[iSetting];
+      profile.name = type;
+      recommended.push_back(profile);
+      results[iBest].labels["recommended"] = "yes";
+      std::cout << "      Recommended: " << results[iBest].name << std::endl;
+    }
+
+  }  // end input loop
+
+  // --------------------------------------------------------------------------
+  // Report and exit
+  // --------------------------------------------------------------------------
+  std::cout << "\n    Results:" << std::endl;
+  BenchmarkHelper::PrintResults(results, {"size_mb", "ratio", "write_mb_per_s", "read_mb_per_s", "peak_rss_mb"});
+
+  BenchmarkHelper::WriteJSON(opt.out_json, "BenchmarkCompression", results);
+  std::cout << "\n    Wrote results to: " << opt.out_json << std::endl;
+
+  CompressionProfiles::Write(opt.out_profiles, recommended);
+  std::cout << "    Wrote recommended profiles to: " << opt.out_profiles << std::endl;
+
+  // announce end & exit
+  std::cout << "  Finished compression benchmarks!\n" << std::endl;
+  return;
+
+}
+
+// end ========================================================================
@@ -0,0 +1,275 @@
+/// ===========================================================================
+/*! \file   BenchmarkUtilityHelpers.cxx
+ *  \author Derek Anderson
+ *  \date   10.17.2026
+ *
+ *  A ROOT macro to microbenchmark the hot operations
+ *  of the utility helpers (NTupleHelper, HistHelper,
+ *  GraphHelper and TMVAHelper) at realistic sizes,
+ *  and to compare them against a baseline.
+ */
+/// ===========================================================================
+
+#define BenchmarkUtilityHelpers_cxx
+
+// c++ utilities
+#include <string>
+#include <vector>
+#include <cassert>
+#include <utility>
+#include <iostream>
+// root libraries
+#include <TH1.h>
+#include <TH2.h>
+#include <TSystem.h>
+#include <TRandom3.h>
+#include <TGraphErrors.h>
+// tmva components
+#include <TMVA/Reader.h>
+// analysis utilities
+#include "../HistHelper.hxx"
+#include "../TMVAHelper.hxx"
+#include "../GraphHelper.hxx"
+#include "../NTupleHelper.hxx"
+#include "../BenchmarkHelper.hxx"
+#include "../../calibration/macros/TMVAClusterParameters.hxx"
+
+
+
+// ============================================================================
+//! Struct to consolidate user options
+// ============================================================================
+/*! If the baseline file doesn't exist, it's
+ *  generated from the current run; set
+ *  `do_update` to overwrite an existing one.
+ */
+struct Options {
+  std::string out_json;     // output json file
+  std::string baseline;     // baseline file
+  std::string in_tmva;      // input tmva directory (for reader benchmarks)
+  std::string name_tmva;    // name of TMVA process
+  std::size_t warmup;       // no. of warm-up calls
+  std::size_t repetitions;  // no. of timed repetitions
+  std::size_t iterations;   // no. of calls per repetition
+  double      tolerance;    // tolerated slowdown before flagging
+  bool        do_update;    // overwrite baseline with this run
+}  DefaultOptions = {
+  "benchmarkUtilityHelpers.json",
+  "benchmarkUtilityHelpers.baseline.txt",
+  "../../calibration/macros/tmva_test",
+  "TMVARegression",
+  1000,
+  30,
+  1000,
+  0.10,
+  false
+};
+
+
+
+// ============================================================================
+//! Microbenchmark utility helpers
+// ============================================================================
+void BenchmarkUtilityHelpers(const Options& opt = DefaultOptions) {
+
+  // lower verbosity & announce start
+  gErrorIgnoreLevel = kError;
+  std::cout << "\n  Beginning utility helper benchmarks..." << std::endl;
+
+  // don't attach histograms to a directory (so they can be deleted freely)
+  TH1::AddDirectory(false);
+
+  // benchmark configurations: expensive operations use fewer calls
+  BenchmarkHelper::Config cheap  = {opt.warmup, opt.repetitions, opt.iterations};
+  BenchmarkHelper::Config costly = {opt.warmup / 10, opt.repetitions, std::max((std::size_t) 1, opt.iterations / 10)};
+
+  // list of results & random numbers for inputs
+  std::vector<BenchmarkHelper::Result> results;
+  TRandom3                             random(12345);
+
+  // --------------------------------------------------------------------------
+  // NTupleHelper: same variables as the calibration tuple
+  // --------------------------------------------------------------------------
+  TMVAHelper::Parameters param = TMVAClusterParameters::GetParameters(false);
+
+  std::vector<std::string> variables;
+  for (const auto& useAndVar : param.variables) {
+    variables.push_back(useAndVar.second);
+  }
+  NTupleHelper tuple_helper(variables);
+  for (const std::string& var : variables) {
+    tuple_helper.SetVariable(var, random.Uniform(0., 10.));
+  }
+
+  results.push_back(
+    BenchmarkHelper::Run(
+      "NTupleHelper::GetVariable (x" + std::to_string(variables.size()) + ")",
+      [&]() {
+        double sum = 0.;
+        for (const std::string& var : variables) {
+          sum += tuple_helper.GetVariable(var);
+        }
+        BenchmarkHelper::Consume(sum);
+      },
+      cheap
+    )
+  );
+  results.push_back(
+    BenchmarkHelper::Run(
+      "NTupleHelper::SetVariable (x" + std::to_string(variables.size()) + ")",
+      [&]() {
+        float value = 0.;
+        for (const std::string& var : variables) {
+          tuple_helper.SetVariable(var, value);
+          value += 1.;
+        }
+      },
+      cheap
+    )
+  );
+  results.push_back(
+    BenchmarkHelper::Run(
+      "NTupleHelper::ResetValues",
+      [&]() {tuple_helper.ResetValues();},
+      cheap
+    )
+  );
+  results.push_back(
+    BenchmarkHelper::Run(
+      "NTupleHelper::GetValues",
+      [&]() {BenchmarkHelper::Consume(tuple_helper.GetValues().size());},
+      cheap
+    )
+  );
+  std::cout << "    Benchmarked NTupleHelper." << std::endl;
+
+  // --------------------------------------------------------------------------
+  // HistHelper
+  // --------------------------------------------------------------------------
+  HistHelper::Bins bins;
+
+  results.push_back(
+    BenchmarkHelper::Run(
+      "HistHelper::Bins::Get",
+      [&]() {BenchmarkHelper::Consume(bins.Get("energy").GetNum());},
+      cheap
+    )
+  );
+
+  HistHelper::Definition def1D("hBench1D", "", {"E [GeV]", "a.u."}, {bins.Get("energy")});
+  HistHelper::Definition def2D("hBench2D", "", {"E [GeV]", "E [GeV]", "a.u."}, {bins.Get("energy"), bins.Get("energy")});
+
+  // n.b. creation + deletion is timed
+  results.push_back(
+    BenchmarkHelper::Run(
+      "HistHelper::Definition::MakeTH1",
+      [&]() {delete def1D.MakeTH1();},
+      costly
+    )
+  );
+  results.push_back(
+    BenchmarkHelper::Run(
+      "HistHelper::Definition::MakeTH2",
+      [&]() {delete def2D.MakeTH2();},
+      costly
+    )
+  );
+  std::cout << "    Benchmarked HistHelper." << std::endl;
+
+  // --------------------------------------------------------------------------
+  // GraphHelper: typical resolution/linearity graph sizes
+  // --------------------------------------------------------------------------
+  for (const std::size_t nPoints : {4, 20}) {
+
+    GraphHelper::Definition graph("grBench" + std::to_string(nPoints));
+    for (std::size_t iPoint = 0; iPoint < nPoints; ++iPoint) {
+      graph.AddPoint( {(double) iPoint, random.Gaus(1., 0.1), 0., random.Uniform(0.01, 0.1)} );
+    }
+
+    results.push_back(
+      BenchmarkHelper::Run(
+        "GraphHelper::Definition::MakeTGraphErrors (" + std::to_string(nPoints) + " pts)",
+        [&]() {delete graph.MakeTGraphErrors();},
+        costly
+      )
+    );
+  }
+  std::cout << "    Benchmarked GraphHelper." << std::endl;
+
+  // --------------------------------------------------------------------------
+  // TMVAHelper: only if trained weights are available
+  // --------------------------------------------------------------------------
+  bool hasWeights = false;
+  for (const auto& methodAndOpt : param.methods) {
+    const std::string path = opt.in_tmva + "/weights/" + opt.name_tmva + "_" + methodAndOpt.first + ".weights.xml";
+    hasWeights = hasWeights || TMVAHelper::DoesFileExist(path);
+  }
+
+  if (hasWeights) {
+
+    TMVAHelper::Reader read_helper( param.variables, param.methods );
+    read_helper.SetOptions(param.opts_reading);
+
+    TMVA::Reader* reader = new TMVA::Reader(read_helper.CompressOptions().data());
+    read_helper.ReadVariables(reader, tuple_helper);
+    read_helper.BookMethodsToRead(reader, opt.in_tmva, opt.name_tmva);
+
+    // fill inputs with something plausible
+    for (const std::string& var : variables) {
+      tuple_helper.SetVariable(var, random.Uniform(0., 10.));
+    }
+
+    results.push_back(
+      BenchmarkHelper::Run(
+        "TMVAHelper::Reader::EvaluateMethods",
+        [&]() {read_helper.EvaluateMethods(reader, tuple_helper);},
+        costly
+      )
+    );
+    delete reader;
+    std::cout << "    Benchmarked TMVAHelper." << std::endl;
+
+  } else {
+    std::cerr << "WARNING: no weights found in '" << opt.in_tmva << "'! Not benchmarking TMVAHelper::Reader." << std::endl;
+  }
+
+  // --------------------------------------------------------------------------
+  // Compare against baseline
+  // --------------------------------------------------------------------------
+  std::size_t nRegress = 0;
+
+  const bool hasBaseline = TMVAHelper::DoesFileExist(opt.baseline);
+  if (hasBaseline && !opt.do_update) {
+    std::cout << "\n    Comparing to baseline '" << opt.baseline << "':" << std::endl;
+    nRegress = BenchmarkHelper::CompareToBaseline(
+      results,
+      BenchmarkHelper::ReadBaseline(opt.baseline),
+      opt.tolerance
+    );
+  } else {
+    BenchmarkHelper::WriteBaseline(opt.baseline, results);
+    std::cout << "\n    Wrote baseline to: " << opt.baseline << std::endl;
+  }
+
+  // --------------------------------------------------------------------------
+  // Report and exit
+  // --------------------------------------------------------------------------
+  std::cout << "\n    Results:" << std::endl;
+  BenchmarkHelper::PrintResults(results, {"ns_per_op", "ci95_ns", "median_ns", "min_ns"});
+
+  BenchmarkHelper::WriteJSON(opt.out_json, "BenchmarkUtilityHelpers", results);
+  std::cout << "\n    Wrote results to: " << opt.out_json << std::endl;
+
+  // flag regressions
+  if (nRegress > 0) {
+    std::cerr << "WARNING: " << nRegress << " benchmark(s) slower than baseline!" << std::endl;
+    gSystem -> Exit(1);
+  }
+
+  // announce end & exit
+  std::cout << "  Finished utility helper benchmarks!\n" << std::endl;
+  return;
+
+}
+
+// end ========================================================================